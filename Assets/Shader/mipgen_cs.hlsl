@@ -1,4 +1,5 @@
-Texture2D<float4> gSourceTexture : register(t0);
+// texture SRVs are arrays, textures without a chain are always a single slice
+Texture2DArray<float4> gSourceTexture : register(t0);
 RWTexture2D<float4> gDestTexture : register(u0);
 
 SamplerState gLinearClampSampler : register(s0);
@@ -29,7 +30,7 @@ void CS(uint3 dispatchThreadId : SV_DispatchThreadID)
     float4 color =
         gSourceTexture.SampleLevel(
             gLinearClampSampler,
-            uv,
+            float3(uv, 0.0f),
             gSourceMipLevel
         );
 
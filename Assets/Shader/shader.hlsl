@@ -27,6 +27,11 @@ cbuffer cbPerObject : register(b0)
     float gNormalScale;
     float gOcclusionStrength;
     int padding2;
+
+    float3 gPositionOffset; // quantized vertices only
+    float padding3;
+    float3 gPositionScale;
+    float padding4;
 };
 
 cbuffer cbPass : register(b1)
@@ -68,10 +73,22 @@ struct sLight
 
 StructuredBuffer<sLight> gLights : register(t0);
 
-// t1 .. tN
-Texture2D textures[GFX_MAX_NUMGER_OF_TEXTURES] : register(t1);
+// bindless table from t1 on, single textures are one slice arrays. Unbounded, its size is
+// GFX_BINDLESS_TEXTURE_CAPACITY on the CPU side
+Texture2DArray textures[] : register(t1);
 SamplerState samp : register(s0);
 
+// material texture indices point here, see cTexturePacker
+struct sTextureRef
+{
+    uint descriptorIndex;
+    uint slice;
+    float2 padding;
+    float4 uvRect; // atlas offset xy, scale zw
+};
+
+StructuredBuffer<sTextureRef> gTextureRefs : register(t0, space1);
+
 // === Vertex Input / Output ===
 struct sVertexIn
 {
@@ -92,6 +109,47 @@ struct sVertexOut
     float2 texC2 : TEXCOORD1;
 };
 
+struct sVertexQuantizedIn
+{
+    float4 pos : POSITION;      // unorm16, relative to the submesh bounds
+#if GFX_QTANGENT_VERTICES
+    float4 qtangent : TANGENT;  // snorm16 quaternion, sign of w = bitangent sign
+#else
+    float2 normal : NORMAL;     // snorm16, octahedral
+#endif
+    float2 texC : TEXCOORD0;    // fp16
+    float2 texC2 : TEXCOORD1;   // fp16
+};
+
+float3 DecodeOctahedral(float2 e)
+{
+    float3 n = float3(e.x, e.y, 1.0f - abs(e.x) - abs(e.y));
+    float t = saturate(-n.z);
+
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+
+    return normalize(n);
+}
+
+// rotates the +X / +Z axes by the quaternion, see cVertexQuantization::DecodeQTangent
+void DecodeQTangent(float4 q, out float3 normal, out float4 tangent)
+{
+    float handedness = q.w < 0.0f ? -1.0f : 1.0f;
+    q = normalize(q);
+
+    tangent = float4(
+        1.0f - 2.0f * (q.y * q.y + q.z * q.z),
+        2.0f * (q.x * q.y + q.w * q.z),
+        2.0f * (q.x * q.z - q.w * q.y),
+        handedness);
+
+    normal = float3(
+        2.0f * (q.x * q.z + q.w * q.y),
+        2.0f * (q.y * q.z - q.w * q.x),
+        1.0f - 2.0f * (q.x * q.x + q.y * q.y));
+}
+
 // === Vertex Shader ===
 sVertexOut VS(sVertexIn vin)
 {
@@ -115,12 +173,41 @@ sVertexOut VS(sVertexIn vin)
     return vout;
 }
 
+sVertexOut VSQuantized(sVertexQuantizedIn vin)
+{
+    sVertexIn v;
+
+    v.pos = gPositionOffset + vin.pos.xyz * gPositionScale;
+#if GFX_QTANGENT_VERTICES
+    DecodeQTangent(vin.qtangent, v.normal, v.tangentU);
+#else
+    v.normal = DecodeOctahedral(vin.normal);
+    v.tangentU = float4(0.0f, 0.0f, 0.0f, 1.0f);
+#endif
+    v.texC = vin.texC;
+    v.texC2 = vin.texC2;
+
+    return VS(v);
+}
+
 // === Texture Sampling Helper ===
 float4 SampleTextureByIndex(int index, float2 uv, float4 defaultValue)
 {
-    if (index >= 0 && index < GFX_MAX_NUMGER_OF_TEXTURES)
+    // the table holds an entry for every index a material uses (root SRVs carry no size)
+    if (index >= 0)
     {
-        return textures[NonUniformResourceIndex((uint) index)].Sample(samp, uv);
+        sTextureRef ref = gTextureRefs[index];
+
+        // textures that got no slot sample the default
+        if (ref.descriptorIndex != 0xFFFFFFFF)
+        {
+            // wrap inside the atlas rect, gradients from the unwrapped uv keep the mip selection
+            // continuous across the seam
+            float2 atlasUv = ref.uvRect.xy + frac(uv) * ref.uvRect.zw;
+
+            return textures[NonUniformResourceIndex(ref.descriptorIndex)].SampleGrad(samp,
+                float3(atlasUv, ref.slice), ddx(uv) * ref.uvRect.zw, ddy(uv) * ref.uvRect.zw);
+        }
     }
 
     return defaultValue;
@@ -146,14 +233,16 @@ float3 GetNormalW(float3 normalW, float4 tangentW, float2 uv)
 
     float3 B = normalize(cross(N, T) * tangentW.w);
 
-    float3 normalTex = SampleTextureByIndex(
+    float2 normalTex = SampleTextureByIndex(
         gNormalIndex,
         uv,
         float4(0.5f, 0.5f, 1.0f, 1.0f)
-    ).xyz;
+    ).xy;
 
-    // [0,1] -> [-1,1]
-    float3 tangentNormal = normalTex * 2.0f - 1.0f;
+    // [0,1] -> [-1,1], Z is rebuilt because BC5 / RG8 normal maps only store X/Y
+    float3 tangentNormal;
+    tangentNormal.xy = normalTex * 2.0f - 1.0f;
+    tangentNormal.z = sqrt(saturate(1.0f - dot(tangentNormal.xy, tangentNormal.xy)));
 
     // glTF normalTexture.scale skaliert X/Y
     tangentNormal.xy *= gNormalScale;
@@ -225,7 +314,7 @@ float4 PS(sVertexOut pin) : SV_Target
     // Metallic-Roughness
     //
     // glTF Packing:
-    // R = unused
+    // R = unused (occlusion in ORM textures)
     // G = roughness
     // B = metallic
     // A = unused
@@ -246,12 +335,20 @@ float4 PS(sVertexOut pin) : SV_Target
     //
     // glTF Packing:
     // R = ambient occlusion
+    //
+    // ORM textures (packed at load or by the exporter) are bound to
+    // both slots, the metallic-roughness sample already holds it
     // ------------------------------------------------------------
-    float occlusionSample = SampleTextureByIndex(
-        gOcclusionIndex,
-        pin.texC,
-        float4(1.0f, 1.0f, 1.0f, 1.0f)
-    ).r;
+    float occlusionSample = metallicRoughnessTex.r;
+
+    if (gOcclusionIndex != gMetallicRoughnessIndex)
+    {
+        occlusionSample = SampleTextureByIndex(
+            gOcclusionIndex,
+            pin.texC,
+            float4(1.0f, 1.0f, 1.0f, 1.0f)
+        ).r;
+    }
 
     float ao = lerp(1.0f, occlusionSample, saturate(gOcclusionStrength));
     ao = saturate(ao * gAO);
@@ -0,0 +1,280 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "spscQueue.h"
+#include "timer.h"
+
+struct sFramePipelineStats
+{
+	uint64_t	frames;
+	double		totalHandoffSeconds;	// submit to the start of the consumer, summed
+	double		maxHandoffSeconds;
+};
+
+// Hands frames from a producer thread to a consumer thread (game -> render). The producer
+// fills a snapshot from BeginFrame and passes it on with SubmitFrame, the consumer thread
+// runs the consume function on it while the producer fills the next one. Snapshots travel
+// through two lock-free queues (submitted and consumed), a side that finds its queue empty
+// sleeps until the other one signals. With _SnapshotCount 2 the producer runs at most one
+// frame ahead. Exceptions of the consume function are rethrown on the producer. Knows
+// nothing about what a frame holds.
+template<typename T, size_t _SnapshotCount = 2>
+class cFramePipeline
+{
+	public:
+
+		cFramePipeline()
+			: m_pCurrent(nullptr)
+			, m_stop(false)
+			, m_failed(false)
+			, m_pException(nullptr)
+			, m_submittedFrames(0)
+			, m_consumedFrames(0)
+			, m_handoffNanoseconds(0)
+			, m_maxHandoffNanoseconds(0)
+		{
+			// every snapshot starts out consumed, BeginFrame takes them from there
+			for (sSlot& rSlot : m_slots)
+			{
+				m_consumed.TryPush(&rSlot);
+			}
+		}
+
+		~cFramePipeline()
+		{
+			Stop();
+		}
+
+		cFramePipeline(const cFramePipeline&)				= delete;
+		cFramePipeline& operator=(const cFramePipeline&)	= delete;
+
+	public:
+
+		// without _useThread SubmitFrame consumes the frame on the calling thread
+		void Start(std::function<void(T&)> _consume, bool _useThread = true)
+		{
+			assert(!m_thread.joinable());
+
+			m_consume = std::move(_consume);
+
+			if (_useThread)
+			{
+				m_thread = std::thread(&cFramePipeline::ThreadMain, this);
+			}
+		}
+
+		// consumes every submitted frame first
+		void Stop()
+		{
+			if (!m_thread.joinable())
+				return;
+
+			m_stop.store(true, std::memory_order_release);
+			Signal(m_submittedCondition);
+
+			m_thread.join();
+
+			m_stop.store(false, std::memory_order_relaxed);
+		}
+
+		// a snapshot nobody reads, waits while every one is in flight
+		T& BeginFrame()
+		{
+			RethrowConsumerException();
+
+			if (m_pCurrent)
+				return m_pCurrent->snapshot;
+
+			while (!m_consumed.TryPop(m_pCurrent))
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+
+				m_consumedCondition.wait(lock, [this]()
+					{
+						return !m_consumed.IsEmpty() || m_failed.load(std::memory_order_acquire);
+					});
+
+				lock.unlock();
+
+				RethrowConsumerException();
+			}
+
+			return m_pCurrent->snapshot;
+		}
+
+		void SubmitFrame()
+		{
+			assert(m_pCurrent);
+
+			m_pCurrent->submitTime = Clock::now();
+
+			m_submittedFrames.fetch_add(1, std::memory_order_relaxed);
+
+			if (!m_thread.joinable())
+			{
+				Consume(*m_pCurrent);
+
+				m_consumed.TryPush(m_pCurrent);
+				m_consumedFrames.fetch_add(1, std::memory_order_release);
+			}
+			else
+			{
+				// there are fewer snapshots than slots, the push always succeeds
+				const bool pushed = m_submitted.TryPush(m_pCurrent);
+
+				assert(pushed);
+				(void)pushed;
+
+				Signal(m_submittedCondition);
+			}
+
+			m_pCurrent = nullptr;
+		}
+
+		// returns once every submitted frame was consumed
+		void WaitIdle()
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+
+				m_consumedCondition.wait(lock, [this]()
+					{
+						return m_consumedFrames.load(std::memory_order_acquire) >= m_submittedFrames.load(std::memory_order_relaxed) ||
+							m_failed.load(std::memory_order_acquire);
+					});
+			}
+
+			RethrowConsumerException();
+		}
+
+		sFramePipelineStats GetStats() const
+		{
+			sFramePipelineStats stats = {};
+
+			stats.frames                = m_consumedFrames.load(std::memory_order_acquire);
+			stats.totalHandoffSeconds   = static_cast<double>(m_handoffNanoseconds.load(std::memory_order_relaxed)) * 1.0e-9;
+			stats.maxHandoffSeconds     = static_cast<double>(m_maxHandoffNanoseconds.load(std::memory_order_relaxed)) * 1.0e-9;
+
+			return stats;
+		}
+
+	private:
+
+		struct sSlot
+		{
+			T			snapshot;
+			TimePoint	submitTime;
+		};
+
+		void ThreadMain()
+		{
+			for (;;)
+			{
+				sSlot* pSlot = nullptr;
+
+				if (!m_submitted.TryPop(pSlot))
+				{
+					// frames submitted before Stop are visible once the flag is, they are consumed first
+					if (m_stop.load(std::memory_order_acquire) && m_submitted.IsEmpty())
+						return;
+
+					std::unique_lock<std::mutex> lock(m_mutex);
+
+					m_submittedCondition.wait(lock, [this]()
+						{
+							return !m_submitted.IsEmpty() || m_stop.load(std::memory_order_acquire);
+						});
+
+					continue;
+				}
+
+				// after a failure the snapshots only travel back, the producer rethrows
+				if (!m_failed.load(std::memory_order_relaxed))
+				{
+					try
+					{
+						Consume(*pSlot);
+					}
+					catch (...)
+					{
+						m_pException = std::current_exception();
+						m_failed.store(true, std::memory_order_release);
+					}
+				}
+
+				m_consumed.TryPush(pSlot);
+				m_consumedFrames.fetch_add(1, std::memory_order_release);
+
+				Signal(m_consumedCondition);
+			}
+		}
+
+		// the waiter checks its condition under the lock, taking it once before the notify
+		// makes sure it either saw the change or already sleeps
+		void Signal(std::condition_variable& _rCondition)
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+			}
+
+			_rCondition.notify_one();
+		}
+
+		void Consume(sSlot& _rSlot)
+		{
+			const uint64_t handoff = static_cast<uint64_t>(
+				std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - _rSlot.submitTime).count());
+
+			// only the consuming thread writes these
+			m_handoffNanoseconds.fetch_add(handoff, std::memory_order_relaxed);
+			m_maxHandoffNanoseconds.store((std::max)(m_maxHandoffNanoseconds.load(std::memory_order_relaxed), handoff),
+				std::memory_order_relaxed);
+
+			m_consume(_rSlot.snapshot);
+		}
+
+		void RethrowConsumerException()
+		{
+			if (!m_failed.load(std::memory_order_acquire) || !m_pException)
+				return;
+
+			std::exception_ptr pException = m_pException;
+
+			m_pException = nullptr;
+
+			std::rethrow_exception(pException);
+		}
+
+	private:
+
+		sSlot										m_slots[_SnapshotCount];
+		cSpscQueue<sSlot*, _SnapshotCount + 1>		m_submitted;	// producer -> consumer
+		cSpscQueue<sSlot*, _SnapshotCount + 1>		m_consumed;		// consumer -> producer
+		sSlot*										m_pCurrent;
+
+		std::mutex									m_mutex;				// only for sleeping, the queues need no lock
+		std::condition_variable						m_submittedCondition;	// consumer sleeps on it
+		std::condition_variable						m_consumedCondition;	// producer sleeps on it
+
+		std::function<void(T&)>						m_consume;
+		std::thread									m_thread;
+		std::atomic<bool>							m_stop;
+		std::atomic<bool>							m_failed;
+		std::exception_ptr							m_pException;	// written before m_failed
+
+		std::atomic<uint64_t>						m_submittedFrames;
+		std::atomic<uint64_t>						m_consumedFrames;
+		std::atomic<uint64_t>						m_handoffNanoseconds;
+		std::atomic<uint64_t>						m_maxHandoffNanoseconds;
+};
@@ -0,0 +1,182 @@
+#include "hash.h"
+
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__)
+#define HASH_SSE2 1
+#include <emmintrin.h>
+#else
+#define HASH_SSE2 0
+#endif
+
+constexpr uint64_t  c_Prime32_1         = 0x9E3779B1ull;
+constexpr uint64_t  c_Prime64_1         = 0x9E3779B185EBCA87ull;
+constexpr uint64_t  c_Prime64_2         = 0xC2B2AE3D27D4EB4Full;
+constexpr uint64_t  c_Prime64_3         = 0x165667B19E3779F9ull;
+constexpr uint64_t  c_Prime64_4         = 0x85EBCA77C2B2AE63ull;
+
+constexpr size_t    c_StripeBytes       = 64;
+constexpr size_t    c_Lanes             = c_StripeBytes / sizeof(uint64_t);
+
+// stripes between two scrambles, keeps the lanes from saturating in their high bits
+constexpr size_t    c_StripesPerBlock   = 16;
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+static uint64_t Avalanche(uint64_t _hash)
+{
+    _hash ^= _hash >> 33;
+    _hash *= c_Prime64_2;
+    _hash ^= _hash >> 29;
+    _hash *= c_Prime64_3;
+    _hash ^= _hash >> 32;
+
+    return _hash;
+}
+
+static uint64_t RotateLeft(uint64_t _value, int _bits)
+{
+    return (_value << _bits) | (_value >> (64 - _bits));
+}
+
+#if !HASH_SSE2
+// the scalar stripes read their lanes with it
+static uint64_t Read64(const uint8_t* _pBytes)
+{
+    // little endian on every platform the engine targets
+    uint64_t value;
+    std::memcpy(&value, _pBytes, sizeof(value));
+
+    return value;
+}
+#endif
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// acc[i] += lo32(d ^ k) * hi32(d ^ k) + d of the neighbouring lane
+static void AccumulateStripe(uint64_t* _pAcc, const uint8_t* _pStripe, const uint64_t* _pKeys)
+{
+#if HASH_SSE2
+    for (size_t i = 0; i < c_Lanes; i += 2)
+    {
+        const __m128i data      = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_pStripe + i * sizeof(uint64_t)));
+        const __m128i key       = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_pKeys + i));
+        const __m128i dataKey   = _mm_xor_si128(data, key);
+        const __m128i keyHigh   = _mm_shuffle_epi32(dataKey, _MM_SHUFFLE(0, 3, 0, 1));
+        const __m128i product   = _mm_mul_epu32(dataKey, keyHigh);
+        const __m128i swapped   = _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+
+        __m128i acc = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_pAcc + i));
+
+        acc = _mm_add_epi64(acc, product);
+        acc = _mm_add_epi64(acc, swapped);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(_pAcc + i), acc);
+    }
+#else
+    uint64_t data[c_Lanes];
+
+    for (size_t i = 0; i < c_Lanes; ++i)
+    {
+        data[i] = Read64(_pStripe + i * sizeof(uint64_t));
+    }
+
+    for (size_t i = 0; i < c_Lanes; ++i)
+    {
+        const uint64_t dataKey = data[i] ^ _pKeys[i];
+
+        _pAcc[i] += (dataKey & 0xFFFFFFFFull) * (dataKey >> 32) + data[i ^ 1];
+    }
+#endif
+}
+
+// acc = (acc ^ (acc >> 47) ^ k) * prime32
+static void ScrambleLanes(uint64_t* _pAcc, const uint64_t* _pKeys)
+{
+#if HASH_SSE2
+    const __m128i prime = _mm_set1_epi32(static_cast<int>(c_Prime32_1));
+
+    for (size_t i = 0; i < c_Lanes; i += 2)
+    {
+        __m128i acc = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_pAcc + i));
+
+        acc = _mm_xor_si128(acc, _mm_srli_epi64(acc, 47));
+        acc = _mm_xor_si128(acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(_pKeys + i)));
+
+        // 64 x 32 bit multiply from two 32 x 32 bit halves
+        const __m128i low   = _mm_mul_epu32(acc, prime);
+        const __m128i high  = _mm_mul_epu32(_mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)), prime);
+
+        acc = _mm_add_epi64(low, _mm_slli_epi64(high, 32));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(_pAcc + i), acc);
+    }
+#else
+    for (size_t i = 0; i < c_Lanes; ++i)
+    {
+        uint64_t acc = _pAcc[i];
+
+        acc ^= acc >> 47;
+        acc ^= _pKeys[i];
+        acc *= c_Prime32_1;
+
+        _pAcc[i] = acc;
+    }
+#endif
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+uint64_t cHash::Hash64(const void* _pData, size_t _byteSize, uint64_t _seed)
+{
+    const uint8_t* pBytes = static_cast<const uint8_t*>(_pData);
+
+    uint64_t keys[c_Lanes];
+    uint64_t acc[c_Lanes];
+
+    for (size_t i = 0; i < c_Lanes; ++i)
+    {
+        keys[i] = Avalanche(_seed + c_Prime64_1 * (i + 1));
+        acc[i]  = c_Prime64_4 * (i + 1);
+    }
+
+    const size_t stripeCount = _byteSize / c_StripeBytes;
+
+    for (size_t stripe = 0; stripe < stripeCount; ++stripe)
+    {
+        AccumulateStripe(acc, pBytes + stripe * c_StripeBytes, keys);
+
+        if (stripe % c_StripesPerBlock == c_StripesPerBlock - 1)
+            ScrambleLanes(acc, keys);
+    }
+
+    // the partial stripe is zero padded, the length below tells it apart from real zeros
+    const size_t tailBytes = _byteSize - stripeCount * c_StripeBytes;
+
+    if (tailBytes > 0)
+    {
+        uint8_t tail[c_StripeBytes] = {};
+        std::memcpy(tail, pBytes + stripeCount * c_StripeBytes, tailBytes);
+
+        AccumulateStripe(acc, tail, keys);
+    }
+
+    uint64_t hash = _seed ^ (static_cast<uint64_t>(_byteSize) * c_Prime64_1);
+
+    for (size_t i = 0; i < c_Lanes; ++i)
+    {
+        hash ^= RotateLeft((acc[i] ^ keys[i]) * c_Prime64_2, 31) * c_Prime64_1;
+        hash  = RotateLeft(hash, 27) * c_Prime64_1 + c_Prime64_4;
+    }
+
+    return Avalanche(hash);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+uint64_t cHash::Combine(uint64_t _hash, uint64_t _value)
+{
+    return Avalanche(RotateLeft(_hash, 27) * c_Prime64_1 + _value * c_Prime64_2 + c_Prime64_4);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Non-cryptographic 64 bit content hash in the style of XXH3. 64 byte stripes are
+// folded into eight 64 bit lanes with 32x32 bit multiplies (SSE2 when available,
+// a scalar path with identical results otherwise), so equal bytes hash equal on
+// every build. Not compatible with the reference xxHash output.
+class cHash
+{
+	public:
+
+		static uint64_t Hash64(const void* _pData, size_t _byteSize, uint64_t _seed = 0);
+
+		// order dependent, for hashing a few values after each other
+		static uint64_t Combine(uint64_t _hash, uint64_t _value);
+};
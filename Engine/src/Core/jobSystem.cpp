@@ -0,0 +1,415 @@
+#include "jobSystem.h"
+
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <thread>
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// the owner pushes and pops at the back, thieves take from the front
+struct alignas(64) sWorkerQueue
+{
+    std::mutex          mutex;
+    std::deque<sJob>    jobs;
+};
+
+struct sJobSystemState
+{
+    std::vector<std::thread>        threads;
+    std::unique_ptr<sWorkerQueue[]> pQueues;
+    unsigned                        workerCount     = 0;
+
+    std::atomic<unsigned>           nextQueue       { 0 };  // round robin for threads outside the system
+    std::atomic<size_t>             queuedJobs      { 0 };  // in every deque
+    std::atomic<unsigned>           sleepingWorkers { 0 };
+    std::atomic<unsigned>           sleepingWaiters { 0 };  // threads in Wait with nothing to run
+    std::atomic<bool>               stop            { false };
+
+    std::mutex                      sleepMutex;
+    std::condition_variable         wakeUp;
+    std::condition_variable         waiterWakeUp;           // a job was pushed or a counter reached zero
+};
+
+static sJobSystemState s_state;
+
+static thread_local int s_workerIndex = -1;
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// a waiter going to sleep either sees the job or the zero or is counted here, then the lock waits until it sleeps
+static void WakeWaiters()
+{
+    if (s_state.sleepingWaiters.load() == 0)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(s_state.sleepMutex);
+    }
+
+    // every waiter checks its own counter
+    s_state.waiterWakeUp.notify_all();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+cJobCounter::cJobCounter()
+    : m_pending(0)
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+bool cJobCounter::IsDone() const
+{
+    return m_pending.load(std::memory_order_acquire) == 0;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cJobSystem::Initialize(unsigned _workerCount)
+{
+    Shutdown();
+
+    if (_workerCount == 0)
+    {
+        const unsigned hardwareThreads = std::thread::hardware_concurrency();
+
+        _workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+    }
+
+    s_state.workerCount = _workerCount;
+    s_state.pQueues     = std::make_unique<sWorkerQueue[]>(_workerCount);
+
+    s_state.stop.store(false);
+    s_state.threads.reserve(_workerCount);
+
+    for (unsigned i = 0; i < _workerCount; ++i)
+    {
+        s_state.threads.emplace_back(WorkerMain, static_cast<int>(i));
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cJobSystem::Shutdown()
+{
+    if (s_state.threads.empty())
+        return;
+
+    s_state.stop.store(true);
+
+    {
+        std::lock_guard<std::mutex> lock(s_state.sleepMutex);
+    }
+
+    s_state.wakeUp.notify_all();
+
+    for (std::thread& rThread : s_state.threads)
+    {
+        rThread.join();
+    }
+
+    s_state.threads.clear();
+    s_state.pQueues.reset();
+    s_state.workerCount = 0;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cJobSystem::Run(std::function<void()> _function, cJobCounter* _pCounter, cJobCounter* _pDependency)
+{
+    if (_pCounter)
+        _pCounter->m_pending.fetch_add(1, std::memory_order_relaxed);
+
+    sJob job = { std::move(_function), _pCounter };
+
+    // every job before this one ran inline as well, the dependency is done
+    if (s_state.workerCount == 0)
+    {
+        assert(!_pDependency || _pDependency->IsDone());
+
+        Execute(job);
+        return;
+    }
+
+    if (_pDependency)
+    {
+        std::lock_guard<std::mutex> lock(_pDependency->m_mutex);
+
+        // the last job of the dependency takes the continuations under this lock
+        if (_pDependency->m_pending.load(std::memory_order_acquire) > 0)
+        {
+            _pDependency->m_continuations.push_back(std::move(job));
+            return;
+        }
+    }
+
+    Push(std::move(job));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cJobSystem::Wait(cJobCounter& _rCounter)
+{
+    while (_rCounter.m_pending.load() > 0)
+    {
+        sJob job;
+
+        if (TryGetJob(job))
+        {
+            Execute(job);
+            continue;
+        }
+
+        // the counter's last jobs run elsewhere, sleep until one of them finishes or there is another job to help with
+        std::unique_lock<std::mutex> lock(s_state.sleepMutex);
+
+        s_state.sleepingWaiters.fetch_add(1);
+
+        s_state.waiterWakeUp.wait(lock, [&_rCounter]()
+            {
+                return _rCounter.m_pending.load() == 0 || s_state.queuedJobs.load() > 0;
+            });
+
+        s_state.sleepingWaiters.fetch_sub(1);
+    }
+
+    // the thread that finished the last job may still hold the lock, the counter can go once it let go
+    std::lock_guard<std::mutex> lock(_rCounter.m_mutex);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cJobSystem::ParallelFor(size_t _count, const std::function<void(size_t)>& _function)
+{
+    if (_count == 0)
+        return;
+
+    const unsigned threadCount = static_cast<unsigned>(std::min<size_t>(GetThreadCount(), _count));
+
+    if (threadCount <= 1)
+    {
+        for (size_t i = 0; i < _count; ++i)
+        {
+            _function(i);
+        }
+
+        return;
+    }
+
+    std::atomic<size_t> nextIndex{ 0 };
+    std::exception_ptr  pException = nullptr;
+    std::mutex          exceptionMutex;
+
+    auto Worker = [&]()
+        {
+            for (;;)
+            {
+                const size_t index = nextIndex.fetch_add(1, std::memory_order_relaxed);
+
+                if (index >= _count)
+                    return;
+
+                try
+                {
+                    _function(index);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(exceptionMutex);
+
+                    if (!pException)
+                        pException = std::current_exception();
+
+                    // drain the remaining items so every worker stops early
+                    nextIndex.store(_count, std::memory_order_relaxed);
+                    return;
+                }
+            }
+        };
+
+    cJobCounter counter;
+
+    for (unsigned i = 1; i < threadCount; ++i)
+    {
+        Run(Worker, &counter);
+    }
+
+    // the calling thread works as well, then helps with whatever is left
+    Worker();
+    Wait(counter);
+
+    if (pException)
+        std::rethrow_exception(pException);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+unsigned cJobSystem::GetThreadCount()
+{
+    return s_state.workerCount + 1;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+int cJobSystem::GetWorkerIndex()
+{
+    return s_workerIndex;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cJobSystem::Push(sJob&& _rJob)
+{
+    const unsigned queueIndex = s_workerIndex >= 0
+        ? static_cast<unsigned>(s_workerIndex)
+        : s_state.nextQueue.fetch_add(1, std::memory_order_relaxed) % s_state.workerCount;
+
+    sWorkerQueue& rQueue = s_state.pQueues[queueIndex];
+
+    {
+        std::lock_guard<std::mutex> lock(rQueue.mutex);
+
+        rQueue.jobs.push_back(std::move(_rJob));
+    }
+
+    s_state.queuedJobs.fetch_add(1);
+
+    // a worker going to sleep either sees the job or is counted here, then the lock waits until it sleeps
+    if (s_state.sleepingWorkers.load() > 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock(s_state.sleepMutex);
+        }
+
+        s_state.wakeUp.notify_one();
+    }
+
+    WakeWaiters();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+bool cJobSystem::TryGetJob(sJob& _rOutJob)
+{
+    const unsigned  workerCount = s_state.workerCount;
+    const int       self        = s_workerIndex;
+
+    if (workerCount == 0 || s_state.queuedJobs.load(std::memory_order_acquire) == 0)
+        return false;
+
+    // own jobs newest first, they are the ones whose data is still in cache
+    if (self >= 0)
+    {
+        sWorkerQueue& rQueue = s_state.pQueues[self];
+
+        std::lock_guard<std::mutex> lock(rQueue.mutex);
+
+        if (!rQueue.jobs.empty())
+        {
+            _rOutJob = std::move(rQueue.jobs.back());
+
+            rQueue.jobs.pop_back();
+            s_state.queuedJobs.fetch_sub(1);
+
+            return true;
+        }
+    }
+
+    // steal the oldest, it tends to be the largest piece of work left
+    const unsigned start = self >= 0 ? static_cast<unsigned>(self) + 1 : 0;
+
+    for (unsigned i = 0; i < workerCount; ++i)
+    {
+        const unsigned victim = (start + i) % workerCount;
+
+        if (static_cast<int>(victim) == self)
+            continue;
+
+        sWorkerQueue& rQueue = s_state.pQueues[victim];
+
+        std::lock_guard<std::mutex> lock(rQueue.mutex);
+
+        if (!rQueue.jobs.empty())
+        {
+            _rOutJob = std::move(rQueue.jobs.front());
+
+            rQueue.jobs.pop_front();
+            s_state.queuedJobs.fetch_sub(1);
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cJobSystem::Execute(sJob& _rJob)
+{
+    _rJob.function();
+
+    cJobCounter* pCounter = _rJob.pCounter;
+
+    if (!pCounter)
+        return;
+
+    std::vector<sJob> continuations;
+    bool isDone = false;
+
+    {
+        std::lock_guard<std::mutex> lock(pCounter->m_mutex);
+
+        if (pCounter->m_pending.fetch_sub(1) == 1)
+        {
+            continuations.swap(pCounter->m_continuations);
+            isDone = true;
+        }
+    }
+
+    if (isDone)
+        WakeWaiters();
+
+    // the counter may be gone from here on, waiters return once the lock is free
+    for (sJob& rContinuation : continuations)
+    {
+        Push(std::move(rContinuation));
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cJobSystem::WorkerMain(int _workerIndex)
+{
+    s_workerIndex = _workerIndex;
+
+    for (;;)
+    {
+        sJob job;
+
+        if (TryGetJob(job))
+        {
+            Execute(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(s_state.sleepMutex);
+
+        s_state.sleepingWorkers.fetch_add(1);
+
+        s_state.wakeUp.wait(lock, []()
+            {
+                return s_state.queuedJobs.load() > 0 || s_state.stop.load();
+            });
+
+        s_state.sleepingWorkers.fetch_sub(1);
+
+        if (s_state.stop.load() && s_state.queuedJobs.load() == 0)
+            return;
+    }
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+class cJobCounter;
+class cJobSystem;
+
+struct sJob
+{
+	std::function<void()>	function;
+	cJobCounter*			pCounter;		// decremented once the function returned, may be null
+};
+
+// Counts the unfinished jobs that were started with it. Jobs can wait for a counter to reach
+// zero, threads wait on it through cJobSystem::Wait. Reuse it only after a Wait returned.
+class cJobCounter
+{
+	public:
+
+		cJobCounter();
+
+		cJobCounter(const cJobCounter&)				= delete;
+		cJobCounter& operator=(const cJobCounter&)	= delete;
+
+	public:
+
+		bool IsDone() const;
+
+	private:
+
+		friend class cJobSystem;
+
+		std::atomic<uint32_t>	m_pending;
+		std::mutex				m_mutex;			// guards the continuations and the last decrement
+		std::vector<sJob>		m_continuations;	// jobs that wait for this counter
+};
+
+// Work stealing job system. Every worker owns a deque, it runs its own jobs newest first and
+// steals the oldest ones of the others when it runs dry. Threads outside the system hand their
+// jobs to the workers round robin. A thread waiting on a counter runs jobs until it reaches
+// zero, so jobs may start jobs and wait for them, and sleeps while the last ones run elsewhere. Without Initialize (or with no workers) every
+// job runs right away on the calling thread.
+class cJobSystem
+{
+	public:
+
+		// _workerCount threads besides the calling one, 0 = one per hardware thread but the caller's
+		static void Initialize(unsigned _workerCount = 0);
+
+		// every counter has to be waited on before
+		static void Shutdown();
+
+		// runs _function once _pDependency (if any) reached zero, _pCounter (if any) counts it
+		// until it returned. Jobs must not throw.
+		static void Run(std::function<void()> _function, cJobCounter* _pCounter = nullptr, cJobCounter* _pDependency = nullptr);
+
+		// runs jobs until the counter reached zero, sleeps while there are none to run
+		static void Wait(cJobCounter& _rCounter);
+
+		// Runs _function(i) for every i in [0, _count) on the workers and the calling thread
+		// and returns once all are done. Items are handed out one at a time from a shared cursor,
+		// so uneven items balance. The first exception thrown is rethrown on the caller.
+		static void ParallelFor(size_t _count, const std::function<void(size_t)>& _function);
+
+		// workers plus the thread that waits
+		static unsigned GetThreadCount();
+
+		// index of the calling worker, -1 on threads outside the system
+		static int GetWorkerIndex();
+
+	private:
+
+		static void Push(sJob&& _rJob);
+		static bool TryGetJob(sJob& _rOutJob);
+		static void Execute(sJob& _rJob);
+		static void WorkerMain(int _workerIndex);
+};
@@ -0,0 +1,19 @@
+#include "parallel.h"
+
+#include "jobSystem.h"
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cParallel::For(size_t _count, const std::function<void(size_t)>& _function)
+{
+    cJobSystem::ParallelFor(_count, _function);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+unsigned cParallel::GetWorkerCount()
+{
+    return cJobSystem::GetThreadCount();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+class cParallel
+{
+	public:
+
+		// Runs _function(i) for every i in [0, _count) on the cJobSystem workers and the
+		// calling thread, serially before cJobSystem::Initialize. Items are handed out one
+		// at a time, so callers that write into a slot indexed by i get deterministic output
+		// regardless of scheduling. The first exception thrown by a worker is rethrown on
+		// the caller. Nesting is fine, waiting threads run the inner items.
+		static void For(size_t _count, const std::function<void(size_t)>& _function);
+
+		// threads a For runs on, the calling one included
+		static unsigned GetWorkerCount();
+};
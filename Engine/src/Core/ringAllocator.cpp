@@ -0,0 +1,128 @@
+#include "ringAllocator.h"
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+cRingAllocator::cRingAllocator()
+    : m_capacity(0)
+    , m_head(0)
+    , m_tail(0)
+    , m_usedBytes(0)
+    , m_openBytes(0)
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cRingAllocator::Reset(uint64_t _capacity)
+{
+    m_capacity  = _capacity;
+    m_head      = 0;
+    m_tail      = 0;
+    m_usedBytes = 0;
+    m_openBytes = 0;
+
+    m_batches.clear();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+bool cRingAllocator::Allocate(uint64_t _byteSize, uint64_t _alignment, uint64_t& _rOutOffset)
+{
+    if (_byteSize > m_capacity)
+        return false;
+
+    // an empty ring starts over at zero, so a large request is not blocked by where the last one ended
+    if (m_usedBytes == 0)
+    {
+        m_head = 0;
+        m_tail = 0;
+    }
+
+    const uint64_t alignedHead = (m_head + _alignment - 1) / _alignment * _alignment;
+
+    uint64_t offset  = 0;
+    uint64_t padding = 0;
+
+    if (m_usedBytes == 0 || m_head > m_tail)
+    {
+        // live data sits in [tail, head), free space is [head, capacity) and [0, tail)
+        if (alignedHead + _byteSize <= m_capacity)
+        {
+            offset  = alignedHead;
+            padding = alignedHead - m_head;
+        }
+        else if (_byteSize <= m_tail)
+        {
+            offset  = 0;
+            padding = m_capacity - m_head;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    else
+    {
+        // wrapped, free space is [head, tail)
+        if (alignedHead + _byteSize > m_tail)
+            return false;
+
+        offset  = alignedHead;
+        padding = alignedHead - m_head;
+    }
+
+    m_head       = offset + _byteSize;
+    m_usedBytes += padding + _byteSize;
+    m_openBytes += padding + _byteSize;
+
+    _rOutOffset = offset;
+
+    return true;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cRingAllocator::Close(uint64_t _fenceValue)
+{
+    if (m_openBytes == 0)
+        return;
+
+    m_batches.push_back({ _fenceValue, m_head, m_openBytes });
+    m_openBytes = 0;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cRingAllocator::Retire(uint64_t _completedFenceValue)
+{
+    while (!m_batches.empty() && m_batches.front().fenceValue <= _completedFenceValue)
+    {
+        m_tail       = m_batches.front().end;
+        m_usedBytes -= m_batches.front().byteSize;
+
+        m_batches.pop_front();
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+uint64_t cRingAllocator::GetCapacity() const
+{
+    return m_capacity;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+uint64_t cRingAllocator::GetUsedBytes() const
+{
+    return m_usedBytes;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+bool cRingAllocator::IsIdle() const
+{
+    return m_usedBytes == 0;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+
+// Offset bookkeeping for a ring buffer whose space is handed back in submission order.
+// Allocations made between two Close calls form one batch, Retire frees every batch
+// whose fence value has completed. An allocation never wraps, it starts over at offset
+// zero when the end of the ring is too close.
+class cRingAllocator
+{
+	public:
+
+		cRingAllocator();
+
+	public:
+
+		// drops every batch, only while nothing is in flight
+		void Reset(uint64_t _capacity);
+
+		// false when the ring has no room until older batches retire
+		bool Allocate(uint64_t _byteSize, uint64_t _alignment, uint64_t& _rOutOffset);
+
+		// everything allocated since the last Close is done once _fenceValue completes
+		void Close(uint64_t _fenceValue);
+		void Retire(uint64_t _completedFenceValue);
+
+		uint64_t GetCapacity() const;
+		uint64_t GetUsedBytes() const;
+		bool	 IsIdle() const;
+
+	private:
+
+		struct sBatch
+		{
+			uint64_t fenceValue;
+			uint64_t end;		// head when the batch was closed
+			uint64_t byteSize;	// including alignment and wrap padding
+		};
+
+		uint64_t			m_capacity;
+		uint64_t			m_head;
+		uint64_t			m_tail;
+		uint64_t			m_usedBytes;
+		uint64_t			m_openBytes;	// allocated since the last Close
+		std::deque<sBatch>	m_batches;
+};
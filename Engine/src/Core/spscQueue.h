@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+// Bounded lock-free queue for exactly one producer and one consumer thread. Holds up to
+// _Capacity - 1 elements, one slot stays empty to tell full from empty. Push publishes the
+// element with release, Pop acquires it, so whatever the producer wrote before Push is
+// visible to the consumer after Pop.
+template<typename T, size_t _Capacity>
+class cSpscQueue
+{
+	static_assert(_Capacity >= 2, "cSpscQueue needs room for at least one element");
+
+	public:
+
+		cSpscQueue()
+			: m_head(0)
+			, m_tail(0)
+		{
+		}
+
+		cSpscQueue(const cSpscQueue&)				= delete;
+		cSpscQueue& operator=(const cSpscQueue&)	= delete;
+
+	public:
+
+		// producer only, false when full
+		bool TryPush(const T& _rValue)
+		{
+			const size_t tail = m_tail.load(std::memory_order_relaxed);
+			const size_t next = (tail + 1) % _Capacity;
+
+			if (next == m_head.load(std::memory_order_acquire))
+				return false;
+
+			m_elements[tail] = _rValue;
+			m_tail.store(next, std::memory_order_release);
+
+			return true;
+		}
+
+		// consumer only, false when empty
+		bool TryPop(T& _rOutValue)
+		{
+			const size_t head = m_head.load(std::memory_order_relaxed);
+
+			if (head == m_tail.load(std::memory_order_acquire))
+				return false;
+
+			_rOutValue = m_elements[head];
+			m_head.store((head + 1) % _Capacity, std::memory_order_release);
+
+			return true;
+		}
+
+		// exact on either thread for its own side, a hint otherwise
+		bool IsEmpty() const
+		{
+			return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+		}
+
+	private:
+
+		// producer and consumer indices on their own cache lines
+		alignas(64) std::atomic<size_t>	m_head;
+		alignas(64) std::atomic<size_t>	m_tail;
+		alignas(64) T					m_elements[_Capacity];
+};
@@ -0,0 +1,1006 @@
+#include "blockCompressor.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "Core/parallel.h"
+
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__)
+#define BLOCK_COMPRESSOR_SSE2 1
+#include <emmintrin.h>
+#else
+#define BLOCK_COMPRESSOR_SSE2 0
+#endif
+
+// least squares passes after the principal axis fit, each one only sticks when it lowers the error
+constexpr int c_EndpointRefinePasses    = 2;
+constexpr int c_PrincipalAxisIterations = 8;
+
+// BC7 4 bit index weights of the second endpoint, out of 64
+static const int s_bc7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+// BC1 weights of the second endpoint in four color mode
+static const float s_bc1Weights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// one 4x4 block as channel planes, values 0..255, channels a format does not store stay 0
+struct sBlockPixels
+{
+    alignas(16) float channels[4][16];
+};
+
+struct sBitWriter
+{
+    uint8_t*    pBytes;
+    uint32_t    position;
+
+    void Write(uint32_t _value, uint32_t _bitCount)
+    {
+        for (uint32_t bit = 0; bit < _bitCount; ++bit, ++position)
+        {
+            if ((_value >> bit) & 1u)
+                pBytes[position >> 3] |= static_cast<uint8_t>(1u << (position & 7));
+        }
+    }
+};
+
+struct sBitReader
+{
+    const uint8_t*  pBytes;
+    uint32_t        position;
+
+    uint32_t Read(uint32_t _bitCount)
+    {
+        uint32_t value = 0;
+
+        for (uint32_t bit = 0; bit < _bitCount; ++bit, ++position)
+        {
+            value |= static_cast<uint32_t>((pBytes[position >> 3] >> (position & 7)) & 1u) << bit;
+        }
+
+        return value;
+    }
+};
+
+static inline float Clamp255(float _value)
+{
+    return std::min(std::max(_value, 0.0f), 255.0f);
+}
+
+static void LoadPixels(const uint8_t _rgba[64], uint32_t _channelMask, sBlockPixels& _rOut)
+{
+    for (int channel = 0; channel < 4; ++channel)
+    {
+        const bool used = (_channelMask >> channel) & 1u;
+
+        for (int i = 0; i < 16; ++i)
+        {
+            _rOut.channels[channel][i] = used ? static_cast<float>(_rgba[i * 4 + channel]) : 0.0f;
+        }
+    }
+}
+
+// nearest palette entry per pixel over all four channels, returns the summed squared error.
+// Pixels and palette entries are whole numbers, so the float sums are exact and the SSE2
+// and scalar paths pick identical indices.
+static float FindIndices(const sBlockPixels& _rPixels, const float (*_pPalette)[4], int _paletteSize, uint8_t _indices[16])
+{
+#if BLOCK_COMPRESSOR_SSE2
+    __m128 totalError = _mm_setzero_ps();
+
+    for (int group = 0; group < 16; group += 4)
+    {
+        const __m128 r = _mm_load_ps(&_rPixels.channels[0][group]);
+        const __m128 g = _mm_load_ps(&_rPixels.channels[1][group]);
+        const __m128 b = _mm_load_ps(&_rPixels.channels[2][group]);
+        const __m128 a = _mm_load_ps(&_rPixels.channels[3][group]);
+
+        __m128  bestError = _mm_set1_ps(FLT_MAX);
+        __m128i bestIndex = _mm_setzero_si128();
+
+        for (int entry = 0; entry < _paletteSize; ++entry)
+        {
+            const __m128 dr = _mm_sub_ps(r, _mm_set1_ps(_pPalette[entry][0]));
+            const __m128 dg = _mm_sub_ps(g, _mm_set1_ps(_pPalette[entry][1]));
+            const __m128 db = _mm_sub_ps(b, _mm_set1_ps(_pPalette[entry][2]));
+            const __m128 da = _mm_sub_ps(a, _mm_set1_ps(_pPalette[entry][3]));
+
+            const __m128 error = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(dr, dr), _mm_mul_ps(dg, dg)),
+                _mm_add_ps(_mm_mul_ps(db, db), _mm_mul_ps(da, da)));
+
+            const __m128i closer = _mm_castps_si128(_mm_cmplt_ps(error, bestError));
+
+            bestError = _mm_min_ps(error, bestError);
+            bestIndex = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(entry)), _mm_andnot_si128(closer, bestIndex));
+        }
+
+        alignas(16) int32_t lanes[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), bestIndex);
+
+        for (int k = 0; k < 4; ++k)
+        {
+            _indices[group + k] = static_cast<uint8_t>(lanes[k]);
+        }
+
+        totalError = _mm_add_ps(totalError, bestError);
+    }
+
+    alignas(16) float sums[4];
+    _mm_store_ps(sums, totalError);
+
+    return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+#else
+    float groupErrors[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+    for (int i = 0; i < 16; ++i)
+    {
+        float   bestError = FLT_MAX;
+        int     bestIndex = 0;
+
+        for (int entry = 0; entry < _paletteSize; ++entry)
+        {
+            float error = 0.0f;
+
+            for (int channel = 0; channel < 4; ++channel)
+            {
+                const float d = _rPixels.channels[channel][i] - _pPalette[entry][channel];
+                error += d * d;
+            }
+
+            if (error < bestError)
+            {
+                bestError = error;
+                bestIndex = entry;
+            }
+        }
+
+        _indices[i] = static_cast<uint8_t>(bestIndex);
+        groupErrors[i & 3] += bestError;
+    }
+
+    return (groupErrors[0] + groupErrors[1]) + (groupErrors[2] + groupErrors[3]);
+#endif
+}
+
+// principal axis of the block through its mean, falls back to the bounding box diagonal
+static void FitLine(const sBlockPixels& _rPixels, float _mean[4], float _axis[4], float& _rMinT, float& _rMaxT)
+{
+    float minimum[4];
+    float maximum[4];
+
+    for (int channel = 0; channel < 4; ++channel)
+    {
+        const float* pChannel = _rPixels.channels[channel];
+
+        float sum = 0.0f;
+
+        minimum[channel] = pChannel[0];
+        maximum[channel] = pChannel[0];
+
+        for (int i = 0; i < 16; ++i)
+        {
+            sum += pChannel[i];
+            minimum[channel] = std::min(minimum[channel], pChannel[i]);
+            maximum[channel] = std::max(maximum[channel], pChannel[i]);
+        }
+
+        _mean[channel] = sum / 16.0f;
+    }
+
+    float covariance[4][4] = {};
+
+    for (int i = 0; i < 16; ++i)
+    {
+        float d[4];
+
+        for (int channel = 0; channel < 4; ++channel)
+        {
+            d[channel] = _rPixels.channels[channel][i] - _mean[channel];
+        }
+
+        for (int row = 0; row < 4; ++row)
+        {
+            for (int column = row; column < 4; ++column)
+            {
+                covariance[row][column] += d[row] * d[column];
+            }
+        }
+    }
+
+    for (int row = 0; row < 4; ++row)
+    {
+        for (int column = 0; column < row; ++column)
+        {
+            covariance[row][column] = covariance[column][row];
+        }
+    }
+
+    float axis[4];
+    float length = 0.0f;
+
+    for (int channel = 0; channel < 4; ++channel)
+    {
+        axis[channel]   = maximum[channel] - minimum[channel];
+        length         += axis[channel] * axis[channel];
+    }
+
+    if (length <= 0.0f)
+    {
+        // flat block, both endpoints end up on the mean
+        std::fill(_axis, _axis + 4, 0.0f);
+        _rMinT = 0.0f;
+        _rMaxT = 0.0f;
+        return;
+    }
+
+    for (int iteration = 0; iteration < c_PrincipalAxisIterations; ++iteration)
+    {
+        float next[4] = {};
+
+        for (int row = 0; row < 4; ++row)
+        {
+            for (int column = 0; column < 4; ++column)
+            {
+                next[row] += covariance[row][column] * axis[column];
+            }
+        }
+
+        float nextLength = 0.0f;
+
+        for (int channel = 0; channel < 4; ++channel)
+        {
+            nextLength += next[channel] * next[channel];
+        }
+
+        if (nextLength <= 1e-12f)
+            break;
+
+        nextLength = 1.0f / std::sqrt(nextLength);
+
+        for (int channel = 0; channel < 4; ++channel)
+        {
+            axis[channel] = next[channel] * nextLength;
+        }
+    }
+
+    length = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2] + axis[3] * axis[3]);
+
+    for (int channel = 0; channel < 4; ++channel)
+    {
+        _axis[channel] = axis[channel] / length;
+    }
+
+    _rMinT = FLT_MAX;
+    _rMaxT = -FLT_MAX;
+
+    for (int i = 0; i < 16; ++i)
+    {
+        float t = 0.0f;
+
+        for (int channel = 0; channel < 4; ++channel)
+        {
+            t += (_rPixels.channels[channel][i] - _mean[channel]) * _axis[channel];
+        }
+
+        _rMinT = std::min(_rMinT, t);
+        _rMaxT = std::max(_rMaxT, t);
+    }
+}
+
+// least squares endpoints for fixed indices, _pWeights[index] is the share of the second endpoint
+static bool SolveEndpoints(const sBlockPixels& _rPixels, const uint8_t _indices[16], const float* _pWeights,
+    float _e0[4], float _e1[4])
+{
+    float aa = 0.0f;
+    float ab = 0.0f;
+    float bb = 0.0f;
+
+    float ax[4] = {};
+    float bx[4] = {};
+
+    for (int i = 0; i < 16; ++i)
+    {
+        const float b = _pWeights[_indices[i]];
+        const float a = 1.0f - b;
+
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+
+        for (int channel = 0; channel < 4; ++channel)
+        {
+            ax[channel] += a * _rPixels.channels[channel][i];
+            bx[channel] += b * _rPixels.channels[channel][i];
+        }
+    }
+
+    const float determinant = aa * bb - ab * ab;
+
+    if (std::fabs(determinant) < 1e-6f)
+        return false;
+
+    const float inverse = 1.0f / determinant;
+
+    for (int channel = 0; channel < 4; ++channel)
+    {
+        _e0[channel] = Clamp255((bb * ax[channel] - ab * bx[channel]) * inverse);
+        _e1[channel] = Clamp255((aa * bx[channel] - ab * ax[channel]) * inverse);
+    }
+
+    return true;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+// BC1 color
+// --------------------------------------------------------------------------------------------------------------------------
+
+static uint16_t PackRgb565(const float _color[4])
+{
+    const uint32_t r = static_cast<uint32_t>(std::lround(Clamp255(_color[0]) * 31.0f / 255.0f));
+    const uint32_t g = static_cast<uint32_t>(std::lround(Clamp255(_color[1]) * 63.0f / 255.0f));
+    const uint32_t b = static_cast<uint32_t>(std::lround(Clamp255(_color[2]) * 31.0f / 255.0f));
+
+    return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+static void UnpackRgb565(uint16_t _packed, int _rgb[3])
+{
+    const int r = (_packed >> 11) & 31;
+    const int g = (_packed >> 5) & 63;
+    const int b = _packed & 31;
+
+    _rgb[0] = (r << 3) | (r >> 2);
+    _rgb[1] = (g << 2) | (g >> 4);
+    _rgb[2] = (b << 3) | (b >> 2);
+}
+
+// four color palette as the decoder builds it, alpha stays 0 to match the loaded pixels
+static void BuildBC1Palette(uint16_t _c0, uint16_t _c1, float _palette[4][4])
+{
+    int c0[3];
+    int c1[3];
+
+    UnpackRgb565(_c0, c0);
+    UnpackRgb565(_c1, c1);
+
+    for (int channel = 0; channel < 3; ++channel)
+    {
+        _palette[0][channel] = static_cast<float>(c0[channel]);
+        _palette[1][channel] = static_cast<float>(c1[channel]);
+        _palette[2][channel] = static_cast<float>((2 * c0[channel] + c1[channel]) / 3);
+        _palette[3][channel] = static_cast<float>((c0[channel] + 2 * c1[channel]) / 3);
+    }
+
+    for (int entry = 0; entry < 4; ++entry)
+    {
+        _palette[entry][3] = 0.0f;
+    }
+}
+
+static void EncodeBC1Color(const sBlockPixels& _rPixels, uint8_t* _pOut)
+{
+    float mean[4];
+    float axis[4];
+    float minT;
+    float maxT;
+
+    FitLine(_rPixels, mean, axis, minT, maxT);
+
+    float e0[4];
+    float e1[4];
+
+    for (int channel = 0; channel < 4; ++channel)
+    {
+        e0[channel] = mean[channel] + axis[channel] * maxT;
+        e1[channel] = mean[channel] + axis[channel] * minT;
+    }
+
+    uint16_t    c0 = PackRgb565(e0);
+    uint16_t    c1 = PackRgb565(e1);
+    uint8_t     indices[16];
+    float       palette[4][4];
+
+    BuildBC1Palette(c0, c1, palette);
+    float error = FindIndices(_rPixels, palette, 4, indices);
+
+    for (int pass = 0; pass < c_EndpointRefinePasses && error > 0.0f; ++pass)
+    {
+        if (!SolveEndpoints(_rPixels, indices, s_bc1Weights, e0, e1))
+            break;
+
+        const uint16_t refined0 = PackRgb565(e0);
+        const uint16_t refined1 = PackRgb565(e1);
+
+        uint8_t refinedIndices[16];
+
+        BuildBC1Palette(refined0, refined1, palette);
+        const float refinedError = FindIndices(_rPixels, palette, 4, refinedIndices);
+
+        if (refinedError >= error)
+            break;
+
+        c0      = refined0;
+        c1      = refined1;
+        error   = refinedError;
+        std::memcpy(indices, refinedIndices, sizeof(indices));
+    }
+
+    // c0 > c1 selects four color mode, swapping the endpoints mirrors the indices (0 <-> 1, 2 <-> 3)
+    if (c0 < c1)
+    {
+        std::swap(c0, c1);
+
+        for (uint8_t& rIndex : indices)
+        {
+            rIndex ^= 1;
+        }
+    }
+    else if (c0 == c1)
+    {
+        std::memset(indices, 0, sizeof(indices));
+    }
+
+    uint32_t packedIndices = 0;
+
+    for (int i = 0; i < 16; ++i)
+    {
+        packedIndices |= static_cast<uint32_t>(indices[i]) << (i * 2);
+    }
+
+    _pOut[0] = static_cast<uint8_t>(c0);
+    _pOut[1] = static_cast<uint8_t>(c0 >> 8);
+    _pOut[2] = static_cast<uint8_t>(c1);
+    _pOut[3] = static_cast<uint8_t>(c1 >> 8);
+    std::memcpy(_pOut + 4, &packedIndices, sizeof(packedIndices));
+}
+
+static void DecodeBC1Color(const uint8_t* _pBlock, bool _alwaysFourColor, uint8_t _rgba[64])
+{
+    const uint16_t c0 = static_cast<uint16_t>(_pBlock[0] | (_pBlock[1] << 8));
+    const uint16_t c1 = static_cast<uint16_t>(_pBlock[2] | (_pBlock[3] << 8));
+
+    int rgb0[3];
+    int rgb1[3];
+
+    UnpackRgb565(c0, rgb0);
+    UnpackRgb565(c1, rgb1);
+
+    uint8_t palette[4][4];
+
+    for (int channel = 0; channel < 3; ++channel)
+    {
+        palette[0][channel] = static_cast<uint8_t>(rgb0[channel]);
+        palette[1][channel] = static_cast<uint8_t>(rgb1[channel]);
+
+        if (_alwaysFourColor || c0 > c1)
+        {
+            palette[2][channel] = static_cast<uint8_t>((2 * rgb0[channel] + rgb1[channel]) / 3);
+            palette[3][channel] = static_cast<uint8_t>((rgb0[channel] + 2 * rgb1[channel]) / 3);
+        }
+        else
+        {
+            palette[2][channel] = static_cast<uint8_t>((rgb0[channel] + rgb1[channel]) / 2);
+            palette[3][channel] = 0;
+        }
+    }
+
+    palette[0][3] = 255;
+    palette[1][3] = 255;
+    palette[2][3] = 255;
+    palette[3][3] = (_alwaysFourColor || c0 > c1) ? 255 : 0;
+
+    uint32_t packedIndices;
+    std::memcpy(&packedIndices, _pBlock + 4, sizeof(packedIndices));
+
+    for (int i = 0; i < 16; ++i)
+    {
+        std::memcpy(_rgba + i * 4, palette[(packedIndices >> (i * 2)) & 3], 4);
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+// BC4 single channel, also the alpha block of BC3 and both halves of BC5
+// --------------------------------------------------------------------------------------------------------------------------
+
+static void BuildBC4Palette(int _r0, int _r1, int _palette[8])
+{
+    _palette[0] = _r0;
+    _palette[1] = _r1;
+
+    if (_r0 > _r1)
+    {
+        for (int i = 1; i < 7; ++i)
+        {
+            _palette[i + 1] = ((7 - i) * _r0 + i * _r1) / 7;
+        }
+    }
+    else
+    {
+        for (int i = 1; i < 5; ++i)
+        {
+            _palette[i + 1] = ((5 - i) * _r0 + i * _r1) / 5;
+        }
+
+        _palette[6] = 0;
+        _palette[7] = 255;
+    }
+}
+
+static void EncodeBC4Channel(const uint8_t _rgba[64], int _channel, uint8_t* _pOut)
+{
+    int minimum = 255;
+    int maximum = 0;
+
+    for (int i = 0; i < 16; ++i)
+    {
+        minimum = std::min(minimum, static_cast<int>(_rgba[i * 4 + _channel]));
+        maximum = std::max(maximum, static_cast<int>(_rgba[i * 4 + _channel]));
+    }
+
+    std::memset(_pOut, 0, 8);
+
+    // eight value mode needs r0 > r1, a flat block keeps every index at 0
+    _pOut[0] = static_cast<uint8_t>(maximum);
+    _pOut[1] = static_cast<uint8_t>(minimum);
+
+    if (maximum == minimum)
+        return;
+
+    int palette[8];
+    BuildBC4Palette(maximum, minimum, palette);
+
+    uint64_t packedIndices = 0;
+
+    for (int i = 0; i < 16; ++i)
+    {
+        const int value = _rgba[i * 4 + _channel];
+
+        int bestIndex = 0;
+        int bestError = std::numeric_limits<int>::max();
+
+        for (int entry = 0; entry < 8; ++entry)
+        {
+            const int error = std::abs(palette[entry] - value);
+
+            if (error < bestError)
+            {
+                bestError = error;
+                bestIndex = entry;
+            }
+        }
+
+        packedIndices |= static_cast<uint64_t>(bestIndex) << (i * 3);
+    }
+
+    for (int byte = 0; byte < 6; ++byte)
+    {
+        _pOut[2 + byte] = static_cast<uint8_t>(packedIndices >> (byte * 8));
+    }
+}
+
+static void DecodeBC4Channel(const uint8_t* _pBlock, int _channel, uint8_t _rgba[64])
+{
+    int palette[8];
+    BuildBC4Palette(_pBlock[0], _pBlock[1], palette);
+
+    uint64_t packedIndices = 0;
+
+    for (int byte = 0; byte < 6; ++byte)
+    {
+        packedIndices |= static_cast<uint64_t>(_pBlock[2 + byte]) << (byte * 8);
+    }
+
+    for (int i = 0; i < 16; ++i)
+    {
+        _rgba[i * 4 + _channel] = static_cast<uint8_t>(palette[(packedIndices >> (i * 3)) & 7]);
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+// BC7 mode 6: one subset, RGBA 7.7.7.7 endpoints with a unique p-bit each, 4 bit indices
+// --------------------------------------------------------------------------------------------------------------------------
+
+// picks the p-bit that lands closer to _endpoint, _quantized receives the 7 bit channels
+static void QuantizeBC7Endpoint(const float _endpoint[4], uint8_t _quantized[4], uint8_t& _rPBit)
+{
+    float bestError = FLT_MAX;
+
+    for (uint8_t pBit = 0; pBit < 2; ++pBit)
+    {
+        uint8_t quantized[4];
+        float   error = 0.0f;
+
+        for (int channel = 0; channel < 4; ++channel)
+        {
+            const long value = std::lround((_endpoint[channel] - pBit) * 0.5f);
+
+            quantized[channel] = static_cast<uint8_t>(std::min(std::max(value, 0L), 127L));
+
+            const float d = static_cast<float>((quantized[channel] << 1) | pBit) - _endpoint[channel];
+            error += d * d;
+        }
+
+        if (error < bestError)
+        {
+            bestError = error;
+            _rPBit    = pBit;
+            std::memcpy(_quantized, quantized, 4);
+        }
+    }
+}
+
+static void BuildBC7Palette(const uint8_t _q0[4], uint8_t _p0, const uint8_t _q1[4], uint8_t _p1, float _palette[16][4])
+{
+    for (int channel = 0; channel < 4; ++channel)
+    {
+        const int e0 = (_q0[channel] << 1) | _p0;
+        const int e1 = (_q1[channel] << 1) | _p1;
+
+        for (int entry = 0; entry < 16; ++entry)
+        {
+            _palette[entry][channel] = static_cast<float>(((64 - s_bc7Weights[entry]) * e0 + s_bc7Weights[entry] * e1 + 32) >> 6);
+        }
+    }
+}
+
+static void EncodeBC7Mode6(const sBlockPixels& _rPixels, uint8_t* _pOut)
+{
+    static const float s_weights[16] =
+    {
+        0.0f / 64.0f,  4.0f / 64.0f,  9.0f / 64.0f, 13.0f / 64.0f, 17.0f / 64.0f, 21.0f / 64.0f, 26.0f / 64.0f, 30.0f / 64.0f,
+        34.0f / 64.0f, 38.0f / 64.0f, 43.0f / 64.0f, 47.0f / 64.0f, 51.0f / 64.0f, 55.0f / 64.0f, 60.0f / 64.0f, 64.0f / 64.0f,
+    };
+
+    float mean[4];
+    float axis[4];
+    float minT;
+    float maxT;
+
+    FitLine(_rPixels, mean, axis, minT, maxT);
+
+    float e0[4];
+    float e1[4];
+
+    for (int channel = 0; channel < 4; ++channel)
+    {
+        e0[channel] = Clamp255(mean[channel] + axis[channel] * minT);
+        e1[channel] = Clamp255(mean[channel] + axis[channel] * maxT);
+    }
+
+    uint8_t q0[4];
+    uint8_t q1[4];
+    uint8_t p0 = 0;
+    uint8_t p1 = 0;
+
+    QuantizeBC7Endpoint(e0, q0, p0);
+    QuantizeBC7Endpoint(e1, q1, p1);
+
+    uint8_t indices[16];
+    float   palette[16][4];
+
+    BuildBC7Palette(q0, p0, q1, p1, palette);
+    float error = FindIndices(_rPixels, palette, 16, indices);
+
+    for (int pass = 0; pass < c_EndpointRefinePasses && error > 0.0f; ++pass)
+    {
+        if (!SolveEndpoints(_rPixels, indices, s_weights, e0, e1))
+            break;
+
+        uint8_t refined0[4];
+        uint8_t refined1[4];
+        uint8_t refinedP0 = 0;
+        uint8_t refinedP1 = 0;
+        uint8_t refinedIndices[16];
+
+        QuantizeBC7Endpoint(e0, refined0, refinedP0);
+        QuantizeBC7Endpoint(e1, refined1, refinedP1);
+
+        BuildBC7Palette(refined0, refinedP0, refined1, refinedP1, palette);
+        const float refinedError = FindIndices(_rPixels, palette, 16, refinedIndices);
+
+        if (refinedError >= error)
+            break;
+
+        std::memcpy(q0, refined0, 4);
+        std::memcpy(q1, refined1, 4);
+        std::memcpy(indices, refinedIndices, sizeof(indices));
+
+        p0      = refinedP0;
+        p1      = refinedP1;
+        error   = refinedError;
+    }
+
+    // the anchor index is stored with an implicit 0 msb
+    if (indices[0] >= 8)
+    {
+        for (int channel = 0; channel < 4; ++channel)
+        {
+            std::swap(q0[channel], q1[channel]);
+        }
+
+        std::swap(p0, p1);
+
+        for (uint8_t& rIndex : indices)
+        {
+            rIndex = static_cast<uint8_t>(15 - rIndex);
+        }
+    }
+
+    std::memset(_pOut, 0, 16);
+
+    sBitWriter writer = { _pOut, 0 };
+
+    writer.Write(1u << 6, 7);
+
+    for (int channel = 0; channel < 4; ++channel)
+    {
+        writer.Write(q0[channel], 7);
+        writer.Write(q1[channel], 7);
+    }
+
+    writer.Write(p0, 1);
+    writer.Write(p1, 1);
+    writer.Write(indices[0], 3);
+
+    for (int i = 1; i < 16; ++i)
+    {
+        writer.Write(indices[i], 4);
+    }
+}
+
+static void DecodeBC7(const uint8_t* _pBlock, uint8_t _rgba[64])
+{
+    sBitReader reader = { _pBlock, 0 };
+
+    if (reader.Read(7) != (1u << 6))
+    {
+        // not written by this encoder, show it rather than guessing
+        for (int i = 0; i < 16; ++i)
+        {
+            _rgba[i * 4 + 0] = 255;
+            _rgba[i * 4 + 1] = 0;
+            _rgba[i * 4 + 2] = 255;
+            _rgba[i * 4 + 3] = 255;
+        }
+
+        return;
+    }
+
+    uint8_t q0[4];
+    uint8_t q1[4];
+
+    for (int channel = 0; channel < 4; ++channel)
+    {
+        q0[channel] = static_cast<uint8_t>(reader.Read(7));
+        q1[channel] = static_cast<uint8_t>(reader.Read(7));
+    }
+
+    const uint8_t p0 = static_cast<uint8_t>(reader.Read(1));
+    const uint8_t p1 = static_cast<uint8_t>(reader.Read(1));
+
+    float palette[16][4];
+    BuildBC7Palette(q0, p0, q1, p1, palette);
+
+    for (int i = 0; i < 16; ++i)
+    {
+        const uint32_t index = reader.Read(i == 0 ? 3 : 4);
+
+        for (int channel = 0; channel < 4; ++channel)
+        {
+            _rgba[i * 4 + channel] = static_cast<uint8_t>(palette[index][channel]);
+        }
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+size_t cBlockCompressor::GetBlockByteSize(eBlockFormat _format)
+{
+    return (_format == BLOCK_FORMAT_BC1 || _format == BLOCK_FORMAT_BC4) ? 8 : 16;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+size_t cBlockCompressor::GetCompressedSize(uint32_t _width, uint32_t _height, eBlockFormat _format)
+{
+    const size_t blocksX = (std::max(_width, 1u) + 3) / 4;
+    const size_t blocksY = (std::max(_height, 1u) + 3) / 4;
+
+    return blocksX * blocksY * GetBlockByteSize(_format);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+uint32_t cBlockCompressor::GetChannelCount(eBlockFormat _format)
+{
+    switch (_format)
+    {
+        case BLOCK_FORMAT_BC1:  return 3;
+        case BLOCK_FORMAT_BC4:  return 1;
+        case BLOCK_FORMAT_BC5:  return 2;
+        default:                return 4;
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cBlockCompressor::Compress(const uint8_t* _pRgba, uint32_t _width, uint32_t _height, eBlockFormat _format,
+    uint8_t* _pOutBlocks, bool _multithreaded)
+{
+    const uint32_t blocksX      = (_width + 3) / 4;
+    const uint32_t blocksY      = (_height + 3) / 4;
+    const size_t   blockBytes   = GetBlockByteSize(_format);
+
+    auto CompressRow = [&](size_t _blockY)
+        {
+            uint8_t rgba[64];
+
+            for (uint32_t blockX = 0; blockX < blocksX; ++blockX)
+            {
+                for (uint32_t y = 0; y < 4; ++y)
+                {
+                    const uint32_t sourceY = std::min(static_cast<uint32_t>(_blockY) * 4 + y, _height - 1);
+
+                    for (uint32_t x = 0; x < 4; ++x)
+                    {
+                        const uint32_t sourceX = std::min(blockX * 4 + x, _width - 1);
+
+                        std::memcpy(rgba + (y * 4 + x) * 4, _pRgba + (static_cast<size_t>(sourceY) * _width + sourceX) * 4, 4);
+                    }
+                }
+
+                EncodeBlock(rgba, _format, _pOutBlocks + (_blockY * blocksX + blockX) * blockBytes);
+            }
+        };
+
+    if (_multithreaded)
+    {
+        cParallel::For(blocksY, CompressRow);
+    }
+    else
+    {
+        for (uint32_t blockY = 0; blockY < blocksY; ++blockY)
+        {
+            CompressRow(blockY);
+        }
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cBlockCompressor::Decompress(const uint8_t* _pBlocks, uint32_t _width, uint32_t _height, eBlockFormat _format,
+    uint8_t* _pOutRgba)
+{
+    const uint32_t blocksX      = (_width + 3) / 4;
+    const uint32_t blocksY      = (_height + 3) / 4;
+    const size_t   blockBytes   = GetBlockByteSize(_format);
+
+    uint8_t rgba[64];
+
+    for (uint32_t blockY = 0; blockY < blocksY; ++blockY)
+    {
+        for (uint32_t blockX = 0; blockX < blocksX; ++blockX)
+        {
+            DecodeBlock(_pBlocks + (static_cast<size_t>(blockY) * blocksX + blockX) * blockBytes, _format, rgba);
+
+            for (uint32_t y = 0; y < 4 && blockY * 4 + y < _height; ++y)
+            {
+                for (uint32_t x = 0; x < 4 && blockX * 4 + x < _width; ++x)
+                {
+                    const size_t pixel = static_cast<size_t>(blockY * 4 + y) * _width + blockX * 4 + x;
+
+                    std::memcpy(_pOutRgba + pixel * 4, rgba + (y * 4 + x) * 4, 4);
+                }
+            }
+        }
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cBlockCompressor::EncodeBlock(const uint8_t _rgba[64], eBlockFormat _format, uint8_t* _pOutBlock)
+{
+    sBlockPixels pixels;
+
+    switch (_format)
+    {
+        case BLOCK_FORMAT_BC1:
+            LoadPixels(_rgba, 0x7, pixels);
+            EncodeBC1Color(pixels, _pOutBlock);
+            break;
+
+        case BLOCK_FORMAT_BC3:
+            EncodeBC4Channel(_rgba, 3, _pOutBlock);
+            LoadPixels(_rgba, 0x7, pixels);
+            EncodeBC1Color(pixels, _pOutBlock + 8);
+            break;
+
+        case BLOCK_FORMAT_BC4:
+            EncodeBC4Channel(_rgba, 0, _pOutBlock);
+            break;
+
+        case BLOCK_FORMAT_BC5:
+            EncodeBC4Channel(_rgba, 0, _pOutBlock);
+            EncodeBC4Channel(_rgba, 1, _pOutBlock + 8);
+            break;
+
+        case BLOCK_FORMAT_BC7:
+            LoadPixels(_rgba, 0xF, pixels);
+            EncodeBC7Mode6(pixels, _pOutBlock);
+            break;
+
+        default:
+            break;
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cBlockCompressor::DecodeBlock(const uint8_t* _pBlock, eBlockFormat _format, uint8_t _rgba[64])
+{
+    switch (_format)
+    {
+        case BLOCK_FORMAT_BC1:
+            DecodeBC1Color(_pBlock, false, _rgba);
+            break;
+
+        case BLOCK_FORMAT_BC3:
+            DecodeBC1Color(_pBlock + 8, true, _rgba);
+            DecodeBC4Channel(_pBlock, 3, _rgba);
+            break;
+
+        case BLOCK_FORMAT_BC4:
+        case BLOCK_FORMAT_BC5:
+            // the GPU returns 0 for missing color channels and 1 for alpha
+            for (int i = 0; i < 16; ++i)
+            {
+                _rgba[i * 4 + 1] = 0;
+                _rgba[i * 4 + 2] = 0;
+                _rgba[i * 4 + 3] = 255;
+            }
+
+            DecodeBC4Channel(_pBlock, 0, _rgba);
+
+            if (_format == BLOCK_FORMAT_BC5)
+                DecodeBC4Channel(_pBlock + 8, 1, _rgba);
+            break;
+
+        case BLOCK_FORMAT_BC7:
+            DecodeBC7(_pBlock, _rgba);
+            break;
+
+        default:
+            std::memset(_rgba, 0, 64);
+            break;
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+double cBlockCompressor::ComputePsnr(const uint8_t* _pReference, const uint8_t* _pTest, size_t _pixelCount, uint32_t _channelCount)
+{
+    double squaredError = 0.0;
+
+    for (size_t pixel = 0; pixel < _pixelCount; ++pixel)
+    {
+        for (uint32_t channel = 0; channel < _channelCount; ++channel)
+        {
+            const double d = static_cast<double>(_pReference[pixel * 4 + channel]) - _pTest[pixel * 4 + channel];
+            squaredError += d * d;
+        }
+    }
+
+    if (squaredError <= 0.0)
+        return std::numeric_limits<double>::infinity();
+
+    const double meanSquaredError = squaredError / (static_cast<double>(_pixelCount) * _channelCount);
+
+    return 10.0 * std::log10(255.0 * 255.0 / meanSquaredError);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
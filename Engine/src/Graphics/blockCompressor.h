@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+enum eBlockFormat : uint32_t
+{
+	BLOCK_FORMAT_BC1 = 0,	// RGB, 8 bytes per block
+	BLOCK_FORMAT_BC3,		// RGBA, BC4 alpha + BC1 color, 16 bytes per block
+	BLOCK_FORMAT_BC4,		// R, 8 bytes per block
+	BLOCK_FORMAT_BC5,		// RG, two BC4 blocks
+	BLOCK_FORMAT_BC7,		// RGBA, mode 6 only, 16 bytes per block
+
+	BLOCK_FORMAT_COUNT
+};
+
+// Platform neutral BCn codec for RGBA8 images. Endpoints come from the principal axis
+// of each 4x4 block and are refined with a least squares fit, the palette search runs
+// four pixels at a time with SSE2 where available. Partial blocks at the right and
+// bottom edge replicate the last column / row.
+//
+// Decompress and ComputePsnr only exist to measure the encoder, BC7 decoding covers
+// the single mode the encoder writes.
+class cBlockCompressor
+{
+	public:
+
+		static size_t	GetBlockByteSize(eBlockFormat _format);
+		static size_t	GetCompressedSize(uint32_t _width, uint32_t _height, eBlockFormat _format);
+
+		// channels the format stores, PSNR should only compare these
+		static uint32_t	GetChannelCount(eBlockFormat _format);
+
+		// block rows are spread over all workers when _multithreaded is set, the output
+		// does not depend on it
+		static void Compress(const uint8_t* _pRgba, uint32_t _width, uint32_t _height, eBlockFormat _format,
+			uint8_t* _pOutBlocks, bool _multithreaded);
+
+		static void Decompress(const uint8_t* _pBlocks, uint32_t _width, uint32_t _height, eBlockFormat _format,
+			uint8_t* _pOutRgba);
+
+		static void EncodeBlock(const uint8_t _rgba[64], eBlockFormat _format, uint8_t* _pOutBlock);
+		static void DecodeBlock(const uint8_t* _pBlock, eBlockFormat _format, uint8_t _rgba[64]);
+
+		// over the first _channelCount channels of two RGBA8 images, infinity when they match
+		static double ComputePsnr(const uint8_t* _pReference, const uint8_t* _pTest, size_t _pixelCount, uint32_t _channelCount);
+};
@@ -13,6 +13,7 @@
 cBufferManager::cBufferManager(cDeviceManager* _pDeviceManager, cSwapChainManager* _pSwapChainManager)
     : m_pDeviceManager(_pDeviceManager)
     , m_pSwapChainManager(_pSwapChainManager)
+    , m_objectCapacity(0)
     , m_textureOffset(0)
     , m_mipMapsOffset(0)
 {
@@ -26,8 +27,10 @@ cBufferManager::~cBufferManager()
 
 // --------------------------------------------------------------------------------------------------------------------------
 
-void cBufferManager::Initialize()
+void cBufferManager::Initialize(UINT _objectCapacity)
 {
+    m_objectCapacity = _objectCapacity;
+
     InitializeDescriptorHeaps();
 }
 
@@ -54,18 +57,25 @@ int cBufferManager::GetMipMapOffset() const
 
 // --------------------------------------------------------------------------------------------------------------------------
 
+UINT cBufferManager::GetDescriptorsPerFrame() const
+{
+    return m_objectCapacity + 1 + 1; // obj CBVs + pass + lights
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
 void cBufferManager::InitializeDescriptorHeaps()
 {
     D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
 
     heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
     heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-    UINT descriptorsPerFrame = GFX_MAX_NUMBER_OF_RENDER_ITEMS + 1 + 1; // obj CBVs + pass + lights
-    heapDesc.NumDescriptors = c_NumberOfFrameResources * descriptorsPerFrame + GFX_MAX_NUMGER_OF_TEXTURES + (GFX_MAX_NUMGER_OF_TEXTURES * GFX_MAX_MIP_MAPS_PER_TEXTURE);
+    UINT descriptorsPerFrame = GetDescriptorsPerFrame();
+    heapDesc.NumDescriptors = c_NumberOfFrameResources * descriptorsPerFrame + GFX_BINDLESS_TEXTURE_CAPACITY + GFX_MIP_GEN_UAV_CAPACITY;
     heapDesc.NodeMask = 0;
 
     m_textureOffset = c_NumberOfFrameResources * descriptorsPerFrame;
-    m_mipMapsOffset = m_textureOffset + GFX_MAX_NUMGER_OF_TEXTURES;
+    m_mipMapsOffset = m_textureOffset + GFX_BINDLESS_TEXTURE_CAPACITY;   // transient, reused by every upload batch
 
     cDirectX12Util::ThrowIfFailed(m_pDeviceManager->GetDevice()->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&m_pCbvHeap)));
 }
@@ -42,6 +42,12 @@ struct sObjectConstants
 	float occlusionStrength;
 	int padding2;
 
+	// Quantized vertex decode, identity for full precision vertices
+	XMFLOAT3	positionOffset;
+	float		padding3;
+	XMFLOAT3	positionScale;
+	float		padding4;
+
 	sObjectConstants()
 		: world()
 		, worldInvTranspose()
@@ -60,6 +66,10 @@ struct sObjectConstants
 		, normalScale(1.0f)
 		, occlusionStrength(1.0f)
 		, padding2(0)
+		, positionOffset(0.0f, 0.0f, 0.0f)
+		, padding3(0.0f)
+		, positionScale(1.0f, 1.0f, 1.0f)
+		, padding4(0.0f)
 	{
 		XMStoreFloat4x4(&world, XMMatrixIdentity());
 		XMStoreFloat4x4(&worldInvTranspose, XMMatrixIdentity());
@@ -93,7 +103,8 @@ class cBufferManager
 
 	public:
 		
-		void Initialize();
+		// creates the heap again when called twice, descriptors written before are gone
+		void Initialize(UINT _objectCapacity);
 
 	public:
 
@@ -101,6 +112,9 @@ class cBufferManager
 		int GetTextureOffset() const;
 		int GetMipMapOffset()  const;
 
+		// object CBVs, pass CBV and lights SRV of one frame resource, they start the heap
+		UINT GetDescriptorsPerFrame() const;
+
 	private:
 
 		void InitializeDescriptorHeaps();
@@ -110,6 +124,8 @@ class cBufferManager
 		cDeviceManager*		m_pDeviceManager;
 		cSwapChainManager*	m_pSwapChainManager;
 
+		UINT m_objectCapacity;
+
 		int m_textureOffset;
 		int m_mipMapsOffset;
 
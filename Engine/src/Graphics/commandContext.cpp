@@ -154,6 +154,13 @@ void cCommandContext::SetGraphicsRootDescriptorTable(UINT _RootParameterIndex, C
 
 // --------------------------------------------------------------------------------------------------------------------------
 
+void cCommandContext::SetGraphicsRootShaderResourceView(UINT _rootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS _bufferLocation)
+{
+	m_pCommandList->SetGraphicsRootShaderResourceView(_rootParameterIndex, _bufferLocation);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
 void cCommandContext::SetVertexBuffer(UINT _startSlot, UINT _numViews, D3D12_VERTEX_BUFFER_VIEW* _pVetexBufferView)
 {
 	m_pCommandList->IASetVertexBuffers(0, 1, _pVetexBufferView);
@@ -37,6 +37,7 @@ class cCommandContext
 
 		void SetRenderTargets(UINT _numRenderTargetDescriptors, D3D12_CPU_DESCRIPTOR_HANDLE* _pRenderTargetDescriptors, bool _rtSingleHandleToDescriptorRange, D3D12_CPU_DESCRIPTOR_HANDLE* _pDepthStencilDescriptor);
 		void SetGraphicsRootDescriptorTable(UINT _rootParameterIndex, CD3DX12_GPU_DESCRIPTOR_HANDLE _baseDescriptor);
+		void SetGraphicsRootShaderResourceView(UINT _rootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS _bufferLocation);
 
 		void SetVertexBuffer(UINT _startSlot, UINT _numViews, D3D12_VERTEX_BUFFER_VIEW* _pVetexBufferView);
 		void SetIndexBuffer(D3D12_INDEX_BUFFER_VIEW* _pIndexBufferView);
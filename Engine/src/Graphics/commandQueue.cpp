@@ -114,7 +114,7 @@ void cCommandQueue::Flush()
 
 UINT64 cCommandQueue::GetCompletedValue() const
 {
-	return UINT64();
+	return m_pFence->GetCompletedValue();
 }
 
 // --------------------------------------------------------------------------------------------------------------------------
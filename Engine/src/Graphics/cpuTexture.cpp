@@ -1,12 +1,16 @@
 #include "cpuTexture.h"
 
+#include <utility>
+
 // --------------------------------------------------------------------------------------------------------------------------
 
-cCpuTexture::cCpuTexture(int _width, int _height, std::vector<uint8_t> _data, DXGI_FORMAT _format)
+cCpuTexture::cCpuTexture(int _width, int _height, cTexturePayload _data, DXGI_FORMAT _format, UINT _mipLevels, UINT _arraySize)
 	: m_width(_width)
 	, m_height(_height)
-	, m_data(_data)
+	, m_data(std::move(_data))
 	, m_format(_format)
+	, m_mipLevels(_mipLevels)
+	, m_arraySize(_arraySize)
 {
 }
 
@@ -18,9 +22,9 @@ cCpuTexture::~cCpuTexture()
 
 // --------------------------------------------------------------------------------------------------------------------------
 
-std::vector<uint8_t>& cCpuTexture::GetData()
+cTexturePayload& cCpuTexture::GetPayload()
 {
-	return m_data; 
+	return m_data;
 }
 
 // --------------------------------------------------------------------------------------------------------------------------
@@ -42,4 +46,85 @@ DXGI_FORMAT cCpuTexture::GetFormat()
 	return m_format;
 }
 
+// --------------------------------------------------------------------------------------------------------------------------
+
+UINT cCpuTexture::GetMipLevels()
+{
+	return m_mipLevels;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+UINT cCpuTexture::GetArraySize()
+{
+	return m_arraySize;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cCpuTexture::GetPackedFootprints(sSubresourceFootprint* _pOutFootprints)
+{
+	uint32_t blockBytes	= 0;
+	uint32_t blockSize	= 0;
+
+	GetBlockLayout(m_format, blockBytes, blockSize);
+
+	cTextureFootprint::ComputePacked(static_cast<uint32_t>(m_width), static_cast<uint32_t>(m_height), m_mipLevels, m_arraySize,
+		blockBytes, blockSize, _pOutFootprints);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+bool cCpuTexture::IsBlockCompressed(DXGI_FORMAT _format)
+{
+	switch (_format)
+	{
+		case DXGI_FORMAT_BC1_UNORM:
+		case DXGI_FORMAT_BC3_UNORM:
+		case DXGI_FORMAT_BC4_UNORM:
+		case DXGI_FORMAT_BC5_UNORM:
+		case DXGI_FORMAT_BC7_UNORM:
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cCpuTexture::GetBlockLayout(DXGI_FORMAT _format, uint32_t& _rOutBlockBytes, uint32_t& _rOutBlockSize)
+{
+	switch (_format)
+	{
+		case DXGI_FORMAT_BC1_UNORM:
+		case DXGI_FORMAT_BC4_UNORM:
+			_rOutBlockBytes	= 8;
+			_rOutBlockSize	= 4;
+			break;
+
+		case DXGI_FORMAT_BC3_UNORM:
+		case DXGI_FORMAT_BC5_UNORM:
+		case DXGI_FORMAT_BC7_UNORM:
+			_rOutBlockBytes	= 16;
+			_rOutBlockSize	= 4;
+			break;
+
+		case DXGI_FORMAT_R8_UNORM:
+			_rOutBlockBytes	= 1;
+			_rOutBlockSize	= 1;
+			break;
+
+		case DXGI_FORMAT_R8G8_UNORM:
+			_rOutBlockBytes	= 2;
+			_rOutBlockSize	= 1;
+			break;
+
+		default:
+			_rOutBlockBytes	= 4;
+			_rOutBlockSize	= 1;
+			break;
+	}
+}
+
 // --------------------------------------------------------------------------------------------------------------------------
\ No newline at end of file
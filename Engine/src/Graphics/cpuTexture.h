@@ -1,30 +1,49 @@
 #pragma once
 
 #include <d3d12.h>
-#include <vector>
+
+#include "texturePayload.h"
+#include "textureFootprint.h"
 
 class cCpuTexture
 {
 	public:
 
-		cCpuTexture(int _width, int _height, std::vector<uint8_t> _data, DXGI_FORMAT _format = DXGI_FORMAT_R8G8B8A8_UNORM);
+		// _data holds _mipLevels levels back to back per slice, slices follow each other,
+		// block compressed formats always carry their full chain
+		cCpuTexture(int _width, int _height, cTexturePayload _data, DXGI_FORMAT _format = DXGI_FORMAT_R8G8B8A8_UNORM, UINT _mipLevels = 1, UINT _arraySize = 1);
 		~cCpuTexture();
 
+		cCpuTexture(cCpuTexture&& _rOther) noexcept = default;
+		cCpuTexture& operator=(cCpuTexture&& _rOther) noexcept = default;
+
 	public:
 
-		std::vector<uint8_t>& GetData();
+		cTexturePayload& GetPayload();
 
 		int GetWidth();
 		int GetHeight(); 
 
 		DXGI_FORMAT GetFormat();
+		UINT GetMipLevels();
+		UINT GetArraySize();
+
+		// layout of every subresource (mip + slice * mips) inside the payload, packed back to back
+		void GetPackedFootprints(sSubresourceFootprint* _pOutFootprints);
+
+		static bool IsBlockCompressed(DXGI_FORMAT _format);
+
+		// bytes per 4x4 block for BCn and per texel otherwise, _rOutBlockSize is 4 or 1
+		static void GetBlockLayout(DXGI_FORMAT _format, uint32_t& _rOutBlockBytes, uint32_t& _rOutBlockSize);
 
 	private:	
 
 		int m_width;
 		int m_height;
 
-		std::vector<uint8_t>	m_data;
+		cTexturePayload			m_data;
 		DXGI_FORMAT				m_format;
+		UINT					m_mipLevels;
+		UINT					m_arraySize;
 
 };
\ No newline at end of file
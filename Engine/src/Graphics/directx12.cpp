@@ -1,8 +1,10 @@
 #include "directx12.h"
 
+#include <algorithm>
 #include <array>
 #include <dxgidebug.h>
 #include <iostream>
+#include <stdexcept>
 #include <string>
 #include <comdef.h>
 #include <windows.h>
@@ -15,13 +17,17 @@
 #include "core/window.h"
 #include "core/timer.h"
 #include "core/input.h"
+#include "Core/jobSystem.h"
+#include "Core/parallel.h"
 
 #include "cpuTexture.h"
 #include "directx12Util.h"
 #include "frameResource.h"
+#include "frameSnapshot.h"
 #include "shaderManager.h"
 #include "swapChainManager.h"
 #include "deviceManager.h"
+#include "drawChunks.h"
 #include "gfxConfig.h"
 #include "gpuTexture.h"
 #include "pipelineStateManager.h"
@@ -32,6 +38,7 @@
 #include "vertex.h"
 #include "light.h"
 #include "meshGeometry.h"
+#include "Scene/cookedScene.h"
 
 // --------------------------------------------------------------------------------------------------------------------------
 // Microsoft PIX Debug
@@ -106,7 +113,18 @@ void cDirectX12::Initialize(cWindow* _pWindow, cTimer* _pTimer)
     ));
 
     m_cmdContext.Initialize(m_pDeviceManager->GetDevice(), m_pCmdAlloc.Get());
+
+    // the draw chunk lists, every recording resets them onto an allocator of the frame resource
+    for (cCommandContext& rContext : m_recordContexts)
+    {
+        rContext.Initialize(m_pDeviceManager->GetDevice(), m_pCmdAlloc.Get());
+    }
     m_graphicsQueue.Initialize(m_pDeviceManager->GetDevice(), D3D12_COMMAND_LIST_TYPE_DIRECT);
+    m_stagingRing.Initialize(m_pDeviceManager->GetDevice(), GFX_STAGING_RING_BYTE_SIZE);
+    m_objectCapacity            = GFX_MAX_NUMBER_OF_RENDER_ITEMS;
+    m_hasTextures               = false;
+
+    m_transforms.Initialize(m_objectCapacity);
 
     cDirectX12Util::ThrowIfFailed(m_pCmdAlloc->Reset());
     m_cmdContext.Reset(m_pCmdAlloc.Get());
@@ -120,9 +138,10 @@ void cDirectX12::Initialize(cWindow* _pWindow, cTimer* _pTimer)
     m_pRootSignatureManager = new cRootSignatureManager; 
     
     m_pSwapChainManager ->Initialize();
-    m_pBufferManager    ->Initialize();
+    m_pBufferManager    ->Initialize(m_objectCapacity);
 
     m_pShaderManager->Load("vs", L"..\\Assets\\Shader\\shader.hlsl", "VS", "vs_5_1");
+    m_pShaderManager->Load("vsQuantized", L"..\\Assets\\Shader\\shader.hlsl", "VSQuantized", "vs_5_1");
     m_pShaderManager->Load("ps", L"..\\Assets\\Shader\\shader.hlsl", "PS", "ps_5_1");
     m_pShaderManager->Load("cs", L"..\\Assets\\Shader\\mipgen_cs.hlsl", "CS", "cs_5_1");
     
@@ -162,86 +181,146 @@ void cDirectX12::Finalize()
 
 void cDirectX12::InitializeMesh(sMeshData& _rMeshData)
 {
-    sSubmeshGeometry subMesh;
+    m_geometryBuilder.AddMesh(_rMeshData);
+}
 
-    subMesh.indexCount          = static_cast<uint32>(_rMeshData.indices32.size());
-    subMesh.startIndexLocation  = static_cast<uint32>(m_indices.size());
-    subMesh.startVertexLocation = static_cast<uint32>(m_vertecis.size());
-    subMesh.materialId          = _rMeshData.materialId;
+// --------------------------------------------------------------------------------------------------------------------------
 
-    for (const auto& v : _rMeshData.vertices)
-    {
-        sVertex vOut = {};
+sMeshGeometry* cDirectX12::InitializeGeometryBuffer()
+{
+    const std::vector<sVertex>&             rVertices           = m_geometryBuilder.GetVertices();
+    const std::vector<sVertexQuantized>&    rQuantizedVertices  = m_geometryBuilder.GetQuantizedVertices();
+    const std::vector<uint32>&              rIndices32          = m_geometryBuilder.GetIndices32();
+    const std::vector<uint16>&              rIndices16          = m_geometryBuilder.GetIndices16();
 
-        vOut.position   = v.position;
-        vOut.normal     = v.normal;
-        vOut.tangentU   = v.tangentU;
-        vOut.texC       = v.texC;
-        vOut.texC2      = v.texC2;
+    m_pGeometry->drawArguments = m_geometryBuilder.GetSubmeshes();
 
-        m_vertecis.push_back(vOut);
-    }
+    const UINT vbByteSize   = static_cast<UINT>(rVertices.size() * sizeof(sVertex));
+    const UINT qvbByteSize  = static_cast<UINT>(rQuantizedVertices.size() * sizeof(sVertexQuantized));
+    const UINT ibByteSize   = static_cast<UINT>(rIndices32.size() * sizeof(uint32_t));
+    const UINT ib16ByteSize = static_cast<UINT>(rIndices16.size() * sizeof(uint16_t));
 
-    m_indices.insert(
-        m_indices.end(),
-        _rMeshData.indices32.begin(),
-        _rMeshData.indices32.end()
+    cDirectX12Util::ThrowIfFailed(D3DCreateBlob(vbByteSize, &m_pGeometry->vertexBufferCPU));
+    CopyMemory(m_pGeometry->vertexBufferCPU->GetBufferPointer(), rVertices.data(), vbByteSize);
+
+    cDirectX12Util::ThrowIfFailed(D3DCreateBlob(ibByteSize, &m_pGeometry->indexBufferCPU));
+    CopyMemory(m_pGeometry->indexBufferCPU->GetBufferPointer(), rIndices32.data(), ibByteSize);
+
+    cDirectX12Util::ThrowIfFailed(D3DCreateBlob(ib16ByteSize, &m_pGeometry->index16BufferCPU));
+    CopyMemory(m_pGeometry->index16BufferCPU->GetBufferPointer(), rIndices16.data(), ib16ByteSize);
+
+    return UploadGeometry(
+        rVertices.data(), vbByteSize,
+        rQuantizedVertices.data(), qvbByteSize,
+        rIndices32.data(), ibByteSize,
+        rIndices16.data(), ib16ByteSize
+    );
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+// uploads straight from the mapped cooked file, the pools are already in GPU layout
+sMeshGeometry* cDirectX12::InitializeGeometryBuffer(const cCookedScene& _rCookedScene)
+{
+    m_pGeometry->drawArguments.assign(
+        _rCookedScene.GetSubmeshes(),
+        _rCookedScene.GetSubmeshes() + _rCookedScene.GetSubmeshCount()
     );
 
-    m_pGeometry->drawArguments.push_back(subMesh);
+    const UINT vbByteSize   = static_cast<UINT>(_rCookedScene.GetVertexCount() * sizeof(sVertex));
+    const UINT qvbByteSize  = static_cast<UINT>(_rCookedScene.GetQuantizedVertexCount() * sizeof(sVertexQuantized));
+    const UINT ibByteSize   = static_cast<UINT>(_rCookedScene.GetIndex32Count() * sizeof(uint32_t));
+    const UINT ib16ByteSize = static_cast<UINT>(_rCookedScene.GetIndex16Count() * sizeof(uint16_t));
+
+    return UploadGeometry(
+        _rCookedScene.GetVertices(), vbByteSize,
+        _rCookedScene.GetQuantizedVertices(), qvbByteSize,
+        _rCookedScene.GetIndices32(), ibByteSize,
+        _rCookedScene.GetIndices16(), ib16ByteSize
+    );
 }
 
 // --------------------------------------------------------------------------------------------------------------------------
 
-sMeshGeometry* cDirectX12::InitializeGeometryBuffer()
+sMeshGeometry* cDirectX12::UploadGeometry(const void* _pVertices, UINT _vbByteSize, const void* _pQuantizedVertices, UINT _qvbByteSize,
+    const void* _pIndices, UINT _ibByteSize, const void* _pIndices16, UINT _ib16ByteSize)
 {
-    const UINT vbByteSize = static_cast<UINT>(m_vertecis.size() * sizeof(sVertex));
-    const UINT ibByteSize = static_cast<UINT>(m_indices.size() * sizeof(uint32_t));
-
     m_pGeometry->name = "shapeGeo";
 
-    cDirectX12Util::ThrowIfFailed(D3DCreateBlob(vbByteSize, &m_pGeometry->vertexBufferCPU));
-    CopyMemory(m_pGeometry->vertexBufferCPU->GetBufferPointer(), m_vertecis.data(), vbByteSize);
+    // either pool may be empty when every mesh ended up in the other one
+    if (_vbByteSize > 0)
+    {
+        m_pGeometry->vertexBufferGPU = cDirectX12Util::CreateDefaultBuffer(
+            m_pDeviceManager->GetDevice(),
+            m_cmdContext.GetCommandList(),
+            _pVertices,
+            _vbByteSize,
+            m_pGeometry->vertexBufferUploader
+        );
+    }
 
-    cDirectX12Util::ThrowIfFailed(D3DCreateBlob(ibByteSize, &m_pGeometry->indexBufferCPU));
-    CopyMemory(m_pGeometry->indexBufferCPU->GetBufferPointer(), m_indices.data(), ibByteSize);
-
-    m_pGeometry->vertexBufferGPU = cDirectX12Util::CreateDefaultBuffer(
-        m_pDeviceManager->GetDevice(),
-        m_cmdContext.GetCommandList(),
-        m_vertecis.data(),
-        vbByteSize,
-        m_pGeometry->vertexBufferUploader
-    );
+    if (_qvbByteSize > 0)
+    {
+        m_pGeometry->quantizedVertexBufferGPU = cDirectX12Util::CreateDefaultBuffer(
+            m_pDeviceManager->GetDevice(),
+            m_cmdContext.GetCommandList(),
+            _pQuantizedVertices,
+            _qvbByteSize,
+            m_pGeometry->quantizedVertexBufferUploader
+        );
+    }
 
-    m_pGeometry->indexBufferGPU = cDirectX12Util::CreateDefaultBuffer(
-        m_pDeviceManager->GetDevice(),
-        m_cmdContext.GetCommandList(),
-        m_indices.data(),
-        ibByteSize,
-        m_pGeometry->indexBufferUploader
-    );
+    if (_ibByteSize > 0)
+    {
+        m_pGeometry->indexBufferGPU = cDirectX12Util::CreateDefaultBuffer(
+            m_pDeviceManager->GetDevice(),
+            m_cmdContext.GetCommandList(),
+            _pIndices,
+            _ibByteSize,
+            m_pGeometry->indexBufferUploader
+        );
+    }
+
+    if (_ib16ByteSize > 0)
+    {
+        m_pGeometry->index16BufferGPU = cDirectX12Util::CreateDefaultBuffer(
+            m_pDeviceManager->GetDevice(),
+            m_cmdContext.GetCommandList(),
+            _pIndices16,
+            _ib16ByteSize,
+            m_pGeometry->index16BufferUploader
+        );
+    }
 
     m_pGeometry->vertexByteStride       = sizeof(sVertex);
-    m_pGeometry->vertexBufferByteSize   = vbByteSize;
-    m_pGeometry->indexFormat            = DXGI_FORMAT_R32_UINT;
-    m_pGeometry->indexBufferByteSize    = ibByteSize;
+    m_pGeometry->vertexBufferByteSize   = _vbByteSize;
+    m_pGeometry->quantizedVertexBufferByteSize = _qvbByteSize;
+    m_pGeometry->indexBufferByteSize    = _ibByteSize;
+    m_pGeometry->index16BufferByteSize  = _ib16ByteSize;
+
+    std::cout << "Index buffers: " << _ib16ByteSize / 1024 << " KB 16-bit, " << _ibByteSize / 1024 << " KB 32-bit\n";
 
     m_cmdContext.Close(); 
     ID3D12CommandList* cmdLists[] = { m_cmdContext.GetCommandList() };
     m_graphicsQueue.Execute(cmdLists, _countof(cmdLists)); 
     m_graphicsQueue.Flush();
+
+    // the mapped source may go away after this call, drop the staging copies too
+    m_pGeometry->DisposeUploaders();
+    m_geometryBuilder.Clear();
     
     return m_pGeometry;
 }
 
 // --------------------------------------------------------------------------------------------------------------------------
 
-void cDirectX12::Update(XMMATRIX _view, XMFLOAT3 _eyePos, std::vector<sRenderItem>* _pRenderItems, std::vector<sLightConstants>* _pLights)
+void cDirectX12::Update(sFrameSnapshot& _rSnapshot)
 {
-    m_pRenderItems  = _pRenderItems; 
-    m_pLights       = _pLights;
-    m_eyePos        = _eyePos;
+    m_pRenderItems      = &_rSnapshot.renderItems; 
+    m_pTransformUpdates = &_rSnapshot.transforms;
+    m_pLights           = &_rSnapshot.lights;
+    m_eyePos            = _rSnapshot.eyePos;
+    m_totalTime         = _rSnapshot.totalTime;
+    m_deltaTime         = _rSnapshot.deltaTime;
 
     // Advance frame resource
     m_currentFrameResourceIndex = (m_currentFrameResourceIndex + 1) % c_NumberOfFrameResources;
@@ -256,14 +335,21 @@ void cDirectX12::Update(XMMATRIX _view, XMFLOAT3 _eyePos, std::vector<sRenderIte
     cDirectX12Util::ThrowIfFailed(pDirectCmdListAlloc->Reset());
     m_cmdContext.Reset(pDirectCmdListAlloc, pPso);
 
-    // Handle window resize
-    if (m_pWindow->GetHasResized())
+    // Stream missing texture levels, requests were made for this frame
+    const UINT64 completedFence = m_graphicsQueue.GetCompletedValue();
+
+    m_stagingRing.Retire(completedFence);
+    m_textureManager.RetireStreaming(completedFence);
+    m_textureManager.GetStreamer().Request(_rSnapshot.textureRequests);
+    m_textureManager.StreamTextures(pCommandList, m_stagingRing, GFX_STREAMING_FRAME_BUDGET);
+
+    // Handle window resize, the game thread waits for this frame and leaves the window alone
+    if (_rSnapshot.hasResized)
     {
         OnResize();
-        m_pWindow->SetHasResized(false);
     }
 
-    XMStoreFloat4x4(&m_view, _view);
+    m_view = _rSnapshot.view;
 
     // === Upload data to GPU buffers ===
     UpdateObjectCB();  
@@ -271,104 +357,204 @@ void cDirectX12::Update(XMMATRIX _view, XMFLOAT3 _eyePos, std::vector<sRenderIte
     UpdateLightCB();
 }
 
+// --------------------------------------------------------------------------------------------------------------------------
+
+// everything a command list needs bound before it draws, every list of the frame sets it again
+struct sPassBindings
+{
+    D3D12_VIEWPORT                  viewport;
+    D3D12_RECT                      scissorRect;
+    D3D12_CPU_DESCRIPTOR_HANDLE     backBufferView;
+    D3D12_CPU_DESCRIPTOR_HANDLE     depthStencilView;
+    ID3D12DescriptorHeap*           pCbvHeap;
+    ID3D12RootSignature*            pRootSignature;
+    ID3D12PipelineState*            pipelineStates[VERTEX_FORMAT_COUNT];
+    CD3DX12_GPU_DESCRIPTOR_HANDLE   objectCbvBase;      // object CBVs of the frame resource
+    CD3DX12_GPU_DESCRIPTOR_HANDLE   passCbv;
+    CD3DX12_GPU_DESCRIPTOR_HANDLE   lightSrv;
+    CD3DX12_GPU_DESCRIPTOR_HANDLE   textureTable;
+    D3D12_GPU_VIRTUAL_ADDRESS       textureRefs;
+    UINT                            descriptorSize;
+};
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+static void BindPass(cCommandContext& _rContext, sPassBindings& _rBindings)
+{
+    _rContext.SetViewports(1, &_rBindings.viewport);
+    _rContext.SetScissorRects(1, &_rBindings.scissorRect);
+    _rContext.SetRenderTargets(1, &_rBindings.backBufferView, TRUE, &_rBindings.depthStencilView);
+
+    ID3D12DescriptorHeap* descriptorHeaps[] = { _rBindings.pCbvHeap };
+    _rContext.SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
+
+    _rContext.SetGraphicsRootSignature(_rBindings.pRootSignature);
+    _rContext.SetPipelineState(_rBindings.pipelineStates[VERTEX_FORMAT_FULL]);
+
+    // === Lights SRV (root param 2, t0) ===
+    _rContext.SetGraphicsRootDescriptorTable(2, _rBindings.lightSrv);
+
+    // === Pass CBV (root param 1, b1) ===
+    _rContext.SetGraphicsRootDescriptorTable(1, _rBindings.passCbv);
+
+    // === Bindless texture table (root param 3, t1..) ===
+    _rContext.SetGraphicsRootDescriptorTable(3, _rBindings.textureTable);
+
+    // === Texture references (root param 4, t0 space1) ===
+    _rContext.SetGraphicsRootShaderResourceView(4, _rBindings.textureRefs);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+static void RecordDraws(cCommandContext& _rContext, const sPassBindings& _rBindings, const sRenderItem* const* _ppItems, size_t _itemCount)
+{
+    UINT boundVertexFormat = VERTEX_FORMAT_FULL;
+
+    for (size_t i = 0; i < _itemCount; ++i)
+    {
+        const sRenderItem& renderItem = *_ppItems[i];
+
+        if (renderItem.vertexFormat != boundVertexFormat)
+        {
+            boundVertexFormat = renderItem.vertexFormat;
+            _rContext.SetPipelineState(_rBindings.pipelineStates[boundVertexFormat]);
+        }
+
+        D3D12_VERTEX_BUFFER_VIEW vertexBufferView = renderItem.vertexFormat == VERTEX_FORMAT_QUANTIZED
+            ? renderItem.pGeometry->GetQuantizedVertexBufferView()
+            : renderItem.pGeometry->GetVertexBufferView();
+
+        D3D12_INDEX_BUFFER_VIEW indexBufferView = renderItem.pGeometry->GetIndexBufferView(renderItem.indexFormat);
+
+        _rContext.SetVertexBuffer(0, 1, &vertexBufferView);
+        _rContext.SetIndexBuffer(&indexBufferView);
+        _rContext.SetPrimitiveTopology(renderItem.primitiveType);
+
+        CD3DX12_GPU_DESCRIPTOR_HANDLE objCbvHandle(_rBindings.objectCbvBase, renderItem.objCBIndex, _rBindings.descriptorSize);
+        _rContext.SetGraphicsRootDescriptorTable(0, objCbvHandle);
+
+        _rContext.DrawIndexedInstanced(
+            renderItem.indexCount,
+            1,
+            renderItem.startIndexLocation,
+            renderItem.baseVertexLocation,
+            0);
+    }
+}
+
 // --------------------------------------------------------------------------------------------------------------------------
 // clears backbuffer, depthstencil and presents the frame to the screen
 void cDirectX12::Draw()
 {
     ID3D12PipelineState*    pPso                = m_pPipelineStateManager->GetPipelineState("graphics");
-    ID3D12RootSignature*    pRootSignature      = m_pRootSignatureManager->GetRootSignature("graphics");
     IDXGISwapChain4*        pSwapChain          = m_pSwapChainManager->GetSwapChain();
-    D3D12_VIEWPORT&         rViewport           = m_pSwapChainManager->GetViewport();
     ID3D12DescriptorHeap*   pCbvHeap            = m_pBufferManager->GetCbvHeap();
+    ID3D12Resource*         pBackBuffer         = m_pSwapChainManager->GetCurrentBackBuffer();
 
-    // Set viewport and scissor
-    
-    m_cmdContext.SetViewports(1, &rViewport);
+    UINT descriptorSize = m_pDeviceManager->GetDescriptorSizes().cbvSrvUav;
+
+    // Update descriptors per frame to include render items, pass CBV, and lights SRV
+    UINT descriptorsPerFrame = m_pBufferManager->GetDescriptorsPerFrame();
+    UINT baseOffset = m_currentFrameResourceIndex * descriptorsPerFrame;
+
+    CD3DX12_GPU_DESCRIPTOR_HANDLE heapStart(pCbvHeap->GetGPUDescriptorHandleForHeapStart());
+
+    sPassBindings bindings = {};
+
+    bindings.viewport           = m_pSwapChainManager->GetViewport();
+    bindings.scissorRect        = { 0, 0, static_cast<LONG>(bindings.viewport.Width), static_cast<LONG>(bindings.viewport.Height) };
+    bindings.backBufferView     = m_pSwapChainManager->GetCurrentBackBufferView();
+    bindings.depthStencilView   = m_pSwapChainManager->GetDepthStencilView();
+    bindings.pCbvHeap           = pCbvHeap;
+    bindings.pRootSignature     = m_pRootSignatureManager->GetRootSignature("graphics");
+    bindings.pipelineStates[VERTEX_FORMAT_FULL]         = pPso;
+    bindings.pipelineStates[VERTEX_FORMAT_QUANTIZED]    = m_pPipelineStateManager->GetPipelineState("graphicsQuantized");
+    bindings.objectCbvBase      = CD3DX12_GPU_DESCRIPTOR_HANDLE(heapStart, baseOffset, descriptorSize);
+    bindings.passCbv            = CD3DX12_GPU_DESCRIPTOR_HANDLE(heapStart, baseOffset + m_objectCapacity, descriptorSize);
+    bindings.lightSrv           = CD3DX12_GPU_DESCRIPTOR_HANDLE(heapStart, baseOffset + m_objectCapacity + 1, descriptorSize);
+    bindings.textureTable       = CD3DX12_GPU_DESCRIPTOR_HANDLE(heapStart, m_pBufferManager->GetTextureOffset(), descriptorSize);
+    bindings.textureRefs        = m_textureManager.GetTextureRefsAddress();
+    bindings.descriptorSize     = descriptorSize;
 
-    D3D12_RECT scissorRect = { 0, 0, m_pWindow->GetWidth(), m_pWindow->GetHeight() };
-    m_cmdContext.SetScissorRects(1, &scissorRect);
-    
     // Transition back buffer PRESENT -> RENDER_TARGET
-    m_cmdContext.Transition(m_pSwapChainManager->GetCurrentBackBuffer(), 
-        D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    m_cmdContext.Transition(pBackBuffer, D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET);
 
     // Clear RTV and DSV
     float clearColor[] = { 0.f, 0.f, 0.f, 1.f };
-    m_cmdContext.ClearRenderTargetView(m_pSwapChainManager->GetCurrentBackBufferView(), clearColor);
-    m_cmdContext.ClearDepthStencilView(m_pSwapChainManager->GetDepthStencilView());
-
-    // Set render targets
-    m_cmdContext.SetRenderTargets(1, &m_pSwapChainManager->GetCurrentBackBufferView(), TRUE, &m_pSwapChainManager->GetDepthStencilView());
+    m_cmdContext.ClearRenderTargetView(bindings.backBufferView, clearColor);
+    m_cmdContext.ClearDepthStencilView(bindings.depthStencilView);
 
-    // Bind descriptor heap
-    ID3D12DescriptorHeap* descriptorHeaps[] = { pCbvHeap };
-    m_cmdContext.SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
+    // Gather the visible render items, the chunks split them evenly. Items without object
+    // constants would read the CBVs of the pass and the next frame resource
+    m_visibleItems.clear();
 
-    // Set root signature
-    m_cmdContext.SetGraphicsRootSignature(pRootSignature);
-    m_cmdContext.SetPipelineState(pPso);
+    for (const sRenderItem& rRenderItem : *m_pRenderItems)
+    {
+        if (!rRenderItem.isCulled && rRenderItem.objCBIndex < m_objectCapacity)
+            m_visibleItems.push_back(&rRenderItem);
+    }
 
-    UINT descriptorSize = m_pDeviceManager->GetDescriptorSizes().cbvSrvUav;
+    const size_t visibleCount   = m_visibleItems.size();
+    const size_t chunkCount     = cDrawChunks::GetCount(visibleCount, static_cast<size_t>(cJobSystem::GetThreadCount()));
 
-    // Update descriptors per frame to include render items, pass CBV, and lights SRV
-    UINT descriptorsPerFrame = GFX_MAX_NUMBER_OF_RENDER_ITEMS + 1 + 1; // +1 for pass CBV, +1 for lights SRV
-    UINT baseOffset = m_currentFrameResourceIndex * descriptorsPerFrame;
+    ID3D12CommandList* cmdLists[1 + GFX_MAX_RECORDING_THREADS] = { m_cmdContext.GetCommandList() };
+    UINT listCount = 1;
 
-    // === Lights SRV (root param 2, t32) ===
-    UINT lightIndex = baseOffset + GFX_MAX_NUMBER_OF_RENDER_ITEMS + 1;
-    CD3DX12_GPU_DESCRIPTOR_HANDLE lightSrvHandle(pCbvHeap->GetGPUDescriptorHandleForHeapStart());
-    lightSrvHandle.Offset(lightIndex, descriptorSize);
-    m_cmdContext.SetGraphicsRootDescriptorTable(2, lightSrvHandle);
+    if (chunkCount <= 1)
+    {
+        // small scenes stay on the frame's list
+        BindPass(m_cmdContext, bindings);
+        RecordDraws(m_cmdContext, bindings, m_visibleItems.data(), visibleCount);
 
-    // === Pass CBV (root param 1, b1) ===
-    UINT passIndex = baseOffset + GFX_MAX_NUMBER_OF_RENDER_ITEMS;
-    CD3DX12_GPU_DESCRIPTOR_HANDLE passCbvHandle(pCbvHeap->GetGPUDescriptorHandleForHeapStart());
-    passCbvHandle.Offset(passIndex, descriptorSize);
-    m_cmdContext.SetGraphicsRootDescriptorTable(1, passCbvHandle);
-
-    // === Texturen (root param 3, t0..t6) ===
-    UINT texBaseIndex = m_pBufferManager->GetTextureOffset();
-    CD3DX12_GPU_DESCRIPTOR_HANDLE texHandle(pCbvHeap->GetGPUDescriptorHandleForHeapStart());
-    texHandle.Offset(texBaseIndex, descriptorSize);
-    m_cmdContext.SetGraphicsRootDescriptorTable(3, texHandle);
-
-    // Draw all render items
-    for (auto& renderItem : *m_pRenderItems)
+        // Transition back buffer RENDER_TARGET -> PRESENT
+        m_cmdContext.Transition(pBackBuffer, D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT);
+        m_cmdContext.Close();
+    }
+    else
     {
-        m_cmdContext.SetVertexBuffer(0, 1, &renderItem.pGeometry->GetVertexBufferView());
-        m_cmdContext.SetIndexBuffer(&renderItem.pGeometry->GetIndexBufferView());
-        m_cmdContext.SetPrimitiveTopology(renderItem.primitiveType);
-        
+        // streaming copies and clears go first, every chunk records into its own list and
+        // allocator, the last one hands the back buffer to present
+        m_cmdContext.Close();
 
-        UINT objIndex = baseOffset + renderItem.objCBIndex;
-        CD3DX12_GPU_DESCRIPTOR_HANDLE objCbvHandle(pCbvHeap->GetGPUDescriptorHandleForHeapStart());
-        objCbvHandle.Offset(objIndex, descriptorSize);
-        m_cmdContext.SetGraphicsRootDescriptorTable(0, objCbvHandle);
+        cParallel::For(chunkCount, [&](size_t _chunk)
+            {
+                cCommandContext&        rContext    = m_recordContexts[_chunk];
+                ID3D12CommandAllocator* pAllocator  = m_pCurrentFrameResource->pRecordAllocators[_chunk].Get();
 
+                size_t begin    = 0;
+                size_t end      = 0;
+                cDrawChunks::GetRange(visibleCount, _chunk, chunkCount, begin, end);
 
-        m_cmdContext.DrawIndexedInstanced( 
-            renderItem.indexCount,
-            1,
-            renderItem.startIndexLocation,
-            renderItem.baseVertexLocation,
-            0);
-    }
+                cDirectX12Util::ThrowIfFailed(pAllocator->Reset());
+                rContext.Reset(pAllocator, pPso);
 
-    // Transition back buffer RENDER_TARGET -> PRESENT
-    m_cmdContext.Transition(m_pSwapChainManager->GetCurrentBackBuffer(),
-        D3D12_RESOURCE_STATE_RENDER_TARGET,
-        D3D12_RESOURCE_STATE_PRESENT);
+                BindPass(rContext, bindings);
+                RecordDraws(rContext, bindings, m_visibleItems.data() + begin, end - begin);
 
-    // Close and execute command list
-    m_cmdContext.Close();
+                if (_chunk == chunkCount - 1)
+                {
+                    rContext.Transition(pBackBuffer, D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT);
+                }
 
-    ID3D12CommandList* cmdLists[] = { m_cmdContext.GetCommandList() };
-    m_graphicsQueue.Execute(cmdLists, _countof(cmdLists));
+                rContext.Close();
+            });
+
+        // submitted in chunk order, the draw order stays the one of the render items
+        for (size_t i = 0; i < chunkCount; ++i)
+        {
+            cmdLists[listCount++] = m_recordContexts[i].GetCommandList();
+        }
+    }
+
+    m_graphicsQueue.Execute(cmdLists, listCount);
 
     // Signal fence
      UINT64 currentFence = m_graphicsQueue.Signal();
     m_pCurrentFrameResource->fence = currentFence;
 
+    m_stagingRing.Close(currentFence);
+    m_textureManager.CloseStreaming(currentFence);
+
     // Present frame
     cDirectX12Util::ThrowIfFailed(pSwapChain->Present(0, 0));
 }
@@ -432,71 +618,84 @@ ID3D12Device* cDirectX12::GetDevice()
 
 // --------------------------------------------------------------------------------------------------------------------------
 
+// every material field of the constants, they are written in place so nothing keeps a default
+static void WriteMaterialConstants(const sMaterial* _pMaterial, sObjectConstants& _rOutConstants)
+{
+    if (_pMaterial)
+    {
+        // Validate numbers
+        const sMaterial& mat = *_pMaterial;
+        if (std::isfinite(mat.albedo.x) && std::isfinite(mat.albedo.y) && std::isfinite(mat.albedo.z) && std::isfinite(mat.alpha))
+            _rOutConstants.baseColor = XMFLOAT4(mat.albedo.x, mat.albedo.y, mat.albedo.z, mat.alpha);
+        else
+            _rOutConstants.baseColor = XMFLOAT4(1, 1, 1, 1);
+
+        _rOutConstants.metallicFactor         = std::isfinite(mat.metallic) ? mat.metallic : 0.f;
+        _rOutConstants.roughnessFactor        = std::isfinite(mat.roughness) ? mat.roughness : 0.5f;
+        _rOutConstants.aoFactor               = std::isfinite(mat.ao) ? mat.ao : 1.f;
+        _rOutConstants.emissive               = mat.emissive;
+        _rOutConstants.baseColorIndex         = mat.baseColorIndex;
+        _rOutConstants.metallicRoughnessIndex = mat.metallicRoughnessIndex;
+        _rOutConstants.normalIndex            = mat.normalIndex;
+        _rOutConstants.occlusionIndex         = mat.occlusionIndex;
+        _rOutConstants.emissiveIndex          = mat.emissiveIndex;
+        _rOutConstants.normalScale            = mat.normalScale;
+        _rOutConstants.occlusionStrength      = mat.occlusionStrength;
+        _rOutConstants.emissiveStrength       = mat.emissiveStrength;
+    }
+    else
+    {
+        _rOutConstants.baseColor              = XMFLOAT4(1, 1, 1, 1);
+        _rOutConstants.metallicFactor         = 0.f;
+        _rOutConstants.roughnessFactor        = 0.5f;
+        _rOutConstants.aoFactor               = 1.f;
+        _rOutConstants.emissive               = XMFLOAT3(0, 0, 0);
+        _rOutConstants.baseColorIndex         = 0;
+        _rOutConstants.metallicRoughnessIndex = -1;
+        _rOutConstants.normalIndex            = -1;
+        _rOutConstants.occlusionIndex         = -1;
+        _rOutConstants.emissiveIndex          = -1;
+        _rOutConstants.normalScale            = 1.f;
+        _rOutConstants.occlusionStrength      = 1.f;
+        _rOutConstants.emissiveStrength       = 1.f;
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
 void cDirectX12::UpdateObjectCB()
 {
-    auto currObjCB = m_pCurrentFrameResource->pObjectCB;
+    cUploadBuffer<sObjectConstants>* pObjectCB = m_pCurrentFrameResource->pObjectCB;
 
-    for (sRenderItem& pItem : *m_pRenderItems)
+    // the snapshot only carries the items that moved, the transform system keeps the rest and
+    // recomputes the moved ones in batches, once even though an item stays dirty for every frame resource
+    for (const sTransformUpdate& rUpdate : *m_pTransformUpdates)
     {
-        if (pItem.numberOfFramesDirty > 0)
+        if (rUpdate.index < m_objectCapacity)
         {
-            sObjectConstants objConstants{};
-            
-                XMMATRIX world = XMLoadFloat4x4(&pItem.worldMatrix);
-                XMStoreFloat4x4(&objConstants.world, XMMatrixTranspose(world));
-
-                XMMATRIX worldNoTranslation = world;
-                worldNoTranslation.r[3] = XMVectorSet(0.f, 0.f, 0.f, 1.f);
-                XMStoreFloat4x4(&objConstants.worldInvTranspose, XMMatrixTranspose(XMMatrixInverse(nullptr, worldNoTranslation)));
-            
-
-            // Material
-            if (pItem.pMaterial)
-            {
-                // Validate numbers
-                auto& mat = *pItem.pMaterial;
-                if (std::isfinite(mat.albedo.x) && std::isfinite(mat.albedo.y) && std::isfinite(mat.albedo.z) && std::isfinite(mat.alpha))
-                    objConstants.baseColor = XMFLOAT4(mat.albedo.x, mat.albedo.y, mat.albedo.z, mat.alpha);
-                else
-                    objConstants.baseColor = XMFLOAT4(1, 1, 1, 1);
-
-                objConstants.metallicFactor         = std::isfinite(mat.metallic) ? mat.metallic : 0.f;
-                objConstants.roughnessFactor        = std::isfinite(mat.roughness) ? mat.roughness : 0.5f;
-                objConstants.aoFactor               = std::isfinite(mat.ao) ? mat.ao : 1.f;
-                objConstants.emissive               = mat.emissive;
-                objConstants.baseColorIndex         = mat.baseColorIndex;
-                objConstants.metallicRoughnessIndex = mat.metallicRoughnessIndex;
-                objConstants.normalIndex            = mat.normalIndex;
-                objConstants.occlusionIndex         = mat.occlusionIndex;
-                objConstants.emissiveIndex          = mat.emissiveIndex;
-                objConstants.normalScale            = mat.normalScale;
-                objConstants.occlusionStrength      = mat.occlusionStrength;
-                objConstants.emissiveStrength       = mat.emissiveStrength;
+            m_transforms.SetWorld(rUpdate.index, rUpdate.world);
+        }
+    }
 
-            }
-            else
-            {
-                objConstants.baseColor = XMFLOAT4(1, 1, 1, 1);
-                objConstants.metallicFactor = 0.f;
-                objConstants.roughnessFactor = 0.5f;
-                objConstants.aoFactor = 1.f;
-                objConstants.emissive = XMFLOAT3(0, 0, 0);
-                objConstants.baseColorIndex =0;
-            }
+    m_transforms.Update();
 
-            // Index safety
-            if (pItem.objCBIndex >= 0 && pItem.objCBIndex < GFX_MAX_NUMBER_OF_RENDER_ITEMS)
-            {
-                currObjCB->CopyData(pItem.objCBIndex, objConstants);
-            }
-            else
-            {
-                // Debug warning
-                OutputDebugString(L"Warning: objCBIndex out of bounds!\n");
-            }
+    // one pass from the structure of arrays straight into the mapped constants, nothing is copied twice
+    for (sRenderItem& rItem : *m_pRenderItems)
+    {
+        // Draw skips the items past the capacity too
+        if (rItem.numberOfFramesDirty <= 0 || rItem.objCBIndex >= m_objectCapacity)
+            continue;
 
-            pItem.numberOfFramesDirty--;
-        }
+        sObjectConstants& rConstants = pObjectCB->GetElement(rItem.objCBIndex);
+
+        m_transforms.WriteConstants(rItem.objCBIndex, rConstants.world, rConstants.worldInvTranspose);
+
+        WriteMaterialConstants(rItem.pMaterial, rConstants);
+
+        rConstants.positionOffset   = rItem.positionOffset;
+        rConstants.positionScale    = rItem.positionScale;
+
+        rItem.numberOfFramesDirty--;
     }
 }
 
@@ -522,12 +721,15 @@ void cDirectX12::UpdatePassCB()
     XMStoreFloat4x4(&passConstants.invViewProj, XMMatrixTranspose(invViewProj));
 
     passConstants.eyePos                = m_eyePos;
-    passConstants.renderTargetSize      = XMFLOAT2((float)m_pWindow->GetWidth() , (float)m_pWindow->GetHeight());
-    passConstants.invRenderTargetSize   = XMFLOAT2(1.0f / m_pWindow->GetWidth(), 1.0f / m_pWindow->GetHeight());
+    // the viewport covers the back buffer, the window may already have changed on the game thread
+    const D3D12_VIEWPORT& rViewport     = m_pSwapChainManager->GetViewport();
+
+    passConstants.renderTargetSize      = XMFLOAT2(rViewport.Width, rViewport.Height);
+    passConstants.invRenderTargetSize   = XMFLOAT2(1.0f / rViewport.Width, 1.0f / rViewport.Height);
     passConstants.nearZ                 = 1.0f;
     passConstants.farZ                  = 1000.0f;
-    passConstants.totalTime             = static_cast<float> (m_pTimer->GetTotalTime());
-    passConstants.deltaTime             = static_cast<float> (m_pTimer->GetDeltaTime());
+    passConstants.totalTime             = static_cast<float> (m_totalTime);
+    passConstants.deltaTime             = static_cast<float> (m_deltaTime);
     passConstants.lightCount            = static_cast<int>   (m_pLights->size());
 
     auto currPassCB = m_pCurrentFrameResource->pPassCB;
@@ -567,7 +769,7 @@ void cDirectX12::InitializeFrameResources()
             new sFrameResource(
                 pDevice,
                 1,                        // pass count
-                GFX_MAX_NUMBER_OF_RENDER_ITEMS, // object count
+                m_objectCapacity,               // object count
                 GFX_MAX_NUMGER_OF_LIGHTS       // light count
             )
         );
@@ -585,7 +787,7 @@ void cDirectX12::InitializeFrameResources()
         // === Object CBVs (b0) ===
         D3D12_GPU_VIRTUAL_ADDRESS objCBAddress = frameResource->pObjectCB->GetResource()->GetGPUVirtualAddress();
 
-        for (UINT objIndex = 0; objIndex < GFX_MAX_NUMBER_OF_RENDER_ITEMS; objIndex++)
+        for (UINT objIndex = 0; objIndex < m_objectCapacity; objIndex++)
         {
             D3D12_CONSTANT_BUFFER_VIEW_DESC cbvDesc = {};
             cbvDesc.BufferLocation = objCBAddress + objIndex * objCBByteSize;
@@ -609,7 +811,7 @@ void cDirectX12::InitializeFrameResources()
         lightSrvDesc.ViewDimension              = D3D12_SRV_DIMENSION_BUFFER;
         lightSrvDesc.Shader4ComponentMapping    = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
         lightSrvDesc.Buffer.FirstElement        = 0;
-        lightSrvDesc.Buffer.NumElements         = GFX_MAX_NUMBER_OF_RENDER_ITEMS; 
+        lightSrvDesc.Buffer.NumElements         = GFX_MAX_NUMGER_OF_LIGHTS;
         lightSrvDesc.Buffer.StructureByteStride = sizeof(sLightConstants);
         lightSrvDesc.Buffer.Flags               = D3D12_BUFFER_SRV_FLAG_NONE;
 
@@ -625,7 +827,7 @@ void cDirectX12::InitializeFrameResources()
 // --------------------------------------------------------------------------------------------------------------------------
 
 void cDirectX12::UploadCpuTexturesToGpu(
-    std::vector<cCpuTexture>& _rCpuTextures)
+    std::vector<cCpuTexture>& _rCpuTextures, const std::vector<sTextureRef>& _rTextureRefs)
 {
     ID3D12Device*           pDevice = m_pDeviceManager->GetDevice();
     ID3D12DescriptorHeap*   pHeap   = m_pBufferManager->GetCbvHeap();
@@ -638,15 +840,25 @@ void cDirectX12::UploadCpuTexturesToGpu(
 
     const UINT textureSrvBaseOffset = m_pBufferManager->GetTextureOffset();
 
+    // every footprint is known before recording, so the ring grows to the whole batch up front,
+    // with streaming that is the mip tails and room for the largest streamed level
+    m_stagingRing.Retire(m_graphicsQueue.GetCompletedValue());
+    m_stagingRing.Reserve(cTextureManager::GetStagingByteSize(_rCpuTextures, _rTextureRefs));
+
+    m_hasTextures = true;
+
     const int uploadedTextures =
         m_textureManager.UploadCpuTextures(
             _rCpuTextures,
+            _rTextureRefs,
             pDevice,
             pHeap,
             &m_cmdContext,
+            &m_stagingRing,
             m_pPipelineStateManager->GetPipelineState("mipgen"),
             m_pRootSignatureManager->GetRootSignature("mipgen"),
-            textureSrvBaseOffset
+            textureSrvBaseOffset,
+            m_pBufferManager->GetMipMapOffset()
         );
 
     m_cmdContext.Close();
@@ -656,14 +868,60 @@ void cDirectX12::UploadCpuTexturesToGpu(
         pCmdList
     };
 
-    m_graphicsQueue.Execute(lists, 1);
+    m_stagingRing.Close(m_graphicsQueue.Execute(lists, 1));
     m_graphicsQueue.Flush();
-    m_textureManager.ReleaseUploadHeaps();
+    m_stagingRing.Retire(m_graphicsQueue.GetCompletedValue());
 
     std::wcout
         << L"[UPLOAD COMPLETE] "
         << uploadedTextures
         << L" textures\n";
+
+#if GFX_TEXTURE_STREAMING
+    const sStreamingStats stats = m_textureManager.GetStreamer().GetStats();
+
+    std::cout << "Texture streaming: " << stats.residentBytes / 1024 << " KB mip tails resident, "
+        << GFX_STREAMING_FRAME_BUDGET / 1024 << " KB per frame budget, "
+        << stats.budgetBytes / (1024 * 1024) << " MB memory budget\n";
+#endif
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cDirectX12::ReserveRenderItems(UINT _count)
+{
+    if (_count <= m_objectCapacity)
+        return;
+
+    // the texture descriptors live in the same heap and would be lost
+    if (m_hasTextures)
+        throw std::runtime_error("ReserveRenderItems: render items must be reserved before textures are uploaded");
+
+    m_graphicsQueue.Flush();
+
+    for (sFrameResource* pFrameResource : m_frameResources)
+    {
+        delete pFrameResource;
+    }
+
+    m_frameResources.clear();
+    m_pCurrentFrameResource = nullptr;
+
+    m_objectCapacity = _count;
+
+    m_pBufferManager->Initialize(m_objectCapacity);
+    m_transforms.Initialize(m_objectCapacity);
+
+    InitializeFrameResources();
+
+    std::cout << "Object constants: " << m_objectCapacity << " render items per frame resource\n";
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+cTextureStreamer& cDirectX12::GetTextureStreamer()
+{
+    return m_textureManager.GetStreamer();
 }
 
 // --------------------------------------------------------------------------------------------------------------------------
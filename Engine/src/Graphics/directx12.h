@@ -14,7 +14,11 @@
 #include "graphics/commandContext.h"
 #include "Graphics/gpuTexture.h"
 #include "Graphics/meshData.h"
+#include "Graphics/geometryBuilder.h"
+#include "gfxConfig.h"
 #include "textureManager.h"
+#include "stagingRing.h"
+#include "transformSystem.h"
 
 using namespace DirectX;
 using namespace Microsoft::WRL;
@@ -25,9 +29,11 @@ struct sFrameResource;
 struct sLightConstants;
 struct sRenderItem; 
 struct sPassConstants;
+struct sFrameSnapshot;
 
 class cWindow;
 class cTimer;
+class cCookedScene;
 
 class cSwapChainManager;
 class cDeviceManager;
@@ -62,16 +68,24 @@ class cDirectX12
 
 		void InitializeMesh(sMeshData& _rMeshData);
 		sMeshGeometry* InitializeGeometryBuffer(); 
+		sMeshGeometry* InitializeGeometryBuffer(const cCookedScene& _rCookedScene);
 
-		void Update(XMMATRIX _view,  XMFLOAT3 _eyePos, std::vector<sRenderItem>* _renderItems, std::vector<sLightConstants>* _pLights);
+		// the snapshot stays untouched by the game thread until Draw returned
+		void Update(sFrameSnapshot& _rSnapshot);
 		void Draw(); 
 		float GetAspectRatio() const;
 		void CalculateFrameStats() const;
 		void OnResize();
-		void UploadCpuTexturesToGpu(std::vector<cCpuTexture>& _rCpuTextures);
+		void UploadCpuTexturesToGpu(std::vector<cCpuTexture>& _rCpuTextures, const std::vector<sTextureRef>& _rTextureRefs);
+
+		// grows the object constants of every frame resource to _count render items, their CBVs start the
+		// descriptor heap so it is created again, call it before the textures are uploaded.
+		// Items with an objCBIndex past the capacity are neither updated nor drawn
+		void ReserveRenderItems(UINT _count);
 
 		sMeshGeometry* GetGeometry(); 
 		ID3D12Device* GetDevice(); 
+		cTextureStreamer& GetTextureStreamer();
 
 	private:
 
@@ -82,6 +96,8 @@ class cDirectX12
 	private:
 
 		void InitializeFrameResources();
+		sMeshGeometry* UploadGeometry(const void* _pVertices, UINT _vbByteSize, const void* _pQuantizedVertices, UINT _qvbByteSize,
+			const void* _pIndices, UINT _ibByteSize, const void* _pIndices16, UINT _ib16ByteSize);
 		
 		void WaitForCurrentFrameResourceIfInUse(); 
 
@@ -106,19 +122,27 @@ class cDirectX12
 
 		std::vector<sFrameResource*>	m_frameResources;
 		std::vector<sRenderItem>*		m_pRenderItems;
+		std::vector<sTransformUpdate>*	m_pTransformUpdates;
 		std::vector<sLightConstants>*	m_pLights;
+		double							m_totalTime;
+		double							m_deltaTime;
 		std::vector<cGpuTexture> m_textures;
 
 		sFrameResource*	m_pCurrentFrameResource;
 		int m_currentFrameResourceIndex; 
 
+		UINT m_objectCapacity;		// object constants per frame resource
+		bool m_hasTextures;
+
 		std::unordered_map<std::string, sMeshGeometry*> m_geometries; 
 
-		std::vector<sVertex>		m_vertecis; 
-		std::vector<std::uint32_t>	m_indices;
+		cGeometryBuilder m_geometryBuilder;
 
 		cCommandQueue	m_graphicsQueue; 
 		cCommandContext m_cmdContext; 
+		cCommandContext m_recordContexts[GFX_MAX_RECORDING_THREADS];	// one per draw chunk
+
+		std::vector<const sRenderItem*> m_visibleItems;
 
 		ComPtr<ID3D12CommandAllocator> m_pCmdAlloc;
 
@@ -127,4 +151,7 @@ class cDirectX12
 		cShaderManager*			m_pShaderManager; 
 
 		cTextureManager m_textureManager; 
+		cStagingRing	m_stagingRing;
+
+		cTransformSystem m_transforms;	// indexed by objCBIndex, the worlds of every item
 };
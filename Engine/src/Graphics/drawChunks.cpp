@@ -0,0 +1,27 @@
+#include "drawChunks.h"
+
+#include <algorithm>
+
+#include "gfxConfig.h"
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+size_t cDrawChunks::GetCount(size_t _itemCount, size_t _threadCount)
+{
+    const size_t chunkCount = (std::min)({
+        static_cast<size_t>(GFX_MAX_RECORDING_THREADS),
+        _threadCount,
+        _itemCount / GFX_MIN_DRAWS_PER_RECORDING_CHUNK });
+
+    return (std::max)(chunkCount, static_cast<size_t>(1));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cDrawChunks::GetRange(size_t _itemCount, size_t _chunk, size_t _chunkCount, size_t& _rOutBegin, size_t& _rOutEnd)
+{
+    _rOutBegin  = _itemCount * _chunk / _chunkCount;
+    _rOutEnd    = _itemCount * (_chunk + 1) / _chunkCount;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+
+// How the visible draws of a frame are split into command lists, each recorded on its own
+// job thread and submitted in chunk order. Platform neutral, so the split can be checked
+// without a device.
+class cDrawChunks
+{
+	public:
+
+		// lists for _itemCount draws on _threadCount threads, at most GFX_MAX_RECORDING_THREADS and
+		// none with fewer than GFX_MIN_DRAWS_PER_RECORDING_CHUNK draws unless it is the only one
+		static size_t GetCount(size_t _itemCount, size_t _threadCount);
+
+		// the draws of _chunk, the chunks cover the items in order and differ by one at most
+		static void GetRange(size_t _itemCount, size_t _chunk, size_t _chunkCount, size_t& _rOutBegin, size_t& _rOutEnd);
+};
@@ -20,6 +20,14 @@ sFrameResource::sFrameResource(ID3D12Device* _pDevice, UINT _passCount, UINT _ob
 		IID_PPV_ARGS(pCmdListAlloc.GetAddressOf())
 	));
 
+	for (ComPtr<ID3D12CommandAllocator>& rAllocator : pRecordAllocators)
+	{
+		cDirectX12Util::ThrowIfFailed(_pDevice->CreateCommandAllocator(
+			D3D12_COMMAND_LIST_TYPE_DIRECT,
+			IID_PPV_ARGS(rAllocator.GetAddressOf())
+		));
+	}
+
 	pObjectCB		= new cUploadBuffer<sObjectConstants>(_pDevice, _objectCount, true);
 	pPassCB			= new cUploadBuffer<sPassConstants>(_pDevice, _passCount, true);
 	pLightBuffer	= new cUploadBuffer<sLightConstants>(_pDevice, _lightCount, false);
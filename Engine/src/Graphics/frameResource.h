@@ -3,6 +3,8 @@
 #include <d3d12.h>
 #include <wrl.h>
 
+#include "gfxConfig.h"
+
 using namespace Microsoft::WRL;
 
 template <typename T>
@@ -24,6 +26,9 @@ struct sFrameResource
 
 		ComPtr<ID3D12CommandAllocator> pCmdListAlloc;
 
+		// one per draw chunk, so the chunks of a frame record on separate threads
+		ComPtr<ID3D12CommandAllocator> pRecordAllocators[GFX_MAX_RECORDING_THREADS];
+
 		cUploadBuffer<sObjectConstants>*	pObjectCB;
 		cUploadBuffer<sPassConstants>*		pPassCB;
 		cUploadBuffer<sLightConstants>*		pLightBuffer;
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <vector>
+#include <DirectXMath.h>
+
+#include "Core/framePipeline.h"
+#include "light.h"
+#include "renderItem.h"
+#include "textureStreamer.h"
+#include "transformSystem.h"
+
+using namespace DirectX;
+
+// Everything the renderer reads of one game frame. The game thread fills it and hands it to
+// the render thread, after that only the render thread touches it until it comes back.
+// The vectors keep their capacity from frame to frame.
+struct sFrameSnapshot
+{
+	XMFLOAT4X4						view;
+	XMFLOAT3						eyePos;
+
+	double							totalTime;
+	double							deltaTime;
+
+	// the window was resized, the game thread waits until the frame was drawn
+	bool							hasResized;
+
+	std::vector<sRenderItem>		renderItems;		// visible ones and culled dirty ones, numberOfFramesDirty as of this frame
+	std::vector<sTransformUpdate>	transforms;			// worlds of the items that moved, visible or not
+	std::vector<sLightConstants>	lights;
+	std::vector<sTextureRequest>	textureRequests;
+};
+
+// the game thread simulates the next frame while the render thread records this one
+using cRenderThread = cFramePipeline<sFrameSnapshot>;
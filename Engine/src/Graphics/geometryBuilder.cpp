@@ -0,0 +1,248 @@
+#include "geometryBuilder.h"
+
+#include <cmath>
+
+// absolute position error a quantized mesh may introduce, in world units
+constexpr float c_MaxQuantizedPositionError     = 0.001f;
+
+// submeshes with at most this many vertices get 16-bit indices, indices are relative to startVertexLocation
+constexpr size_t c_MaxIndex16VertexCount        = size_t(UINT16_MAX) + 1;
+
+// texture coordinate precision fp16 has to hold, 1/2048 keeps 2k textures texel exact
+constexpr float c_QuantizedTexCoordPrecision    = 1.0f / 2048.0f;
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+const sSubmeshGeometry& cGeometryBuilder::AddMesh(const sMeshData& _rMeshData)
+{
+    sSubmeshGeometry subMesh;
+
+    subMesh.indexCount          = static_cast<uint32>(_rMeshData.indices32.size());
+    subMesh.materialId          = _rMeshData.materialId;
+    subMesh.indexFormat         = _rMeshData.vertices.size() <= c_MaxIndex16VertexCount ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+
+    if (!_rMeshData.vertices.empty())
+    {
+        BoundingBox::CreateFromPoints(
+            subMesh.bounds,
+            _rMeshData.vertices.size(),
+            &_rMeshData.vertices[0].position,
+            sizeof(sVertex)
+        );
+    }
+
+    if (CanQuantize(_rMeshData, subMesh.bounds))
+    {
+        const XMFLOAT3& center  = subMesh.bounds.Center;
+        const XMFLOAT3& extents = subMesh.bounds.Extents;
+
+        const float boundsMin[3]    = { center.x - extents.x, center.y - extents.y, center.z - extents.z };
+        const float boundsExtent[3] = { 2.0f * extents.x, 2.0f * extents.y, 2.0f * extents.z };
+
+        subMesh.vertexFormat        = VERTEX_FORMAT_QUANTIZED;
+        subMesh.startVertexLocation = static_cast<uint32>(m_quantizedVertices.size());
+        subMesh.positionOffset      = XMFLOAT3(boundsMin[0], boundsMin[1], boundsMin[2]);
+        subMesh.positionScale       = XMFLOAT3(boundsExtent[0], boundsExtent[1], boundsExtent[2]);
+
+        for (const sVertex& vertex : _rMeshData.vertices)
+        {
+            m_quantizedVertices.push_back(cVertexQuantization::Pack(
+                &vertex.position.x,
+                &vertex.normal.x,
+                &vertex.tangentU.x,
+                &vertex.texC.x,
+                &vertex.texC2.x,
+                boundsMin,
+                boundsExtent
+            ));
+        }
+    }
+    else
+    {
+        subMesh.startVertexLocation = static_cast<uint32>(m_vertices.size());
+
+        // sVertex is the GPU layout, so the mesh is appended as one block
+        m_vertices.insert(
+            m_vertices.end(),
+            _rMeshData.vertices.begin(),
+            _rMeshData.vertices.end()
+        );
+    }
+
+    subMesh.startIndexLocation = AppendIndices(_rMeshData.indices32.data(), _rMeshData.indices32.size(), subMesh.indexFormat);
+
+    subMesh.lods[0]     = { subMesh.indexCount, subMesh.startIndexLocation, 0.0f };
+    subMesh.lodCount    = 1;
+
+    for (const sMeshLod& rLod : _rMeshData.lods)
+    {
+        if (subMesh.lodCount == c_MaxSubmeshLods)
+            break;
+
+        // LODs share the vertices, so they always fit the format of LOD 0
+        const uint32 startIndexLocation = AppendIndices(
+            _rMeshData.lodIndices.data() + rLod.indexOffset,
+            rLod.indexCount,
+            subMesh.indexFormat
+        );
+
+        subMesh.lods[subMesh.lodCount++] = { rLod.indexCount, startIndexLocation, rLod.error };
+    }
+
+    AddMeshlets(_rMeshData.meshletData, subMesh);
+
+    m_submeshes.push_back(subMesh);
+
+    return m_submeshes.back();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cGeometryBuilder::Clear()
+{
+    m_vertices.clear();
+    m_quantizedVertices.clear();
+    m_indices32.clear();
+    m_indices16.clear();
+    m_submeshes.clear();
+    m_meshlets.clear();
+    m_meshletVertices.clear();
+    m_meshletTriangles.clear();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+const std::vector<sVertex>& cGeometryBuilder::GetVertices() const
+{
+    return m_vertices;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+const std::vector<sVertexQuantized>& cGeometryBuilder::GetQuantizedVertices() const
+{
+    return m_quantizedVertices;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+const std::vector<uint32>& cGeometryBuilder::GetIndices32() const
+{
+    return m_indices32;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+const std::vector<uint16>& cGeometryBuilder::GetIndices16() const
+{
+    return m_indices16;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+const std::vector<sSubmeshGeometry>& cGeometryBuilder::GetSubmeshes() const
+{
+    return m_submeshes;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+const std::vector<sMeshlet>& cGeometryBuilder::GetMeshlets() const
+{
+    return m_meshlets;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+const std::vector<uint32>& cGeometryBuilder::GetMeshletVertices() const
+{
+    return m_meshletVertices;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+const std::vector<uint8_t>& cGeometryBuilder::GetMeshletTriangles() const
+{
+    return m_meshletTriangles;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cGeometryBuilder::AddMeshlets(const sMeshletData& _rMeshletData, sSubmeshGeometry& _rSubmesh)
+{
+    const uint32 vertexBase     = static_cast<uint32>(m_meshletVertices.size());
+    const uint32 triangleBase   = static_cast<uint32>(m_meshletTriangles.size());
+
+    _rSubmesh.meshletOffset = static_cast<uint32>(m_meshlets.size());
+    _rSubmesh.meshletCount  = static_cast<uint32>(_rMeshletData.meshlets.size());
+
+    for (sMeshlet meshlet : _rMeshletData.meshlets)
+    {
+        meshlet.vertexOffset    += vertexBase;
+        meshlet.triangleOffset  += triangleBase;
+
+        m_meshlets.push_back(meshlet);
+    }
+
+    m_meshletVertices.insert(m_meshletVertices.end(), _rMeshletData.vertices.begin(), _rMeshletData.vertices.end());
+    m_meshletTriangles.insert(m_meshletTriangles.end(), _rMeshletData.triangles.begin(), _rMeshletData.triangles.end());
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+bool cGeometryBuilder::CanQuantize(const sMeshData& _rMeshData, const BoundingBox& _rBounds) const
+{
+    if (_rMeshData.vertices.empty())
+        return false;
+
+    const float maxExtent = 2.0f * (std::max)((std::max)(_rBounds.Extents.x, _rBounds.Extents.y), _rBounds.Extents.z);
+
+    if (cVertexQuantization::GetPositionErrorBound(maxExtent) > c_MaxQuantizedPositionError)
+        return false;
+
+    const float maxTexCoord = cVertexQuantization::GetMaxHalfTexCoord(c_QuantizedTexCoordPrecision);
+
+    for (const sVertex& vertex : _rMeshData.vertices)
+    {
+#if !GFX_QTANGENT_VERTICES
+        // without QTangents the quantized layout carries no tangent frame
+        const XMFLOAT4& tangent = vertex.tangentU;
+
+        if (tangent.x != 0.0f || tangent.y != 0.0f || tangent.z != 0.0f)
+            return false;
+#endif
+
+        if (std::fabs(vertex.texC.x) > maxTexCoord || std::fabs(vertex.texC.y) > maxTexCoord ||
+            std::fabs(vertex.texC2.x) > maxTexCoord || std::fabs(vertex.texC2.y) > maxTexCoord)
+            return false;
+    }
+
+    return true;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+uint32 cGeometryBuilder::AppendIndices(const uint32* _pIndices, size_t _count, DXGI_FORMAT _format)
+{
+    if (_format == DXGI_FORMAT_R16_UINT)
+    {
+        const uint32 startIndexLocation = static_cast<uint32>(m_indices16.size());
+
+        m_indices16.reserve(m_indices16.size() + _count);
+
+        for (size_t i = 0; i < _count; ++i)
+        {
+            m_indices16.push_back(static_cast<uint16>(_pIndices[i]));
+        }
+
+        return startIndexLocation;
+    }
+
+    const uint32 startIndexLocation = static_cast<uint32>(m_indices32.size());
+
+    m_indices32.insert(m_indices32.end(), _pIndices, _pIndices + _count);
+
+    return startIndexLocation;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
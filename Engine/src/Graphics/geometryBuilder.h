@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+
+#include "Graphics/meshData.h"
+#include "Graphics/meshGeometry.h"
+
+// Concatenates sMeshData into the pooled vertex/index layout used by the
+// GPU geometry buffer. The renderer and the scene cooker share it so the
+// cooked file holds exactly what InitializeGeometryBuffer uploads.
+// Meshes that survive quantization go into a second, compact vertex pool,
+// meshes with at most 65536 vertices get their indices from a 16-bit pool.
+class cGeometryBuilder
+{
+	public:
+
+		cGeometryBuilder()	= default;
+		~cGeometryBuilder()	= default;
+
+	public:
+
+		const sSubmeshGeometry& AddMesh(const sMeshData& _rMeshData);
+		void Clear();
+
+		const std::vector<sVertex>&				GetVertices() const;
+		const std::vector<sVertexQuantized>&	GetQuantizedVertices() const;
+		const std::vector<uint32>&				GetIndices32() const;
+		const std::vector<uint16>&				GetIndices16() const;
+		const std::vector<sSubmeshGeometry>&	GetSubmeshes() const;
+
+		const std::vector<sMeshlet>&			GetMeshlets() const;
+		const std::vector<uint32>&				GetMeshletVertices() const;
+		const std::vector<uint8_t>&				GetMeshletTriangles() const;
+
+	private:
+
+		bool CanQuantize(const sMeshData& _rMeshData, const BoundingBox& _rBounds) const;
+		uint32 AppendIndices(const uint32* _pIndices, size_t _count, DXGI_FORMAT _format);
+		void AddMeshlets(const sMeshletData& _rMeshletData, sSubmeshGeometry& _rSubmesh);
+
+	private:
+
+		std::vector<sVertex>			m_vertices;
+		std::vector<sVertexQuantized>	m_quantizedVertices;
+		std::vector<uint32>				m_indices32;
+		std::vector<uint16>				m_indices16;
+		std::vector<sSubmeshGeometry>	m_submeshes;
+
+		std::vector<sMeshlet>			m_meshlets;
+		std::vector<uint32>				m_meshletVertices;
+		std::vector<uint8_t>			m_meshletTriangles;
+};
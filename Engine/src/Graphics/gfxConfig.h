@@ -5,9 +5,65 @@
 // Descriptor Sizes
 // --------------------------------------------------------------------------------------------------------------------------
 
+// object constants reserved at startup, loading a scene with more render items grows them
 #define GFX_MAX_NUMBER_OF_RENDER_ITEMS	1000 
 #define GFX_MAX_NUMGER_OF_LIGHTS		1000
-#define GFX_MAX_NUMGER_OF_TEXTURES		32
 #define GFX_MAX_MIP_MAPS_PER_TEXTURE	16
 
+// slots of the bindless texture table, the shaders index it unbounded so only the heap depends on it
+#define GFX_BINDLESS_TEXTURE_CAPACITY	16384
+
+// transient UAVs one upload batch takes for GPU mip generation, one per generated level
+#define GFX_MIP_GEN_UAV_CAPACITY		4096
+
+// --------------------------------------------------------------------------------------------------------------------------
+// Uploads
+// --------------------------------------------------------------------------------------------------------------------------
+
+// initial size of the persistently mapped staging ring, a texture batch grows it when needed
+#define GFX_STAGING_RING_BYTE_SIZE		(32ull << 20)
+
+// --------------------------------------------------------------------------------------------------------------------------
+// Texture Streaming
+// --------------------------------------------------------------------------------------------------------------------------
+
+// 1 = only the mip tail is uploaded at load, finer levels follow on demand
+#define GFX_TEXTURE_STREAMING			1
+
+// levels whose largest side is at most this many texels form the tail that is always resident
+#define GFX_STREAMING_TAIL_SIZE			64
+
+// staging bytes streamed levels may take per frame, a single larger level goes out alone
+#define GFX_STREAMING_FRAME_BUDGET		(4ull << 20)
+
+// bytes the texture levels may take, the tails count against it and the least recently
+// sampled streamed levels are evicted to make room
+#define GFX_TEXTURE_MEMORY_BUDGET		(512ull << 20)
+
+// largest side of the finest level ever uploaded, coarser levels replace the ones above it
+// at load (also without streaming), 0 = no cap
+#define GFX_TEXTURE_MAX_RESOLUTION		0
+
+// --------------------------------------------------------------------------------------------------------------------------
+// Draw Recording
+// --------------------------------------------------------------------------------------------------------------------------
+
+// 1 = frames are drawn on a render thread while the game thread simulates the next one,
+// 0 = drawn on the game thread right after they were simulated
+#define GFX_RENDER_THREAD					1
+
+// command lists the draws of a frame are split into, each recorded on its own job thread
+#define GFX_MAX_RECORDING_THREADS			8
+
+// fewer visible items per list are not worth another list, small scenes record on one thread
+#define GFX_MIN_DRAWS_PER_RECORDING_CHUNK	256
+
+// --------------------------------------------------------------------------------------------------------------------------
+// Vertex Formats
+// --------------------------------------------------------------------------------------------------------------------------
+
+// 1 = quantized vertices carry the full tangent frame as a snorm16 QTangent (24 bytes),
+// 0 = octahedral normal only (20 bytes), meshes with tangents stay full precision
+#define GFX_QTANGENT_VERTICES			1
+
 #endif
\ No newline at end of file
@@ -1,6 +1,8 @@
 #include "gpuTexture.h"
 
-#include <vector>
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
 #include <d3dx12.h>
 
 #include "cpuTexture.h"
@@ -10,7 +12,9 @@
 
 cGpuTexture::cGpuTexture()
 	: m_pTexture(nullptr)
-	, m_pUploadheap(nullptr)
+	, m_firstMip(0)
+	, m_width(0)
+	, m_height(0)
 	, m_srvCpuHandle()
 	, m_srvGpuHandle()
 {
@@ -25,84 +29,248 @@ cGpuTexture::~cGpuTexture()
 
 // --------------------------------------------------------------------------------------------------------------------------
 
-void cGpuTexture::UploadToGpu(cCpuTexture& _rCpuTexture, ID3D12Device* _pDevice, ID3D12GraphicsCommandList* _pCmdList)
+void cGpuTexture::UploadToGpu(cCpuTexture& _rCpuTexture, ID3D12Device* _pDevice, ID3D12GraphicsCommandList* _pCmdList, cStagingRing& _rStagingRing,
+    UINT _firstMip)
 {
-    const uint8_t* pData  = _rCpuTexture.GetData().data();
-    DXGI_FORMAT    format = _rCpuTexture.GetFormat();
+    DXGI_FORMAT format = _rCpuTexture.GetFormat();
 
     int width  = _rCpuTexture.GetWidth();
     int height = _rCpuTexture.GetHeight();
 
+    // textures without a prebuilt chain get their mips from mipgen_cs, which writes through UAVs.
+    // A 1x1 texture is its own chain, arrays and atlases always keep the levels they were packed with
+    const UINT arraySize    = _rCpuTexture.GetArraySize();
+    const bool hasMipChain  = _rCpuTexture.GetMipLevels() > 1 || cCpuTexture::IsBlockCompressed(format) ||
+        cDirectX12Util::CalculateMipLevels(width, height) == 1 || arraySize > 1;
+    const UINT uploadMips   = hasMipChain ? _rCpuTexture.GetMipLevels() : 1;
+    const UINT mipLevels    = hasMipChain ? uploadMips : cDirectX12Util::CalculateMipLevels(width, height);
+    const UINT firstMip     = hasMipChain ? (std::min)(_firstMip, uploadMips - 1) : 0;
+
+    // the resource only holds the levels from firstMip on
+    Create(_pDevice, (std::max)(static_cast<UINT>(width) >> firstMip, 1u), (std::max)(static_cast<UINT>(height) >> firstMip, 1u), format,
+        mipLevels - firstMip, arraySize, hasMipChain ? D3D12_RESOURCE_FLAG_NONE : D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+
+    m_firstMip  = firstMip;
+    m_width     = static_cast<UINT>(width);
+    m_height    = static_cast<UINT>(height);
+
+    if (!UploadMips(_rCpuTexture, _pCmdList, _rStagingRing, firstMip, uploadMips - firstMip))
+    {
+        throw std::runtime_error("Staging ring is out of space, reserve the upload before recording it.");
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+bool cGpuTexture::UploadMips(cCpuTexture& _rCpuTexture, ID3D12GraphicsCommandList* _pCmdList, cStagingRing& _rStagingRing,
+    UINT _firstMip, UINT _mipCount)
+{
+    sTextureStaging staging;
+
+    if (!BeginUpload(_firstMip, _mipCount, _rStagingRing, staging))
+        return false;
+
+    // the payload is packed with every level per slice, the staging block only holds the uploaded ones at 256 byte aligned rows
+    const UINT cpuMipLevels = _rCpuTexture.GetMipLevels();
+
+    std::vector<sSubresourceFootprint> packed(static_cast<size_t>(cpuMipLevels) * staging.arraySize);
+    _rCpuTexture.GetPackedFootprints(packed.data());
+
+    for (UINT slice = 0; slice < staging.arraySize; ++slice)
+    {
+        for (UINT mip = 0; mip < _mipCount; ++mip)
+        {
+            cTextureFootprint::CopyRows(_rCpuTexture.GetPayload().GetData(), packed[_firstMip + mip + slice * cpuMipLevels],
+                staging.allocation.pData, staging.footprints[mip + slice * _mipCount]);
+        }
+    }
+
+    EndUpload(_pCmdList, staging);
+
+    return true;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cGpuTexture::Create(ID3D12Device* _pDevice, UINT _width, UINT _height, DXGI_FORMAT _format, UINT _mipLevels, UINT _arraySize,
+    D3D12_RESOURCE_FLAGS _flags)
+{
+    if (_mipLevels > GFX_MAX_MIP_MAPS_PER_TEXTURE)
+    {
+        throw std::runtime_error("Texture has more mip levels than GFX_MAX_MIP_MAPS_PER_TEXTURE.");
+    }
+
     D3D12_RESOURCE_DESC desc = {};
 
     desc.Dimension          = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
-    desc.Width              = width;
-    desc.Height             = height;
-    desc.DepthOrArraySize   = 1;
-    desc.MipLevels          = static_cast<UINT16>(cDirectX12Util::CalculateMipLevels(width, height));
-    desc.Format             = format;
+    desc.Width              = _width;
+    desc.Height             = _height;
+    desc.DepthOrArraySize   = static_cast<UINT16>(_arraySize);
+    desc.MipLevels          = static_cast<UINT16>(_mipLevels);
+    desc.Format             = _format;
     desc.SampleDesc.Count   = 1;
     desc.Layout             = D3D12_TEXTURE_LAYOUT_UNKNOWN;
-    desc.Flags              = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
+    desc.Flags              = _flags;
 
     CD3DX12_HEAP_PROPERTIES defaultHeap(D3D12_HEAP_TYPE_DEFAULT);
 
-    _pDevice->CreateCommittedResource(
+    cDirectX12Util::ThrowIfFailed(_pDevice->CreateCommittedResource(
         &defaultHeap,
         D3D12_HEAP_FLAG_NONE,
         &desc,
         D3D12_RESOURCE_STATE_COPY_DEST,
         nullptr,
         IID_PPV_ARGS(&m_pTexture)
-    );
+    ));
 
-    // -------------------------
-    // 2. UPLOAD BUFFER
-    // -------------------------
-    UINT64 uploadSize = 0;
+    m_firstMip  = 0;
+    m_width     = _width;
+    m_height    = _height;
+}
 
-    _pDevice->GetCopyableFootprints(
-        &desc,
-        0, 1, 0,
-        nullptr,
-        nullptr,
-        nullptr,
-        &uploadSize
-    );
+// --------------------------------------------------------------------------------------------------------------------------
 
-    CD3DX12_HEAP_PROPERTIES uploadHeap(D3D12_HEAP_TYPE_UPLOAD);
-    auto uploadDesc = CD3DX12_RESOURCE_DESC::Buffer(uploadSize);
+Microsoft::WRL::ComPtr<ID3D12Resource> cGpuTexture::Reallocate(ID3D12Device* _pDevice, ID3D12GraphicsCommandList* _pCmdList, UINT _firstMip)
+{
+    Microsoft::WRL::ComPtr<ID3D12Resource> pOldTexture = m_pTexture;
 
-    _pDevice->CreateCommittedResource(
-        &uploadHeap,
-        D3D12_HEAP_FLAG_NONE,
-        &uploadDesc,
-        D3D12_RESOURCE_STATE_GENERIC_READ,
-        nullptr,
-        IID_PPV_ARGS(&m_pUploadheap)
+    const D3D12_RESOURCE_DESC oldDesc = pOldTexture->GetDesc();
+
+    const UINT oldFirstMip  = m_firstMip;
+    const UINT oldLevels    = oldDesc.MipLevels;
+    const UINT arraySize    = oldDesc.DepthOrArraySize;
+
+    // the coarsest level of the chain stays the same, only the finest one moves
+    assert(_firstMip < oldFirstMip + oldLevels);
+
+    const UINT newLevels    = oldFirstMip + oldLevels - _firstMip;
+    const UINT sourceWidth  = m_width;
+    const UINT sourceHeight = m_height;
+
+    Create(_pDevice, (std::max)(sourceWidth >> _firstMip, 1u), (std::max)(sourceHeight >> _firstMip, 1u), oldDesc.Format,
+        newLevels, arraySize, oldDesc.Flags);
+
+    m_firstMip  = _firstMip;
+    m_width     = sourceWidth;
+    m_height    = sourceHeight;
+
+    auto toSource = CD3DX12_RESOURCE_BARRIER::Transition(
+        pOldTexture.Get(),
+        D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
+        D3D12_RESOURCE_STATE_COPY_SOURCE
     );
 
-    D3D12_SUBRESOURCE_DATA sub = {};
-    sub.pData = pData;
+    _pCmdList->ResourceBarrier(1, &toSource);
+
+    const UINT sharedFirstMip = (std::max)(oldFirstMip, _firstMip);
 
-    sub.RowPitch = width * 4;
-    sub.SlicePitch = sub.RowPitch * height;
+    for (UINT slice = 0; slice < arraySize; ++slice)
+    {
+        for (UINT mip = sharedFirstMip; mip < oldFirstMip + oldLevels; ++mip)
+        {
+            CD3DX12_TEXTURE_COPY_LOCATION destination(m_pTexture.Get(),
+                D3D12CalcSubresource(mip - _firstMip, slice, 0, newLevels, arraySize));
+            CD3DX12_TEXTURE_COPY_LOCATION source(pOldTexture.Get(),
+                D3D12CalcSubresource(mip - oldFirstMip, slice, 0, oldLevels, arraySize));
 
-    UpdateSubresources(
-        _pCmdList,
-        m_pTexture.Get(),
-        m_pUploadheap.Get(),
-        0, 0, 1,
-        &sub
+            _pCmdList->CopyTextureRegion(&destination, 0, 0, 0, &source, nullptr);
+        }
+    }
+
+    // the old resource stays bound until the caller swaps the descriptor
+    auto toShader = CD3DX12_RESOURCE_BARRIER::Transition(
+        pOldTexture.Get(),
+        D3D12_RESOURCE_STATE_COPY_SOURCE,
+        D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE
     );
 
-    //_pCmdList->ResourceBarrier(1,
-    //    &CD3DX12_RESOURCE_BARRIER::Transition(
-    //        m_pTexture.Get(),
-    //        D3D12_RESOURCE_STATE_COPY_DEST,
-    //        D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE
-    //    )
-    //);
+    _pCmdList->ResourceBarrier(1, &toShader);
+
+    return pOldTexture;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+bool cGpuTexture::BeginUpload(UINT _firstMip, UINT _mipCount, cStagingRing& _rStagingRing, sTextureStaging& _rOutStaging)
+{
+    const D3D12_RESOURCE_DESC desc = m_pTexture->GetDesc();
+
+    const UINT width        = static_cast<UINT>(desc.Width);
+    const UINT height       = desc.Height;
+    const UINT arraySize    = desc.DepthOrArraySize;
+
+    // _firstMip counts source levels, the resource starts at m_firstMip
+    assert(_firstMip >= m_firstMip);
+
+    const UINT resourceMip  = _firstMip - m_firstMip;
+
+    uint32_t blockBytes = 0;
+    uint32_t blockSize  = 0;
+
+    cCpuTexture::GetBlockLayout(desc.Format, blockBytes, blockSize);
+
+    _rOutStaging.footprints.resize(static_cast<size_t>(_mipCount) * arraySize);
+
+    // level resourceMip + i of the texture is level i of a texture resourceMip levels smaller
+    const UINT64 stagingBytes = cTextureFootprint::ComputeStaging((std::max)(width >> resourceMip, 1u), (std::max)(height >> resourceMip, 1u),
+        _mipCount, arraySize, blockBytes, blockSize, _rOutStaging.footprints.data());
+
+#ifdef _DEBUG
+    // the device lists consecutive subresources, which only matches a partial range for one slice
+    if (arraySize == 1 || _mipCount == desc.MipLevels)
+    {
+        Microsoft::WRL::ComPtr<ID3D12Device> pDevice;
+        cDirectX12Util::ThrowIfFailed(m_pTexture->GetDevice(IID_PPV_ARGS(&pDevice)));
+
+        UINT64 deviceBytes = 0;
+        pDevice->GetCopyableFootprints(&desc, resourceMip, _mipCount * arraySize, 0, nullptr, nullptr, nullptr, &deviceBytes);
+        assert(deviceBytes == stagingBytes);
+    }
+#endif
+
+    if (!_rStagingRing.Allocate(stagingBytes, c_TexturePlacementAlignment, _rOutStaging.allocation))
+        return false;
+
+    _rOutStaging.firstMip   = resourceMip;
+    _rOutStaging.mipCount   = _mipCount;
+    _rOutStaging.mipLevels  = desc.MipLevels;
+    _rOutStaging.arraySize  = arraySize;
+    _rOutStaging.format     = desc.Format;
+
+    return true;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cGpuTexture::EndUpload(ID3D12GraphicsCommandList* _pCmdList, const sTextureStaging& _rStaging)
+{
+    uint32_t blockBytes = 0;
+    uint32_t blockSize  = 0;
+
+    cCpuTexture::GetBlockLayout(_rStaging.format, blockBytes, blockSize);
+
+    for (UINT subresource = 0; subresource < _rStaging.mipCount * _rStaging.arraySize; ++subresource)
+    {
+        const UINT mip      = _rStaging.firstMip + subresource % _rStaging.mipCount;
+        const UINT slice    = subresource / _rStaging.mipCount;
+
+        const sSubresourceFootprint& rFootprint = _rStaging.footprints[subresource];
+
+        // BCn footprints cover whole blocks, also for the 2x2 and 1x1 levels
+        D3D12_PLACED_SUBRESOURCE_FOOTPRINT placed = {};
+
+        placed.Offset               = _rStaging.allocation.offset + rFootprint.offset;
+        placed.Footprint.Format     = _rStaging.format;
+        placed.Footprint.Width      = (rFootprint.width + blockSize - 1) / blockSize * blockSize;
+        placed.Footprint.Height     = (rFootprint.height + blockSize - 1) / blockSize * blockSize;
+        placed.Footprint.Depth      = 1;
+        placed.Footprint.RowPitch   = rFootprint.rowPitch;
+
+        CD3DX12_TEXTURE_COPY_LOCATION destination(m_pTexture.Get(), D3D12CalcSubresource(mip, slice, 0, _rStaging.mipLevels, _rStaging.arraySize));
+        CD3DX12_TEXTURE_COPY_LOCATION source(_rStaging.allocation.pResource, placed);
+
+        _pCmdList->CopyTextureRegion(&destination, 0, 0, 0, &source, nullptr);
+    }
 }
 
 // --------------------------------------------------------------------------------------------------------------------------
@@ -114,9 +282,9 @@ ID3D12Resource* cGpuTexture::GetResource()
 
 // --------------------------------------------------------------------------------------------------------------------------
 
-void cGpuTexture::ReleaseUploadHeap()
+UINT cGpuTexture::GetFirstMip() const
 {
-    m_pUploadheap.Reset();
+	return m_firstMip;
 }
 
 
@@ -1,10 +1,27 @@
 #pragma once
 
+#include <vector>
 #include <d3d12.h>
 #include <wrl.h>
 
+#include "gfxConfig.h"
+#include "stagingRing.h"
+#include "textureFootprint.h"
+
 class cCpuTexture;
 
+// staging memory of one texture, laid out for the copy into every uploaded mip of every slice
+struct sTextureStaging
+{
+	sStagingAllocation					allocation;
+	std::vector<sSubresourceFootprint>	footprints;		// mip + slice * mipCount
+	UINT								firstMip;		// of the resource
+	UINT								mipCount;
+	UINT								mipLevels;		// of the resource
+	UINT								arraySize;
+	DXGI_FORMAT							format;
+};
+
 class cGpuTexture
 {
 	public:
@@ -13,18 +30,48 @@ class cGpuTexture
 	
 	public:
 	
-		void UploadToGpu(cCpuTexture& _rCpuTexture, ID3D12Device* _pDevice, ID3D12GraphicsCommandList* _pCmdList);
+		// creates the texture with the levels from _firstMip on and uploads them, finer ones can
+		// follow through Reallocate and UploadMips (texture streaming). Mip arguments always
+		// count levels of the source texture, not of the resource
+		void UploadToGpu(cCpuTexture& _rCpuTexture, ID3D12Device* _pDevice, ID3D12GraphicsCommandList* _pCmdList, cStagingRing& _rStagingRing,
+			UINT _firstMip = 0);
+
+		// records the copies of _mipCount levels of every slice into the existing texture, which
+		// has to be in COPY_DEST. False when the ring has no room until older uploads retire
+		bool UploadMips(cCpuTexture& _rCpuTexture, ID3D12GraphicsCommandList* _pCmdList, cStagingRing& _rStagingRing,
+			UINT _firstMip, UINT _mipCount);
+
+		// the texture (array) starts in COPY_DEST
+		void Create(ID3D12Device* _pDevice, UINT _width, UINT _height, DXGI_FORMAT _format, UINT _mipLevels, UINT _arraySize,
+			D3D12_RESOURCE_FLAGS _flags);
+
+		// Moves the texture into a new resource that starts at source level _firstMip, which grows
+		// it by finer levels or drops some. Levels both hold are copied on the GPU, new ones wait
+		// for UploadMips. The new resource is in COPY_DEST, the old one is returned in
+		// PIXEL_SHADER_RESOURCE and has to stay alive until the GPU is done with it
+		Microsoft::WRL::ComPtr<ID3D12Resource> Reallocate(ID3D12Device* _pDevice, ID3D12GraphicsCommandList* _pCmdList, UINT _firstMip);
+
+		// Takes staging memory for levels [_firstMip, _firstMip + _mipCount) of every slice from the
+		// ring. Producers (decoders, cMipGenerator) write every level straight to allocation.pData +
+		// footprints[i].offset at footprints[i].rowPitch, EndUpload then records the GPU copies,
+		// which are the only copies after that. False when the ring is full.
+		bool BeginUpload(UINT _firstMip, UINT _mipCount, cStagingRing& _rStagingRing, sTextureStaging& _rOutStaging);
+		void EndUpload(ID3D12GraphicsCommandList* _pCmdList, const sTextureStaging& _rStaging);
 	
 	public:
 
 		ID3D12Resource* GetResource(); 
-		void ReleaseUploadHeap();
+
+		// source level that is level 0 of the resource
+		UINT GetFirstMip() const;
 
 	
 	private:
 	
 		Microsoft::WRL::ComPtr<ID3D12Resource> m_pTexture;
-		Microsoft::WRL::ComPtr<ID3D12Resource> m_pUploadheap;
+		UINT									m_firstMip;
+		UINT									m_width;	// of the source, level 0
+		UINT									m_height;
 	
 		D3D12_CPU_DESCRIPTOR_HANDLE m_srvCpuHandle{};
 		D3D12_GPU_DESCRIPTOR_HANDLE m_srvGpuHandle{};
@@ -5,10 +5,19 @@
 #include <vector>
 
 #include "Graphics/vertex.h"
+#include "Scene/meshletBuilder.h"
 
 using uint16 = std::uint16_t;
 using uint32 = std::uint32_t;
 
+// simplified index range in sMeshData::lodIndices, error is in mesh units
+struct sMeshLod
+{
+	uint32 indexOffset;
+	uint32 indexCount;
+	float error;
+};
+
 struct sMeshData
 {
 	public:
@@ -16,6 +25,12 @@ struct sMeshData
 		std::vector<uint32> indices32;
 		std::vector<uint16> indices16;
 		int materialId = -1;
+		bool hasTangents = false;	// false until read from glTF or generated
+		sMeshletData meshletData;	// built on the final index order
+
+		// LOD 1..n, LOD 0 is indices32, all share the vertices
+		std::vector<uint32> lodIndices;
+		std::vector<sMeshLod> lods;
 	
 		std::vector<uint16>& GetIndices16()
 		{
@@ -7,9 +7,20 @@
 #include <wrl.h>
 #include <vector> 
 
+#include "vertexQuantization.h"
+
 using namespace DirectX;
 using namespace Microsoft::WRL;
 
+constexpr UINT c_MaxSubmeshLods = 4;
+
+struct sSubmeshLod
+{
+	UINT	indexCount;
+	UINT	startIndexLocation;
+	float	error;				// largest surface deviation from LOD 0, in mesh units
+};
+
 struct sSubmeshGeometry
 {
 	UINT indexCount				= 0;
@@ -19,6 +30,24 @@ struct sSubmeshGeometry
 	UINT materialId = UINT_MAX; 
 
 	BoundingBox bounds;
+
+	// quantized submeshes index into the quantized vertex pool and
+	// decode positions as positionOffset + unorm * positionScale
+	UINT		vertexFormat	= VERTEX_FORMAT_FULL;
+	XMFLOAT3	positionOffset	= XMFLOAT3(0.f, 0.f, 0.f);
+	XMFLOAT3	positionScale	= XMFLOAT3(1.f, 1.f, 1.f);
+
+	// R16_UINT submeshes (and all of their LODs) index into the 16-bit pool,
+	// startIndexLocation is relative to the pool of that format
+	DXGI_FORMAT	indexFormat		= DXGI_FORMAT_R32_UINT;
+
+	// range in the meshlet pool, meshlet vertices are relative to startVertexLocation
+	UINT meshletOffset	= 0;
+	UINT meshletCount	= 0;
+
+	// lods[0] is the full index range, coarser levels follow
+	sSubmeshLod	lods[c_MaxSubmeshLods]	= {};
+	UINT		lodCount				= 1;
 };
 
 struct sMeshGeometry
@@ -27,18 +56,26 @@ struct sMeshGeometry
 
 	ComPtr<ID3DBlob>		vertexBufferCPU		= nullptr;
 	ComPtr<ID3DBlob>		indexBufferCPU		= nullptr;
+	ComPtr<ID3DBlob>		index16BufferCPU	= nullptr;
 
 	ComPtr<ID3D12Resource> vertexBufferGPU		= nullptr;
 	ComPtr<ID3D12Resource> indexBufferGPU		= nullptr;
+	ComPtr<ID3D12Resource> index16BufferGPU		= nullptr;
 
 	ComPtr<ID3D12Resource> vertexBufferUploader	= nullptr;
 	ComPtr<ID3D12Resource> indexBufferUploader	= nullptr;
+	ComPtr<ID3D12Resource> index16BufferUploader	= nullptr;
+
+	ComPtr<ID3D12Resource> quantizedVertexBufferGPU		= nullptr;
+	ComPtr<ID3D12Resource> quantizedVertexBufferUploader	= nullptr;
+
+	UINT quantizedVertexBufferByteSize	= 0;
 
 	UINT vertexByteStride		= 0;
 	UINT vertexBufferByteSize	= 0;
 
-	DXGI_FORMAT indexFormat		= DXGI_FORMAT_R16_UINT;
 	UINT indexBufferByteSize	= 0;
+	UINT index16BufferByteSize	= 0;
 
 	std::vector<sSubmeshGeometry> drawArguments;
 
@@ -53,20 +90,43 @@ struct sMeshGeometry
 		return vbv;
 	}
 
-	D3D12_INDEX_BUFFER_VIEW GetIndexBufferView() const
+	D3D12_VERTEX_BUFFER_VIEW GetQuantizedVertexBufferView() const
+	{
+		D3D12_VERTEX_BUFFER_VIEW vbv;
+
+		vbv.BufferLocation	= quantizedVertexBufferGPU->GetGPUVirtualAddress();
+		vbv.SizeInBytes		= quantizedVertexBufferByteSize;
+		vbv.StrideInBytes	= sizeof(sVertexQuantized);
+
+		return vbv;
+	}
+
+	// _format selects the pool, see sSubmeshGeometry::indexFormat
+	D3D12_INDEX_BUFFER_VIEW GetIndexBufferView(DXGI_FORMAT _format) const
 	{
 		D3D12_INDEX_BUFFER_VIEW ibv;
 
-		ibv.BufferLocation	= indexBufferGPU->GetGPUVirtualAddress();
-		ibv.Format			= indexFormat;
-		ibv.SizeInBytes		= indexBufferByteSize;
+		if (_format == DXGI_FORMAT_R16_UINT)
+		{
+			ibv.BufferLocation	= index16BufferGPU->GetGPUVirtualAddress();
+			ibv.SizeInBytes		= index16BufferByteSize;
+		}
+		else
+		{
+			ibv.BufferLocation	= indexBufferGPU->GetGPUVirtualAddress();
+			ibv.SizeInBytes		= indexBufferByteSize;
+		}
+
+		ibv.Format = _format;
 
 		return ibv;
 	}
 
 	void DisposeUploaders()
 	{
-		vertexBufferUploader	= nullptr;
-		indexBufferUploader		= nullptr;
+		vertexBufferUploader			= nullptr;
+		indexBufferUploader				= nullptr;
+		index16BufferUploader			= nullptr;
+		quantizedVertexBufferUploader	= nullptr;
 	}
 };
\ No newline at end of file
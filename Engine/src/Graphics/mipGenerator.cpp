@@ -0,0 +1,428 @@
+#include "mipGenerator.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "Core/parallel.h"
+
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__)
+#define MIP_GENERATOR_SSE2 1
+#include <emmintrin.h>
+#else
+#define MIP_GENERATOR_SSE2 0
+#endif
+
+#if MIP_GENERATOR_SSE2 && defined(__AVX__)
+#define MIP_GENERATOR_AVX 1
+#include <immintrin.h>
+#else
+#define MIP_GENERATOR_AVX 0
+#endif
+
+// output rows per task, a task filters the source rows it overlaps on its own
+constexpr uint32_t  c_MipRowsPerTask    = 16;
+
+constexpr int       c_MaxFilterTaps     = 8;
+constexpr double    c_KaiserBeta        = 4.0;
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// taps of one separable pass, output pixel x reads source pixels 2 * x + offsets[i]
+struct sFilterKernel
+{
+    int     offsets[c_MaxFilterTaps];
+    float   weights[c_MaxFilterTaps];
+    int     tapCount;
+};
+
+struct sMipTables
+{
+    float           unormToFloat[256];
+    float           srgbToLinear[256];
+    float           srgbThresholds[256];    // linear value halfway (in sRGB) between code i and i + 1
+    uint8_t         srgbEncode[4096];       // code of the lower bound of every 1/4095 bucket
+    sFilterKernel   kernels[MIP_FILTER_COUNT];
+
+    sMipTables();
+};
+
+static double SrgbToLinear(double _value)
+{
+    return _value <= 0.04045 ? _value / 12.92 : std::pow((_value + 0.055) / 1.055, 2.4);
+}
+
+// zeroth order modified Bessel function of the first kind
+static double BesselI0(double _x)
+{
+    double sum  = 1.0;
+    double term = 1.0;
+
+    for (int k = 1; k < 32; ++k)
+    {
+        term *= (_x * 0.5 / k) * (_x * 0.5 / k);
+        sum  += term;
+    }
+
+    return sum;
+}
+
+sMipTables::sMipTables()
+{
+    for (int i = 0; i < 256; ++i)
+    {
+        unormToFloat[i]     = static_cast<float>(i / 255.0);
+        srgbToLinear[i]     = static_cast<float>(SrgbToLinear(i / 255.0));
+        srgbThresholds[i]   = i < 255 ? static_cast<float>(SrgbToLinear((i + 0.5) / 255.0)) : FLT_MAX;
+    }
+
+    int code = 0;
+
+    for (int bucket = 0; bucket < 4096; ++bucket)
+    {
+        const float value = bucket / 4095.0f;
+
+        while (value >= srgbThresholds[code])
+        {
+            ++code;
+        }
+
+        srgbEncode[bucket] = static_cast<uint8_t>(code);
+    }
+
+    sFilterKernel& rBox = kernels[MIP_FILTER_BOX];
+
+    rBox            = {};
+    rBox.tapCount   = 2;
+    rBox.offsets[0] = 0;
+    rBox.offsets[1] = 1;
+    rBox.weights[0] = 0.5f;
+    rBox.weights[1] = 0.5f;
+
+    // half band sinc under a Kaiser window, taps sit 0.5, 1.5, .. 3.5 source texels from the output center
+    sFilterKernel& rKaiser = kernels[MIP_FILTER_KAISER];
+
+    rKaiser             = {};
+    rKaiser.tapCount    = c_MaxFilterTaps;
+
+    double weights[c_MaxFilterTaps];
+    double weightSum = 0.0;
+
+    const double pi         = 3.14159265358979323846;
+    const double halfWidth  = c_MaxFilterTaps * 0.5;
+
+    for (int tap = 0; tap < c_MaxFilterTaps; ++tap)
+    {
+        const double distance   = tap - (c_MaxFilterTaps / 2 - 1) - 0.5;
+        const double t          = distance * 0.5;
+        const double sinc       = std::fabs(t) < 1e-9 ? 1.0 : std::sin(pi * t) / (pi * t);
+        const double window     = distance / halfWidth;
+
+        weights[tap]    = sinc * BesselI0(c_KaiserBeta * std::sqrt((std::max)(0.0, 1.0 - window * window))) / BesselI0(c_KaiserBeta);
+        weightSum      += weights[tap];
+
+        rKaiser.offsets[tap] = tap - (c_MaxFilterTaps / 2 - 1);
+    }
+
+    for (int tap = 0; tap < c_MaxFilterTaps; ++tap)
+    {
+        rKaiser.weights[tap] = static_cast<float>(weights[tap] / weightSum);
+    }
+}
+
+static const sMipTables& GetTables()
+{
+    static const sMipTables s_tables;
+    return s_tables;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+static inline uint8_t EncodeUnorm(float _value)
+{
+    return static_cast<uint8_t>((std::min)((std::max)(_value, 0.0f), 1.0f) * 255.0f + 0.5f);
+}
+
+static inline uint8_t EncodeSrgb(float _value, const sMipTables& _rTables)
+{
+    const float value = (std::min)((std::max)(_value, 0.0f), 1.0f);
+
+    int code = _rTables.srgbEncode[static_cast<int>(value * 4095.0f)];
+
+    // the bucket only gives a starting point, the thresholds decide
+    while (code > 0 && value < _rTables.srgbThresholds[code - 1])
+    {
+        --code;
+    }
+
+    while (value >= _rTables.srgbThresholds[code])
+    {
+        ++code;
+    }
+
+    return static_cast<uint8_t>(code);
+}
+
+static void LoadRow(const uint8_t* _pRow, uint32_t _width, bool _srgb, const sMipTables& _rTables, float* _pOut)
+{
+    const float* pColorTable = _srgb ? _rTables.srgbToLinear : _rTables.unormToFloat;
+
+    for (uint32_t x = 0; x < _width; ++x)
+    {
+        _pOut[x * 4 + 0] = pColorTable[_pRow[x * 4 + 0]];
+        _pOut[x * 4 + 1] = pColorTable[_pRow[x * 4 + 1]];
+        _pOut[x * 4 + 2] = pColorTable[_pRow[x * 4 + 2]];
+        _pOut[x * 4 + 3] = _rTables.unormToFloat[_pRow[x * 4 + 3]];
+    }
+}
+
+static void StoreRow(const float* _pRow, uint32_t _width, bool _srgb, const sMipTables& _rTables, uint8_t* _pOut)
+{
+    for (uint32_t x = 0; x < _width; ++x)
+    {
+        for (int channel = 0; channel < 3; ++channel)
+        {
+            _pOut[x * 4 + channel] = _srgb ? EncodeSrgb(_pRow[x * 4 + channel], _rTables) : EncodeUnorm(_pRow[x * 4 + channel]);
+        }
+
+        _pOut[x * 4 + 3] = EncodeUnorm(_pRow[x * 4 + 3]);
+    }
+}
+
+// horizontal pass, one float RGBA row to one row of the next level's width
+static void FilterRow(const float* _pSource, uint32_t _sourceWidth, float* _pOut, uint32_t _width, const sFilterKernel& _rKernel)
+{
+    const int lastSource = static_cast<int>(_sourceWidth) - 1;
+
+    auto SourceIndex = [&](uint32_t _x, int _tap)
+        {
+            return (std::min)((std::max)(static_cast<int>(_x * 2) + _rKernel.offsets[_tap], 0), lastSource);
+        };
+
+    uint32_t x = 0;
+
+#if MIP_GENERATOR_AVX
+    for (; x + 2 <= _width; x += 2)
+    {
+        __m256 sum = _mm256_setzero_ps();
+
+        for (int tap = 0; tap < _rKernel.tapCount; ++tap)
+        {
+            const __m256 pixels = _mm256_insertf128_ps(
+                _mm256_castps128_ps256(_mm_loadu_ps(_pSource + SourceIndex(x, tap) * 4)),
+                _mm_loadu_ps(_pSource + SourceIndex(x + 1, tap) * 4),
+                1);
+
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(_rKernel.weights[tap]), pixels));
+        }
+
+        _mm256_storeu_ps(_pOut + x * 4, sum);
+    }
+#endif
+
+    for (; x < _width; ++x)
+    {
+#if MIP_GENERATOR_SSE2
+        __m128 sum = _mm_setzero_ps();
+
+        for (int tap = 0; tap < _rKernel.tapCount; ++tap)
+        {
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(_rKernel.weights[tap]), _mm_loadu_ps(_pSource + SourceIndex(x, tap) * 4)));
+        }
+
+        _mm_storeu_ps(_pOut + x * 4, sum);
+#else
+        float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+        for (int tap = 0; tap < _rKernel.tapCount; ++tap)
+        {
+            const float* pPixel = _pSource + SourceIndex(x, tap) * 4;
+
+            for (int channel = 0; channel < 4; ++channel)
+            {
+                sum[channel] = sum[channel] + _rKernel.weights[tap] * pPixel[channel];
+            }
+        }
+
+        std::memcpy(_pOut + x * 4, sum, sizeof(sum));
+#endif
+    }
+}
+
+// vertical pass over rows that are already at the next level's width, _ppRows holds one row per tap
+static void FilterColumns(const float* const* _ppRows, uint32_t _width, float* _pOut, const sFilterKernel& _rKernel)
+{
+    const uint32_t floatCount = _width * 4;
+
+    uint32_t i = 0;
+
+#if MIP_GENERATOR_AVX
+    for (; i + 8 <= floatCount; i += 8)
+    {
+        __m256 sum = _mm256_setzero_ps();
+
+        for (int tap = 0; tap < _rKernel.tapCount; ++tap)
+        {
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(_rKernel.weights[tap]), _mm256_loadu_ps(_ppRows[tap] + i)));
+        }
+
+        _mm256_storeu_ps(_pOut + i, sum);
+    }
+#endif
+
+#if MIP_GENERATOR_SSE2
+    for (; i < floatCount; i += 4)
+    {
+        __m128 sum = _mm_setzero_ps();
+
+        for (int tap = 0; tap < _rKernel.tapCount; ++tap)
+        {
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(_rKernel.weights[tap]), _mm_loadu_ps(_ppRows[tap] + i)));
+        }
+
+        _mm_storeu_ps(_pOut + i, sum);
+    }
+#else
+    for (; i < floatCount; ++i)
+    {
+        float sum = 0.0f;
+
+        for (int tap = 0; tap < _rKernel.tapCount; ++tap)
+        {
+            sum = sum + _rKernel.weights[tap] * _ppRows[tap][i];
+        }
+
+        _pOut[i] = sum;
+    }
+#endif
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+uint32_t cMipGenerator::GetMipCount(uint32_t _width, uint32_t _height)
+{
+    uint32_t mipCount   = 1;
+    uint32_t size       = (std::max)(_width, _height);
+
+    while (size > 1)
+    {
+        size >>= 1;
+        ++mipCount;
+    }
+
+    return mipCount;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+size_t cMipGenerator::GetChainByteSize(uint32_t _width, uint32_t _height)
+{
+    const uint32_t mipCount = GetMipCount(_width, _height);
+
+    size_t byteSize = 0;
+
+    for (uint32_t mip = 0; mip < mipCount; ++mip)
+    {
+        byteSize += static_cast<size_t>((std::max)(_width >> mip, 1u)) * (std::max)(_height >> mip, 1u) * 4;
+    }
+
+    return byteSize;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cMipGenerator::GenerateChain(const uint8_t* _pRgba, uint32_t _width, uint32_t _height, uint8_t* _pOutChain,
+    eMipFilter _filter, bool _srgb, bool _multithreaded)
+{
+    std::vector<sSubresourceFootprint> footprints(GetMipCount(_width, _height));
+    cTextureFootprint::ComputePacked(_width, _height, static_cast<uint32_t>(footprints.size()), 1, 4, 1, footprints.data());
+
+    GenerateChain(_pRgba, _width, _height, _pOutChain, footprints.data(), _filter, _srgb, _multithreaded);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cMipGenerator::GenerateChain(const uint8_t* _pRgba, uint32_t _width, uint32_t _height, uint8_t* _pOut,
+    const sSubresourceFootprint* _pFootprints, eMipFilter _filter, bool _srgb, bool _multithreaded)
+{
+    const sMipTables&       rTables = GetTables();
+    const sFilterKernel&    rKernel = rTables.kernels[_filter];
+
+    const uint32_t mipCount = GetMipCount(_width, _height);
+
+    sSubresourceFootprint source = _pFootprints[0];
+
+    source.offset   = 0;
+    source.rowPitch = _width * 4;
+
+    cTextureFootprint::CopyRows(_pRgba, source, _pOut, _pFootprints[0]);
+
+    for (uint32_t mip = 1; mip < mipCount; ++mip)
+    {
+        const sSubresourceFootprint& rSource        = _pFootprints[mip - 1];
+        const sSubresourceFootprint& rDestination   = _pFootprints[mip];
+
+        const uint8_t*  pSource         = _pOut + rSource.offset;
+        uint8_t*        pDestination    = _pOut + rDestination.offset;
+
+        const uint32_t sourceWidth  = rSource.width;
+        const uint32_t width        = rDestination.width;
+        const uint32_t height       = rDestination.height;
+        const int      lastRow      = static_cast<int>(rSource.height) - 1;
+
+        auto SourceRow = [&](uint32_t _y, int _tap)
+            {
+                return (std::min)((std::max)(static_cast<int>(_y * 2) + rKernel.offsets[_tap], 0), lastRow);
+            };
+
+        auto FilterBand = [&](size_t _band)
+            {
+                const uint32_t firstRow = static_cast<uint32_t>(_band) * c_MipRowsPerTask;
+                const uint32_t endRow   = (std::min)(firstRow + c_MipRowsPerTask, height);
+
+                const int firstSource   = SourceRow(firstRow, 0);
+                const int lastSource    = SourceRow(endRow - 1, rKernel.tapCount - 1);
+
+                std::vector<float> sourceRow(static_cast<size_t>(sourceWidth) * 4);
+                std::vector<float> filteredRows(static_cast<size_t>(lastSource - firstSource + 1) * width * 4);
+                std::vector<float> outRow(static_cast<size_t>(width) * 4);
+
+                for (int y = firstSource; y <= lastSource; ++y)
+                {
+                    LoadRow(pSource + static_cast<size_t>(y) * rSource.rowPitch, sourceWidth, _srgb, rTables, sourceRow.data());
+                    FilterRow(sourceRow.data(), sourceWidth, filteredRows.data() + static_cast<size_t>(y - firstSource) * width * 4, width, rKernel);
+                }
+
+                const float* rows[c_MaxFilterTaps];
+
+                for (uint32_t y = firstRow; y < endRow; ++y)
+                {
+                    for (int tap = 0; tap < rKernel.tapCount; ++tap)
+                    {
+                        rows[tap] = filteredRows.data() + static_cast<size_t>(SourceRow(y, tap) - firstSource) * width * 4;
+                    }
+
+                    FilterColumns(rows, width, outRow.data(), rKernel);
+                    StoreRow(outRow.data(), width, _srgb, rTables, pDestination + static_cast<size_t>(y) * rDestination.rowPitch);
+                }
+            };
+
+        const size_t bandCount = (height + c_MipRowsPerTask - 1) / c_MipRowsPerTask;
+
+        if (_multithreaded)
+        {
+            cParallel::For(bandCount, FilterBand);
+        }
+        else
+        {
+            for (size_t band = 0; band < bandCount; ++band)
+            {
+                FilterBand(band);
+            }
+        }
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
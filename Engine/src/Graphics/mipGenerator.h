@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "textureFootprint.h"
+
+enum eMipFilter : uint32_t
+{
+	MIP_FILTER_BOX = 0,		// 2x2 average
+	MIP_FILTER_KAISER,		// 8 tap Kaiser windowed sinc, sharper and less aliasing
+
+	MIP_FILTER_COUNT
+};
+
+// Platform neutral mip chain builder for RGBA8 images. Levels are stored one after
+// another without padding, mip 0 first, down to 1x1. Every level is filtered from the
+// one above it with a separable kernel, odd edges repeat the last texel.
+//
+// The filters run on float RGBA pixels with SSE2 (two pixels per AVX register when the
+// compiler targets AVX). Every path performs the same operations in the same order, so
+// the output is identical for any instruction set and thread count.
+class cMipGenerator
+{
+	public:
+
+		static uint32_t	GetMipCount(uint32_t _width, uint32_t _height);
+		static size_t	GetChainByteSize(uint32_t _width, uint32_t _height);
+
+		// _pOutChain needs GetChainByteSize bytes, mip 0 is copied from _pRgba.
+		// _srgb averages RGB in linear light and encodes the result back to sRGB, alpha
+		// is always linear. Row bands of each level go to all workers when _multithreaded is set.
+		static void GenerateChain(const uint8_t* _pRgba, uint32_t _width, uint32_t _height, uint8_t* _pOutChain,
+			eMipFilter _filter = MIP_FILTER_BOX, bool _srgb = false, bool _multithreaded = false);
+
+		// same chain written at the offsets and row pitches of _pFootprints (one per mip), e.g.
+		// straight into a staging allocation laid out by cTextureFootprint::ComputeStaging
+		static void GenerateChain(const uint8_t* _pRgba, uint32_t _width, uint32_t _height, uint8_t* _pOut,
+			const sSubresourceFootprint* _pFootprints, eMipFilter _filter = MIP_FILTER_BOX, bool _srgb = false, bool _multithreaded = false);
+};
@@ -2,6 +2,7 @@
 
 #include <d3dx12.h>
 
+#include "gfxConfig.h"
 #include "rootSignatureManager.h"
 #include "shaderManager.h"
 
@@ -12,6 +13,7 @@ cPipelineStateManager::cPipelineStateManager()
     , m_pShaderManager(nullptr)
     , m_pRootSignatureManager(nullptr)
     , m_InputLayouts()
+    , m_quantizedInputLayout()
     , m_pipelineStateObjects()
 {
 }
@@ -54,6 +56,25 @@ void cPipelineStateManager::CreateGraphicsPSO()
         { "TEXCOORD", 1, DXGI_FORMAT_R32G32_FLOAT,      0, 48, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
     };
 
+    // sVertexQuantized, decoded in VSQuantized
+#if GFX_QTANGENT_VERTICES
+    m_quantizedInputLayout =
+    {
+        { "POSITION", 0, DXGI_FORMAT_R16G16B16A16_UNORM, 0, 0,  D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+        { "TANGENT",  0, DXGI_FORMAT_R16G16B16A16_SNORM, 0, 8,  D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+        { "TEXCOORD", 0, DXGI_FORMAT_R16G16_FLOAT,       0, 16, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+        { "TEXCOORD", 1, DXGI_FORMAT_R16G16_FLOAT,       0, 20, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+    };
+#else
+    m_quantizedInputLayout =
+    {
+        { "POSITION", 0, DXGI_FORMAT_R16G16B16A16_UNORM, 0, 0,  D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+        { "NORMAL",   0, DXGI_FORMAT_R16G16_SNORM,       0, 8,  D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+        { "TEXCOORD", 0, DXGI_FORMAT_R16G16_FLOAT,       0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+        { "TEXCOORD", 1, DXGI_FORMAT_R16G16_FLOAT,       0, 16, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+    };
+#endif
+
     D3D12_GRAPHICS_PIPELINE_STATE_DESC desc = {};
     desc.pRootSignature = m_pRootSignatureManager->GetRootSignature("graphics");
 
@@ -79,6 +100,17 @@ void cPipelineStateManager::CreateGraphicsPSO()
     m_pDevice->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(&pso));
 
     m_pipelineStateObjects["graphics"] = pso;
+
+    // same state, quantized vertex input
+    auto vsQuantized = m_pShaderManager->GetShader("vsQuantized");
+
+    desc.VS             = { vsQuantized->GetBufferPointer(), vsQuantized->GetBufferSize() };
+    desc.InputLayout    = { m_quantizedInputLayout.data(), static_cast<UINT>(m_quantizedInputLayout.size()) };
+
+    ComPtr<ID3D12PipelineState> psoQuantized;
+    m_pDevice->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(&psoQuantized));
+
+    m_pipelineStateObjects["graphicsQuantized"] = psoQuantized;
 }
 
 // --------------------------------------------------------------------------------------------------------------------------
@@ -36,6 +36,7 @@ class cPipelineStateManager
 		cRootSignatureManager*	m_pRootSignatureManager;
 
 		std::vector<D3D12_INPUT_ELEMENT_DESC> m_InputLayouts;
+		std::vector<D3D12_INPUT_ELEMENT_DESC> m_quantizedInputLayout;
 
 		std::unordered_map<std::string, ComPtr<ID3D12PipelineState>> m_pipelineStateObjects;
 };
\ No newline at end of file
@@ -11,8 +11,7 @@ using namespace DirectX;
 struct sRenderItem
 {
     sRenderItem()
-        : worldMatrix()
-        , numberOfFramesDirty(c_NumberOfFrameResources)
+        : numberOfFramesDirty(c_NumberOfFrameResources)
         , objCBIndex(-1)
         , pGeometry(nullptr)
         , pMaterial(nullptr)
@@ -20,12 +19,19 @@ struct sRenderItem
         , indexCount(0)
         , startIndexLocation(0)
         , baseVertexLocation(0)
+        , vertexFormat(VERTEX_FORMAT_FULL)
+        , indexFormat(DXGI_FORMAT_R32_UINT)
+        , positionOffset(0.f, 0.f, 0.f)
+        , positionScale(1.f, 1.f, 1.f)
+        , submeshIndex(0)
+        , lodIndex(0)
+        , isCulled(false)
     {
-        XMStoreFloat4x4(&worldMatrix, XMMatrixIdentity());
     }
 
-    XMFLOAT4X4                  worldMatrix;
     int                         numberOfFramesDirty;  
+
+    // object constants and transform system entry, the scene graph node holds the world
     UINT                        objCBIndex;          
     sMeshGeometry*              pGeometry;          
     sMaterial*                  pMaterial;         
@@ -34,4 +40,14 @@ struct sRenderItem
     UINT                        indexCount;      
     UINT                        startIndexLocation;   
     int                         baseVertexLocation;  
+
+    UINT                        vertexFormat;
+    DXGI_FORMAT                 indexFormat;
+    XMFLOAT3                    positionOffset;
+    XMFLOAT3                    positionScale;
+
+    // index into pGeometry->drawArguments, cScene::SelectLods picks the index range from its LODs
+    UINT                        submeshIndex;
+    UINT                        lodIndex;
+    bool                        isCulled;
 };
@@ -3,6 +3,7 @@
 #include <d3dx12.h>
 
 #include "directx12Util.h"
+#include "gfxConfig.h"
 
 // --------------------------------------------------------------------------------------------------------------------------
 
@@ -40,7 +41,7 @@ ID3D12RootSignature* cRootSignatureManager::GetRootSignature(const std::string&
 void cRootSignatureManager::CreateGraphicsRS()
 {
   
-    CD3DX12_ROOT_PARAMETER params[4] = {};
+    CD3DX12_ROOT_PARAMETER params[5] = {};
 
     CD3DX12_DESCRIPTOR_RANGE cbv0;
     cbv0.Init(D3D12_DESCRIPTOR_RANGE_TYPE_CBV, 1, 0);
@@ -55,13 +56,17 @@ void cRootSignatureManager::CreateGraphicsRS()
     params[2].InitAsDescriptorTable(1, &srv0);
 
     CD3DX12_DESCRIPTOR_RANGE srv1;
-    srv1.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 512, 1);
+    // bindless texture table, cTextureRegistry hands out its slots
+    srv1.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, GFX_BINDLESS_TEXTURE_CAPACITY, 1);
     params[3].InitAsDescriptorTable(1, &srv1, D3D12_SHADER_VISIBILITY_PIXEL);
 
+    // texture references (t0, space1), a root SRV so it needs no descriptor
+    params[4].InitAsShaderResourceView(0, 1, D3D12_SHADER_VISIBILITY_PIXEL);
+
     CD3DX12_STATIC_SAMPLER_DESC samp(0, D3D12_FILTER_MIN_MAG_MIP_LINEAR);
 
     CD3DX12_ROOT_SIGNATURE_DESC desc(
-        4, params,
+        5, params,
         1, &samp,
         D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT
     );
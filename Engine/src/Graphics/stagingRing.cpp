@@ -0,0 +1,124 @@
+#include "stagingRing.h"
+
+#include <stdexcept>
+#include <d3dx12.h>
+
+#include "directx12Util.h"
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+cStagingRing::cStagingRing()
+    : m_pDevice(nullptr)
+    , m_pBuffer(nullptr)
+    , m_pMapped(nullptr)
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+cStagingRing::~cStagingRing()
+{
+    if (m_pBuffer)
+        m_pBuffer->Unmap(0, nullptr);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cStagingRing::Initialize(ID3D12Device* _pDevice, UINT64 _byteSize)
+{
+    m_pDevice = _pDevice;
+
+    CreateBuffer(_byteSize);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cStagingRing::Reserve(UINT64 _byteSize)
+{
+    if (_byteSize <= m_allocator.GetCapacity())
+        return;
+
+    if (!m_allocator.IsIdle())
+    {
+        throw std::runtime_error("Staging ring can only grow while no upload is in flight.");
+    }
+
+    CreateBuffer(_byteSize);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+bool cStagingRing::Allocate(UINT64 _byteSize, UINT64 _alignment, sStagingAllocation& _rOutAllocation)
+{
+    UINT64 offset = 0;
+
+    if (!m_allocator.Allocate(_byteSize, _alignment, offset))
+        return false;
+
+    _rOutAllocation.pData       = m_pMapped + offset;
+    _rOutAllocation.offset      = offset;
+    _rOutAllocation.pResource   = m_pBuffer.Get();
+
+    return true;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cStagingRing::Close(UINT64 _fenceValue)
+{
+    m_allocator.Close(_fenceValue);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cStagingRing::Retire(UINT64 _completedFenceValue)
+{
+    m_allocator.Retire(_completedFenceValue);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+ID3D12Resource* cStagingRing::GetResource() const
+{
+    return m_pBuffer.Get();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+UINT64 cStagingRing::GetCapacity() const
+{
+    return m_allocator.GetCapacity();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cStagingRing::CreateBuffer(UINT64 _byteSize)
+{
+    if (m_pBuffer)
+    {
+        m_pBuffer->Unmap(0, nullptr);
+        m_pBuffer.Reset();
+        m_pMapped = nullptr;
+    }
+
+    CD3DX12_HEAP_PROPERTIES uploadHeap(D3D12_HEAP_TYPE_UPLOAD);
+    auto bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(_byteSize);
+
+    cDirectX12Util::ThrowIfFailed(m_pDevice->CreateCommittedResource(
+        &uploadHeap,
+        D3D12_HEAP_FLAG_NONE,
+        &bufferDesc,
+        D3D12_RESOURCE_STATE_GENERIC_READ,
+        nullptr,
+        IID_PPV_ARGS(&m_pBuffer)
+    ));
+
+    // the CPU never reads it back
+    D3D12_RANGE readRange = { 0, 0 };
+
+    cDirectX12Util::ThrowIfFailed(m_pBuffer->Map(0, &readRange, reinterpret_cast<void**>(&m_pMapped)));
+
+    m_allocator.Reset(_byteSize);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <d3d12.h>
+#include <wrl.h>
+
+#include "Core/ringAllocator.h"
+
+struct sStagingAllocation
+{
+	uint8_t*		pData;		// persistently mapped, write only
+	UINT64			offset;		// into GetResource()
+	ID3D12Resource*	pResource;
+};
+
+// One upload heap buffer that stays mapped for the lifetime of the renderer. Uploads
+// take space from it in submission order and give it back once their fence completes,
+// instead of creating (and later releasing) a committed upload heap per resource.
+class cStagingRing
+{
+	public:
+
+		cStagingRing();
+		~cStagingRing();
+
+		cStagingRing(const cStagingRing&) = delete;
+		cStagingRing& operator=(const cStagingRing&) = delete;
+
+	public:
+
+		void Initialize(ID3D12Device* _pDevice, UINT64 _byteSize);
+
+		// recreates the buffer with at least _byteSize bytes, only while nothing is in flight
+		void Reserve(UINT64 _byteSize);
+
+		// false when the ring is full until older uploads retire
+		bool Allocate(UINT64 _byteSize, UINT64 _alignment, sStagingAllocation& _rOutAllocation);
+
+		void Close(UINT64 _fenceValue);
+		void Retire(UINT64 _completedFenceValue);
+
+		ID3D12Resource* GetResource() const;
+		UINT64			GetCapacity() const;
+
+	private:
+
+		void CreateBuffer(UINT64 _byteSize);
+
+	private:
+
+		ID3D12Device*							m_pDevice;
+		Microsoft::WRL::ComPtr<ID3D12Resource>	m_pBuffer;
+		uint8_t*								m_pMapped;
+		cRingAllocator							m_allocator;
+};
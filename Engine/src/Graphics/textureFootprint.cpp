@@ -0,0 +1,84 @@
+#include "textureFootprint.h"
+
+#include <algorithm>
+#include <cstring>
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+static uint64_t AlignUp(uint64_t _value, uint64_t _alignment)
+{
+    return (_value + _alignment - 1) / _alignment * _alignment;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+uint64_t cTextureFootprint::Compute(uint32_t _width, uint32_t _height, uint32_t _mipCount, uint32_t _arraySize, uint32_t _blockBytes, uint32_t _blockSize,
+    uint32_t _pitchAlignment, uint32_t _placementAlignment, sSubresourceFootprint* _pOutFootprints)
+{
+    uint64_t offset     = 0;
+    uint64_t totalBytes = 0;
+
+    for (uint32_t subresource = 0; subresource < _mipCount * _arraySize; ++subresource)
+    {
+        const uint32_t mip = subresource % _mipCount;
+
+        sSubresourceFootprint& rFootprint = _pOutFootprints[subresource];
+
+        rFootprint.width    = (std::max)(_width >> mip, 1u);
+        rFootprint.height   = (std::max)(_height >> mip, 1u);
+
+        const uint32_t columns = (rFootprint.width + _blockSize - 1) / _blockSize;
+
+        offset = AlignUp(offset, _placementAlignment);
+
+        rFootprint.offset   = offset;
+        rFootprint.rowBytes = columns * _blockBytes;
+        rFootprint.rowPitch = static_cast<uint32_t>(AlignUp(rFootprint.rowBytes, _pitchAlignment));
+        rFootprint.rowCount = (rFootprint.height + _blockSize - 1) / _blockSize;
+
+        totalBytes  = offset + static_cast<uint64_t>(rFootprint.rowPitch) * (rFootprint.rowCount - 1) + rFootprint.rowBytes;
+        offset     += static_cast<uint64_t>(rFootprint.rowPitch) * rFootprint.rowCount;
+    }
+
+    return totalBytes;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+uint64_t cTextureFootprint::ComputeStaging(uint32_t _width, uint32_t _height, uint32_t _mipCount, uint32_t _arraySize, uint32_t _blockBytes, uint32_t _blockSize,
+    sSubresourceFootprint* _pOutFootprints)
+{
+    return Compute(_width, _height, _mipCount, _arraySize, _blockBytes, _blockSize, c_TexturePitchAlignment, c_TexturePlacementAlignment, _pOutFootprints);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+uint64_t cTextureFootprint::ComputePacked(uint32_t _width, uint32_t _height, uint32_t _mipCount, uint32_t _arraySize, uint32_t _blockBytes, uint32_t _blockSize,
+    sSubresourceFootprint* _pOutFootprints)
+{
+    return Compute(_width, _height, _mipCount, _arraySize, _blockBytes, _blockSize, 1, 1, _pOutFootprints);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTextureFootprint::CopyRows(const uint8_t* _pSource, const sSubresourceFootprint& _rSource,
+    uint8_t* _pDestination, const sSubresourceFootprint& _rDestination)
+{
+    const uint8_t*  pSource         = _pSource + _rSource.offset;
+    uint8_t*        pDestination    = _pDestination + _rDestination.offset;
+
+    // matching pitches (packed mips of at least 256 bytes per row) go in one block
+    if (_rSource.rowPitch == _rDestination.rowPitch)
+    {
+        std::memcpy(pDestination, pSource, static_cast<size_t>(_rSource.rowPitch) * (_rSource.rowCount - 1) + _rSource.rowBytes);
+        return;
+    }
+
+    for (uint32_t row = 0; row < _rSource.rowCount; ++row)
+    {
+        std::memcpy(pDestination + static_cast<size_t>(row) * _rDestination.rowPitch,
+            pSource + static_cast<size_t>(row) * _rSource.rowPitch, _rSource.rowBytes);
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// D3D12_TEXTURE_DATA_PITCH_ALIGNMENT / D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT
+constexpr uint32_t c_TexturePitchAlignment		= 256;
+constexpr uint32_t c_TexturePlacementAlignment	= 512;
+
+// Layout of one mip inside a staging block or a payload. Rows are block rows for
+// block compressed formats (four texel rows each) and texel rows otherwise.
+struct sSubresourceFootprint
+{
+	uint64_t	offset;		// from the start of the block
+	uint32_t	width;		// texels
+	uint32_t	height;		// texels
+	uint32_t	rowPitch;	// bytes from one row to the next
+	uint32_t	rowCount;
+	uint32_t	rowBytes;	// bytes of a row that carry data, rowPitch minus padding
+};
+
+// Platform neutral copy of the footprint math behind ID3D12Device::GetCopyableFootprints,
+// so decoders and mip generators can be handed the final staging layout before anything
+// is written, and the layouts can be checked without a device.
+class cTextureFootprint
+{
+	public:
+
+		// fills _mipCount * _arraySize footprints in subresource order (mip + slice * _mipCount)
+		// and returns the bytes they span, the last row of the last subresource is not padded.
+		// _blockSize is 4 for BCn, 1 for uncompressed formats
+		static uint64_t Compute(uint32_t _width, uint32_t _height, uint32_t _mipCount, uint32_t _arraySize, uint32_t _blockBytes, uint32_t _blockSize,
+			uint32_t _pitchAlignment, uint32_t _placementAlignment, sSubresourceFootprint* _pOutFootprints);
+
+		// the GPU upload layout
+		static uint64_t ComputeStaging(uint32_t _width, uint32_t _height, uint32_t _mipCount, uint32_t _arraySize, uint32_t _blockBytes, uint32_t _blockSize,
+			sSubresourceFootprint* _pOutFootprints);
+
+		// levels back to back without padding, slice after slice, the layout of a cCpuTexture payload
+		static uint64_t ComputePacked(uint32_t _width, uint32_t _height, uint32_t _mipCount, uint32_t _arraySize, uint32_t _blockBytes, uint32_t _blockSize,
+			sSubresourceFootprint* _pOutFootprints);
+
+		// copies the rows of one mip between two layouts of the same texture
+		static void CopyRows(const uint8_t* _pSource, const sSubresourceFootprint& _rSource,
+			uint8_t* _pDestination, const sSubresourceFootprint& _rDestination);
+};
@@ -2,24 +2,28 @@
 
 #include <algorithm>
 #include <cassert>
+#include <iostream>
 #include <stdexcept>
 
 #include "cpuTexture.h"
 #include "commandContext.h"
+#include "directx12Util.h"
 #include "gfxConfig.h"
 
 #include "d3dx12.h"
 
 // --------------------------------------------------------------------------------------------------------------------------
 
-int cTextureManager::UploadCpuTextures(std::vector<cCpuTexture>& _rCpuTextures, ID3D12Device* _pDevice, ID3D12DescriptorHeap* _pHeap,
-    cCommandContext* _pCommandContext, ID3D12PipelineState* _pMipGenPipelineState,
-    ID3D12RootSignature* _pMipGenRootSignature, UINT _textureSrvBaseOffset
+int cTextureManager::UploadCpuTextures(std::vector<cCpuTexture>& _rCpuTextures, const std::vector<sTextureRef>& _rTextureRefs,
+    ID3D12Device* _pDevice, ID3D12DescriptorHeap* _pHeap,
+    cCommandContext* _pCommandContext, cStagingRing* _pStagingRing, ID3D12PipelineState* _pMipGenPipelineState,
+    ID3D12RootSignature* _pMipGenRootSignature, UINT _textureSrvBaseOffset, UINT _mipUavBaseOffset
 )
 {
     assert(_pDevice);
     assert(_pHeap);
     assert(_pCommandContext);
+    assert(_pStagingRing);
     assert(_pMipGenPipelineState);
     assert(_pMipGenRootSignature);
 
@@ -28,24 +32,94 @@ int cTextureManager::UploadCpuTextures(std::vector<cCpuTexture>& _rCpuTextures,
     assert(pCmdList);
 
     const UINT descriptorSize   = _pDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-    const UINT numTextures      = min(static_cast<UINT>(_rCpuTextures.size()), GFX_MAX_NUMGER_OF_TEXTURES);
-    const UINT mipUavBaseOffset = _textureSrvBaseOffset + GFX_MAX_NUMGER_OF_TEXTURES;
+    const UINT numTextures      = static_cast<UINT>(_rCpuTextures.size());
+
+    if (m_registry.GetCapacity() == 0)
+    {
+        m_registry.Initialize(GFX_BINDLESS_TEXTURE_CAPACITY);
+    }
+
+    // frames recorded before may still sample the textures through their slots
+    for (uint32_t slot : m_slots)
+    {
+        m_registry.Free(slot, m_lastFenceValue);
+    }
+
+    m_slots.clear();
+    m_slots.reserve(numTextures);
+
+    for (UINT i = 0; i < numTextures; ++i)
+    {
+        const uint32_t slot = m_registry.Allocate();
+
+        if (slot == cTextureRegistry::c_InvalidSlot)
+        {
+            throw std::runtime_error("Bindless texture table is full, raise GFX_BINDLESS_TEXTURE_CAPACITY.");
+        }
+
+        m_slots.push_back(slot);
+    }
+
+    // the mip generation UAVs only live until this batch executed
+    UINT mipUavCursor = 0;
 
     m_textures.clear();
     m_textures.resize(numTextures);
+    m_bindings.clear();
+    m_bindings.resize(numTextures);
+    m_rebindTextures.clear();
+    m_pendingStreams.clear();
+    m_releasedResources.clear();
+    m_freeTextureRefTables.clear();
+    m_retiredTextureRefTables.clear();
+
+    m_pDevice           = _pDevice;
+    m_pHeap             = _pHeap;
+    m_descriptorSize    = descriptorSize;
+    m_srvBaseOffset     = _textureSrvBaseOffset;
+
+    std::vector<sStreamedTextureDesc> streamedTextures(numTextures);
 
     ID3D12DescriptorHeap* heaps[] = { _pHeap };
     pCmdList->SetDescriptorHeaps(_countof(heaps), heaps);
 
+    m_textureRefs = _rTextureRefs;
+    m_pTextureRefs.Reset();
+
+    sStagingAllocation refsStaging = {};
+
+    if (!_pStagingRing->Allocate(GetTextureRefsByteSize(), c_TexturePlacementAlignment, refsStaging))
+    {
+        throw std::runtime_error("Staging ring is out of space, reserve the upload before recording it.");
+    }
+
+    RecordTextureRefs(refsStaging, pCmdList);
+
     for (UINT i = 0; i < numTextures; ++i)
     {
         // ---------------------------------------------------------
-        // upload texture (mip 0)
+        // upload texture (every level it carries, or its mip tail)
         // ---------------------------------------------------------
+        cCpuTexture& rCpuTexture    = _rCpuTextures[i];
+        const UINT initialMip       = GetInitialMip(rCpuTexture);
+
+        sStreamedTextureDesc& rStreamed = streamedTextures[i];
+
+        rStreamed.width     = static_cast<uint32_t>(rCpuTexture.GetWidth());
+        rStreamed.height    = static_cast<uint32_t>(rCpuTexture.GetHeight());
+        rStreamed.mipLevels = rCpuTexture.GetMipLevels();
+        rStreamed.arraySize = rCpuTexture.GetArraySize();
+        rStreamed.firstMip  = GetFirstMip(rCpuTexture);
+        rStreamed.tailMip   = initialMip;
+
+        cCpuTexture::GetBlockLayout(rCpuTexture.GetFormat(), rStreamed.blockBytes, rStreamed.blockSize);
+
         m_textures[i].UploadToGpu(
-            _rCpuTextures[i],
+            rCpuTexture,
             _pDevice,
-            pCmdList
+            pCmdList,
+            *_pStagingRing,
+            initialMip
         );
 
         ID3D12Resource* pTexture =
@@ -56,15 +130,34 @@ int cTextureManager::UploadCpuTextures(std::vector<cCpuTexture>& _rCpuTextures,
         // ---------------------------------------------------------
         // create SRVs
         // ---------------------------------------------------------
-        const UINT srvHeapIndex = _textureSrvBaseOffset + i;
+        const UINT srvHeapIndex = _textureSrvBaseOffset + m_slots[i];
 
         D3D12_GPU_DESCRIPTOR_HANDLE srvGpuHandle = CreateSRV(_pDevice, _pHeap, pTexture, descriptorSize, srvHeapIndex);
 
+        m_bindings[i] = { pTexture, initialMip, pTexture, false };
+
+        // ---------------------------------------------------------
+        // block compressed / CPU built chains arrive complete
+        // ---------------------------------------------------------
+        if (!(pTexture->GetDesc().Flags & D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS))
+        {
+            auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(
+                pTexture,
+                D3D12_RESOURCE_STATE_COPY_DEST,
+                D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE
+            );
+
+            pCmdList->ResourceBarrier(1, &barrier);
+            continue;
+        }
+
         // ---------------------------------------------------------
         // create UAVs for mipmaps
         // ---------------------------------------------------------
-        std::vector<D3D12_GPU_DESCRIPTOR_HANDLE> uavGpuHandles = 
-            CreateMipUAVs(_pDevice, _pHeap, pTexture, descriptorSize, i, mipUavBaseOffset, GFX_MAX_MIP_MAPS_PER_TEXTURE);
+        std::vector<D3D12_GPU_DESCRIPTOR_HANDLE> uavGpuHandles = CreateMipUAVs(_pDevice, _pHeap, pTexture, descriptorSize,
+            _mipUavBaseOffset + mipUavCursor, GFX_MIP_GEN_UAV_CAPACITY - mipUavCursor);
+
+        mipUavCursor += pTexture->GetDesc().MipLevels - 1;
 
         // ---------------------------------------------------------
         // generate mipmaps (compute shader)
@@ -72,21 +165,445 @@ int cTextureManager::UploadCpuTextures(std::vector<cCpuTexture>& _rCpuTextures,
         GenerateMipmaps(pCmdList, pTexture, srvGpuHandle, uavGpuHandles, _pMipGenPipelineState, _pMipGenRootSignature);
     }
 
+    m_streamer.Initialize(streamedTextures.data(), streamedTextures.size(), _rTextureRefs.data(), _rTextureRefs.size());
+    m_streamer.SetMemoryBudget(GFX_TEXTURE_MEMORY_BUDGET);
+
+    // the tails stay resident whatever the budget says, nothing streams in until levels are evicted
+    if (m_streamer.GetCommittedBytes() > GFX_TEXTURE_MEMORY_BUDGET)
+    {
+        std::cout << "Texture budget: mip tails take " << (m_streamer.GetCommittedBytes() >> 20) << " MB of "
+            << (GFX_TEXTURE_MEMORY_BUDGET >> 20) << " MB" << std::endl;
+    }
+
+#if GFX_TEXTURE_STREAMING
+    m_streamSources = std::move(_rCpuTextures);
+#else
+    m_streamSources.clear();
+#endif
+
     return static_cast<int>(numTextures);
 }
 
 // --------------------------------------------------------------------------------------------------------------------------
 
-void cTextureManager::ReleaseUploadHeaps()
+UINT64 cTextureManager::GetStagingByteSize(std::vector<cCpuTexture>& _rCpuTextures, const std::vector<sTextureRef>& _rTextureRefs)
+{
+    const UINT numTextures = static_cast<UINT>(_rCpuTextures.size());
+
+    // the reference table goes first, RecordTextureRefs keeps at least one entry
+    UINT64 byteSize = static_cast<UINT64>(max(_rTextureRefs.size(), static_cast<size_t>(1))) * sizeof(sTextureRef);
+
+    byteSize = (byteSize + c_TexturePlacementAlignment - 1) / c_TexturePlacementAlignment * c_TexturePlacementAlignment;
+
+    UINT64 largestLevelBytes = 0;
+
+    for (UINT i = 0; i < numTextures; ++i)
+    {
+        cCpuTexture& rTexture = _rCpuTextures[i];
+
+        const UINT width    = static_cast<UINT>(rTexture.GetWidth());
+        const UINT height   = static_cast<UINT>(rTexture.GetHeight());
+
+        // cGpuTexture::UploadToGpu stages the levels the texture carries from the initial one on, for every slice
+        const UINT firstMip     = GetInitialMip(rTexture);
+        const UINT uploadMips   = rTexture.GetMipLevels() - firstMip;
+        const UINT arraySize    = rTexture.GetArraySize();
+
+        sStreamedTextureDesc streamed = {};
+
+        streamed.width      = width;
+        streamed.height     = height;
+        streamed.mipLevels  = rTexture.GetMipLevels();
+        streamed.arraySize  = arraySize;
+        streamed.firstMip   = GetFirstMip(rTexture);
+
+        cCpuTexture::GetBlockLayout(rTexture.GetFormat(), streamed.blockBytes, streamed.blockSize);
+
+        std::vector<sSubresourceFootprint> footprints(static_cast<size_t>(uploadMips) * arraySize);
+
+        const UINT64 textureBytes = cTextureFootprint::ComputeStaging(max(width >> firstMip, 1u), max(height >> firstMip, 1u),
+            uploadMips, arraySize, streamed.blockBytes, streamed.blockSize, footprints.data());
+
+        byteSize += (textureBytes + c_TexturePlacementAlignment - 1) / c_TexturePlacementAlignment * c_TexturePlacementAlignment;
+
+        // the finest streamed level is the largest, the resolution cap keeps the ones above it out
+        if (firstMip > streamed.firstMip)
+        {
+            largestLevelBytes = max(largestLevelBytes,
+                cTextureStreamer::GetMipByteSize(streamed, streamed.firstMip) + c_TexturePlacementAlignment);
+        }
+    }
+
+    return max(byteSize, largestLevelBytes);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTextureManager::RetireStreaming(UINT64 _completedFenceValue)
+{
+    while (!m_pendingStreams.empty() &&
+           m_pendingStreams.front().fenceValue != 0 &&
+           m_pendingStreams.front().fenceValue <= _completedFenceValue)
+    {
+        sPendingStream&     rStream     = m_pendingStreams.front();
+        sTextureBinding&    rBinding    = m_bindings[rStream.texture];
+
+        // the copies into the new resource are done. The descriptor keeps the bound resource alive,
+        // one that replaced it since was never bound and only waits for the frames copying out of it
+        if (rStream.pResource)
+        {
+            if (rBinding.pResource != rBinding.pBoundResource)
+            {
+                m_releasedResources.push_back({ 0, std::move(rBinding.pResource) });
+            }
+
+            rBinding.pResource  = std::move(rStream.pResource);
+            rBinding.firstMip   = rStream.firstMip;
+        }
+
+        if (rStream.isUpload)
+        {
+            m_streamer.MarkResident(rStream.upload);
+        }
+
+        if (!rBinding.needsRebind)
+        {
+            rBinding.needsRebind = true;
+            m_rebindTextures.push_back(rStream.texture);
+        }
+
+        m_pendingStreams.pop_front();
+    }
+
+    m_registry.Retire(_completedFenceValue);
+
+    while (!m_releasedResources.empty() &&
+           m_releasedResources.front().fenceValue != 0 &&
+           m_releasedResources.front().fenceValue <= _completedFenceValue)
+    {
+        m_releasedResources.pop_front();
+    }
+
+    while (!m_retiredTextureRefTables.empty() &&
+           m_retiredTextureRefTables.front().fenceValue != 0 &&
+           m_retiredTextureRefTables.front().fenceValue <= _completedFenceValue)
+    {
+        m_freeTextureRefTables.push_back(std::move(m_retiredTextureRefTables.front().pResource));
+        m_retiredTextureRefTables.pop_front();
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTextureManager::StreamTextures(ID3D12GraphicsCommandList* _pCmdList, cStagingRing& _rStagingRing, UINT64 _budgetBytes)
+{
+    assert(_pCmdList);
+
+    RebindTextures(_pCmdList, _rStagingRing);
+
+    if (m_streamSources.empty())
+        return;
+
+    m_streamer.Schedule(_budgetBytes, _rStagingRing.GetCapacity(), m_scheduledUploads, m_scheduledEvictions);
+
+    // evicted levels leave with the resource they live in, the texture moves into a smaller one
+    for (const sStreamingEviction& rEviction : m_scheduledEvictions)
+    {
+        MoveTexture(rEviction.texture, rEviction.mip, _pCmdList);
+    }
+
+    for (size_t i = 0; i < m_scheduledUploads.size(); ++i)
+    {
+        const sStreamingUpload& rUpload = m_scheduledUploads[i];
+
+        cGpuTexture& rTexture = m_textures[rUpload.texture];
+
+        // the first upload of a texture this frame grows it by every level it gets
+        if (rUpload.mip < rTexture.GetFirstMip())
+        {
+            UINT finestMip = rUpload.mip;
+
+            for (size_t j = i + 1; j < m_scheduledUploads.size(); ++j)
+            {
+                if (m_scheduledUploads[j].texture == rUpload.texture)
+                    finestMip = min(finestMip, m_scheduledUploads[j].mip);
+            }
+
+            MoveTexture(rUpload.texture, finestMip, _pCmdList);
+        }
+
+        ID3D12Resource* pTexture = rTexture.GetResource();
+
+        // earlier frames on this queue finish sampling before the copy starts
+        auto toCopy = CD3DX12_RESOURCE_BARRIER::Transition(
+            pTexture,
+            D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
+            D3D12_RESOURCE_STATE_COPY_DEST
+        );
+
+        _pCmdList->ResourceBarrier(1, &toCopy);
+
+        const bool recorded = rTexture.UploadMips(
+            m_streamSources[rUpload.texture],
+            _pCmdList,
+            _rStagingRing,
+            rUpload.mip,
+            1
+        );
+
+        auto toShader = CD3DX12_RESOURCE_BARRIER::Transition(
+            pTexture,
+            D3D12_RESOURCE_STATE_COPY_DEST,
+            D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE
+        );
+
+        _pCmdList->ResourceBarrier(1, &toShader);
+
+        // the ring is full until older frames retire, the rest goes back finest level first. A texture
+        // that already moved keeps the room for the levels, its descriptor clamps them away
+        if (!recorded)
+        {
+            for (size_t j = m_scheduledUploads.size(); j-- > i;)
+            {
+                m_streamer.Cancel(m_scheduledUploads[j]);
+            }
+
+            break;
+        }
+
+        m_pendingStreams.push_back({ 0, rUpload.texture, true, rUpload, nullptr, 0 });
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTextureManager::CloseStreaming(UINT64 _fenceValue)
+{
+    m_lastFenceValue = _fenceValue;
+
+    for (auto it = m_pendingStreams.rbegin(); it != m_pendingStreams.rend() && it->fenceValue == 0; ++it)
+    {
+        it->fenceValue = _fenceValue;
+    }
+
+    for (auto it = m_releasedResources.rbegin(); it != m_releasedResources.rend() && it->fenceValue == 0; ++it)
+    {
+        it->fenceValue = _fenceValue;
+    }
+
+    for (auto it = m_retiredTextureRefTables.rbegin(); it != m_retiredTextureRefTables.rend() && it->fenceValue == 0; ++it)
+    {
+        it->fenceValue = _fenceValue;
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTextureManager::MoveTexture(uint32_t _texture, UINT _firstMip, ID3D12GraphicsCommandList* _pCmdList)
+{
+    cGpuTexture& rTexture = m_textures[_texture];
+
+    // the old resource is the bound one or one whose move is still pending, both entries keep it
+    // alive until it is unbound, this one until the copies out of it are done
+    m_releasedResources.push_back({ 0, rTexture.Reallocate(m_pDevice, _pCmdList, _firstMip) });
+
+    auto toShader = CD3DX12_RESOURCE_BARRIER::Transition(
+        rTexture.GetResource(),
+        D3D12_RESOURCE_STATE_COPY_DEST,
+        D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE
+    );
+
+    _pCmdList->ResourceBarrier(1, &toShader);
+
+    m_pendingStreams.push_back({ 0, _texture, false, {}, rTexture.GetResource(), _firstMip });
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTextureManager::RebindTextures(ID3D12GraphicsCommandList* _pCmdList, cStagingRing& _rStagingRing)
 {
-    for (cGpuTexture& texture : m_textures)
+    if (m_rebindTextures.empty())
+        return;
+
+    sStagingAllocation staging = {};
+
+    // the ring is full until older frames retire, the textures keep their descriptors until then
+    if (!_rStagingRing.Allocate(GetTextureRefsByteSize(), c_TexturePlacementAlignment, staging))
+        return;
+
+    size_t waiting = 0;
+
+    for (uint32_t texture : m_rebindTextures)
+    {
+        const uint32_t slot = m_registry.Allocate();
+
+        // every slot is taken or still read by frames in flight, the texture tries again next frame
+        if (slot == cTextureRegistry::c_InvalidSlot)
+        {
+            m_rebindTextures[waiting++] = texture;
+            continue;
+        }
+
+        sTextureBinding& rBinding = m_bindings[texture];
+
+        const UINT residentMip = max(static_cast<UINT>(m_streamer.GetResidentMip(texture)), rBinding.firstMip);
+
+        CreateSRV(m_pDevice, m_pHeap, rBinding.pResource.Get(), m_descriptorSize, m_srvBaseOffset + slot,
+            static_cast<float>(residentMip - rBinding.firstMip));
+
+        // the frames recorded so far read the old slot and the resource it points at
+        m_registry.Free(m_slots[texture], m_lastFenceValue);
+        m_releasedResources.push_back({ 0, std::move(rBinding.pBoundResource) });
+
+        m_slots[texture]        = slot;
+        rBinding.pBoundResource = rBinding.pResource;
+        rBinding.needsRebind    = false;
+    }
+
+    const bool slotsChanged = waiting < m_rebindTextures.size();
+
+    m_rebindTextures.resize(waiting);
+
+    if (slotsChanged)
     {
-        texture.ReleaseUploadHeap();
+        RecordTextureRefs(staging, _pCmdList);
     }
 }
 
 // --------------------------------------------------------------------------------------------------------------------------
 
+// BCn resources need their top level in whole blocks
+static bool IsBlockAligned(cCpuTexture& _rCpuTexture, UINT _mip)
+{
+    uint32_t blockBytes = 0;
+    uint32_t blockSize  = 0;
+
+    cCpuTexture::GetBlockLayout(_rCpuTexture.GetFormat(), blockBytes, blockSize);
+
+    const UINT width    = max(static_cast<UINT>(_rCpuTexture.GetWidth()) >> _mip, 1u);
+    const UINT height   = max(static_cast<UINT>(_rCpuTexture.GetHeight()) >> _mip, 1u);
+
+    return width % blockSize == 0 && height % blockSize == 0;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+UINT cTextureManager::GetFirstMip(cCpuTexture& _rCpuTexture)
+{
+    UINT mip = cTextureStreamer::GetTailMip(static_cast<uint32_t>(_rCpuTexture.GetWidth()), static_cast<uint32_t>(_rCpuTexture.GetHeight()),
+        _rCpuTexture.GetMipLevels(), GFX_TEXTURE_MAX_RESOLUTION);
+
+    // level 0 is always aligned, the block compressor only takes whole blocks
+    while (mip > 0 && !IsBlockAligned(_rCpuTexture, mip))
+    {
+        --mip;
+    }
+
+    return mip;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+UINT cTextureManager::GetInitialMip(cCpuTexture& _rCpuTexture)
+{
+    UINT mip = GetFirstMip(_rCpuTexture);
+
+#if GFX_TEXTURE_STREAMING
+    const UINT tailMip = cTextureStreamer::GetTailMip(static_cast<uint32_t>(_rCpuTexture.GetWidth()),
+        static_cast<uint32_t>(_rCpuTexture.GetHeight()), _rCpuTexture.GetMipLevels(), GFX_STREAMING_TAIL_SIZE);
+
+    // every level between the cap and the tail can become the top of the resource
+    while (mip < tailMip && IsBlockAligned(_rCpuTexture, mip + 1))
+    {
+        ++mip;
+    }
+#endif
+
+    return mip;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+UINT64 cTextureManager::GetTextureRefsByteSize() const
+{
+    return static_cast<UINT64>(max(m_textureRefs.size(), static_cast<size_t>(1))) * sizeof(sTextureRef);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTextureManager::RecordTextureRefs(const sStagingAllocation& _rStaging, ID3D12GraphicsCommandList* _pCmdList)
+{
+    const sTextureRef noTexture = { cTextureRegistry::c_InvalidSlot, 0, { 0.0f, 0.0f }, { 0.0f, 0.0f, 1.0f, 1.0f } };
+
+    const UINT64 byteSize = GetTextureRefsByteSize();
+
+    sTextureRef* pRefs = reinterpret_cast<sTextureRef*>(_rStaging.pData);
+
+    if (m_textureRefs.empty())
+    {
+        pRefs[0] = noTexture;
+    }
+
+    // the shaders index the bindless table, texture indices become slots
+    for (size_t i = 0; i < m_textureRefs.size(); ++i)
+    {
+        const uint32_t texture = m_textureRefs[i].descriptorIndex;
+
+        pRefs[i]                    = m_textureRefs[i];
+        pRefs[i].descriptorIndex    = texture < m_slots.size() ? m_slots[texture] : cTextureRegistry::c_InvalidSlot;
+    }
+
+    // a table the frames in flight are done with, or a new one
+    Microsoft::WRL::ComPtr<ID3D12Resource> pTable;
+
+    if (!m_freeTextureRefTables.empty())
+    {
+        pTable = std::move(m_freeTextureRefTables.back());
+        m_freeTextureRefTables.pop_back();
+
+        auto toCopy = CD3DX12_RESOURCE_BARRIER::Transition(
+            pTable.Get(),
+            D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
+            D3D12_RESOURCE_STATE_COPY_DEST
+        );
+
+        _pCmdList->ResourceBarrier(1, &toCopy);
+    }
+    else
+    {
+        CD3DX12_HEAP_PROPERTIES defaultHeap(D3D12_HEAP_TYPE_DEFAULT);
+        auto bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(byteSize);
+
+        cDirectX12Util::ThrowIfFailed(m_pDevice->CreateCommittedResource(
+            &defaultHeap,
+            D3D12_HEAP_FLAG_NONE,
+            &bufferDesc,
+            D3D12_RESOURCE_STATE_COPY_DEST,
+            nullptr,
+            IID_PPV_ARGS(&pTable)
+        ));
+    }
+
+    _pCmdList->CopyBufferRegion(pTable.Get(), 0, _rStaging.pResource, _rStaging.offset, byteSize);
+
+    auto toShader = CD3DX12_RESOURCE_BARRIER::Transition(
+        pTable.Get(),
+        D3D12_RESOURCE_STATE_COPY_DEST,
+        D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE
+    );
+
+    _pCmdList->ResourceBarrier(1, &toShader);
+
+    if (m_pTextureRefs)
+    {
+        m_retiredTextureRefTables.push_back({ 0, std::move(m_pTextureRefs) });
+    }
+
+    m_pTextureRefs = std::move(pTable);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
 D3D12_CPU_DESCRIPTOR_HANDLE cTextureManager::GetCpuHandle(ID3D12DescriptorHeap* _pHeap, UINT _descriptorSize, UINT _heapIndex) const
 {
     D3D12_CPU_DESCRIPTOR_HANDLE handle = _pHeap->GetCPUDescriptorHandleForHeapStart();
@@ -110,7 +627,7 @@ D3D12_GPU_DESCRIPTOR_HANDLE cTextureManager::GetGpuHandle(ID3D12DescriptorHeap*
 // --------------------------------------------------------------------------------------------------------------------------
 
 D3D12_GPU_DESCRIPTOR_HANDLE cTextureManager::CreateSRV(ID3D12Device* _pDevice, ID3D12DescriptorHeap* _pHeap, 
-    ID3D12Resource* _pTexture, UINT _descriptorSize, UINT _heapIndex) const
+    ID3D12Resource* _pTexture, UINT _descriptorSize, UINT _heapIndex, float _minLod) const
 {
     const D3D12_RESOURCE_DESC texDesc = _pTexture->GetDesc();
 
@@ -121,11 +638,14 @@ D3D12_GPU_DESCRIPTOR_HANDLE cTextureManager::CreateSRV(ID3D12Device* _pDevice, I
 
     srvDesc.Shader4ComponentMapping       = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
     srvDesc.Format                        = texDesc.Format;
-    srvDesc.ViewDimension                 = D3D12_SRV_DIMENSION_TEXTURE2D;
-    srvDesc.Texture2D.MostDetailedMip     = 0;
-    srvDesc.Texture2D.MipLevels           = texDesc.MipLevels;
-    srvDesc.Texture2D.PlaneSlice          = 0;
-    srvDesc.Texture2D.ResourceMinLODClamp = 0.0f;
+    // every texture is viewed as an array, single textures have one slice
+    srvDesc.ViewDimension                           = D3D12_SRV_DIMENSION_TEXTURE2DARRAY;
+    srvDesc.Texture2DArray.MostDetailedMip          = 0;
+    srvDesc.Texture2DArray.MipLevels                = texDesc.MipLevels;
+    srvDesc.Texture2DArray.FirstArraySlice          = 0;
+    srvDesc.Texture2DArray.ArraySize                = texDesc.DepthOrArraySize;
+    srvDesc.Texture2DArray.PlaneSlice               = 0;
+    srvDesc.Texture2DArray.ResourceMinLODClamp      = _minLod;
 
     _pDevice->CreateShaderResourceView(_pTexture, &srvDesc, srvCpuHandle);
 
@@ -135,16 +655,16 @@ D3D12_GPU_DESCRIPTOR_HANDLE cTextureManager::CreateSRV(ID3D12Device* _pDevice, I
 // --------------------------------------------------------------------------------------------------------------------------
 
 std::vector<D3D12_GPU_DESCRIPTOR_HANDLE> cTextureManager::CreateMipUAVs(ID3D12Device* _pDevice, ID3D12DescriptorHeap* _pHeap, ID3D12Resource* _pTexture,
-    UINT _descriptorSize, UINT _textureIndex, UINT _mipUavBaseOffset, UINT _maxMipLevelsPerTexture) const
+    UINT _descriptorSize, UINT _heapIndex, UINT _availableDescriptors) const
 {
     const D3D12_RESOURCE_DESC texDesc = _pTexture->GetDesc();
 
     const UINT mipLevels = texDesc.MipLevels;
 
-    if (mipLevels > _maxMipLevelsPerTexture)
+    if (mipLevels - 1 > _availableDescriptors)
     {
         throw std::runtime_error(
-            "Texture has more mip levels than the reserved UAV descriptor block."
+            "Mip generation of the upload batch needs more UAVs than GFX_MIP_GEN_UAV_CAPACITY."
         );
     }
 
@@ -154,7 +674,7 @@ std::vector<D3D12_GPU_DESCRIPTOR_HANDLE> cTextureManager::CreateMipUAVs(ID3D12De
     // mip 0 already exists
     for (UINT mip = 1; mip < mipLevels; ++mip)
     {
-        const UINT uavHeapIndex = _mipUavBaseOffset + _textureIndex * _maxMipLevelsPerTexture + mip;
+        const UINT uavHeapIndex = _heapIndex + mip - 1;
 
         D3D12_CPU_DESCRIPTOR_HANDLE uavCpuHandle = GetCpuHandle(_pHeap, _descriptorSize, uavHeapIndex);
         D3D12_GPU_DESCRIPTOR_HANDLE uavGpuHandle = GetGpuHandle(_pHeap, _descriptorSize, uavHeapIndex);
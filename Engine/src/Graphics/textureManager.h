@@ -1,12 +1,18 @@
 #pragma once
 
+#include <deque>
 #include <vector>
 #include <d3d12.h>
+#include <wrl.h>
 
 #include "gpuTexture.h"
+#include "textureRef.h"
+#include "textureRegistry.h"
+#include "textureStreamer.h"
 
 class cCpuTexture;
 class cCommandContext;
+class cStagingRing;
 
 class cTextureManager
 {
@@ -17,23 +23,63 @@ class cTextureManager
 
     public:
 
+        // _rTextureRefs is the table materials index, descriptorIndex of every entry counts from the first texture
+        // and is translated to the texture's slot in the bindless table at _textureSrvBaseOffset. Slots of the
+        // textures uploaded before are freed once the frames using them completed. GPU mip generation takes
+        // its UAVs from the transient area at _mipUavBaseOffset.
+        // Levels above GFX_TEXTURE_MAX_RESOLUTION are never uploaded. With GFX_TEXTURE_STREAMING only the mip
+        // tails are uploaded, the manager takes the textures over (they must stay valid) and StreamTextures
+        // brings in the finer levels later, within GFX_TEXTURE_MEMORY_BUDGET
         int UploadCpuTextures(
-            std::vector<cCpuTexture>&   _rCpuTextures,
-            ID3D12Device*               _pDevice,
-            ID3D12DescriptorHeap*       _pHeap,
-            cCommandContext*            _pCommandContext,
-            ID3D12PipelineState*        _pMipGenPipelineState,
-            ID3D12RootSignature*        _pMipGenRootSignature,
-            UINT                        _textureSrvBaseOffset
+            std::vector<cCpuTexture>&       _rCpuTextures,
+            const std::vector<sTextureRef>& _rTextureRefs,
+            ID3D12Device*                   _pDevice,
+            ID3D12DescriptorHeap*           _pHeap,
+            cCommandContext*                _pCommandContext,
+            cStagingRing*                   _pStagingRing,
+            ID3D12PipelineState*            _pMipGenPipelineState,
+            ID3D12RootSignature*            _pMipGenRootSignature,
+            UINT                            _textureSrvBaseOffset,
+            UINT                            _mipUavBaseOffset
         );
 
-        void ReleaseUploadHeaps();
+        // staging bytes UploadCpuTextures takes from the ring, known before anything is recorded. Never
+        // less than the largest level streamed later, so a ring reserved for it can take any of them
+        static UINT64 GetStagingByteSize(std::vector<cCpuTexture>& _rCpuTextures, const std::vector<sTextureRef>& _rTextureRefs);
+
+        // ---------------------------------------------------------
+        // streaming, once per frame on the frame's command list
+        // ---------------------------------------------------------
+
+        // levels whose copies completed become resident and textures move to the resources they were
+        // reallocated into, the next StreamTextures shows them to the shaders
+        void RetireStreaming(UINT64 _completedFenceValue);
+
+        // first gives the textures whose levels changed a descriptor in a fresh slot and a reference table
+        // pointing at it, frames in flight keep reading the old ones. Then records the evictions and uploads
+        // the streamer schedules for this frame. Every texture resource only holds its resident levels, so
+        // both reallocate it
+        void StreamTextures(ID3D12GraphicsCommandList* _pCmdList, cStagingRing& _rStagingRing, UINT64 _budgetBytes);
+
+        // the work recorded since the last call completes with _fenceValue
+        void CloseStreaming(UINT64 _fenceValue);
+
+        cTextureStreamer& GetStreamer() noexcept
+        {
+            return m_streamer;
+        }
 
         const std::vector<cGpuTexture>& GetTextures() const noexcept
         {
             return m_textures;
         }
 
+        // StructuredBuffer<sTextureRef>, bound as a root SRV
+        D3D12_GPU_VIRTUAL_ADDRESS GetTextureRefsAddress() const noexcept
+        {
+            return m_pTextureRefs ? m_pTextureRefs->GetGPUVirtualAddress() : 0;
+        }
+
     private:
 
         D3D12_CPU_DESCRIPTOR_HANDLE GetCpuHandle(
@@ -48,22 +94,24 @@ class cTextureManager
             UINT                    _heapIndex
         ) const;
 
+        // _minLod hides the levels that are not resident yet, it counts levels of _pTexture
         D3D12_GPU_DESCRIPTOR_HANDLE CreateSRV(
             ID3D12Device*           _pDevice,
             ID3D12DescriptorHeap*   _pHeap,
             ID3D12Resource*         _pTexture,
             UINT                    _descriptorSize,
-            UINT                    _heapIndex
+            UINT                    _heapIndex,
+            float                   _minLod = 0.0f
         ) const;
 
+        // one UAV per generated level from _heapIndex on, at most _availableDescriptors
         std::vector<D3D12_GPU_DESCRIPTOR_HANDLE> CreateMipUAVs(
             ID3D12Device*           _pDevice,
             ID3D12DescriptorHeap*   _pHeap,
             ID3D12Resource*         _pTexture,
             UINT                    _descriptorSize,
-            UINT                    _textureIndex,
-            UINT                    _mipUavBaseOffset,
-            UINT                    _maxMipLevelsPerTexture
+            UINT                    _heapIndex,
+            UINT                    _availableDescriptors
         ) const;
 
         void GenerateMipmaps(
@@ -75,7 +123,76 @@ class cTextureManager
             ID3D12RootSignature*                            _pMipGenRootSignature
         ) const;
 
+        // at least one entry, a scene without textures still binds a valid buffer
+        UINT64 GetTextureRefsByteSize() const;
+
+        // writes the reference table with the current slots to _rStaging and copies it into a table no frame
+        // in flight reads, the shaders see it from this frame on
+        void RecordTextureRefs(const sStagingAllocation& _rStaging, ID3D12GraphicsCommandList* _pCmdList);
+
+        // finest level that is ever uploaded, GFX_TEXTURE_MAX_RESOLUTION cuts the chain above it
+        static UINT GetFirstMip(cCpuTexture& _rCpuTexture);
+
+        // first level uploaded with the texture, the mip tail when it streams
+        static UINT GetInitialMip(cCpuTexture& _rCpuTexture);
+
+        // moves the texture into a resource starting at _firstMip, the move shows once this frame completes
+        void MoveTexture(uint32_t _texture, UINT _firstMip, ID3D12GraphicsCommandList* _pCmdList);
+
+        // descriptors are never rewritten while a frame may read them. Every texture whose bound levels
+        // changed gets its descriptor written to a fresh slot, clamped to the resident levels, the table
+        // is repointed and the old slot goes back once the frames recorded so far completed
+        void RebindTextures(ID3D12GraphicsCommandList* _pCmdList, cStagingRing& _rStagingRing);
+
     private:
 
-        std::vector<cGpuTexture> m_textures;
+        // the resource the texture lives in, its level 0 is source level firstMip
+        struct sTextureBinding
+        {
+            Microsoft::WRL::ComPtr<ID3D12Resource>  pResource;
+            UINT                                    firstMip;
+            Microsoft::WRL::ComPtr<ID3D12Resource>  pBoundResource;     // the one the texture's descriptor points at
+            bool                                    needsRebind;        // listed in m_rebindTextures
+        };
+
+        // recorded streaming work, applied once its frame completed
+        struct sPendingStream
+        {
+            UINT64                                  fenceValue;     // 0 until CloseStreaming
+            uint32_t                                texture;
+            bool                                    isUpload;
+            sStreamingUpload                        upload;
+            Microsoft::WRL::ComPtr<ID3D12Resource>  pResource;      // set when the texture moved into it
+            UINT                                    firstMip;
+        };
+
+        struct sReleasedResource
+        {
+            UINT64                                  fenceValue;     // 0 until CloseStreaming
+            Microsoft::WRL::ComPtr<ID3D12Resource>  pResource;
+        };
+
+        std::vector<cGpuTexture>                m_textures;
+        std::vector<sTextureRef>                m_textureRefs;      // descriptorIndex counts textures, the tables hold slots
+        Microsoft::WRL::ComPtr<ID3D12Resource>  m_pTextureRefs;     // bound from the frame that recorded it on
+        std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> m_freeTextureRefTables;
+        std::deque<sReleasedResource>           m_retiredTextureRefTables;  // frames in flight may still read them
+
+        cTextureRegistry                        m_registry;
+        std::vector<uint32_t>                   m_slots;            // bindless table slot of every texture
+        UINT64                                  m_lastFenceValue    = 0;
+
+        cTextureStreamer                        m_streamer;
+        std::vector<cCpuTexture>                m_streamSources;    // the levels still to come are read from here
+        std::vector<sStreamingUpload>           m_scheduledUploads;
+        std::vector<sStreamingEviction>         m_scheduledEvictions;
+        std::vector<sTextureBinding>            m_bindings;
+        std::vector<uint32_t>                   m_rebindTextures;   // descriptors still to move, see RebindTextures
+        std::deque<sPendingStream>              m_pendingStreams;
+        std::deque<sReleasedResource>           m_releasedResources;    // frames in flight may still sample them
+
+        ID3D12Device*                           m_pDevice           = nullptr;
+        ID3D12DescriptorHeap*                   m_pHeap             = nullptr;
+        UINT                                    m_descriptorSize    = 0;
+        UINT                                    m_srvBaseOffset     = 0;
 };
\ No newline at end of file
@@ -0,0 +1,432 @@
+#include "texturePacker.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <tuple>
+
+#include "textureFootprint.h"
+
+constexpr uint32_t c_MinArraySlices         = 2;
+constexpr uint32_t c_MaxArraySlices         = 256;      // well below D3D12_REQ_TEXTURE2D_ARRAY_AXIS_DIMENSION
+constexpr uint32_t c_AtlasMaxTextureSize    = 256;      // larger textures keep a descriptor of their own
+constexpr uint32_t c_AtlasMaxSize           = 2048;
+constexpr uint32_t c_AtlasMaxGutter         = 16;       // texels at mip 0, also the placement grid
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+static uint32_t AlignUp(uint32_t _value, uint32_t _alignment)
+{
+    return (_value + _alignment - 1) / _alignment * _alignment;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+static uint32_t PositiveModulo(int64_t _value, uint32_t _modulus)
+{
+    const int64_t remainder = _value % static_cast<int64_t>(_modulus);
+
+    return static_cast<uint32_t>(remainder < 0 ? remainder + _modulus : remainder);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// mips an atlas keeps for a texture. The grid (and gutter) of an atlas is blockSize << (levels - 1)
+// so every entry starts on a whole block in every level, the last level still needs one block and
+// the size has to halve exactly, otherwise the mip 0 UV rect would drift off the smaller levels.
+static uint32_t GetAtlasMipLevels(const sTexturePackInput& _rInput)
+{
+    const uint32_t minSize  = (std::min)(_rInput.width, _rInput.height);
+    uint32_t levels         = 1;
+
+    while (levels < _rInput.mipLevels &&
+           (_rInput.blockSize << levels) <= c_AtlasMaxGutter &&
+           (_rInput.blockSize << levels) <= minSize &&
+           (_rInput.width & ((1u << levels) - 1)) == 0 &&
+           (_rInput.height & ((1u << levels) - 1)) == 0)
+    {
+        ++levels;
+    }
+
+    return levels;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTexturePacker::Plan(const sTexturePackInput* _pInputs, size_t _count, sTexturePackPlan& _rOutPlan)
+{
+    _rOutPlan.pages.clear();
+    _rOutPlan.placements.assign(_count, sTexturePlacement{});
+
+    std::vector<bool> placed(_count, false);
+
+    for (size_t i = 0; i < _count; ++i)
+    {
+        _rOutPlan.placements[i].width   = _pInputs[i].width;
+        _rOutPlan.placements[i].height  = _pInputs[i].height;
+    }
+
+    // ----------------------------------------------------------------------------------------------------------------------
+    // textures of identical shape become slices of one array
+    // ----------------------------------------------------------------------------------------------------------------------
+
+    std::map<std::tuple<uint32_t, uint32_t, uint32_t, uint32_t>, std::vector<uint32_t>> shapes;
+
+    for (size_t i = 0; i < _count; ++i)
+    {
+        const sTexturePackInput& rInput = _pInputs[i];
+
+        shapes[{ rInput.format, rInput.width, rInput.height, rInput.mipLevels }].push_back(static_cast<uint32_t>(i));
+    }
+
+    for (const auto& rShape : shapes)
+    {
+        const std::vector<uint32_t>& rMembers = rShape.second;
+
+        for (size_t first = 0; first < rMembers.size(); first += c_MaxArraySlices)
+        {
+            const size_t last = (std::min)(first + c_MaxArraySlices, rMembers.size());
+
+            // a lone leftover is better off in an atlas or on its own
+            if (last - first < c_MinArraySlices)
+                break;
+
+            const sTexturePackInput& rInput = _pInputs[rMembers[first]];
+            const uint32_t pageIndex        = static_cast<uint32_t>(_rOutPlan.pages.size());
+
+            sTexturePage page   = {};
+            page.kind           = TEXTURE_PAGE_ARRAY;
+            page.width          = rInput.width;
+            page.height         = rInput.height;
+            page.mipLevels      = rInput.mipLevels;
+            page.arraySize      = static_cast<uint32_t>(last - first);
+            page.format         = rInput.format;
+            page.blockBytes     = rInput.blockBytes;
+            page.blockSize      = rInput.blockSize;
+            page.gutter         = 0;
+
+            for (size_t member = first; member < last; ++member)
+            {
+                const uint32_t textureIndex = rMembers[member];
+
+                page.members.push_back(textureIndex);
+
+                _rOutPlan.placements[textureIndex].page     = pageIndex;
+                _rOutPlan.placements[textureIndex].slice    = static_cast<uint32_t>(member - first);
+                placed[textureIndex]                        = true;
+            }
+
+            _rOutPlan.pages.push_back(std::move(page));
+        }
+    }
+
+    // ----------------------------------------------------------------------------------------------------------------------
+    // small leftovers of the same format and atlas mip count share atlases
+    // ----------------------------------------------------------------------------------------------------------------------
+
+    std::map<std::tuple<uint32_t, uint32_t, uint32_t, uint32_t>, std::vector<uint32_t>> atlasGroups;
+
+    for (size_t i = 0; i < _count; ++i)
+    {
+        const sTexturePackInput& rInput = _pInputs[i];
+
+        if (placed[i] || (std::max)(rInput.width, rInput.height) > c_AtlasMaxTextureSize)
+            continue;
+
+        atlasGroups[{ rInput.format, rInput.blockBytes, rInput.blockSize, GetAtlasMipLevels(rInput) }].push_back(static_cast<uint32_t>(i));
+    }
+
+    for (auto& rGroup : atlasGroups)
+    {
+        std::vector<uint32_t>& rMembers = rGroup.second;
+
+        if (rMembers.size() < 2)
+            continue;
+
+        const uint32_t blockBytes   = std::get<1>(rGroup.first);
+        const uint32_t blockSize    = std::get<2>(rGroup.first);
+        const uint32_t mipLevels    = std::get<3>(rGroup.first);
+        const uint32_t grid         = blockSize << (mipLevels - 1);
+
+        std::stable_sort(rMembers.begin(), rMembers.end(), [&](uint32_t _a, uint32_t _b)
+        {
+            return _pInputs[_a].height > _pInputs[_b].height;
+        });
+
+        size_t first = 0;
+
+        while (first < rMembers.size())
+        {
+            const size_t remaining = rMembers.size() - first;
+
+            std::vector<uint32_t> widths(remaining), heights(remaining), x(remaining), y(remaining);
+
+            for (size_t i = 0; i < remaining; ++i)
+            {
+                const sTexturePackInput& rInput = _pInputs[rMembers[first + i]];
+
+                widths[i]   = AlignUp(rInput.width, grid) + 2 * grid;
+                heights[i]  = AlignUp(rInput.height, grid) + 2 * grid;
+            }
+
+            uint32_t usedWidth  = 0;
+            uint32_t usedHeight = 0;
+
+            const size_t packed = PackShelves(widths.data(), heights.data(), remaining, c_AtlasMaxSize, c_AtlasMaxSize,
+                x.data(), y.data(), usedWidth, usedHeight);
+
+            // the rest stays single
+            if (packed < 2)
+                break;
+
+            const uint32_t pageIndex = static_cast<uint32_t>(_rOutPlan.pages.size());
+
+            sTexturePage page   = {};
+            page.kind           = TEXTURE_PAGE_ATLAS;
+            page.width          = usedWidth;
+            page.height         = usedHeight;
+            page.mipLevels      = mipLevels;
+            page.arraySize      = 1;
+            page.format         = std::get<0>(rGroup.first);
+            page.blockBytes     = blockBytes;
+            page.blockSize      = blockSize;
+            page.gutter         = grid;
+
+            for (size_t i = 0; i < packed; ++i)
+            {
+                const uint32_t textureIndex = rMembers[first + i];
+
+                page.members.push_back(textureIndex);
+
+                sTexturePlacement& rPlacement = _rOutPlan.placements[textureIndex];
+                rPlacement.page     = pageIndex;
+                rPlacement.slice    = 0;
+                rPlacement.x        = x[i] + grid;
+                rPlacement.y        = y[i] + grid;
+                placed[textureIndex] = true;
+            }
+
+            _rOutPlan.pages.push_back(std::move(page));
+
+            first += packed;
+        }
+    }
+
+    // ----------------------------------------------------------------------------------------------------------------------
+    // everything else keeps its own descriptor
+    // ----------------------------------------------------------------------------------------------------------------------
+
+    for (size_t i = 0; i < _count; ++i)
+    {
+        if (placed[i])
+            continue;
+
+        const sTexturePackInput& rInput = _pInputs[i];
+        const uint32_t pageIndex        = static_cast<uint32_t>(_rOutPlan.pages.size());
+
+        sTexturePage page   = {};
+        page.kind           = TEXTURE_PAGE_SINGLE;
+        page.width          = rInput.width;
+        page.height         = rInput.height;
+        page.mipLevels      = rInput.mipLevels;
+        page.arraySize      = 1;
+        page.format         = rInput.format;
+        page.blockBytes     = rInput.blockBytes;
+        page.blockSize      = rInput.blockSize;
+        page.gutter         = 0;
+        page.members.push_back(static_cast<uint32_t>(i));
+
+        _rOutPlan.placements[i].page = pageIndex;
+        _rOutPlan.pages.push_back(std::move(page));
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+sTextureRef cTexturePacker::GetReference(const sTexturePackPlan& _rPlan, uint32_t _textureIndex)
+{
+    const sTexturePlacement& rPlacement = _rPlan.placements[_textureIndex];
+    const sTexturePage& rPage           = _rPlan.pages[rPlacement.page];
+
+    sTextureRef reference       = {};
+    reference.descriptorIndex   = rPlacement.page;
+    reference.slice             = rPlacement.slice;
+    reference.uvRect[0]         = 0.0f;
+    reference.uvRect[1]         = 0.0f;
+    reference.uvRect[2]         = 1.0f;
+    reference.uvRect[3]         = 1.0f;
+
+    if (rPage.kind == TEXTURE_PAGE_ATLAS)
+    {
+        const float invWidth    = 1.0f / static_cast<float>(rPage.width);
+        const float invHeight   = 1.0f / static_cast<float>(rPage.height);
+
+        reference.uvRect[0] = static_cast<float>(rPlacement.x) * invWidth;
+        reference.uvRect[1] = static_cast<float>(rPlacement.y) * invHeight;
+        reference.uvRect[2] = static_cast<float>(rPlacement.width) * invWidth;
+        reference.uvRect[3] = static_cast<float>(rPlacement.height) * invHeight;
+    }
+
+    return reference;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+size_t cTexturePacker::GetPageByteSize(const sTexturePage& _rPage)
+{
+    std::vector<sSubresourceFootprint> footprints(static_cast<size_t>(_rPage.mipLevels) * _rPage.arraySize);
+
+    return static_cast<size_t>(cTextureFootprint::ComputePacked(_rPage.width, _rPage.height, _rPage.mipLevels, _rPage.arraySize,
+        _rPage.blockBytes, _rPage.blockSize, footprints.data()));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTexturePacker::BuildPage(const sTexturePackPlan& _rPlan, uint32_t _pageIndex, const sTexturePackInput* _pInputs,
+    const uint8_t* const* _ppSources, uint8_t* _pOut)
+{
+    const sTexturePage& rPage = _rPlan.pages[_pageIndex];
+
+    // ----------------------------------------------------------------------------------------------------------------------
+    // single textures and array slices are packed payloads already
+    // ----------------------------------------------------------------------------------------------------------------------
+
+    if (rPage.kind != TEXTURE_PAGE_ATLAS)
+    {
+        sTexturePage slicePage  = rPage;
+        slicePage.arraySize     = 1;
+
+        const size_t sliceBytes = GetPageByteSize(slicePage);
+
+        for (size_t slice = 0; slice < rPage.members.size(); ++slice)
+        {
+            std::memcpy(_pOut + slice * sliceBytes, _ppSources[rPage.members[slice]], sliceBytes);
+        }
+
+        return;
+    }
+
+    // ----------------------------------------------------------------------------------------------------------------------
+    // atlas, every entry plus a gutter that repeats its opposite edge, per mip
+    // ----------------------------------------------------------------------------------------------------------------------
+
+    std::memset(_pOut, 0, GetPageByteSize(rPage));
+
+    std::vector<sSubresourceFootprint> pageFootprints(rPage.mipLevels);
+    cTextureFootprint::ComputePacked(rPage.width, rPage.height, rPage.mipLevels, 1, rPage.blockBytes, rPage.blockSize, pageFootprints.data());
+
+    const uint32_t grid         = rPage.gutter;
+    const uint32_t blockBytes   = rPage.blockBytes;
+    const uint32_t blockSize    = rPage.blockSize;
+
+    std::vector<sSubresourceFootprint> sourceFootprints;
+
+    for (uint32_t textureIndex : rPage.members)
+    {
+        const sTexturePackInput& rInput         = _pInputs[textureIndex];
+        const sTexturePlacement& rPlacement     = _rPlan.placements[textureIndex];
+
+        sourceFootprints.resize(rInput.mipLevels);
+        cTextureFootprint::ComputePacked(rInput.width, rInput.height, rInput.mipLevels, 1, rInput.blockBytes, rInput.blockSize, sourceFootprints.data());
+
+        for (uint32_t mip = 0; mip < rPage.mipLevels; ++mip)
+        {
+            const sSubresourceFootprint& rSource        = sourceFootprints[mip];
+            const sSubresourceFootprint& rDestination   = pageFootprints[mip];
+
+            const uint8_t* pSource  = _ppSources[textureIndex] + rSource.offset;
+            uint8_t* pDestination   = _pOut + rDestination.offset;
+
+            // in blocks (texels for uncompressed formats) of this mip
+            const uint32_t columns  = rSource.rowBytes / blockBytes;
+            const uint32_t rows     = rSource.rowCount;
+            const uint32_t column0  = (rPlacement.x >> mip) / blockSize;
+            const uint32_t row0     = (rPlacement.y >> mip) / blockSize;
+            const uint32_t left     = ((rPlacement.x - grid) >> mip) / blockSize;
+            const uint32_t top      = ((rPlacement.y - grid) >> mip) / blockSize;
+            const uint32_t right    = ((rPlacement.x + AlignUp(rInput.width, grid) + grid) >> mip) / blockSize;
+            const uint32_t bottom   = ((rPlacement.y + AlignUp(rInput.height, grid) + grid) >> mip) / blockSize;
+
+            auto GetBlock = [&](uint32_t _row, uint32_t _column)
+            {
+                return pDestination + static_cast<size_t>(_row) * rDestination.rowPitch + static_cast<size_t>(_column) * blockBytes;
+            };
+
+            // source rows, wrapped sideways across the whole entry
+            for (uint32_t row = 0; row < rows; ++row)
+            {
+                const uint8_t* pSourceRow = pSource + static_cast<size_t>(row) * rSource.rowPitch;
+
+                std::memcpy(GetBlock(row0 + row, column0), pSourceRow, rSource.rowBytes);
+
+                for (uint32_t column = left; column < right; ++column)
+                {
+                    if (column >= column0 && column < column0 + columns)
+                        continue;
+
+                    const uint32_t sourceColumn = PositiveModulo(static_cast<int64_t>(column) - column0, columns);
+
+                    std::memcpy(GetBlock(row0 + row, column), pSourceRow + static_cast<size_t>(sourceColumn) * blockBytes, blockBytes);
+                }
+            }
+
+            // rows above and below repeat the opposite edge, corners included
+            for (uint32_t row = top; row < bottom; ++row)
+            {
+                if (row >= row0 && row < row0 + rows)
+                    continue;
+
+                const uint32_t sourceRow = row0 + PositiveModulo(static_cast<int64_t>(row) - row0, rows);
+
+                std::memcpy(GetBlock(row, left), GetBlock(sourceRow, left), static_cast<size_t>(right - left) * blockBytes);
+            }
+        }
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+size_t cTexturePacker::PackShelves(const uint32_t* _pWidths, const uint32_t* _pHeights, size_t _count, uint32_t _maxWidth, uint32_t _maxHeight,
+    uint32_t* _pOutX, uint32_t* _pOutY, uint32_t& _rOutWidth, uint32_t& _rOutHeight)
+{
+    uint32_t shelfX         = 0;
+    uint32_t shelfY         = 0;
+    uint32_t shelfHeight    = 0;
+    size_t placed           = 0;
+
+    _rOutWidth  = 0;
+    _rOutHeight = 0;
+
+    for (; placed < _count; ++placed)
+    {
+        const uint32_t width    = _pWidths[placed];
+        const uint32_t height   = _pHeights[placed];
+
+        if (width > _maxWidth)
+            break;
+
+        // next shelf
+        if (shelfX + width > _maxWidth)
+        {
+            shelfY      += shelfHeight;
+            shelfX      = 0;
+            shelfHeight = 0;
+        }
+
+        if (shelfY + height > _maxHeight)
+            break;
+
+        _pOutX[placed] = shelfX;
+        _pOutY[placed] = shelfY;
+
+        shelfX      += width;
+        shelfHeight = (std::max)(shelfHeight, height);
+
+        _rOutWidth  = (std::max)(_rOutWidth, shelfX);
+        _rOutHeight = (std::max)(_rOutHeight, shelfY + shelfHeight);
+    }
+
+    return placed;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
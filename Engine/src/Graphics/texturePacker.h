@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "textureRef.h"
+
+struct sTexturePackInput
+{
+	uint32_t	width;
+	uint32_t	height;
+	uint32_t	mipLevels;
+	uint32_t	format;			// only textures of the same format share a page
+	uint32_t	blockBytes;		// bytes per 4x4 block for BCn, per texel otherwise
+	uint32_t	blockSize;		// 4 for BCn, 1 otherwise
+};
+
+enum eTexturePageKind : uint32_t
+{
+	TEXTURE_PAGE_SINGLE = 0,	// one texture as it is
+	TEXTURE_PAGE_ARRAY,			// textures of identical size / format / mips, one slice each
+	TEXTURE_PAGE_ATLAS,			// small textures side by side in one slice
+};
+
+struct sTexturePage
+{
+	eTexturePageKind		kind;
+	uint32_t				width;
+	uint32_t				height;
+	uint32_t				mipLevels;
+	uint32_t				arraySize;
+	uint32_t				format;
+	uint32_t				blockBytes;
+	uint32_t				blockSize;
+	uint32_t				gutter;		// atlas texels around every texture at mip 0
+	std::vector<uint32_t>	members;	// input indices, in slice order for arrays
+};
+
+struct sTexturePlacement
+{
+	uint32_t page;
+	uint32_t slice;
+	uint32_t x;			// top left texel of the texture inside an atlas
+	uint32_t y;
+	uint32_t width;		// of the source texture
+	uint32_t height;
+};
+
+struct sTexturePackPlan
+{
+	std::vector<sTexturePage>		pages;
+	std::vector<sTexturePlacement>	placements;		// one per input
+};
+
+// Groups textures into as few descriptors as possible. Textures of identical shape go
+// into Texture2DArrays, the remaining small ones into atlases. Atlas entries sit on a
+// grid that stays block aligned down to the last mip the atlas keeps, their gutter
+// repeats the opposite edge so wrapped sampling stays seamless. Platform neutral, the
+// pages are plain packed payloads (slices back to back, mips packed per slice).
+class cTexturePacker
+{
+	public:
+
+		static void Plan(const sTexturePackInput* _pInputs, size_t _count, sTexturePackPlan& _rOutPlan);
+
+		static sTextureRef GetReference(const sTexturePackPlan& _rPlan, uint32_t _textureIndex);
+
+		static size_t GetPageByteSize(const sTexturePage& _rPage);
+
+		// _ppSources holds the packed payload of every input, _pOut GetPageByteSize bytes
+		static void BuildPage(const sTexturePackPlan& _rPlan, uint32_t _pageIndex, const sTexturePackInput* _pInputs,
+			const uint8_t* const* _ppSources, uint8_t* _pOut);
+
+		// Shelf packer. Places rects in the given order (sort them by height first) into rows
+		// of at most _maxWidth, returns how many fit under _maxHeight and the extent they use.
+		static size_t PackShelves(const uint32_t* _pWidths, const uint32_t* _pHeights, size_t _count, uint32_t _maxWidth, uint32_t _maxHeight,
+			uint32_t* _pOutX, uint32_t* _pOutY, uint32_t& _rOutWidth, uint32_t& _rOutHeight);
+};
@@ -0,0 +1,305 @@
+#include "texturePayload.h"
+
+#include <algorithm>
+#include <mutex>
+#include <new>
+#include <vector>
+
+constexpr size_t    c_MinBlockSize          = 4096;
+constexpr uint32_t  c_SizeClassesPerOctave  = 4;
+
+// released blocks beyond this are freed right away, the pool must not raise the peak it is meant to lower
+constexpr uint64_t  c_MaxPooledBytes        = 64ull << 20;
+
+constexpr uint32_t  c_ViewSizeClass         = UINT32_MAX;
+constexpr uint32_t  c_AdoptedSizeClass      = UINT32_MAX - 1;
+
+static std::mutex                           s_arenaMutex;
+static std::vector<std::vector<uint8_t*>>   s_freeBlocks;   // per size class
+static sTextureArenaStats                   s_stats = {};
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+static uint32_t GetSizeClass(size_t _size, size_t& _rOutBlockSize)
+{
+    uint32_t    sizeClass   = 0;
+    size_t      octave      = c_MinBlockSize;
+
+    for (;;)
+    {
+        for (uint32_t step = 0; step < c_SizeClassesPerOctave; ++step, ++sizeClass)
+        {
+            const size_t blockSize = octave + octave / c_SizeClassesPerOctave * step;
+
+            if (blockSize >= _size)
+            {
+                _rOutBlockSize = blockSize;
+                return sizeClass;
+            }
+        }
+
+        octave *= 2;
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+static void UpdatePeak()
+{
+    s_stats.peakBytes = (std::max)(s_stats.peakBytes, s_stats.liveBytes + s_stats.pooledBytes);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+cTexturePayload::cTexturePayload()
+    : m_pData(nullptr)
+    , m_size(0)
+    , m_capacity(0)
+    , m_sizeClass(c_ViewSizeClass)
+    , m_pFree(nullptr)
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+cTexturePayload::~cTexturePayload()
+{
+    Reset();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+cTexturePayload::cTexturePayload(cTexturePayload&& _rOther) noexcept
+    : m_pData(_rOther.m_pData)
+    , m_size(_rOther.m_size)
+    , m_capacity(_rOther.m_capacity)
+    , m_sizeClass(_rOther.m_sizeClass)
+    , m_pFree(_rOther.m_pFree)
+{
+    _rOther.m_pData     = nullptr;
+    _rOther.m_size      = 0;
+    _rOther.m_capacity  = 0;
+    _rOther.m_sizeClass = c_ViewSizeClass;
+    _rOther.m_pFree     = nullptr;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+cTexturePayload& cTexturePayload::operator=(cTexturePayload&& _rOther) noexcept
+{
+    if (this != &_rOther)
+    {
+        Reset();
+
+        std::swap(m_pData,      _rOther.m_pData);
+        std::swap(m_size,       _rOther.m_size);
+        std::swap(m_capacity,   _rOther.m_capacity);
+        std::swap(m_sizeClass,  _rOther.m_sizeClass);
+        std::swap(m_pFree,      _rOther.m_pFree);
+    }
+
+    return *this;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+cTexturePayload cTexturePayload::View(const uint8_t* _pData, size_t _size)
+{
+    cTexturePayload payload;
+
+    payload.m_pData     = const_cast<uint8_t*>(_pData);
+    payload.m_size      = _size;
+    payload.m_capacity  = _size;
+
+    return payload;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+uint8_t* cTexturePayload::GetData()
+{
+    return m_pData;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+const uint8_t* cTexturePayload::GetData() const
+{
+    return m_pData;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+size_t cTexturePayload::GetSize() const
+{
+    return m_size;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+bool cTexturePayload::IsEmpty() const
+{
+    return m_size == 0;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTexturePayload::Reset()
+{
+    if (m_pData && m_sizeClass != c_ViewSizeClass)
+    {
+        cTextureArena::Release(*this);
+    }
+
+    m_pData     = nullptr;
+    m_size      = 0;
+    m_capacity  = 0;
+    m_sizeClass = c_ViewSizeClass;
+    m_pFree     = nullptr;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+cTexturePayload cTextureArena::Allocate(size_t _size)
+{
+    size_t          blockSize   = 0;
+    const uint32_t  sizeClass   = GetSizeClass(_size, blockSize);
+
+    uint8_t* pBlock = nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(s_arenaMutex);
+
+        if (sizeClass < s_freeBlocks.size() && !s_freeBlocks[sizeClass].empty())
+        {
+            pBlock = s_freeBlocks[sizeClass].back();
+            s_freeBlocks[sizeClass].pop_back();
+
+            s_stats.pooledBytes -= blockSize;
+            ++s_stats.reuses;
+        }
+        else
+        {
+            ++s_stats.allocations;
+        }
+
+        s_stats.liveBytes += blockSize;
+        UpdatePeak();
+    }
+
+    // the heap allocation itself runs outside the lock
+    if (!pBlock)
+    {
+        pBlock = static_cast<uint8_t*>(::operator new(blockSize));
+    }
+
+    cTexturePayload payload;
+
+    payload.m_pData     = pBlock;
+    payload.m_size      = _size;
+    payload.m_capacity  = blockSize;
+    payload.m_sizeClass = sizeClass;
+
+    return payload;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+cTexturePayload cTextureArena::Adopt(uint8_t* _pData, size_t _size, void (*_pFree)(void*))
+{
+    {
+        std::lock_guard<std::mutex> lock(s_arenaMutex);
+
+        ++s_stats.adoptions;
+        s_stats.liveBytes += _size;
+        UpdatePeak();
+    }
+
+    cTexturePayload payload;
+
+    payload.m_pData     = _pData;
+    payload.m_size      = _size;
+    payload.m_capacity  = _size;
+    payload.m_sizeClass = c_AdoptedSizeClass;
+    payload.m_pFree     = _pFree;
+
+    return payload;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTextureArena::Release(cTexturePayload& _rPayload)
+{
+    if (_rPayload.m_sizeClass == c_AdoptedSizeClass)
+    {
+        _rPayload.m_pFree(_rPayload.m_pData);
+
+        std::lock_guard<std::mutex> lock(s_arenaMutex);
+        s_stats.liveBytes -= _rPayload.m_capacity;
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(s_arenaMutex);
+
+        s_stats.liveBytes -= _rPayload.m_capacity;
+
+        if (s_stats.pooledBytes + _rPayload.m_capacity <= c_MaxPooledBytes)
+        {
+            if (_rPayload.m_sizeClass >= s_freeBlocks.size())
+            {
+                s_freeBlocks.resize(_rPayload.m_sizeClass + 1);
+            }
+
+            s_freeBlocks[_rPayload.m_sizeClass].push_back(_rPayload.m_pData);
+            s_stats.pooledBytes += _rPayload.m_capacity;
+            return;
+        }
+    }
+
+    ::operator delete(_rPayload.m_pData);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTextureArena::Trim()
+{
+    std::vector<std::vector<uint8_t*>> freeBlocks;
+
+    {
+        std::lock_guard<std::mutex> lock(s_arenaMutex);
+
+        freeBlocks.swap(s_freeBlocks);
+        s_stats.pooledBytes = 0;
+    }
+
+    for (std::vector<uint8_t*>& rBlocks : freeBlocks)
+    {
+        for (uint8_t* pBlock : rBlocks)
+        {
+            ::operator delete(pBlock);
+        }
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+sTextureArenaStats cTextureArena::GetStats()
+{
+    std::lock_guard<std::mutex> lock(s_arenaMutex);
+    return s_stats;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTextureArena::ResetStats()
+{
+    std::lock_guard<std::mutex> lock(s_arenaMutex);
+
+    s_stats.allocations = 0;
+    s_stats.reuses      = 0;
+    s_stats.adoptions   = 0;
+    s_stats.peakBytes   = s_stats.liveBytes + s_stats.pooledBytes;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
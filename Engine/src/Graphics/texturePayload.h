@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Pixel (or block) bytes of one texture with all its mips. Move-only, so the bytes a
+// decoder or mip generator writes are the bytes UpdateSubresources reads, without copies
+// on the way. Owned payloads come from cTextureArena and go back to its pool on
+// destruction, views point at memory that outlives them (a mapped cooked scene).
+class cTexturePayload
+{
+	public:
+
+		cTexturePayload();
+		~cTexturePayload();
+
+		cTexturePayload(cTexturePayload&& _rOther) noexcept;
+		cTexturePayload& operator=(cTexturePayload&& _rOther) noexcept;
+
+		cTexturePayload(const cTexturePayload&) = delete;
+		cTexturePayload& operator=(const cTexturePayload&) = delete;
+
+		// read only, nothing is released when the view dies
+		static cTexturePayload View(const uint8_t* _pData, size_t _size);
+
+	public:
+
+		uint8_t*		GetData();
+		const uint8_t*	GetData() const;
+		size_t			GetSize() const;
+		bool			IsEmpty() const;
+
+		// hands the bytes back to their owner, the payload is empty afterwards
+		void Reset();
+
+	private:
+
+		friend class cTextureArena;
+
+		uint8_t*	m_pData;
+		size_t		m_size;
+		size_t		m_capacity;
+		uint32_t	m_sizeClass;
+		void		(*m_pFree)(void*);
+};
+
+struct sTextureArenaStats
+{
+	uint64_t allocations;	// blocks taken from the heap
+	uint64_t reuses;		// blocks served from the pool
+	uint64_t adoptions;		// decoder buffers taken over as they are
+	uint64_t liveBytes;		// held by payloads
+	uint64_t pooledBytes;	// released, kept for reuse
+	uint64_t peakBytes;		// highest live + pooled since the last ResetStats
+};
+
+// Thread safe pool of texture payload blocks. Sizes are rounded up to a quarter of
+// their power of two (at most 25% slack). Released blocks are kept per size class
+// until Trim, up to a fixed budget, so textures of the same size reuse each other's
+// chains and blocks instead of going back to the heap every time.
+class cTextureArena
+{
+	public:
+
+		static cTexturePayload Allocate(size_t _size);
+
+		// takes over _pData as it is, _pFree(_pData) runs when the payload is released
+		static cTexturePayload Adopt(uint8_t* _pData, size_t _size, void (*_pFree)(void*));
+
+		// frees every pooled block, live payloads are unaffected
+		static void Trim();
+
+		static sTextureArenaStats GetStats();
+
+		// zeroes the counters, the peak restarts at the current live + pooled bytes
+		static void ResetStats();
+
+	private:
+
+		friend class cTexturePayload;
+
+		static void Release(cTexturePayload& _rPayload);
+};
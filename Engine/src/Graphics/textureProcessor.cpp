@@ -0,0 +1,806 @@
+#include "textureProcessor.h"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <type_traits>
+#include <unordered_map>
+
+#include "blockCompressor.h"
+#include "cpuTexture.h"
+#include "gfxConfig.h"
+#include "mipGenerator.h"
+#include "texturePacker.h"
+#include "texturePayload.h"
+#include "Core/hash.h"
+#include "Core/parallel.h"
+#include "Scene/model.h"
+
+// full mip chains are built on the CPU so every texture uploads in one copy without the compute
+// mip pass. Color textures are averaged in linear light, textures of at least c_ParallelMipPixelCount
+// pixels are filtered one at a time across all workers, the rest one texture per worker
+constexpr bool          c_GenerateMipsOnCpu         = true;
+constexpr eMipFilter    c_MipFilter                 = MIP_FILTER_KAISER;
+constexpr uint32_t      c_ParallelMipPixelCount     = 1 << 20;
+
+// block compression of the CPU built mip chain. Normal maps go to BC5, occlusion-only maps
+// to BC4, everything else to BC7, or BC1 / BC3 (with alpha) at a quarter / half the size
+constexpr bool      c_CompressTextures          = true;
+constexpr bool      c_CompressColorAsBC1        = false;
+constexpr bool      c_MeasureTexturePsnr        = true;
+
+// textures of the same shape become Texture2DArray slices, small leftovers share padded atlases,
+// so a scene needs a few descriptors instead of one per image. Needs complete mip chains
+constexpr bool      c_PackTextures              = true;
+
+// images with the same size and pixels and materials with the same parameters collapse to one,
+// found by content hash and confirmed byte for byte. Images only merge when bound to the same slots
+constexpr bool      c_DeduplicateAssets         = true;
+
+// occlusion and metallic-roughness maps of one material merge into one ORM texture
+// (R = occlusion, G = roughness, B = metallic), so the pixel shader samples it once
+constexpr bool      c_PackOrmTextures           = true;
+
+// textures left uncompressed drop the channels their slots never read, occlusion maps
+// become R8, normal maps RG8 (Z is rebuilt in the shader)
+constexpr bool      c_ReduceTextureChannels     = true;
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTextureProcessor::Process(sModel& _rModel)
+{
+    using Clock = std::chrono::high_resolution_clock;
+
+    // before any per-texture work, duplicates would pay for mips and compression too
+    if (c_DeduplicateAssets)
+    {
+        auto dedupStart =
+            Clock::now();
+
+        DeduplicateTextures(_rModel);
+        DeduplicateMaterials(_rModel);
+
+        std::cout
+            << "Asset deduplication: "
+            << std::chrono::duration<double>(
+                Clock::now() - dedupStart).count()
+            << " seconds\n";
+    }
+
+    if (c_PackOrmTextures)
+    {
+        auto ormStart =
+            Clock::now();
+
+        PackOrmTextures(_rModel);
+
+        std::cout
+            << "ORM packing: "
+            << std::chrono::duration<double>(
+                Clock::now() - ormStart).count()
+            << " seconds\n";
+    }
+
+    if (c_GenerateMipsOnCpu || c_CompressTextures)
+    {
+        auto mipStart =
+            Clock::now();
+
+        GenerateMips(_rModel);
+
+        std::cout
+            << "Mip generation: "
+            << std::chrono::duration<double>(
+                Clock::now() - mipStart).count()
+            << " seconds\n";
+    }
+
+    if (c_CompressTextures)
+    {
+        auto compressStart =
+            Clock::now();
+
+        CompressTextures(_rModel);
+
+        std::cout
+            << "Texture compression: "
+            << std::chrono::duration<double>(
+                Clock::now() - compressStart).count()
+            << " seconds\n";
+    }
+
+    if (c_ReduceTextureChannels)
+    {
+        ReduceTextureChannels(_rModel);
+    }
+
+    auto packStart =
+        Clock::now();
+
+    PackTextures(_rModel);
+
+    std::cout
+        << "Texture packing: "
+        << std::chrono::duration<double>(
+            Clock::now() - packStart).count()
+        << " seconds\n";
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+static void RemapTextureIndices(std::vector<sMaterial>& _rMaterials, const std::vector<int>& _rRemap)
+{
+    auto Remap = [&](int& _rTextureIndex)
+        {
+            if (_rTextureIndex >= 0 && _rTextureIndex < static_cast<int>(_rRemap.size()))
+                _rTextureIndex = _rRemap[_rTextureIndex];
+        };
+
+    for (sMaterial& rMaterial : _rMaterials)
+    {
+        Remap(rMaterial.baseColorIndex);
+        Remap(rMaterial.metallicRoughnessIndex);
+        Remap(rMaterial.normalIndex);
+        Remap(rMaterial.occlusionIndex);
+        Remap(rMaterial.emissiveIndex);
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTextureProcessor::DeduplicateTextures(sModel& _rModel)
+{
+    std::vector<cCpuTexture>& rTextures = _rModel.cpuTextures;
+
+    // the slots decide sRGB and the block format, so only textures used alike may merge
+    const std::vector<uint32_t> usages = GetTextureUsages(_rModel);
+
+    std::vector<uint64_t> hashes(rTextures.size());
+
+    cParallel::For(rTextures.size(), [&](size_t _textureIndex)
+        {
+            cCpuTexture&            rTexture = rTextures[_textureIndex];
+            const cTexturePayload&  rPayload = rTexture.GetPayload();
+
+            uint64_t hash = cHash::Hash64(rPayload.GetData(), rPayload.GetSize());
+
+            hash = cHash::Combine(hash, (static_cast<uint64_t>(rTexture.GetWidth()) << 32) | static_cast<uint32_t>(rTexture.GetHeight()));
+            hash = cHash::Combine(hash, (static_cast<uint64_t>(rTexture.GetFormat()) << 32) | rTexture.GetMipLevels());
+            hash = cHash::Combine(hash, usages[_textureIndex]);
+
+            hashes[_textureIndex] = hash;
+        });
+
+    auto IsSameTexture = [&](size_t _a, size_t _b)
+        {
+            cCpuTexture& rA = rTextures[_a];
+            cCpuTexture& rB = rTextures[_b];
+
+            return usages[_a] == usages[_b] &&
+                rA.GetWidth() == rB.GetWidth() &&
+                rA.GetHeight() == rB.GetHeight() &&
+                rA.GetFormat() == rB.GetFormat() &&
+                rA.GetMipLevels() == rB.GetMipLevels() &&
+                rA.GetArraySize() == rB.GetArraySize() &&
+                rA.GetPayload().GetSize() == rB.GetPayload().GetSize() &&
+                std::memcmp(rA.GetPayload().GetData(), rB.GetPayload().GetData(), rA.GetPayload().GetSize()) == 0;
+        };
+
+    // original index -> index of the kept texture, a collision only costs the byte compare
+    std::unordered_map<uint64_t, std::vector<uint32_t>> keptByHash;
+    std::vector<int>                                    remap(rTextures.size(), -1);
+    std::vector<cCpuTexture>                            unique;
+    std::vector<size_t>                                 uniqueSources;
+
+    unique.reserve(rTextures.size());
+
+    size_t savedBytes = 0;
+
+    for (size_t i = 0; i < rTextures.size(); ++i)
+    {
+        std::vector<uint32_t>& rCandidates = keptByHash[hashes[i]];
+
+        for (uint32_t candidate : rCandidates)
+        {
+            if (IsSameTexture(uniqueSources[candidate], i))
+            {
+                remap[i] = static_cast<int>(candidate);
+                break;
+            }
+        }
+
+        if (remap[i] >= 0)
+        {
+            savedBytes += rTextures[i].GetPayload().GetSize();
+            continue;
+        }
+
+        remap[i] = static_cast<int>(unique.size());
+        rCandidates.push_back(static_cast<uint32_t>(unique.size()));
+        uniqueSources.push_back(i);
+    }
+
+    const size_t duplicateCount = rTextures.size() - uniqueSources.size();
+
+    std::cout
+        << "Texture deduplication: "
+        << duplicateCount << " of " << rTextures.size() << " textures were duplicates, "
+        << savedBytes / 1024 << " KB saved\n";
+
+    if (duplicateCount == 0)
+        return;
+
+    for (size_t source : uniqueSources)
+    {
+        unique.push_back(std::move(rTextures[source]));
+    }
+
+    RemapTextureIndices(_rModel.materials, remap);
+
+    // the duplicates' payloads go back to the arena here
+    rTextures = std::move(unique);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTextureProcessor::DeduplicateMaterials(sModel& _rModel)
+{
+    // compared as raw bytes, every member is 4 bytes wide so there is no padding to hash
+    static_assert(std::is_trivially_copyable<sMaterial>::value, "sMaterial is hashed as raw bytes");
+    static_assert(sizeof(sMaterial) % sizeof(float) == 0, "sMaterial is hashed as raw bytes");
+
+    std::vector<sMaterial>& rMaterials = _rModel.materials;
+
+    std::unordered_map<uint64_t, std::vector<uint32_t>> keptByHash;
+    std::vector<int>                                    remap(rMaterials.size(), -1);
+    std::vector<sMaterial>                              unique;
+
+    unique.reserve(rMaterials.size());
+
+    for (size_t i = 0; i < rMaterials.size(); ++i)
+    {
+        const sMaterial& rMaterial = rMaterials[i];
+
+        std::vector<uint32_t>& rCandidates = keptByHash[cHash::Hash64(&rMaterial, sizeof(sMaterial))];
+
+        for (uint32_t candidate : rCandidates)
+        {
+            if (std::memcmp(&unique[candidate], &rMaterial, sizeof(sMaterial)) == 0)
+            {
+                remap[i] = static_cast<int>(candidate);
+                break;
+            }
+        }
+
+        if (remap[i] >= 0)
+            continue;
+
+        remap[i] = static_cast<int>(unique.size());
+        rCandidates.push_back(static_cast<uint32_t>(unique.size()));
+        unique.push_back(rMaterial);
+    }
+
+    std::cout
+        << "Material deduplication: "
+        << rMaterials.size() - unique.size() << " of " << rMaterials.size() << " materials were duplicates\n";
+
+    if (unique.size() == rMaterials.size())
+        return;
+
+    for (sMeshData& rMesh : _rModel.meshes)
+    {
+        if (rMesh.materialId >= 0 && rMesh.materialId < static_cast<int>(remap.size()))
+            rMesh.materialId = remap[rMesh.materialId];
+    }
+
+    rMaterials = std::move(unique);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTextureProcessor::PackOrmTextures(sModel& _rModel)
+{
+    std::vector<cCpuTexture>& rTextures = _rModel.cpuTextures;
+
+    const int textureCount = static_cast<int>(rTextures.size());
+
+    struct sOrmJob
+    {
+        int occlusionIndex;
+        int metallicRoughnessIndex;
+    };
+
+    // materials that pair the same two maps share their ORM texture
+    std::unordered_map<uint64_t, int>   ormByPair;
+    std::vector<sOrmJob>                jobs;
+
+    size_t skippedCount = 0;
+
+    for (sMaterial& rMaterial : _rModel.materials)
+    {
+        const int occlusion         = rMaterial.occlusionIndex;
+        const int metallicRoughness = rMaterial.metallicRoughnessIndex;
+
+        // already one texture (exporters often write ORM themselves) or nothing to merge
+        if (occlusion < 0 || metallicRoughness < 0 || occlusion >= textureCount || metallicRoughness >= textureCount ||
+            occlusion == metallicRoughness)
+            continue;
+
+        cCpuTexture& rOcclusion         = rTextures[occlusion];
+        cCpuTexture& rMetallicRoughness = rTextures[metallicRoughness];
+
+        // decoded single level RGBA8 of the same size, anything else would need resampling
+        if (rOcclusion.GetFormat() != DXGI_FORMAT_R8G8B8A8_UNORM || rMetallicRoughness.GetFormat() != DXGI_FORMAT_R8G8B8A8_UNORM ||
+            rOcclusion.GetMipLevels() != 1 || rMetallicRoughness.GetMipLevels() != 1 ||
+            rOcclusion.GetWidth() != rMetallicRoughness.GetWidth() || rOcclusion.GetHeight() != rMetallicRoughness.GetHeight())
+        {
+            ++skippedCount;
+            continue;
+        }
+
+        const uint64_t key = (static_cast<uint64_t>(occlusion) << 32) | static_cast<uint32_t>(metallicRoughness);
+
+        auto it = ormByPair.find(key);
+
+        if (it == ormByPair.end())
+        {
+            it = ormByPair.emplace(key, textureCount + static_cast<int>(jobs.size())).first;
+            jobs.push_back({ occlusion, metallicRoughness });
+        }
+
+        rMaterial.occlusionIndex            = it->second;
+        rMaterial.metallicRoughnessIndex    = it->second;
+    }
+
+    std::vector<cTexturePayload> ormPixels(jobs.size());
+
+    cParallel::For(jobs.size(), [&](size_t _jobIndex)
+        {
+            cCpuTexture& rOcclusion         = rTextures[jobs[_jobIndex].occlusionIndex];
+            cCpuTexture& rMetallicRoughness = rTextures[jobs[_jobIndex].metallicRoughnessIndex];
+
+            const size_t pixelCount = static_cast<size_t>(rOcclusion.GetWidth()) * rOcclusion.GetHeight();
+
+            ormPixels[_jobIndex] = cTextureArena::Allocate(pixelCount * 4);
+
+            const uint8_t*  pOcclusion          = rOcclusion.GetPayload().GetData();
+            const uint8_t*  pMetallicRoughness  = rMetallicRoughness.GetPayload().GetData();
+            uint8_t*        pOrm                = ormPixels[_jobIndex].GetData();
+
+            for (size_t pixel = 0; pixel < pixelCount; ++pixel)
+            {
+                pOrm[pixel * 4 + 0] = pOcclusion[pixel * 4];
+                pOrm[pixel * 4 + 1] = pMetallicRoughness[pixel * 4 + 1];
+                pOrm[pixel * 4 + 2] = pMetallicRoughness[pixel * 4 + 2];
+                pOrm[pixel * 4 + 3] = 255;
+            }
+        });
+
+    for (size_t i = 0; i < jobs.size(); ++i)
+    {
+        const int sourceIndex = jobs[i].occlusionIndex;
+
+        rTextures.emplace_back(rTextures[sourceIndex].GetWidth(), rTextures[sourceIndex].GetHeight(), std::move(ormPixels[i]));
+    }
+
+    // sources no material samples on its own anymore are dropped
+    std::vector<bool> isReferenced(rTextures.size(), false);
+
+    auto MarkReferenced = [&](int _textureIndex)
+        {
+            if (_textureIndex >= 0 && _textureIndex < static_cast<int>(isReferenced.size()))
+                isReferenced[_textureIndex] = true;
+        };
+
+    for (const sMaterial& rMaterial : _rModel.materials)
+    {
+        MarkReferenced(rMaterial.baseColorIndex);
+        MarkReferenced(rMaterial.metallicRoughnessIndex);
+        MarkReferenced(rMaterial.normalIndex);
+        MarkReferenced(rMaterial.occlusionIndex);
+        MarkReferenced(rMaterial.emissiveIndex);
+    }
+
+    std::vector<bool> isSource(rTextures.size(), false);
+
+    for (const sOrmJob& rJob : jobs)
+    {
+        isSource[rJob.occlusionIndex]           = true;
+        isSource[rJob.metallicRoughnessIndex]   = true;
+    }
+
+    std::vector<int>            remap(rTextures.size(), -1);
+    std::vector<cCpuTexture>    kept;
+
+    kept.reserve(rTextures.size());
+
+    for (size_t i = 0; i < rTextures.size(); ++i)
+    {
+        if (isSource[i] && !isReferenced[i])
+            continue;
+
+        remap[i] = static_cast<int>(kept.size());
+        kept.push_back(std::move(rTextures[i]));
+    }
+
+    std::cout
+        << "ORM textures: "
+        << jobs.size() << " packed, "
+        << rTextures.size() - kept.size() << " source maps dropped, "
+        << skippedCount << " materials left unpacked (size or format mismatch)\n";
+
+    RemapTextureIndices(_rModel.materials, remap);
+
+    rTextures = std::move(kept);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTextureProcessor::ReduceTextureChannels(sModel& _rModel)
+{
+    const std::vector<uint32_t> usages = GetTextureUsages(_rModel);
+
+    size_t r8Count  = 0;
+    size_t rg8Count = 0;
+
+    cParallel::For(_rModel.cpuTextures.size(), [&](size_t _textureIndex)
+        {
+            cCpuTexture& rTexture = _rModel.cpuTextures[_textureIndex];
+
+            if (rTexture.GetFormat() != DXGI_FORMAT_R8G8B8A8_UNORM)
+                return;
+
+            uint32_t channelCount = 4;
+
+            if (usages[_textureIndex] == TEXTURE_USAGE_OCCLUSION)
+                channelCount = 1;
+            else if (usages[_textureIndex] == TEXTURE_USAGE_NORMAL)
+                channelCount = 2;
+            else
+                return;
+
+            // levels (and slices) are packed back to back, so the whole chain is one run of texels
+            const cTexturePayload&  rPixels     = rTexture.GetPayload();
+            const size_t            texelCount  = rPixels.GetSize() / 4;
+
+            cTexturePayload reduced = cTextureArena::Allocate(texelCount * channelCount);
+
+            const uint8_t*  pSource = rPixels.GetData();
+            uint8_t*        pDest   = reduced.GetData();
+
+            for (size_t texel = 0; texel < texelCount; ++texel)
+            {
+                for (uint32_t channel = 0; channel < channelCount; ++channel)
+                {
+                    pDest[texel * channelCount + channel] = pSource[texel * 4 + channel];
+                }
+            }
+
+            rTexture = cCpuTexture(rTexture.GetWidth(), rTexture.GetHeight(), std::move(reduced),
+                channelCount == 1 ? DXGI_FORMAT_R8_UNORM : DXGI_FORMAT_R8G8_UNORM, rTexture.GetMipLevels(), rTexture.GetArraySize());
+        });
+
+    for (cCpuTexture& rTexture : _rModel.cpuTextures)
+    {
+        r8Count     += rTexture.GetFormat() == DXGI_FORMAT_R8_UNORM ? 1 : 0;
+        rg8Count    += rTexture.GetFormat() == DXGI_FORMAT_R8G8_UNORM ? 1 : 0;
+    }
+
+    std::cout
+        << "Reduced channels: "
+        << r8Count << " R8, "
+        << rg8Count << " RG8 textures\n";
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+std::vector<uint32_t> cTextureProcessor::GetTextureUsages(const sModel& _rModel)
+{
+    std::vector<uint32_t> usages(_rModel.cpuTextures.size(), 0);
+
+    auto AddUsage = [&](int _textureIndex, uint32_t _usage)
+        {
+            if (_textureIndex >= 0 && _textureIndex < static_cast<int>(usages.size()))
+                usages[_textureIndex] |= _usage;
+        };
+
+    for (const sMaterial& rMaterial : _rModel.materials)
+    {
+        AddUsage(rMaterial.baseColorIndex,          TEXTURE_USAGE_COLOR);
+        AddUsage(rMaterial.emissiveIndex,           TEXTURE_USAGE_COLOR);
+        AddUsage(rMaterial.metallicRoughnessIndex,  TEXTURE_USAGE_DATA);
+        AddUsage(rMaterial.normalIndex,             TEXTURE_USAGE_NORMAL);
+        AddUsage(rMaterial.occlusionIndex,          TEXTURE_USAGE_OCCLUSION);
+    }
+
+    return usages;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTextureProcessor::GenerateMips(sModel& _rModel)
+{
+    const std::vector<uint32_t> usages = GetTextureUsages(_rModel);
+
+    std::vector<size_t> largeTextures;
+    std::vector<size_t> smallTextures;
+
+    for (size_t i = 0; i < _rModel.cpuTextures.size(); ++i)
+    {
+        cCpuTexture& rTexture = _rModel.cpuTextures[i];
+
+        const uint32_t width    = static_cast<uint32_t>(rTexture.GetWidth());
+        const uint32_t height   = static_cast<uint32_t>(rTexture.GetHeight());
+
+        if (rTexture.GetFormat() != DXGI_FORMAT_R8G8B8A8_UNORM || rTexture.GetMipLevels() > 1 || cMipGenerator::GetMipCount(width, height) == 1)
+            continue;
+
+        if (width * height >= c_ParallelMipPixelCount)
+            largeTextures.push_back(i);
+        else
+            smallTextures.push_back(i);
+    }
+
+    auto Generate = [&](size_t _textureIndex, bool _multithreaded)
+        {
+            cCpuTexture& rTexture = _rModel.cpuTextures[_textureIndex];
+
+            const uint32_t width    = static_cast<uint32_t>(rTexture.GetWidth());
+            const uint32_t height   = static_cast<uint32_t>(rTexture.GetHeight());
+
+            // base color and emissive hold sRGB values, everything else is linear data
+            const bool srgb = (usages[_textureIndex] & TEXTURE_USAGE_COLOR) != 0;
+
+            cTexturePayload chain = cTextureArena::Allocate(cMipGenerator::GetChainByteSize(width, height));
+            cMipGenerator::GenerateChain(rTexture.GetPayload().GetData(), width, height, chain.GetData(), c_MipFilter, srgb, _multithreaded);
+
+            rTexture = cCpuTexture(static_cast<int>(width), static_cast<int>(height), std::move(chain),
+                DXGI_FORMAT_R8G8B8A8_UNORM, cMipGenerator::GetMipCount(width, height));
+        };
+
+    // one large texture at a time across all workers, then the rest one texture per worker
+    for (size_t textureIndex : largeTextures)
+    {
+        Generate(textureIndex, true);
+    }
+
+    cParallel::For(smallTextures.size(), [&](size_t _i)
+        {
+            Generate(smallTextures[_i], false);
+        });
+
+    size_t chainBytes = 0;
+
+    for (size_t textureIndex : largeTextures)
+        chainBytes += _rModel.cpuTextures[textureIndex].GetPayload().GetSize();
+
+    for (size_t textureIndex : smallTextures)
+        chainBytes += _rModel.cpuTextures[textureIndex].GetPayload().GetSize();
+
+    std::cout
+        << "Mips: generated for "
+        << largeTextures.size() + smallTextures.size() << " of " << _rModel.cpuTextures.size() << " textures ("
+        << chainBytes / (1024 * 1024) << " MB with mips)\n";
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTextureProcessor::CompressTextures(sModel& _rModel)
+{
+    using Clock = std::chrono::high_resolution_clock;
+
+    static const char* const s_formatNames[BLOCK_FORMAT_COUNT] = { "BC1", "BC3", "BC4", "BC5", "BC7" };
+
+    static const DXGI_FORMAT s_dxgiFormats[BLOCK_FORMAT_COUNT] =
+    {
+        DXGI_FORMAT_BC1_UNORM,
+        DXGI_FORMAT_BC3_UNORM,
+        DXGI_FORMAT_BC4_UNORM,
+        DXGI_FORMAT_BC5_UNORM,
+        DXGI_FORMAT_BC7_UNORM,
+    };
+
+    const std::vector<uint32_t> usages = GetTextureUsages(_rModel);
+
+    size_t sourceBytes      = 0;
+    size_t compressedBytes  = 0;
+
+    for (size_t i = 0; i < _rModel.cpuTextures.size(); ++i)
+    {
+        cCpuTexture& rTexture = _rModel.cpuTextures[i];
+
+        const uint32_t width    = static_cast<uint32_t>(rTexture.GetWidth());
+        const uint32_t height   = static_cast<uint32_t>(rTexture.GetHeight());
+
+        // D3D12 wants the top level of a BCn texture in whole blocks
+        if (rTexture.GetFormat() != DXGI_FORMAT_R8G8B8A8_UNORM || width % 4 != 0 || height % 4 != 0)
+        {
+            std::cout << "Texture [" << i << "] " << width << "x" << height << " stays uncompressed\n";
+            continue;
+        }
+
+        // GenerateMips has already put the full chain behind the top level
+        const cTexturePayload& rPixels = rTexture.GetPayload();
+
+        const uint32_t mipCount     = rTexture.GetMipLevels();
+        const size_t   topByteSize  = static_cast<size_t>(width) * height * 4;
+
+        eBlockFormat format = BLOCK_FORMAT_BC7;
+
+        if (usages[i] == TEXTURE_USAGE_NORMAL)
+        {
+            format = BLOCK_FORMAT_BC5;
+        }
+        else if (usages[i] == TEXTURE_USAGE_OCCLUSION)
+        {
+            format = BLOCK_FORMAT_BC4;
+        }
+        else if (c_CompressColorAsBC1)
+        {
+            bool opaque = true;
+
+            for (size_t pixel = 3; pixel < topByteSize && opaque; pixel += 4)
+            {
+                opaque = rPixels.GetData()[pixel] == 255;
+            }
+
+            format = opaque ? BLOCK_FORMAT_BC1 : BLOCK_FORMAT_BC3;
+        }
+
+        auto encodeStart = Clock::now();
+
+        size_t blockBytes = 0;
+
+        for (uint32_t mip = 0; mip < mipCount; ++mip)
+        {
+            blockBytes += cBlockCompressor::GetCompressedSize((std::max)(width >> mip, 1u), (std::max)(height >> mip, 1u), format);
+        }
+
+        cTexturePayload blocks = cTextureArena::Allocate(blockBytes);
+
+        const uint8_t*  pMip    = rPixels.GetData();
+        uint8_t*        pBlocks = blocks.GetData();
+
+        for (uint32_t mip = 0; mip < mipCount; ++mip)
+        {
+            const uint32_t mipWidth     = (std::max)(width >> mip, 1u);
+            const uint32_t mipHeight    = (std::max)(height >> mip, 1u);
+
+            cBlockCompressor::Compress(pMip, mipWidth, mipHeight, format, pBlocks, true);
+
+            pMip    += static_cast<size_t>(mipWidth) * mipHeight * 4;
+            pBlocks += cBlockCompressor::GetCompressedSize(mipWidth, mipHeight, format);
+        }
+
+        const double encodeSeconds = std::chrono::duration<double>(Clock::now() - encodeStart).count();
+
+        std::cout
+            << "Texture [" << i << "] "
+            << width << "x" << height << " "
+            << s_formatNames[format] << ", "
+            << mipCount << " mips: "
+            << encodeSeconds * 1000.0 << " ms ("
+            << rPixels.GetSize() / (encodeSeconds * 1024.0 * 1024.0) << " MB/s)";
+
+        if (c_MeasureTexturePsnr)
+        {
+            std::vector<uint8_t> decoded(topByteSize);
+            cBlockCompressor::Decompress(blocks.GetData(), width, height, format, decoded.data());
+
+            std::cout
+                << ", PSNR "
+                << cBlockCompressor::ComputePsnr(rPixels.GetData(), decoded.data(), static_cast<size_t>(width) * height,
+                    cBlockCompressor::GetChannelCount(format))
+                << " dB";
+        }
+
+        std::cout << "\n";
+
+        sourceBytes     += rPixels.GetSize();
+        compressedBytes += blocks.GetSize();
+
+        rTexture = cCpuTexture(static_cast<int>(width), static_cast<int>(height), std::move(blocks), s_dxgiFormats[format], mipCount);
+    }
+
+    std::cout
+        << "Texture memory: "
+        << sourceBytes / (1024 * 1024) << " MB -> "
+        << compressedBytes / (1024 * 1024) << " MB with mips\n";
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTextureProcessor::PackTextures(sModel& _rModel)
+{
+    std::vector<cCpuTexture>& rTextures = _rModel.cpuTextures;
+
+    _rModel.textureRefs.clear();
+    _rModel.textureRefs.reserve(rTextures.size());
+
+    // arrays and atlases keep the levels they are packed with, a texture that relies on the
+    // compute mip pass keeps its own descriptor
+    if (!c_PackTextures || !(c_GenerateMipsOnCpu || c_CompressTextures))
+    {
+        for (size_t i = 0; i < rTextures.size(); ++i)
+        {
+            _rModel.textureRefs.push_back({ static_cast<uint32_t>(i), 0, { 0.0f, 0.0f }, { 0.0f, 0.0f, 1.0f, 1.0f } });
+        }
+
+        return;
+    }
+
+    std::vector<sTexturePackInput>  inputs(rTextures.size());
+    std::vector<const uint8_t*>     sources(rTextures.size());
+
+    for (size_t i = 0; i < rTextures.size(); ++i)
+    {
+        cCpuTexture& rTexture = rTextures[i];
+
+        inputs[i].width     = static_cast<uint32_t>(rTexture.GetWidth());
+        inputs[i].height    = static_cast<uint32_t>(rTexture.GetHeight());
+        inputs[i].mipLevels = rTexture.GetMipLevels();
+        inputs[i].format    = static_cast<uint32_t>(rTexture.GetFormat());
+
+        cCpuTexture::GetBlockLayout(rTexture.GetFormat(), inputs[i].blockBytes, inputs[i].blockSize);
+
+        sources[i] = rTexture.GetPayload().GetData();
+    }
+
+    sTexturePackPlan plan;
+    cTexturePacker::Plan(inputs.data(), inputs.size(), plan);
+
+    std::vector<cTexturePayload> pagePayloads;
+    pagePayloads.reserve(plan.pages.size());
+
+    for (const sTexturePage& rPage : plan.pages)
+    {
+        pagePayloads.push_back(cTextureArena::Allocate(cTexturePacker::GetPageByteSize(rPage)));
+    }
+
+    // every page writes only its own payload
+    cParallel::For(plan.pages.size(), [&](size_t _pageIndex)
+        {
+            cTexturePacker::BuildPage(plan, static_cast<uint32_t>(_pageIndex), inputs.data(), sources.data(), pagePayloads[_pageIndex].GetData());
+        });
+
+    for (uint32_t i = 0; i < static_cast<uint32_t>(rTextures.size()); ++i)
+    {
+        _rModel.textureRefs.push_back(cTexturePacker::GetReference(plan, i));
+    }
+
+    size_t arrayCount   = 0;
+    size_t atlasCount   = 0;
+
+    std::vector<cCpuTexture> pages;
+    pages.reserve(plan.pages.size());
+
+    for (size_t i = 0; i < plan.pages.size(); ++i)
+    {
+        const sTexturePage& rPage = plan.pages[i];
+
+        arrayCount += rPage.kind == TEXTURE_PAGE_ARRAY ? 1 : 0;
+        atlasCount += rPage.kind == TEXTURE_PAGE_ATLAS ? 1 : 0;
+
+        pages.emplace_back(static_cast<int>(rPage.width), static_cast<int>(rPage.height), std::move(pagePayloads[i]),
+            static_cast<DXGI_FORMAT>(rPage.format), rPage.mipLevels, rPage.arraySize);
+    }
+
+    std::cout
+        << "Textures packed: "
+        << rTextures.size() << " textures -> "
+        << pages.size() << " descriptors ("
+        << arrayCount << " arrays, "
+        << atlasCount << " atlases)\n";
+
+    if (pages.size() > GFX_BINDLESS_TEXTURE_CAPACITY)
+    {
+        std::cout
+            << "Textures packed: " << pages.size() - GFX_BINDLESS_TEXTURE_CAPACITY
+            << " pages exceed GFX_BINDLESS_TEXTURE_CAPACITY and cannot be uploaded\n";
+    }
+
+    // the source payloads go back to the arena here
+    rTextures = std::move(pages);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
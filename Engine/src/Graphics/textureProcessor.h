@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+struct sModel;
+
+// material slots an image is bound to, an image may serve several
+enum eTextureUsage : uint32_t
+{
+	TEXTURE_USAGE_COLOR		= 1 << 0,	// base color, emissive
+	TEXTURE_USAGE_DATA		= 1 << 1,	// metallic / roughness
+	TEXTURE_USAGE_NORMAL	= 1 << 2,
+	TEXTURE_USAGE_OCCLUSION	= 1 << 3,
+};
+
+// CPU side texture passes between decode and upload. They work on the decoded sModel::cpuTextures
+// and the materials that reference them, the model loader only decides when they run.
+class cTextureProcessor
+{
+	public:
+
+		// every enabled pass in order: deduplication, ORM packing, mips, block compression,
+		// channel reduction and packing. Fills sModel::textureRefs
+		static void Process(sModel& _rModel);
+
+		// collapse duplicates found by content hash, material texture indices / sMeshData::materialId
+		// are remapped to the kept entry. Textures first, materials then compare remapped indices
+		static void DeduplicateTextures(sModel& _rModel);
+		static void DeduplicateMaterials(sModel& _rModel);
+
+		// merges each material's occlusion and metallic-roughness maps into one ORM texture
+		static void PackOrmTextures(sModel& _rModel);
+
+		// replaces every single level RGBA8 texture with its full mip chain
+		static void GenerateMips(sModel& _rModel);
+
+		// picks a BCn format per texture from the material slots it is bound to and encodes the full mip chain
+		static void CompressTextures(sModel& _rModel);
+
+		// R8 / RG8 for uncompressed textures whose slots read only one / two channels
+		static void ReduceTextureChannels(sModel& _rModel);
+
+		// groups the final textures into arrays / atlases and fills sModel::textureRefs
+		static void PackTextures(sModel& _rModel);
+
+		// eTextureUsage bits per texture from the material slots it is bound to
+		static std::vector<uint32_t> GetTextureUsages(const sModel& _rModel);
+};
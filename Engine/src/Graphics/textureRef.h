@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstdint>
+
+// Shader visible reference to one source texture, gTextureRefs in shader.hlsl. Material
+// texture indices index this table, it says where the texture lives after packing.
+struct sTextureRef
+{
+	uint32_t	descriptorIndex;	// into the texture descriptor table
+	uint32_t	slice;				// Texture2DArray slice
+	float		padding[2];
+	float		uvRect[4];			// offset xy and scale zw inside an atlas, (0, 0, 1, 1) otherwise
+};
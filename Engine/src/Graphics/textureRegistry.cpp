@@ -0,0 +1,109 @@
+#include "textureRegistry.h"
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+cTextureRegistry::cTextureRegistry()
+    : m_capacity(0)
+    , m_usedRange(0)
+    , m_allocatedCount(0)
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTextureRegistry::Initialize(uint32_t _capacity)
+{
+    m_freeSlots.clear();
+    m_retiredSlots.clear();
+
+    m_capacity          = _capacity;
+    m_usedRange         = 0;
+    m_allocatedCount    = 0;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+uint32_t cTextureRegistry::Allocate()
+{
+    uint32_t slot = c_InvalidSlot;
+
+    if (!m_freeSlots.empty())
+    {
+        std::pop_heap(m_freeSlots.begin(), m_freeSlots.end(), std::greater<uint32_t>());
+
+        slot = m_freeSlots.back();
+
+        m_freeSlots.pop_back();
+    }
+    else if (m_usedRange < m_capacity)
+    {
+        slot = m_usedRange++;
+    }
+    else
+    {
+        return c_InvalidSlot;
+    }
+
+    ++m_allocatedCount;
+
+    return slot;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTextureRegistry::Free(uint32_t _slot, uint64_t _fenceValue)
+{
+    assert(_slot < m_usedRange);
+    assert(m_allocatedCount > 0);
+
+    --m_allocatedCount;
+
+    if (_fenceValue == 0)
+    {
+        m_freeSlots.push_back(_slot);
+        std::push_heap(m_freeSlots.begin(), m_freeSlots.end(), std::greater<uint32_t>());
+        return;
+    }
+
+    assert(m_retiredSlots.empty() || m_retiredSlots.back().fenceValue <= _fenceValue);
+
+    m_retiredSlots.push_back({ _fenceValue, _slot });
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTextureRegistry::Retire(uint64_t _completedFenceValue)
+{
+    while (!m_retiredSlots.empty() && m_retiredSlots.front().fenceValue <= _completedFenceValue)
+    {
+        m_freeSlots.push_back(m_retiredSlots.front().slot);
+        std::push_heap(m_freeSlots.begin(), m_freeSlots.end(), std::greater<uint32_t>());
+
+        m_retiredSlots.pop_front();
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+uint32_t cTextureRegistry::GetCapacity() const
+{
+    return m_capacity;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+uint32_t cTextureRegistry::GetAllocatedCount() const
+{
+    return m_allocatedCount;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+uint32_t cTextureRegistry::GetUsedRange() const
+{
+    return m_usedRange;
+}
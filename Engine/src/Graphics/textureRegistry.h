@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+// Hands out slots of the bindless texture table, the descriptor range the shaders index with
+// sTextureRef::descriptorIndex. The table grows from slot 0 as textures register, freed slots
+// go back to the pool once the frames that may still read them completed and are reused
+// lowest first, which keeps the used part of the range compact. Platform neutral, the caller
+// writes the descriptors.
+class cTextureRegistry
+{
+	public:
+
+		static constexpr uint32_t c_InvalidSlot = ~0u;
+
+	public:
+
+		cTextureRegistry();
+
+	public:
+
+		// _capacity slots, every slot handed out before is forgotten
+		void Initialize(uint32_t _capacity);
+
+		// the lowest reusable slot, c_InvalidSlot when the whole range is taken
+		uint32_t Allocate();
+
+		// the slot is reused after _fenceValue completed, 0 = right away
+		void Free(uint32_t _slot, uint64_t _fenceValue);
+
+		// slots freed with a fence value up to _completedFenceValue become reusable
+		void Retire(uint64_t _completedFenceValue);
+
+		uint32_t GetCapacity() const;
+		uint32_t GetAllocatedCount() const;
+
+		// one past the highest slot ever handed out, the part of the range holding descriptors
+		uint32_t GetUsedRange() const;
+
+	private:
+
+		struct sRetiredSlot
+		{
+			uint64_t	fenceValue;
+			uint32_t	slot;
+		};
+
+		std::vector<uint32_t>		m_freeSlots;		// min heap
+		std::deque<sRetiredSlot>	m_retiredSlots;		// fence values ascending
+		uint32_t					m_capacity;
+		uint32_t					m_usedRange;
+		uint32_t					m_allocatedCount;
+};
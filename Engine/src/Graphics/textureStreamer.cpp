@@ -0,0 +1,417 @@
+#include "textureStreamer.h"
+
+#include <algorithm>
+#include <queue>
+
+#include "textureFootprint.h"
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+struct sStreamingCandidate
+{
+    uint32_t deficit;   // levels between the finest one handed out and the wanted one
+    uint32_t wantedMip;
+    uint32_t texture;
+};
+
+// most starved first, then the one that wants the finer level, then the lower index
+struct sStreamingCandidateOrder
+{
+    bool operator()(const sStreamingCandidate& _rA, const sStreamingCandidate& _rB) const
+    {
+        if (_rA.deficit != _rB.deficit)
+            return _rA.deficit < _rB.deficit;
+
+        if (_rA.wantedMip != _rB.wantedMip)
+            return _rA.wantedMip > _rB.wantedMip;
+
+        return _rA.texture > _rB.texture;
+    }
+};
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+cTextureStreamer::cTextureStreamer()
+    : m_evictionCursor(0)
+    , m_idleBytes(0)
+    , m_memoryBudget(UINT64_MAX)
+    , m_committedBytes(0)
+    , m_streamedBytes(0)
+    , m_evictedBytes(0)
+    , m_frame(0)
+    , m_missingLevels(0)
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTextureStreamer::Initialize(const sStreamedTextureDesc* _pTextures, size_t _textureCount, const sTextureRef* _pRefs, size_t _refCount)
+{
+    m_textures.resize(_textureCount);
+    m_refs.assign(_pRefs, _pRefs + _refCount);
+
+    m_committedBytes    = 0;
+    m_streamedBytes     = 0;
+    m_evictedBytes      = 0;
+    m_frame             = 0;
+    m_missingLevels     = 0;
+
+    for (size_t i = 0; i < _textureCount; ++i)
+    {
+        sTextureState& rState = m_textures[i];
+
+        const uint32_t coarsestMip = (std::min)((std::max)(_pTextures[i].mipLevels, 1u), static_cast<uint32_t>(GFX_MAX_MIP_MAPS_PER_TEXTURE)) - 1;
+
+        rState.desc             = _pTextures[i];
+        rState.desc.mipLevels   = (std::min)(rState.desc.mipLevels, static_cast<uint32_t>(GFX_MAX_MIP_MAPS_PER_TEXTURE));
+        rState.desc.firstMip    = (std::min)(rState.desc.firstMip, coarsestMip);
+        rState.desc.tailMip     = (std::min)((std::max)(rState.desc.tailMip, rState.desc.firstMip), coarsestMip);
+        rState.residentMip      = rState.desc.tailMip;
+        rState.scheduledMip     = rState.desc.tailMip;
+        rState.wantedMip        = rState.desc.tailMip;
+        rState.lastUsedFrame    = 0;
+
+        // Schedule, MakeRoom and GetStats look sizes up every frame
+        for (uint32_t mip = 0; mip < rState.desc.mipLevels; ++mip)
+        {
+            rState.mipByteSizes[mip] = GetMipByteSize(rState.desc, mip);
+        }
+
+        for (uint32_t mip = rState.desc.tailMip; mip < rState.desc.mipLevels; ++mip)
+        {
+            m_committedBytes += rState.mipByteSizes[mip];
+        }
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTextureStreamer::SetMemoryBudget(uint64_t _budgetBytes)
+{
+    m_memoryBudget = _budgetBytes;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTextureStreamer::Request(int _refIndex, float _projectedPixels)
+{
+    if (_refIndex < 0 || static_cast<size_t>(_refIndex) >= m_refs.size())
+        return;
+
+    const sTextureRef& rRef = m_refs[_refIndex];
+
+    if (rRef.descriptorIndex >= m_textures.size())
+        return;
+
+    const sStreamedTextureDesc& rDesc = m_textures[rRef.descriptorIndex].desc;
+
+    // texels of the source texture, an atlas entry only covers its rect of the page
+    const float texels = (std::max)(static_cast<float>(rDesc.width) * rRef.uvRect[2], static_cast<float>(rDesc.height) * rRef.uvRect[3]);
+
+    RequestMip(rRef.descriptorIndex, ComputeMip(texels, _projectedPixels, rDesc.mipLevels));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTextureStreamer::Request(const std::vector<sTextureRequest>& _rRequests)
+{
+    for (const sTextureRequest& rRequest : _rRequests)
+    {
+        Request(rRequest.refIndex, rRequest.projectedPixels);
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTextureStreamer::RequestMip(uint32_t _texture, uint32_t _mip)
+{
+    if (_texture >= m_textures.size())
+        return;
+
+    sTextureState& rState = m_textures[_texture];
+
+    rState.wantedMip        = (std::min)(rState.wantedMip, (std::max)(_mip, rState.desc.firstMip));
+    rState.lastUsedFrame    = m_frame;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTextureStreamer::Schedule(uint64_t _budgetBytes, uint64_t _maxUploadBytes, std::vector<sStreamingUpload>& _rOutUploads,
+    std::vector<sStreamingEviction>& _rOutEvictions)
+{
+    _rOutUploads.clear();
+    _rOutEvictions.clear();
+
+    std::priority_queue<sStreamingCandidate, std::vector<sStreamingCandidate>, sStreamingCandidateOrder> candidates;
+
+    m_missingLevels     = 0;
+    m_idleBytes         = 0;
+    m_evictionCursor    = 0;
+
+    m_evictionOrder.clear();
+
+    for (uint32_t i = 0; i < static_cast<uint32_t>(m_textures.size()); ++i)
+    {
+        const sTextureState& rState = m_textures[i];
+
+        const uint64_t idleBytes = GetIdleBytes(rState);
+
+        if (idleBytes > 0)
+        {
+            m_evictionOrder.push_back(i);
+            m_idleBytes += idleBytes;
+        }
+
+        if (rState.wantedMip < rState.residentMip)
+            m_missingLevels += rState.residentMip - rState.wantedMip;
+
+        if (rState.wantedMip < rState.scheduledMip)
+            candidates.push({ rState.scheduledMip - rState.wantedMip, rState.wantedMip, i });
+    }
+
+    // ties keep the texture order, so the same requests always evict the same levels
+    std::stable_sort(m_evictionOrder.begin(), m_evictionOrder.end(), [this](uint32_t _a, uint32_t _b)
+        {
+            return m_textures[_a].lastUsedFrame < m_textures[_b].lastUsedFrame;
+        });
+
+    // a lowered budget
+    MakeRoom(0, _rOutEvictions);
+
+    uint64_t spentBytes = 0;
+
+    while (!candidates.empty())
+    {
+        const sStreamingCandidate candidate = candidates.top();
+        candidates.pop();
+
+        sTextureState& rState = m_textures[candidate.texture];
+
+        // levels go out coarse to fine, so the ones already resident always form a complete tail
+        const uint32_t mip      = rState.scheduledMip - 1;
+        const uint64_t byteSize = rState.mipByteSizes[mip];
+
+        const bool fitsBudget   = spentBytes + byteSize <= _budgetBytes;
+        const bool oversized    = !fitsBudget && _rOutUploads.empty() && byteSize <= _maxUploadBytes;
+
+        // the texture waits for a later frame, smaller levels of others may still fit
+        if (!fitsBudget && !oversized)
+            continue;
+
+        if (!MakeRoom(byteSize, _rOutEvictions))
+            continue;
+
+        _rOutUploads.push_back({ candidate.texture, mip, byteSize });
+
+        rState.scheduledMip     = mip;
+        spentBytes             += byteSize;
+        m_committedBytes       += byteSize;
+
+        if (oversized)
+            break;
+
+        if (rState.wantedMip < rState.scheduledMip)
+            candidates.push({ rState.scheduledMip - rState.wantedMip, rState.wantedMip, candidate.texture });
+    }
+
+    // requests only live for one frame, nothing finer than the tail is wanted without one
+    for (sTextureState& rState : m_textures)
+    {
+        rState.wantedMip = rState.desc.tailMip;
+    }
+
+    ++m_frame;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+bool cTextureStreamer::MakeRoom(uint64_t _byteSize, std::vector<sStreamingEviction>& _rOutEvictions)
+{
+    if (m_committedBytes + _byteSize <= m_memoryBudget)
+        return true;
+
+    // nothing is evicted for a level that would not fit anyway, a lowered budget evicts what it can
+    if (m_committedBytes + _byteSize > m_memoryBudget + m_idleBytes && _byteSize > 0)
+        return false;
+
+    while (m_committedBytes + _byteSize > m_memoryBudget && m_evictionCursor < m_evictionOrder.size())
+    {
+        const uint32_t  texture = m_evictionOrder[m_evictionCursor];
+        sTextureState&  rState  = m_textures[texture];
+
+        if (rState.residentMip >= rState.wantedMip)
+        {
+            ++m_evictionCursor;
+            continue;
+        }
+
+        // finest level first, the rest stays a complete tail
+        const uint64_t byteSize = rState.mipByteSizes[rState.residentMip];
+
+        ++rState.residentMip;
+
+        rState.scheduledMip  = rState.residentMip;
+        m_committedBytes    -= byteSize;
+        m_idleBytes         -= byteSize;
+        m_evictedBytes      += byteSize;
+
+        // one eviction per texture, the cursor finishes a texture before it moves on
+        if (!_rOutEvictions.empty() && _rOutEvictions.back().texture == texture)
+        {
+            _rOutEvictions.back().mip        = rState.residentMip;
+            _rOutEvictions.back().byteSize  += byteSize;
+        }
+        else
+        {
+            _rOutEvictions.push_back({ texture, rState.residentMip, byteSize });
+        }
+    }
+
+    return m_committedBytes + _byteSize <= m_memoryBudget;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+uint64_t cTextureStreamer::GetIdleBytes(const sTextureState& _rState) const
+{
+    // levels with a copy in flight are not touched
+    if (_rState.residentMip != _rState.scheduledMip)
+        return 0;
+
+    uint64_t byteSize = 0;
+
+    for (uint32_t mip = _rState.residentMip; mip < _rState.wantedMip; ++mip)
+    {
+        byteSize += _rState.mipByteSizes[mip];
+    }
+
+    return byteSize;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTextureStreamer::Cancel(const sStreamingUpload& _rUpload)
+{
+    sTextureState& rState = m_textures[_rUpload.texture];
+
+    rState.scheduledMip = (std::max)(rState.scheduledMip, _rUpload.mip + 1);
+    m_committedBytes   -= _rUpload.byteSize;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTextureStreamer::MarkResident(const sStreamingUpload& _rUpload)
+{
+    sTextureState& rState = m_textures[_rUpload.texture];
+
+    rState.residentMip  = (std::min)(rState.residentMip, _rUpload.mip);
+    m_streamedBytes    += _rUpload.byteSize;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+uint32_t cTextureStreamer::GetResidentMip(uint32_t _texture) const
+{
+    return m_textures[_texture].residentMip;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+size_t cTextureStreamer::GetTextureCount() const
+{
+    return m_textures.size();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+uint64_t cTextureStreamer::GetCommittedBytes() const
+{
+    return m_committedBytes;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+sStreamingStats cTextureStreamer::GetStats() const
+{
+    sStreamingStats stats = {};
+
+    for (const sTextureState& rState : m_textures)
+    {
+        for (uint32_t mip = rState.scheduledMip; mip < rState.desc.mipLevels; ++mip)
+        {
+            const uint64_t byteSize = rState.mipByteSizes[mip];
+
+            if (mip < rState.residentMip)
+                stats.scheduledBytes += byteSize;
+            else
+                stats.residentBytes += byteSize;
+        }
+    }
+
+    stats.streamedBytes = m_streamedBytes;
+    stats.evictedBytes  = m_evictedBytes;
+    stats.budgetBytes   = m_memoryBudget;
+    stats.missingLevels = m_missingLevels;
+
+    return stats;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+uint32_t cTextureStreamer::GetTailMip(uint32_t _width, uint32_t _height, uint32_t _mipLevels, uint32_t _tailSize)
+{
+    uint32_t mip = 0;
+
+    if (_tailSize == 0)
+        return mip;
+
+    while (mip + 1 < _mipLevels && (std::max)(_width >> mip, _height >> mip) > _tailSize)
+    {
+        ++mip;
+    }
+
+    return mip;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+uint64_t cTextureStreamer::GetMipByteSize(const sStreamedTextureDesc& _rTexture, uint32_t _mip)
+{
+    if (_rTexture.arraySize == 0)
+        return 0;
+
+    // every slice has the layout of the first one, the next starts on a placement boundary
+    sSubresourceFootprint footprint;
+
+    const uint64_t sliceBytes = cTextureFootprint::ComputeStaging((std::max)(_rTexture.width >> _mip, 1u), (std::max)(_rTexture.height >> _mip, 1u), 1,
+        1, _rTexture.blockBytes, _rTexture.blockSize, &footprint);
+
+    const uint64_t slicePitch = static_cast<uint64_t>(footprint.rowPitch) * footprint.rowCount;
+    const uint64_t sliceStart = (slicePitch + c_TexturePlacementAlignment - 1) / c_TexturePlacementAlignment * c_TexturePlacementAlignment;
+
+    return sliceStart * (_rTexture.arraySize - 1) + sliceBytes;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+uint32_t cTextureStreamer::ComputeMip(float _texels, float _projectedPixels, uint32_t _mipLevels)
+{
+    if (_mipLevels <= 1)
+        return 0;
+
+    if (!(_projectedPixels > 0.0f))
+        return _mipLevels - 1;
+
+    // halving instead of log2 keeps the result identical across compilers and instruction sets
+    uint32_t mip = 0;
+
+    while (mip + 1 < _mipLevels && _texels * 0.5f >= _projectedPixels)
+    {
+        _texels *= 0.5f;
+        ++mip;
+    }
+
+    return mip;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "gfxConfig.h"
+#include "textureRef.h"
+
+struct sStreamedTextureDesc
+{
+	uint32_t	width;
+	uint32_t	height;
+	uint32_t	mipLevels;		// levels the source carries, every one of them can become resident
+	uint32_t	arraySize;
+	uint32_t	blockBytes;		// bytes per 4x4 block for BCn, per texel otherwise
+	uint32_t	blockSize;		// 4 for BCn, 1 otherwise
+	uint32_t	firstMip;		// finest level that may become resident, above it the resolution cap cuts the chain
+	uint32_t	tailMip;		// first level resident from the start, firstMip = nothing to stream
+};
+
+// a Request recorded on one thread and handed to the streamer's on another
+struct sTextureRequest
+{
+	int			refIndex;
+	float		projectedPixels;
+};
+
+struct sStreamingUpload
+{
+	uint32_t	texture;
+	uint32_t	mip;
+	uint64_t	byteSize;		// staging bytes of the level, every slice
+};
+
+// levels finer than mip are no longer resident
+struct sStreamingEviction
+{
+	uint32_t	texture;
+	uint32_t	mip;
+	uint64_t	byteSize;		// of the dropped levels
+};
+
+struct sStreamingStats
+{
+	uint64_t	residentBytes;
+	uint64_t	scheduledBytes;		// handed out, copy not completed yet
+	uint64_t	streamedBytes;		// completed since Initialize
+	uint64_t	evictedBytes;		// since Initialize
+	uint64_t	budgetBytes;
+	uint32_t	missingLevels;		// levels requested last frame that are not resident
+};
+
+// Decides which texture levels become resident. Every frame the renderer reports how large
+// the surfaces a texture covers appear on screen, the streamer turns that into the finest level
+// worth sampling and hands out the missing levels coarse to fine, most starved texture first,
+// within a byte budget. Resident and scheduled levels stay within a memory budget, levels that
+// were not requested for the longest time are evicted when a requested one needs the room. Mip
+// tails are never evicted. Platform neutral, the caller records the copies and reports back once
+// they completed.
+class cTextureStreamer
+{
+	public:
+
+		cTextureStreamer();
+
+	public:
+
+		// _pRefs maps material texture indices to textures (sTextureRef::descriptorIndex), atlas
+		// entries use their rect to find the texel count of the source texture
+		void Initialize(const sStreamedTextureDesc* _pTextures, size_t _textureCount, const sTextureRef* _pRefs, size_t _refCount);
+
+		// _projectedPixels is the on screen size of the surface the texture is mapped onto,
+		// requests of one frame keep the finest level
+		void Request(int _refIndex, float _projectedPixels);
+		void Request(const std::vector<sTextureRequest>& _rRequests);
+		void RequestMip(uint32_t _texture, uint32_t _mip);
+
+		// resident plus scheduled levels, mip tails included. Lowering it evicts on the next Schedule
+		void SetMemoryBudget(uint64_t _budgetBytes);
+
+		// hands out missing levels for at most _budgetBytes and clears the requests. A level above
+		// the budget still goes out when nothing else was scheduled this frame and it is at most
+		// _maxUploadBytes, so large levels cannot starve. Evictions come first, least recently
+		// requested texture first, and only drop levels no request of this frame reaches
+		void Schedule(uint64_t _budgetBytes, uint64_t _maxUploadBytes, std::vector<sStreamingUpload>& _rOutUploads,
+			std::vector<sStreamingEviction>& _rOutEvictions);
+
+		// a scheduled level could not be recorded, it is handed out again by a later Schedule
+		void Cancel(const sStreamingUpload& _rUpload);
+
+		// the copy of a scheduled level completed, levels of one texture complete coarse to fine
+		void MarkResident(const sStreamingUpload& _rUpload);
+
+		uint32_t		GetResidentMip(uint32_t _texture) const;
+		size_t			GetTextureCount() const;
+		uint64_t		GetCommittedBytes() const;
+		sStreamingStats GetStats() const;
+
+	public:
+
+		// first level whose largest side is at most _tailSize, the coarsest level when none is.
+		// Also the resolution cap, _tailSize 0 = no cap
+		static uint32_t GetTailMip(uint32_t _width, uint32_t _height, uint32_t _mipLevels, uint32_t _tailSize);
+
+		// staging bytes of one level, every slice
+		static uint64_t GetMipByteSize(const sStreamedTextureDesc& _rTexture, uint32_t _mip);
+
+		// finest level that still has at least one texel per pixel when _texels texels span _projectedPixels pixels
+		static uint32_t ComputeMip(float _texels, float _projectedPixels, uint32_t _mipLevels);
+
+	private:
+
+		struct sTextureState
+		{
+			sStreamedTextureDesc	desc;
+			uint32_t				residentMip;	// finest level whose copy completed, all coarser ones are resident
+			uint32_t				scheduledMip;	// finest level handed out, never coarser than residentMip
+			uint32_t				wantedMip;		// finest level requested this frame
+			uint64_t				lastUsedFrame;	// frame of the last request, orders evictions
+			uint64_t				mipByteSizes[GFX_MAX_MIP_MAPS_PER_TEXTURE];	// GetMipByteSize of every level, from Initialize
+		};
+
+		// evicts levels nobody requested until _byteSize more fits the memory budget, false (and
+		// nothing evicted) when even every idle level would not make the room
+		bool MakeRoom(uint64_t _byteSize, std::vector<sStreamingEviction>& _rOutEvictions);
+
+		uint64_t GetIdleBytes(const sTextureState& _rState) const;
+
+		std::vector<sTextureState>	m_textures;
+		std::vector<sTextureRef>	m_refs;
+		std::vector<uint32_t>		m_evictionOrder;	// idle textures of this Schedule, least recently used first
+		size_t						m_evictionCursor;
+		uint64_t					m_idleBytes;		// evictable in this Schedule
+		uint64_t					m_memoryBudget;
+		uint64_t					m_committedBytes;	// resident and scheduled levels
+		uint64_t					m_streamedBytes;
+		uint64_t					m_evictedBytes;
+		uint64_t					m_frame;
+		uint32_t					m_missingLevels;
+};
@@ -0,0 +1,497 @@
+#include "transformSystem.h"
+
+#include <bitset>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__)
+#define TRANSFORM_SYSTEM_SSE2 1
+#include <emmintrin.h>
+#else
+#define TRANSFORM_SYSTEM_SSE2 0
+#endif
+
+#if TRANSFORM_SYSTEM_SSE2 && defined(__AVX__)
+#define TRANSFORM_SYSTEM_AVX 1
+#include <immintrin.h>
+#else
+#define TRANSFORM_SYSTEM_AVX 0
+#endif
+
+// entries per dirty bitset word
+constexpr uint32_t  c_EntriesPerWord        = 64;
+
+// relative tolerance of the row lengths and dot products for a uniform scale
+constexpr float     c_UniformScaleEpsilon   = 1.0e-4f;
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+#if !TRANSFORM_SYSTEM_SSE2
+// the 3x3 has orthogonal rows of equal length, a rotation (or mirroring) times a scale
+static bool IsUniformlyScaled(const float* _pM)
+{
+    const float lengthSq0   = _pM[0] * _pM[0] + _pM[1] * _pM[1] + _pM[2] * _pM[2];
+    const float lengthSq1   = _pM[3] * _pM[3] + _pM[4] * _pM[4] + _pM[5] * _pM[5];
+    const float lengthSq2   = _pM[6] * _pM[6] + _pM[7] * _pM[7] + _pM[8] * _pM[8];
+    const float dot01       = _pM[0] * _pM[3] + _pM[1] * _pM[4] + _pM[2] * _pM[5];
+    const float dot12       = _pM[3] * _pM[6] + _pM[4] * _pM[7] + _pM[5] * _pM[8];
+    const float dot20       = _pM[6] * _pM[0] + _pM[7] * _pM[1] + _pM[8] * _pM[2];
+    const float tolerance   = c_UniformScaleEpsilon * lengthSq0;
+
+    return lengthSq0 > 0.0f && lengthSq0 <= FLT_MAX
+        && std::fabs(lengthSq1 - lengthSq0) <= tolerance
+        && std::fabs(lengthSq2 - lengthSq0) <= tolerance
+        && std::fabs(dot01) <= tolerance
+        && std::fabs(dot12) <= tolerance
+        && std::fabs(dot20) <= tolerance;
+}
+#endif
+
+// The inverse transpose of the 3x3 with rows a, b, c has the rows b x c, c x a and a x b divided
+// by the determinant a . (b x c). For M = s * R it is R / s = M / s^2, no inverse needed. The
+// kernels classify a group of lanes like IsUniformlyScaled, skip the inverse when no dirty lane
+// needs it and keep the lanes that are not dirty. They return the lanes that were inverted.
+#if TRANSFORM_SYSTEM_AVX
+static __m256 LaneSelect8(uint32_t _mask)
+{
+    return _mm256_castsi256_ps(_mm256_setr_epi32(
+        -static_cast<int>(_mask & 1),           -static_cast<int>((_mask >> 1) & 1),
+        -static_cast<int>((_mask >> 2) & 1),    -static_cast<int>((_mask >> 3) & 1),
+        -static_cast<int>((_mask >> 4) & 1),    -static_cast<int>((_mask >> 5) & 1),
+        -static_cast<int>((_mask >> 6) & 1),    -static_cast<int>((_mask >> 7) & 1)));
+}
+
+static __m256 Dot3x8(const __m256* _pA, const __m256* _pB)
+{
+    return _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_pA[0], _pB[0]), _mm256_mul_ps(_pA[1], _pB[1])), _mm256_mul_ps(_pA[2], _pB[2]));
+}
+
+static uint32_t UpdateLanes8(const float (*_pWorld)[8], float (*_pNormal)[8], uint32_t _dirtyMask)
+{
+    __m256 m[9];
+
+    for (int i = 0; i < 9; ++i)
+    {
+        m[i] = _mm256_load_ps(_pWorld[i]);
+    }
+
+    const __m256 absMask    = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    const __m256 lengthSq   = Dot3x8(m, m);
+    const __m256 tolerance  = _mm256_mul_ps(_mm256_set1_ps(c_UniformScaleEpsilon), lengthSq);
+
+    auto IsSmall = [&](__m256 _value)
+        {
+            return _mm256_cmp_ps(_mm256_and_ps(_value, absMask), tolerance, _CMP_LE_OQ);
+        };
+
+    __m256 uniform = _mm256_and_ps(_mm256_cmp_ps(lengthSq, _mm256_setzero_ps(), _CMP_GT_OQ), _mm256_cmp_ps(lengthSq, _mm256_set1_ps(FLT_MAX), _CMP_LE_OQ));
+
+    uniform = _mm256_and_ps(uniform, IsSmall(_mm256_sub_ps(Dot3x8(m + 3, m + 3), lengthSq)));
+    uniform = _mm256_and_ps(uniform, IsSmall(_mm256_sub_ps(Dot3x8(m + 6, m + 6), lengthSq)));
+    uniform = _mm256_and_ps(uniform, IsSmall(Dot3x8(m, m + 3)));
+    uniform = _mm256_and_ps(uniform, IsSmall(Dot3x8(m + 3, m + 6)));
+    uniform = _mm256_and_ps(uniform, IsSmall(Dot3x8(m + 6, m)));
+
+    const uint32_t scaledMask   = static_cast<uint32_t>(_mm256_movemask_ps(uniform)) & _dirtyMask;
+    const uint32_t generalMask  = _dirtyMask & ~scaledMask;
+
+    __m256 n[9];
+
+    if (scaledMask != 0)
+    {
+        const __m256 invScaleSq = _mm256_div_ps(_mm256_set1_ps(1.0f), lengthSq);
+
+        for (int i = 0; i < 9; ++i)
+        {
+            n[i] = _mm256_mul_ps(m[i], invScaleSq);
+        }
+    }
+
+    if (generalMask != 0)
+    {
+        __m256 c[9];
+
+        c[0] = _mm256_sub_ps(_mm256_mul_ps(m[4], m[8]), _mm256_mul_ps(m[5], m[7]));
+        c[1] = _mm256_sub_ps(_mm256_mul_ps(m[5], m[6]), _mm256_mul_ps(m[3], m[8]));
+        c[2] = _mm256_sub_ps(_mm256_mul_ps(m[3], m[7]), _mm256_mul_ps(m[4], m[6]));
+        c[3] = _mm256_sub_ps(_mm256_mul_ps(m[7], m[2]), _mm256_mul_ps(m[8], m[1]));
+        c[4] = _mm256_sub_ps(_mm256_mul_ps(m[8], m[0]), _mm256_mul_ps(m[6], m[2]));
+        c[5] = _mm256_sub_ps(_mm256_mul_ps(m[6], m[1]), _mm256_mul_ps(m[7], m[0]));
+        c[6] = _mm256_sub_ps(_mm256_mul_ps(m[1], m[5]), _mm256_mul_ps(m[2], m[4]));
+        c[7] = _mm256_sub_ps(_mm256_mul_ps(m[2], m[3]), _mm256_mul_ps(m[0], m[5]));
+        c[8] = _mm256_sub_ps(_mm256_mul_ps(m[0], m[4]), _mm256_mul_ps(m[1], m[3]));
+
+        const __m256 invDet = _mm256_div_ps(_mm256_set1_ps(1.0f), Dot3x8(m, c));
+
+        for (int i = 0; i < 9; ++i)
+        {
+            const __m256 inverted = _mm256_mul_ps(c[i], invDet);
+
+            n[i] = scaledMask != 0 ? _mm256_blendv_ps(inverted, n[i], uniform) : inverted;
+        }
+    }
+
+    if (_dirtyMask == 0xFF)
+    {
+        for (int i = 0; i < 9; ++i)
+        {
+            _mm256_store_ps(_pNormal[i], n[i]);
+        }
+    }
+    else
+    {
+        const __m256 dirty = LaneSelect8(_dirtyMask);
+
+        for (int i = 0; i < 9; ++i)
+        {
+            _mm256_store_ps(_pNormal[i], _mm256_blendv_ps(_mm256_load_ps(_pNormal[i]), n[i], dirty));
+        }
+    }
+
+    return generalMask;
+}
+#elif TRANSFORM_SYSTEM_SSE2
+static __m128 LaneSelect4(uint32_t _mask)
+{
+    return _mm_castsi128_ps(_mm_setr_epi32(
+        -static_cast<int>(_mask & 1),           -static_cast<int>((_mask >> 1) & 1),
+        -static_cast<int>((_mask >> 2) & 1),    -static_cast<int>((_mask >> 3) & 1)));
+}
+
+// _b where _select is set, _a elsewhere
+static __m128 Select4(__m128 _select, __m128 _a, __m128 _b)
+{
+    return _mm_or_ps(_mm_and_ps(_select, _b), _mm_andnot_ps(_select, _a));
+}
+
+static __m128 Dot3x4(const __m128* _pA, const __m128* _pB)
+{
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(_pA[0], _pB[0]), _mm_mul_ps(_pA[1], _pB[1])), _mm_mul_ps(_pA[2], _pB[2]));
+}
+
+// the four lanes from _lane on of an eight wide block
+static uint32_t UpdateLanes4(const float (*_pWorld)[8], float (*_pNormal)[8], uint32_t _lane, uint32_t _dirtyMask)
+{
+    __m128 m[9];
+
+    for (int i = 0; i < 9; ++i)
+    {
+        m[i] = _mm_load_ps(_pWorld[i] + _lane);
+    }
+
+    const __m128 absMask    = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    const __m128 lengthSq   = Dot3x4(m, m);
+    const __m128 tolerance  = _mm_mul_ps(_mm_set1_ps(c_UniformScaleEpsilon), lengthSq);
+
+    auto IsSmall = [&](__m128 _value)
+        {
+            return _mm_cmple_ps(_mm_and_ps(_value, absMask), tolerance);
+        };
+
+    __m128 uniform = _mm_and_ps(_mm_cmpgt_ps(lengthSq, _mm_setzero_ps()), _mm_cmple_ps(lengthSq, _mm_set1_ps(FLT_MAX)));
+
+    uniform = _mm_and_ps(uniform, IsSmall(_mm_sub_ps(Dot3x4(m + 3, m + 3), lengthSq)));
+    uniform = _mm_and_ps(uniform, IsSmall(_mm_sub_ps(Dot3x4(m + 6, m + 6), lengthSq)));
+    uniform = _mm_and_ps(uniform, IsSmall(Dot3x4(m, m + 3)));
+    uniform = _mm_and_ps(uniform, IsSmall(Dot3x4(m + 3, m + 6)));
+    uniform = _mm_and_ps(uniform, IsSmall(Dot3x4(m + 6, m)));
+
+    const uint32_t scaledMask   = static_cast<uint32_t>(_mm_movemask_ps(uniform)) & _dirtyMask;
+    const uint32_t generalMask  = _dirtyMask & ~scaledMask;
+
+    __m128 n[9];
+
+    if (scaledMask != 0)
+    {
+        const __m128 invScaleSq = _mm_div_ps(_mm_set1_ps(1.0f), lengthSq);
+
+        for (int i = 0; i < 9; ++i)
+        {
+            n[i] = _mm_mul_ps(m[i], invScaleSq);
+        }
+    }
+
+    if (generalMask != 0)
+    {
+        __m128 c[9];
+
+        c[0] = _mm_sub_ps(_mm_mul_ps(m[4], m[8]), _mm_mul_ps(m[5], m[7]));
+        c[1] = _mm_sub_ps(_mm_mul_ps(m[5], m[6]), _mm_mul_ps(m[3], m[8]));
+        c[2] = _mm_sub_ps(_mm_mul_ps(m[3], m[7]), _mm_mul_ps(m[4], m[6]));
+        c[3] = _mm_sub_ps(_mm_mul_ps(m[7], m[2]), _mm_mul_ps(m[8], m[1]));
+        c[4] = _mm_sub_ps(_mm_mul_ps(m[8], m[0]), _mm_mul_ps(m[6], m[2]));
+        c[5] = _mm_sub_ps(_mm_mul_ps(m[6], m[1]), _mm_mul_ps(m[7], m[0]));
+        c[6] = _mm_sub_ps(_mm_mul_ps(m[1], m[5]), _mm_mul_ps(m[2], m[4]));
+        c[7] = _mm_sub_ps(_mm_mul_ps(m[2], m[3]), _mm_mul_ps(m[0], m[5]));
+        c[8] = _mm_sub_ps(_mm_mul_ps(m[0], m[4]), _mm_mul_ps(m[1], m[3]));
+
+        const __m128 invDet = _mm_div_ps(_mm_set1_ps(1.0f), Dot3x4(m, c));
+
+        for (int i = 0; i < 9; ++i)
+        {
+            const __m128 inverted = _mm_mul_ps(c[i], invDet);
+
+            n[i] = scaledMask != 0 ? Select4(uniform, inverted, n[i]) : inverted;
+        }
+    }
+
+    const __m128 dirty = LaneSelect4(_dirtyMask);
+
+    for (int i = 0; i < 9; ++i)
+    {
+        _mm_store_ps(_pNormal[i] + _lane, _dirtyMask == 0xF ? n[i] : Select4(dirty, _mm_load_ps(_pNormal[i] + _lane), n[i]));
+    }
+
+    return generalMask;
+}
+#else
+static bool UpdateLane(const float (*_pWorld)[8], float (*_pNormal)[8], uint32_t _lane)
+{
+    float m[9];
+
+    for (int i = 0; i < 9; ++i)
+    {
+        m[i] = _pWorld[i][_lane];
+    }
+
+    if (IsUniformlyScaled(m))
+    {
+        const float invScaleSq = 1.0f / (m[0] * m[0] + m[1] * m[1] + m[2] * m[2]);
+
+        for (int i = 0; i < 9; ++i)
+        {
+            _pNormal[i][_lane] = m[i] * invScaleSq;
+        }
+
+        return false;
+    }
+
+    float c[9];
+
+    c[0] = m[4] * m[8] - m[5] * m[7];
+    c[1] = m[5] * m[6] - m[3] * m[8];
+    c[2] = m[3] * m[7] - m[4] * m[6];
+    c[3] = m[7] * m[2] - m[8] * m[1];
+    c[4] = m[8] * m[0] - m[6] * m[2];
+    c[5] = m[6] * m[1] - m[7] * m[0];
+    c[6] = m[1] * m[5] - m[2] * m[4];
+    c[7] = m[2] * m[3] - m[0] * m[5];
+    c[8] = m[0] * m[4] - m[1] * m[3];
+
+    const float invDet = 1.0f / (m[0] * c[0] + m[1] * c[1] + m[2] * c[2]);
+
+    for (int i = 0; i < 9; ++i)
+    {
+        _pNormal[i][_lane] = c[i] * invDet;
+    }
+
+    return true;
+}
+#endif
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+cTransformSystem::cTransformSystem()
+    : m_capacity(0)
+    , m_invertedCount(0)
+    , m_scaledCount(0)
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTransformSystem::Initialize(uint32_t _capacity)
+{
+    const uint32_t wordCount = (_capacity + c_EntriesPerWord - 1) / c_EntriesPerWord;
+
+    // identity, the diagonal is components 0, 4 and 8 of both
+    sTransformBlock identity = {};
+
+    for (uint32_t lane = 0; lane < c_Lanes; ++lane)
+    {
+        identity.world[0][lane]     = identity.world[4][lane]   = identity.world[8][lane]   = 1.0f;
+        identity.normal[0][lane]    = identity.normal[4][lane]  = identity.normal[8][lane]  = 1.0f;
+    }
+
+    m_blocks.assign(wordCount * (c_EntriesPerWord / c_Lanes), identity);
+    m_dirty.assign(wordCount, 0);
+
+    m_capacity      = _capacity;
+    m_invertedCount = 0;
+    m_scaledCount   = 0;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTransformSystem::SetWorld(uint32_t _index, const XMFLOAT4X4& _rWorld)
+{
+    assert(_index < m_capacity);
+
+    const float components[12] =
+    {
+        _rWorld._11, _rWorld._12, _rWorld._13,
+        _rWorld._21, _rWorld._22, _rWorld._23,
+        _rWorld._31, _rWorld._32, _rWorld._33,
+        _rWorld._41, _rWorld._42, _rWorld._43,
+    };
+
+    sTransformBlock&    rBlock  = m_blocks[_index / c_Lanes];
+    const uint32_t      lane    = _index % c_Lanes;
+
+    bool hasChanged = false;
+
+    for (int i = 0; i < 12; ++i)
+    {
+        hasChanged |= rBlock.world[i][lane] != components[i];
+
+        rBlock.world[i][lane] = components[i];
+    }
+
+    if (!hasChanged)
+        return;
+
+    const uint32_t word = _index / c_EntriesPerWord;
+    const uint64_t bit  = 1ull << (_index % c_EntriesPerWord);
+
+    m_dirty[word] |= bit;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTransformSystem::Update()
+{
+    uint32_t dirtyCount = 0;
+
+    m_invertedCount = 0;
+
+    for (size_t word = 0; word < m_dirty.size(); ++word)
+    {
+        const uint64_t dirty = m_dirty[word];
+
+        if (dirty == 0)
+            continue;
+
+        dirtyCount += static_cast<uint32_t>(std::bitset<64>(dirty).count());
+
+        for (uint32_t lane = 0; lane < c_EntriesPerWord; lane += c_Lanes)
+        {
+            const uint32_t dirtyMask = static_cast<uint32_t>(dirty >> lane) & 0xFF;
+
+            if (dirtyMask == 0)
+                continue;
+
+            sTransformBlock& rBlock = m_blocks[(word * c_EntriesPerWord + lane) / c_Lanes];
+
+            uint32_t invertedMask = 0;
+
+#if TRANSFORM_SYSTEM_AVX
+            invertedMask = UpdateLanes8(rBlock.world, rBlock.normal, dirtyMask);
+#elif TRANSFORM_SYSTEM_SSE2
+            if ((dirtyMask & 0xF) != 0)
+                invertedMask |= UpdateLanes4(rBlock.world, rBlock.normal, 0, dirtyMask & 0xF);
+
+            if ((dirtyMask >> 4) != 0)
+                invertedMask |= UpdateLanes4(rBlock.world, rBlock.normal, 4, dirtyMask >> 4) << 4;
+#else
+            for (uint32_t i = 0; i < c_Lanes; ++i)
+            {
+                if ((dirtyMask & (1u << i)) != 0 && UpdateLane(rBlock.world, rBlock.normal, i))
+                    invertedMask |= 1u << i;
+            }
+#endif
+
+            m_invertedCount += static_cast<uint32_t>(std::bitset<8>(invertedMask).count());
+        }
+
+        m_dirty[word] = 0;
+    }
+
+    m_scaledCount = dirtyCount - m_invertedCount;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTransformSystem::GetWorldTransposed(uint32_t _index, XMFLOAT4X4& _rOutMatrix) const
+{
+    assert(_index < m_capacity);
+
+    const sTransformBlock&  rBlock  = m_blocks[_index / c_Lanes];
+    const uint32_t          lane    = _index % c_Lanes;
+
+    _rOutMatrix = XMFLOAT4X4(
+        rBlock.world[0][lane], rBlock.world[3][lane], rBlock.world[6][lane], rBlock.world[9][lane],
+        rBlock.world[1][lane], rBlock.world[4][lane], rBlock.world[7][lane], rBlock.world[10][lane],
+        rBlock.world[2][lane], rBlock.world[5][lane], rBlock.world[8][lane], rBlock.world[11][lane],
+        0.0f,                  0.0f,                  0.0f,                  1.0f);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTransformSystem::GetInverseTranspose(uint32_t _index, XMFLOAT4X4& _rOutMatrix) const
+{
+    assert(_index < m_capacity);
+
+    const sTransformBlock&  rBlock  = m_blocks[_index / c_Lanes];
+    const uint32_t          lane    = _index % c_Lanes;
+
+    // of the translation free matrix, the translation stays 0
+    _rOutMatrix = XMFLOAT4X4(
+        rBlock.normal[0][lane], rBlock.normal[1][lane], rBlock.normal[2][lane], 0.0f,
+        rBlock.normal[3][lane], rBlock.normal[4][lane], rBlock.normal[5][lane], 0.0f,
+        rBlock.normal[6][lane], rBlock.normal[7][lane], rBlock.normal[8][lane], 0.0f,
+        0.0f,                   0.0f,                   0.0f,                   1.0f);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTransformSystem::WriteConstants(uint32_t _index, XMFLOAT4X4& _rOutWorld, XMFLOAT4X4& _rOutInverseTranspose) const
+{
+    assert(_index < m_capacity);
+
+    const sTransformBlock&  rBlock  = m_blocks[_index / c_Lanes];
+    const uint32_t          lane    = _index % c_Lanes;
+
+#if TRANSFORM_SYSTEM_SSE2
+    // whole rows, the destination is write combined and takes 16 byte stores best
+    const float (*pW)[c_Lanes] = rBlock.world;
+    const float (*pN)[c_Lanes] = rBlock.normal;
+
+    _mm_storeu_ps(&_rOutWorld._11, _mm_setr_ps(pW[0][lane], pW[3][lane], pW[6][lane], pW[9][lane]));
+    _mm_storeu_ps(&_rOutWorld._21, _mm_setr_ps(pW[1][lane], pW[4][lane], pW[7][lane], pW[10][lane]));
+    _mm_storeu_ps(&_rOutWorld._31, _mm_setr_ps(pW[2][lane], pW[5][lane], pW[8][lane], pW[11][lane]));
+    _mm_storeu_ps(&_rOutWorld._41, _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f));
+
+    _mm_storeu_ps(&_rOutInverseTranspose._11, _mm_setr_ps(pN[0][lane], pN[1][lane], pN[2][lane], 0.0f));
+    _mm_storeu_ps(&_rOutInverseTranspose._21, _mm_setr_ps(pN[3][lane], pN[4][lane], pN[5][lane], 0.0f));
+    _mm_storeu_ps(&_rOutInverseTranspose._31, _mm_setr_ps(pN[6][lane], pN[7][lane], pN[8][lane], 0.0f));
+    _mm_storeu_ps(&_rOutInverseTranspose._41, _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f));
+#else
+    (void)rBlock;
+    (void)lane;
+
+    GetWorldTransposed(_index, _rOutWorld);
+    GetInverseTranspose(_index, _rOutInverseTranspose);
+#endif
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+uint32_t cTransformSystem::GetCapacity() const
+{
+    return m_capacity;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+uint32_t cTransformSystem::GetInvertedCount() const
+{
+    return m_invertedCount;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+uint32_t cTransformSystem::GetScaledCount() const
+{
+    return m_scaledCount;
+}
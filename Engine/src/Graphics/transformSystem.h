@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+
+using namespace DirectX;
+
+// a world matrix for one entry, the game thread hands the renderer one for every moved item
+struct sTransformUpdate
+{
+	uint32_t	index;
+	XMFLOAT4X4	world;
+};
+
+// World matrices of the object constants in structure of arrays form (blocks of eight entries),
+// one entry per object constant buffer slot. SetWorld marks an entry dirty when its matrix
+// changed, Update then recomputes the inverse transpose of the upper 3x3 (the normal matrix)
+// of every dirty entry eight (AVX) or four (SSE2) at a time. Rigid and uniformly scaled
+// matrices skip the inverse, their inverse transpose is the matrix divided by the squared
+// scale. Matrices are affine, the last column is (0, 0, 0, 1). The renderer keeps the only copy
+// of the item transforms here and writes the constants straight from it.
+class cTransformSystem
+{
+	public:
+
+		cTransformSystem();
+
+	public:
+
+		// _capacity entries set to identity
+		void Initialize(uint32_t _capacity);
+
+		// marks the entry dirty unless it holds the same matrix already
+		void SetWorld(uint32_t _index, const XMFLOAT4X4& _rWorld);
+
+		// recomputes the dirty entries and clears their bits
+		void Update();
+
+		// laid out the way sObjectConstants::world and worldInvTranspose hold them
+		void GetWorldTransposed(uint32_t _index, XMFLOAT4X4& _rOutMatrix) const;
+		void GetInverseTranspose(uint32_t _index, XMFLOAT4X4& _rOutMatrix) const;
+
+		// both of the above in one go, straight into the mapped constants of an item
+		void WriteConstants(uint32_t _index, XMFLOAT4X4& _rOutWorld, XMFLOAT4X4& _rOutInverseTranspose) const;
+
+		uint32_t GetCapacity() const;
+
+		// entries recomputed by the last Update, with and without the inverse
+		uint32_t GetInvertedCount() const;
+		uint32_t GetScaledCount() const;
+
+	private:
+
+		static constexpr uint32_t c_Lanes = 8;
+
+		// c_Lanes entries side by side, a kernel loads every component as one vector
+		struct alignas(32) sTransformBlock
+		{
+			float	world[12][c_Lanes];		// rows 0-2 of the 3x3 part, then the translation
+			float	normal[9][c_Lanes];		// inverse transpose of the 3x3 part
+		};
+
+		std::vector<sTransformBlock>	m_blocks;
+		std::vector<uint64_t>			m_dirty;		// one bit per entry
+		uint32_t						m_capacity;
+		uint32_t						m_invertedCount;
+		uint32_t						m_scaledCount;
+};
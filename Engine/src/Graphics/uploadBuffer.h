@@ -72,6 +72,12 @@ public:
         memcpy(&m_pMappedData[_elementIndex * m_elementByteSize], &_rData, sizeof(T));
     }
 
+    // to write an element in place, the upload heap is write combined so never read it
+    T& GetElement(int _elementIndex)
+    {
+        return *reinterpret_cast<T*>(&m_pMappedData[_elementIndex * m_elementByteSize]);
+    }
+
 private:
     BYTE* m_pMappedData;
     Microsoft::WRL::ComPtr<ID3D12Resource> m_pUploadBuffer;
@@ -0,0 +1,378 @@
+#include "vertexQuantization.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+uint16_t cVertexQuantization::FloatToHalf(float _value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &_value, sizeof(bits));
+
+    const uint32_t sign     = (bits >> 16) & 0x8000u;
+    const uint32_t absBits  = bits & 0x7FFFFFFFu;
+
+    // NaN / Inf
+    if (absBits >= 0x7F800000u)
+        return static_cast<uint16_t>(sign | 0x7C00u | (absBits > 0x7F800000u ? 0x200u : 0u));
+
+    // overflow -> Inf
+    if (absBits >= 0x477FF000u)
+        return static_cast<uint16_t>(sign | 0x7C00u);
+
+    // normal half range
+    if (absBits >= 0x38800000u)
+    {
+        const uint32_t rounded = absBits + 0x0FFFu + ((absBits >> 13) & 1u); // round to nearest even
+        return static_cast<uint16_t>(sign | ((rounded - 0x38000000u) >> 13));
+    }
+
+    // subnormal half or zero
+    if (absBits < 0x33000000u)
+        return static_cast<uint16_t>(sign);
+
+    const uint32_t exponent = absBits >> 23;
+    const uint32_t mantissa = (absBits & 0x7FFFFFu) | 0x800000u;
+    const uint32_t shift    = 126u - exponent; // 14..24
+
+    uint32_t half = mantissa >> shift;
+
+    const uint32_t remainder = mantissa & ((1u << shift) - 1u);
+    const uint32_t halfway   = 1u << (shift - 1u);
+
+    if (remainder > halfway || (remainder == halfway && (half & 1u)))
+        ++half;
+
+    return static_cast<uint16_t>(sign | half);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+float cVertexQuantization::HalfToFloat(uint16_t _half)
+{
+    const uint32_t sign     = (static_cast<uint32_t>(_half) & 0x8000u) << 16;
+    const uint32_t exponent = (_half >> 10) & 0x1Fu;
+    const uint32_t mantissa = _half & 0x3FFu;
+
+    uint32_t bits;
+
+    if (exponent == 0)
+    {
+        if (mantissa == 0)
+        {
+            bits = sign;
+        }
+        else
+        {
+            // subnormal: exact in single precision
+            const float value = std::ldexp(static_cast<float>(mantissa), -24);
+            std::memcpy(&bits, &value, sizeof(bits));
+            bits |= sign;
+        }
+    }
+    else if (exponent == 31)
+    {
+        bits = sign | 0x7F800000u | (mantissa << 13);
+    }
+    else
+    {
+        bits = sign | ((exponent + 112u) << 23) | (mantissa << 13);
+    }
+
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+
+    return value;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+uint16_t cVertexQuantization::QuantizeUnorm16(float _value)
+{
+    const float clamped = std::min(std::max(_value, 0.0f), 1.0f);
+
+    return static_cast<uint16_t>(std::lround(clamped * 65535.0f));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+float cVertexQuantization::DequantizeUnorm16(uint16_t _value)
+{
+    return static_cast<float>(_value) / 65535.0f;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+int16_t cVertexQuantization::QuantizeSnorm16(float _value)
+{
+    const float clamped = std::min(std::max(_value, -1.0f), 1.0f);
+
+    return static_cast<int16_t>(std::lround(clamped * 32767.0f));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+float cVertexQuantization::DequantizeSnorm16(int16_t _value)
+{
+    // D3D SNORM: -32768 and -32767 both map to -1
+    return std::max(static_cast<float>(_value) / 32767.0f, -1.0f);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cVertexQuantization::EncodeOctahedral(const float _normal[3], int16_t _outEncoded[2])
+{
+    const float l1 = std::fabs(_normal[0]) + std::fabs(_normal[1]) + std::fabs(_normal[2]);
+
+    if (l1 <= 0.0f)
+    {
+        _outEncoded[0] = 0;
+        _outEncoded[1] = 0;
+        return;
+    }
+
+    float x = _normal[0] / l1;
+    float y = _normal[1] / l1;
+
+    // fold the lower hemisphere over the diagonals
+    if (_normal[2] < 0.0f)
+    {
+        const float foldedX = (1.0f - std::fabs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        const float foldedY = (1.0f - std::fabs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+
+        x = foldedX;
+        y = foldedY;
+    }
+
+    _outEncoded[0] = QuantizeSnorm16(x);
+    _outEncoded[1] = QuantizeSnorm16(y);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cVertexQuantization::DecodeOctahedral(const int16_t _encoded[2], float _outNormal[3])
+{
+    float x = DequantizeSnorm16(_encoded[0]);
+    float y = DequantizeSnorm16(_encoded[1]);
+    float z = 1.0f - std::fabs(x) - std::fabs(y);
+
+    const float t = std::max(-z, 0.0f);
+
+    x += x >= 0.0f ? -t : t;
+    y += y >= 0.0f ? -t : t;
+
+    const float length = std::sqrt(x * x + y * y + z * z);
+
+    _outNormal[0] = x / length;
+    _outNormal[1] = y / length;
+    _outNormal[2] = z / length;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cVertexQuantization::EncodeQTangent(const float _normal[3], const float _tangent[4], int16_t _outEncoded[4])
+{
+    float n[3] = { _normal[0], _normal[1], _normal[2] };
+
+    float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+    if (length <= 0.0f)
+    {
+        n[0] = 0.0f; n[1] = 0.0f; n[2] = 1.0f;
+    }
+    else
+    {
+        n[0] /= length; n[1] /= length; n[2] /= length;
+    }
+
+    // Gram-Schmidt, the quaternion can only describe an orthonormal frame
+    const float nDotT = n[0] * _tangent[0] + n[1] * _tangent[1] + n[2] * _tangent[2];
+
+    float t[3] =
+    {
+        _tangent[0] - n[0] * nDotT,
+        _tangent[1] - n[1] * nDotT,
+        _tangent[2] - n[2] * nDotT,
+    };
+
+    length = std::sqrt(t[0] * t[0] + t[1] * t[1] + t[2] * t[2]);
+
+    if (length <= 1e-6f)
+    {
+        // any perpendicular will do, pick the axis least aligned with the normal
+        const float axis[3] = { std::fabs(n[0]) < 0.9f ? 1.0f : 0.0f, std::fabs(n[0]) < 0.9f ? 0.0f : 1.0f, 0.0f };
+        const float nDotA   = n[0] * axis[0] + n[1] * axis[1];
+
+        t[0] = axis[0] - n[0] * nDotA;
+        t[1] = axis[1] - n[1] * nDotA;
+        t[2] = axis[2] - n[2] * nDotA;
+
+        length = std::sqrt(t[0] * t[0] + t[1] * t[1] + t[2] * t[2]);
+    }
+
+    t[0] /= length; t[1] /= length; t[2] /= length;
+
+    // rotation matrix with the columns T, cross(N, T), N
+    const float b[3] =
+    {
+        n[1] * t[2] - n[2] * t[1],
+        n[2] * t[0] - n[0] * t[2],
+        n[0] * t[1] - n[1] * t[0],
+    };
+
+    const float m00 = t[0], m01 = b[0], m02 = n[0];
+    const float m10 = t[1], m11 = b[1], m12 = n[1];
+    const float m20 = t[2], m21 = b[2], m22 = n[2];
+
+    float q[4]; // x, y, z, w
+    const float trace = m00 + m11 + m22;
+
+    if (trace > 0.0f)
+    {
+        const float s = 0.5f / std::sqrt(trace + 1.0f);
+        q[3] = 0.25f / s;
+        q[0] = (m21 - m12) * s;
+        q[1] = (m02 - m20) * s;
+        q[2] = (m10 - m01) * s;
+    }
+    else if (m00 > m11 && m00 > m22)
+    {
+        const float s = 2.0f * std::sqrt(1.0f + m00 - m11 - m22);
+        q[3] = (m21 - m12) / s;
+        q[0] = 0.25f * s;
+        q[1] = (m01 + m10) / s;
+        q[2] = (m02 + m20) / s;
+    }
+    else if (m11 > m22)
+    {
+        const float s = 2.0f * std::sqrt(1.0f + m11 - m00 - m22);
+        q[3] = (m02 - m20) / s;
+        q[0] = (m01 + m10) / s;
+        q[1] = 0.25f * s;
+        q[2] = (m12 + m21) / s;
+    }
+    else
+    {
+        const float s = 2.0f * std::sqrt(1.0f + m22 - m00 - m11);
+        q[3] = (m10 - m01) / s;
+        q[0] = (m02 + m20) / s;
+        q[1] = (m12 + m21) / s;
+        q[2] = 0.25f * s;
+    }
+
+    // q and -q are the same rotation, keep w positive so its sign is free for the handedness
+    if (q[3] < 0.0f)
+    {
+        q[0] = -q[0]; q[1] = -q[1]; q[2] = -q[2]; q[3] = -q[3];
+    }
+
+    // w must not quantise to 0 or the handedness is lost
+    const float bias = 1.0f / 32767.0f;
+
+    if (q[3] < bias)
+    {
+        const float scale = std::sqrt(1.0f - bias * bias);
+
+        q[0] *= scale; q[1] *= scale; q[2] *= scale;
+        q[3] = bias;
+    }
+
+    const float sign = _tangent[3] < 0.0f ? -1.0f : 1.0f;
+
+    for (int i = 0; i < 4; ++i)
+    {
+        _outEncoded[i] = QuantizeSnorm16(q[i] * sign);
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cVertexQuantization::DecodeQTangent(const int16_t _encoded[4], float _outNormal[3], float _outTangent[4])
+{
+    float x = DequantizeSnorm16(_encoded[0]);
+    float y = DequantizeSnorm16(_encoded[1]);
+    float z = DequantizeSnorm16(_encoded[2]);
+    float w = DequantizeSnorm16(_encoded[3]);
+
+    const float length = std::sqrt(x * x + y * y + z * z + w * w);
+
+    x /= length; y /= length; z /= length; w /= length;
+
+    _outTangent[0] = 1.0f - 2.0f * (y * y + z * z);
+    _outTangent[1] = 2.0f * (x * y + w * z);
+    _outTangent[2] = 2.0f * (x * z - w * y);
+    _outTangent[3] = w < 0.0f ? -1.0f : 1.0f;
+
+    _outNormal[0] = 2.0f * (x * z + w * y);
+    _outNormal[1] = 2.0f * (y * z - w * x);
+    _outNormal[2] = 1.0f - 2.0f * (x * x + y * y);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+sVertexQuantized cVertexQuantization::Pack(const float _position[3], const float _normal[3], const float _tangent[4], 
+    const float _texC[2], const float _texC2[2], const float _boundsMin[3], const float _boundsExtent[3])
+{
+    sVertexQuantized vertex = {};
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        vertex.position[axis] = _boundsExtent[axis] > 0.0f
+            ? QuantizeUnorm16((_position[axis] - _boundsMin[axis]) / _boundsExtent[axis])
+            : 0;
+    }
+
+    vertex.position[3] = 0;
+
+#if GFX_QTANGENT_VERTICES
+    EncodeQTangent(_normal, _tangent, vertex.qtangent);
+#else
+    (void)_tangent;
+    EncodeOctahedral(_normal, vertex.normal);
+#endif
+
+    vertex.texC[0]  = FloatToHalf(_texC[0]);
+    vertex.texC[1]  = FloatToHalf(_texC[1]);
+    vertex.texC2[0] = FloatToHalf(_texC2[0]);
+    vertex.texC2[1] = FloatToHalf(_texC2[1]);
+
+    return vertex;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cVertexQuantization::UnpackPosition(const sVertexQuantized& _rVertex, const float _boundsMin[3], const float _boundsExtent[3], float _outPosition[3])
+{
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        _outPosition[axis] = _boundsMin[axis] + DequantizeUnorm16(_rVertex.position[axis]) * _boundsExtent[axis];
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+float cVertexQuantization::GetPositionErrorBound(float _boundsExtent)
+{
+    // half a quantisation step plus float rounding in the decode
+    return _boundsExtent * (0.5f / 65535.0f) + _boundsExtent * 1e-6f;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+float cVertexQuantization::GetMaxHalfTexCoord(float _texelPrecision)
+{
+    // in [2^e, 2^(e+1)) fp16 values are 2^(e-10) apart, so round to nearest is
+    // off by at most limit / 4096 below a power of two limit
+    float limit = 65536.0f;
+
+    while (limit > 0.0f && limit * (1.0f / 4096.0f) > _texelPrecision)
+    {
+        limit *= 0.5f;
+    }
+
+    return std::min(limit, 65504.0f);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
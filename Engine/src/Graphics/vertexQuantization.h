@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+
+#include "gfxConfig.h"
+
+// --------------------------------------------------------------------------------------------------------------------------
+// Compact vertex layout, 24 (QTangent) or 20 bytes instead of the 56 byte sVertex.
+//
+//   position   R16G16B16A16_UNORM  relative to the submesh bounds, w unused
+//   qtangent   R16G16B16A16_SNORM  normal + tangent rotation, sign of w is the handedness
+//   normal     R16G16_SNORM        octahedral encoded, without GFX_QTANGENT_VERTICES
+//   texC       R16G16_FLOAT
+//   texC2      R16G16_FLOAT
+// --------------------------------------------------------------------------------------------------------------------------
+
+struct sVertexQuantized
+{
+	uint16_t	position[4];
+#if GFX_QTANGENT_VERTICES
+	int16_t		qtangent[4];
+#else
+	int16_t		normal[2];
+#endif
+	uint16_t	texC[2];
+	uint16_t	texC2[2];
+};
+
+static_assert(sizeof(sVertexQuantized) == (GFX_QTANGENT_VERTICES ? 24 : 20), "sVertexQuantized must match the quantized input layout");
+
+enum eVertexFormat : uint32_t
+{
+	VERTEX_FORMAT_FULL = 0,
+	VERTEX_FORMAT_QUANTIZED,
+
+	VERTEX_FORMAT_COUNT
+};
+
+// Platform neutral packing and unpacking, the shader side lives in VSQuantized.
+class cVertexQuantization
+{
+	public:
+
+		static uint16_t FloatToHalf(float _value);
+		static float	HalfToFloat(uint16_t _half);
+
+		static uint16_t QuantizeUnorm16(float _value);
+		static float	DequantizeUnorm16(uint16_t _value);
+
+		static int16_t	QuantizeSnorm16(float _value);
+		static float	DequantizeSnorm16(int16_t _value);
+
+		static void EncodeOctahedral(const float _normal[3], int16_t _outEncoded[2]);
+		static void DecodeOctahedral(const int16_t _encoded[2], float _outNormal[3]);
+
+		// _tangent.w is the bitangent sign (B = cross(N, T) * w). The tangent is
+		// orthogonalised against the normal first, a zero tangent gets an arbitrary one.
+		static void EncodeQTangent(const float _normal[3], const float _tangent[4], int16_t _outEncoded[4]);
+		static void DecodeQTangent(const int16_t _encoded[4], float _outNormal[3], float _outTangent[4]);
+
+		// _boundsMin / _boundsExtent describe the submesh AABB, a zero extent axis packs to 0
+		static sVertexQuantized Pack(const float _position[3], const float _normal[3], const float _tangent[4], 
+			const float _texC[2], const float _texC2[2], const float _boundsMin[3], const float _boundsExtent[3]);
+
+		static void UnpackPosition(const sVertexQuantized& _rVertex, const float _boundsMin[3], const float _boundsExtent[3], float _outPosition[3]);
+
+		// worst case absolute position error for a given bounds extent
+		static float GetPositionErrorBound(float _boundsExtent);
+
+		// largest texture coordinate magnitude that still keeps _texelPrecision in fp16
+		static float GetMaxHalfTexCoord(float _texelPrecision);
+};
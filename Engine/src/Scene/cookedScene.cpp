@@ -0,0 +1,789 @@
+#include "cookedScene.h"
+
+#include <algorithm>
+#include <climits>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <type_traits>
+#include <vector>
+
+#include "model.h"
+#include "Graphics/geometryBuilder.h"
+#include "Graphics/meshGeometry.h"
+
+static_assert(std::is_trivially_copyable_v<sVertex>,            "cooked chunks must be trivially copyable");
+static_assert(std::is_trivially_copyable_v<sVertexQuantized>,   "cooked chunks must be trivially copyable");
+static_assert(std::is_trivially_copyable_v<sMeshlet>,           "cooked chunks must be trivially copyable");
+static_assert(std::is_trivially_copyable_v<sSubmeshGeometry>,   "cooked chunks must be trivially copyable");
+static_assert(std::is_trivially_copyable_v<sMaterial>,          "cooked chunks must be trivially copyable");
+static_assert(std::is_trivially_copyable_v<sLightConstants>,    "cooked chunks must be trivially copyable");
+static_assert(std::is_trivially_copyable_v<sTextureRef>,        "cooked chunks must be trivially copyable");
+
+// element size of every chunk, indexed by eCookedChunk
+static const uint32_t s_cookedElementSizes[COOKED_CHUNK_COUNT] =
+{
+    sizeof(sVertex),
+    sizeof(sVertexQuantized),
+    sizeof(uint32_t),
+    sizeof(uint16_t),
+    sizeof(sSubmeshGeometry),
+    sizeof(sMaterial),
+    sizeof(XMFLOAT4X4),
+    sizeof(uint32_t),
+    sizeof(sLightConstants),
+    sizeof(sCookedTexture),
+    1,
+    sizeof(sMeshlet),
+    sizeof(uint32_t),
+    1,
+    sizeof(sTextureRef),
+    sizeof(uint32_t),
+    sizeof(XMFLOAT4X4),
+    sizeof(uint32_t),
+};
+
+constexpr uint64_t c_CookedChunkAlignment = 16;
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// largest of _count indices, the vertex a draw or meshlet reaches furthest
+template<typename T>
+static uint64_t FindMaxIndex(const T* _pIndices, size_t _count)
+{
+    T maxIndex = 0;
+
+    for (size_t i = 0; i < _count; ++i)
+    {
+        maxIndex = (std::max)(maxIndex, _pIndices[i]);
+    }
+
+    return maxIndex;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+cCookedScene::cCookedScene()
+    : m_file(nullptr)
+    , m_mapping(nullptr)
+    , m_pView(nullptr)
+    , m_size(0)
+    , m_pHeader(nullptr)
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+cCookedScene::~cCookedScene()
+{
+    Close();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+bool cCookedScene::Write(const std::string& _rCookedPath, const std::string& _rSourcePath, sModel& _rModel)
+{
+    auto Align = [](uint64_t _value) -> uint64_t
+        {
+            return (_value + c_CookedChunkAlignment - 1) & ~(c_CookedChunkAlignment - 1);
+        };
+
+    sCookedSceneHeader header = {};
+
+    header.magic    = c_CookedSceneMagic;
+    header.version  = c_CookedSceneVersion;
+
+    if (_rModel.instanceMeshIndices.size() != _rModel.worldMatrices.size() ||
+        _rModel.instanceNodes.size() != _rModel.worldMatrices.size())
+    {
+        std::cerr << "Cooked scene: instance tables do not match\n";
+        return false;
+    }
+
+    if (!GetSourceStamp(_rSourcePath, header.sourceSize, header.sourceWriteTime))
+    {
+        std::cerr << "Cooked scene: source not found: " << _rSourcePath << "\n";
+        return false;
+    }
+
+    // ---------------------------------------------------------
+    // build the GPU layout
+    // ---------------------------------------------------------
+    cGeometryBuilder geometry;
+
+    for (const sMeshData& rMeshData : _rModel.meshes)
+    {
+        geometry.AddMesh(rMeshData);
+    }
+
+    std::vector<XMFLOAT4X4> worldMatrices(_rModel.worldMatrices.size());
+
+    for (size_t i = 0; i < worldMatrices.size(); ++i)
+    {
+        XMStoreFloat4x4(&worldMatrices[i], _rModel.worldMatrices[i]);
+    }
+
+    std::vector<sCookedTexture> textures(_rModel.cpuTextures.size());
+    uint64_t textureDataSize = 0;
+
+    for (size_t i = 0; i < textures.size(); ++i)
+    {
+        cCpuTexture& rCpuTexture = _rModel.cpuTextures[i];
+
+        textures[i].width       = rCpuTexture.GetWidth();
+        textures[i].height      = rCpuTexture.GetHeight();
+        textures[i].format      = static_cast<uint32_t>(rCpuTexture.GetFormat());
+        textures[i].mipLevels   = rCpuTexture.GetMipLevels();
+        textures[i].arraySize   = rCpuTexture.GetArraySize();
+        textures[i].padding     = 0;
+        textures[i].dataOffset  = textureDataSize;
+        textures[i].dataSize    = rCpuTexture.GetPayload().GetSize();
+
+        textureDataSize += Align(textures[i].dataSize);
+    }
+
+    const void* chunkData[COOKED_CHUNK_COUNT] =
+    {
+        geometry.GetVertices().data(),
+        geometry.GetQuantizedVertices().data(),
+        geometry.GetIndices32().data(),
+        geometry.GetIndices16().data(),
+        geometry.GetSubmeshes().data(),
+        _rModel.materials.data(),
+        worldMatrices.data(),
+        _rModel.instanceMeshIndices.data(),
+        _rModel.lights.data(),
+        textures.data(),
+        nullptr, // texture data is streamed per texture below
+        geometry.GetMeshlets().data(),
+        geometry.GetMeshletVertices().data(),
+        geometry.GetMeshletTriangles().data(),
+        _rModel.textureRefs.data(),
+        _rModel.sceneGraph.GetParents().data(),
+        _rModel.sceneGraph.GetLocals().data(),
+        _rModel.instanceNodes.data(),
+    };
+
+    const uint64_t chunkCounts[COOKED_CHUNK_COUNT] =
+    {
+        geometry.GetVertices().size(),
+        geometry.GetQuantizedVertices().size(),
+        geometry.GetIndices32().size(),
+        geometry.GetIndices16().size(),
+        geometry.GetSubmeshes().size(),
+        _rModel.materials.size(),
+        worldMatrices.size(),
+        _rModel.instanceMeshIndices.size(),
+        _rModel.lights.size(),
+        textures.size(),
+        textureDataSize,
+        geometry.GetMeshlets().size(),
+        geometry.GetMeshletVertices().size(),
+        geometry.GetMeshletTriangles().size(),
+        _rModel.textureRefs.size(),
+        _rModel.sceneGraph.GetParents().size(),
+        _rModel.sceneGraph.GetLocals().size(),
+        _rModel.instanceNodes.size(),
+    };
+
+    uint64_t offset = Align(sizeof(sCookedSceneHeader));
+
+    for (uint32_t chunk = 0; chunk < COOKED_CHUNK_COUNT; ++chunk)
+    {
+        header.chunks[chunk].offset         = offset;
+        header.chunks[chunk].count          = chunkCounts[chunk];
+        header.chunks[chunk].elementSize    = s_cookedElementSizes[chunk];
+        header.chunks[chunk].padding        = 0;
+
+        offset += Align(chunkCounts[chunk] * s_cookedElementSizes[chunk]);
+    }
+
+    // ---------------------------------------------------------
+    // write to a temporary file first, so an interrupted cook never
+    // leaves a truncated file that looks valid
+    // ---------------------------------------------------------
+    const std::string tempPath = _rCookedPath + ".tmp";
+
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+
+        if (!file)
+        {
+            std::cerr << "Cooked scene: cannot write " << tempPath << "\n";
+            return false;
+        }
+
+        static const char s_padding[c_CookedChunkAlignment] = {};
+
+        auto WriteBlock = [&](const void* _pData, uint64_t _byteSize)
+            {
+                if (_byteSize > 0)
+                    file.write(static_cast<const char*>(_pData), static_cast<std::streamsize>(_byteSize));
+
+                file.write(s_padding, static_cast<std::streamsize>(Align(_byteSize) - _byteSize));
+            };
+
+        WriteBlock(&header, sizeof(sCookedSceneHeader));
+
+        for (uint32_t chunk = 0; chunk < COOKED_CHUNK_TEXTURE_DATA; ++chunk)
+        {
+            WriteBlock(chunkData[chunk], chunkCounts[chunk] * s_cookedElementSizes[chunk]);
+        }
+
+        for (cCpuTexture& rCpuTexture : _rModel.cpuTextures)
+        {
+            WriteBlock(rCpuTexture.GetPayload().GetData(), rCpuTexture.GetPayload().GetSize());
+        }
+
+        for (uint32_t chunk = COOKED_CHUNK_TEXTURE_DATA + 1; chunk < COOKED_CHUNK_COUNT; ++chunk)
+        {
+            WriteBlock(chunkData[chunk], chunkCounts[chunk] * s_cookedElementSizes[chunk]);
+        }
+
+        if (!file)
+        {
+            std::cerr << "Cooked scene: write failed for " << tempPath << "\n";
+            return false;
+        }
+    }
+
+    std::error_code errorCode;
+    std::filesystem::rename(tempPath, _rCookedPath, errorCode);
+
+    if (errorCode)
+    {
+        std::cerr << "Cooked scene: cannot replace " << _rCookedPath << ": " << errorCode.message() << "\n";
+        return false;
+    }
+
+    std::cout << "Cooked scene written: " << _rCookedPath << " (" << offset << " bytes)\n";
+
+    return true;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+bool cCookedScene::Open(const std::string& _rCookedPath, const std::string& _rSourcePath)
+{
+    Close();
+
+    m_file = CreateFileA(
+        _rCookedPath.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr
+    );
+
+    if (m_file == INVALID_HANDLE_VALUE)
+    {
+        m_file = nullptr;
+        return false;
+    }
+
+    LARGE_INTEGER fileSize = {};
+
+    if (!GetFileSizeEx(m_file, &fileSize) || static_cast<uint64_t>(fileSize.QuadPart) < sizeof(sCookedSceneHeader))
+    {
+        Close();
+        return false;
+    }
+
+    m_size      = static_cast<uint64_t>(fileSize.QuadPart);
+    m_mapping   = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+    if (m_mapping == nullptr)
+    {
+        Close();
+        return false;
+    }
+
+    m_pView = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+
+    if (m_pView == nullptr)
+    {
+        Close();
+        return false;
+    }
+
+    m_pHeader = reinterpret_cast<const sCookedSceneHeader*>(m_pView);
+
+    if (m_pHeader->magic != c_CookedSceneMagic || m_pHeader->version != c_CookedSceneVersion)
+    {
+        std::cout << "Cooked scene: version mismatch, recooking " << _rCookedPath << "\n";
+        Close();
+        return false;
+    }
+
+    // a missing source is fine (shipping without the glTF), a changed one is not
+    uint64_t sourceSize      = 0;
+    int64_t  sourceWriteTime = 0;
+
+    if (GetSourceStamp(_rSourcePath, sourceSize, sourceWriteTime) &&
+        (sourceSize != m_pHeader->sourceSize || sourceWriteTime != m_pHeader->sourceWriteTime))
+    {
+        std::cout << "Cooked scene: stale, recooking " << _rCookedPath << "\n";
+        Close();
+        return false;
+    }
+
+    for (uint32_t chunk = 0; chunk < COOKED_CHUNK_COUNT; ++chunk)
+    {
+        const sCookedChunk& rChunk = m_pHeader->chunks[chunk];
+
+        // divided, count * elementSize may wrap around
+        if (rChunk.elementSize != s_cookedElementSizes[chunk] ||
+            rChunk.offset > m_size ||
+            rChunk.count > (m_size - rChunk.offset) / rChunk.elementSize)
+        {
+            std::cerr << "Cooked scene: corrupt chunk " << chunk << " in " << _rCookedPath << "\n";
+            Close();
+            return false;
+        }
+    }
+
+    // records point into other chunks, a bad one would read past them
+    if (const char* pCorruption = FindCorruptRecord())
+    {
+        std::cerr << "Cooked scene: " << pCorruption << ", recooking " << _rCookedPath << "\n";
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cCookedScene::Close()
+{
+    if (m_pView != nullptr)
+    {
+        UnmapViewOfFile(m_pView);
+        m_pView = nullptr;
+    }
+
+    if (m_mapping != nullptr)
+    {
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+    }
+
+    if (m_file != nullptr)
+    {
+        CloseHandle(m_file);
+        m_file = nullptr;
+    }
+
+    m_size      = 0;
+    m_pHeader   = nullptr;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+const sVertex* cCookedScene::GetVertices() const
+{
+    return static_cast<const sVertex*>(GetChunk(COOKED_CHUNK_VERTICES));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+size_t cCookedScene::GetVertexCount() const
+{
+    return GetChunkCount(COOKED_CHUNK_VERTICES);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+const sVertexQuantized* cCookedScene::GetQuantizedVertices() const
+{
+    return static_cast<const sVertexQuantized*>(GetChunk(COOKED_CHUNK_QUANTIZED_VERTICES));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+size_t cCookedScene::GetQuantizedVertexCount() const
+{
+    return GetChunkCount(COOKED_CHUNK_QUANTIZED_VERTICES);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+const uint32_t* cCookedScene::GetIndices32() const
+{
+    return static_cast<const uint32_t*>(GetChunk(COOKED_CHUNK_INDICES));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+size_t cCookedScene::GetIndex32Count() const
+{
+    return GetChunkCount(COOKED_CHUNK_INDICES);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+const uint16_t* cCookedScene::GetIndices16() const
+{
+    return static_cast<const uint16_t*>(GetChunk(COOKED_CHUNK_INDICES16));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+size_t cCookedScene::GetIndex16Count() const
+{
+    return GetChunkCount(COOKED_CHUNK_INDICES16);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+const sSubmeshGeometry* cCookedScene::GetSubmeshes() const
+{
+    return static_cast<const sSubmeshGeometry*>(GetChunk(COOKED_CHUNK_SUBMESHES));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+size_t cCookedScene::GetSubmeshCount() const
+{
+    return GetChunkCount(COOKED_CHUNK_SUBMESHES);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+const sMeshlet* cCookedScene::GetMeshlets() const
+{
+    return static_cast<const sMeshlet*>(GetChunk(COOKED_CHUNK_MESHLETS));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+size_t cCookedScene::GetMeshletCount() const
+{
+    return GetChunkCount(COOKED_CHUNK_MESHLETS);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+const uint32_t* cCookedScene::GetMeshletVertices() const
+{
+    return static_cast<const uint32_t*>(GetChunk(COOKED_CHUNK_MESHLET_VERTICES));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+const uint8_t* cCookedScene::GetMeshletTriangles() const
+{
+    return static_cast<const uint8_t*>(GetChunk(COOKED_CHUNK_MESHLET_TRIANGLES));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+const sMaterial* cCookedScene::GetMaterials() const
+{
+    return static_cast<const sMaterial*>(GetChunk(COOKED_CHUNK_MATERIALS));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+size_t cCookedScene::GetMaterialCount() const
+{
+    return GetChunkCount(COOKED_CHUNK_MATERIALS);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+const XMFLOAT4X4* cCookedScene::GetWorldMatrices() const
+{
+    return static_cast<const XMFLOAT4X4*>(GetChunk(COOKED_CHUNK_WORLD_MATRICES));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+const uint32_t* cCookedScene::GetInstanceSubmeshes() const
+{
+    return static_cast<const uint32_t*>(GetChunk(COOKED_CHUNK_INSTANCE_SUBMESHES));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+size_t cCookedScene::GetInstanceCount() const
+{
+    return GetChunkCount(COOKED_CHUNK_WORLD_MATRICES);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+const sLightConstants* cCookedScene::GetLights() const
+{
+    return static_cast<const sLightConstants*>(GetChunk(COOKED_CHUNK_LIGHTS));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+size_t cCookedScene::GetLightCount() const
+{
+    return GetChunkCount(COOKED_CHUNK_LIGHTS);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+const sCookedTexture* cCookedScene::GetTextures() const
+{
+    return static_cast<const sCookedTexture*>(GetChunk(COOKED_CHUNK_TEXTURES));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+size_t cCookedScene::GetTextureCount() const
+{
+    return GetChunkCount(COOKED_CHUNK_TEXTURES);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+const uint8_t* cCookedScene::GetTextureData(const sCookedTexture& _rTexture) const
+{
+    return static_cast<const uint8_t*>(GetChunk(COOKED_CHUNK_TEXTURE_DATA)) + _rTexture.dataOffset;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+const sTextureRef* cCookedScene::GetTextureRefs() const
+{
+    return static_cast<const sTextureRef*>(GetChunk(COOKED_CHUNK_TEXTURE_REFS));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+size_t cCookedScene::GetTextureRefCount() const
+{
+    return GetChunkCount(COOKED_CHUNK_TEXTURE_REFS);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+const uint32_t* cCookedScene::GetNodeParents() const
+{
+    return static_cast<const uint32_t*>(GetChunk(COOKED_CHUNK_NODE_PARENTS));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+const XMFLOAT4X4* cCookedScene::GetNodeLocals() const
+{
+    return static_cast<const XMFLOAT4X4*>(GetChunk(COOKED_CHUNK_NODE_LOCALS));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+size_t cCookedScene::GetNodeCount() const
+{
+    return GetChunkCount(COOKED_CHUNK_NODE_PARENTS);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+const uint32_t* cCookedScene::GetInstanceNodes() const
+{
+    return static_cast<const uint32_t*>(GetChunk(COOKED_CHUNK_INSTANCE_NODES));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+const char* cCookedScene::FindCorruptRecord() const
+{
+    const size_t instanceCount = GetInstanceCount();
+
+    if (GetChunkCount(COOKED_CHUNK_INSTANCE_SUBMESHES) != instanceCount || GetChunkCount(COOKED_CHUNK_INSTANCE_NODES) != instanceCount)
+        return "instance tables do not match";
+
+    if (GetChunkCount(COOKED_CHUNK_NODE_LOCALS) != GetNodeCount())
+        return "node tables do not match";
+
+    // parents come before their children, AddNode checks the levels
+    const uint32_t* pParents = GetNodeParents();
+
+    for (size_t node = 0; node < GetNodeCount(); ++node)
+    {
+        if (pParents[node] != cSceneGraph::c_InvalidNode && pParents[node] >= node)
+            return "node parent out of order";
+    }
+
+    const uint32_t* pInstanceSubmeshes  = GetInstanceSubmeshes();
+    const uint32_t* pInstanceNodes      = GetInstanceNodes();
+
+    for (size_t instance = 0; instance < instanceCount; ++instance)
+    {
+        if (pInstanceSubmeshes[instance] >= GetSubmeshCount() || pInstanceNodes[instance] >= GetNodeCount())
+            return "instance out of range";
+    }
+
+    const uint64_t meshletVertexCount   = GetChunkCount(COOKED_CHUNK_MESHLET_VERTICES);
+    const uint64_t meshletTriangleBytes = GetChunkCount(COOKED_CHUNK_MESHLET_TRIANGLES);
+
+    for (size_t i = 0; i < GetMeshletCount(); ++i)
+    {
+        const sMeshlet& rMeshlet = GetMeshlets()[i];
+
+        if (static_cast<uint64_t>(rMeshlet.vertexOffset) + rMeshlet.vertexCount > meshletVertexCount ||
+            static_cast<uint64_t>(rMeshlet.triangleOffset) + rMeshlet.triangleCount * 3ull > meshletTriangleBytes)
+            return "meshlet out of bounds";
+    }
+
+    // the draw ranges of every LOD stay inside the pools of the submesh's formats, and so do the
+    // vertices their indices reach
+    const uint64_t vertexCounts[VERTEX_FORMAT_COUNT] = { GetVertexCount(), GetQuantizedVertexCount() };
+
+    const uint32_t* pMeshletVertices    = GetMeshletVertices();
+    const uint8_t*  pMeshletTriangles   = GetMeshletTriangles();
+
+    for (size_t i = 0; i < GetSubmeshCount(); ++i)
+    {
+        const sSubmeshGeometry& rSubmesh = GetSubmeshes()[i];
+
+        if (rSubmesh.vertexFormat >= VERTEX_FORMAT_COUNT ||
+            rSubmesh.startVertexLocation < 0 ||
+            static_cast<uint64_t>(rSubmesh.startVertexLocation) > vertexCounts[rSubmesh.vertexFormat])
+            return "submesh vertex range out of bounds";
+
+        uint64_t indexCount = 0;
+
+        if (rSubmesh.indexFormat == DXGI_FORMAT_R16_UINT)
+            indexCount = GetIndex16Count();
+        else if (rSubmesh.indexFormat == DXGI_FORMAT_R32_UINT)
+            indexCount = GetIndex32Count();
+        else
+            return "submesh index format unknown";
+
+        if (rSubmesh.lodCount == 0 || rSubmesh.lodCount > c_MaxSubmeshLods)
+            return "submesh LOD count out of range";
+
+        // the vertices after the submesh's first one
+        const uint64_t vertexRange = vertexCounts[rSubmesh.vertexFormat] - static_cast<uint64_t>(rSubmesh.startVertexLocation);
+
+        for (UINT lod = 0; lod < rSubmesh.lodCount; ++lod)
+        {
+            const sSubmeshLod& rLod = rSubmesh.lods[lod];
+
+            if (static_cast<uint64_t>(rLod.startIndexLocation) + rLod.indexCount > indexCount)
+                return "submesh index range out of bounds";
+
+            const uint64_t maxIndex = rSubmesh.indexFormat == DXGI_FORMAT_R16_UINT
+                ? FindMaxIndex(GetIndices16() + rLod.startIndexLocation, rLod.indexCount)
+                : FindMaxIndex(GetIndices32() + rLod.startIndexLocation, rLod.indexCount);
+
+            if (rLod.indexCount > 0 && maxIndex >= vertexRange)
+                return "submesh indices reach past the vertex pool";
+        }
+
+        if (rSubmesh.materialId != UINT_MAX && rSubmesh.materialId >= GetMaterialCount())
+            return "submesh material out of range";
+
+        if (static_cast<uint64_t>(rSubmesh.meshletOffset) + rSubmesh.meshletCount > GetMeshletCount())
+            return "submesh meshlet range out of bounds";
+
+        // meshlet vertices are relative to the submesh's first vertex, triangles to the meshlet's vertices
+        for (UINT meshlet = 0; meshlet < rSubmesh.meshletCount; ++meshlet)
+        {
+            const sMeshlet& rMeshlet = GetMeshlets()[rSubmesh.meshletOffset + meshlet];
+
+            if (rMeshlet.vertexCount > 0 && FindMaxIndex(pMeshletVertices + rMeshlet.vertexOffset, rMeshlet.vertexCount) >= vertexRange)
+                return "meshlet vertex out of range";
+
+            if (rMeshlet.triangleCount > 0 && FindMaxIndex(pMeshletTriangles + rMeshlet.triangleOffset, rMeshlet.triangleCount * 3u) >= rMeshlet.vertexCount)
+                return "meshlet triangle out of range";
+        }
+    }
+
+    // texture indices of the materials go through the texture refs to the descriptor table,
+    // -1 is no texture
+    const int64_t textureRefCount = static_cast<int64_t>(GetTextureRefCount());
+
+    for (size_t i = 0; i < GetMaterialCount(); ++i)
+    {
+        const sMaterial& rMaterial = GetMaterials()[i];
+
+        const int textureIndices[] =
+        {
+            rMaterial.baseColorIndex, rMaterial.metallicRoughnessIndex, rMaterial.normalIndex, rMaterial.occlusionIndex, rMaterial.emissiveIndex
+        };
+
+        for (int textureIndex : textureIndices)
+        {
+            if (textureIndex < -1 || textureIndex >= textureRefCount)
+                return "material texture out of range";
+        }
+    }
+
+    // a texture ref names a cooked texture (a packed page) and one of its slices
+    for (size_t i = 0; i < GetTextureRefCount(); ++i)
+    {
+        const sTextureRef& rRef = GetTextureRefs()[i];
+
+        if (rRef.descriptorIndex >= GetTextureCount() || rRef.slice >= GetTextures()[rRef.descriptorIndex].arraySize)
+            return "texture ref out of range";
+    }
+
+    // GetTextureData hands out pointers into the data chunk
+    const uint64_t textureDataSize = GetChunkCount(COOKED_CHUNK_TEXTURE_DATA);
+
+    for (size_t i = 0; i < GetTextureCount(); ++i)
+    {
+        const sCookedTexture& rTexture = GetTextures()[i];
+
+        if (rTexture.dataOffset > textureDataSize || rTexture.dataSize > textureDataSize - rTexture.dataOffset)
+            return "texture data out of bounds";
+
+        if (rTexture.width <= 0 || rTexture.height <= 0 || rTexture.mipLevels == 0 || rTexture.arraySize == 0)
+            return "texture without texels";
+    }
+
+    return nullptr;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+bool cCookedScene::GetSourceStamp(const std::string& _rSourcePath, uint64_t& _rOutSize, int64_t& _rOutWriteTime)
+{
+    std::error_code errorCode;
+
+    const uintmax_t fileSize = std::filesystem::file_size(_rSourcePath, errorCode);
+
+    if (errorCode)
+        return false;
+
+    const auto writeTime = std::filesystem::last_write_time(_rSourcePath, errorCode);
+
+    if (errorCode)
+        return false;
+
+    _rOutSize       = static_cast<uint64_t>(fileSize);
+    _rOutWriteTime  = static_cast<int64_t>(writeTime.time_since_epoch().count());
+
+    return true;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+const void* cCookedScene::GetChunk(eCookedChunk _chunk) const
+{
+    if (m_pHeader == nullptr)
+        return nullptr;
+
+    return m_pView + m_pHeader->chunks[_chunk].offset;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+size_t cCookedScene::GetChunkCount(eCookedChunk _chunk) const
+{
+    if (m_pHeader == nullptr)
+        return 0;
+
+    return static_cast<size_t>(m_pHeader->chunks[_chunk].count);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
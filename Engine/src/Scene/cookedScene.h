@@ -0,0 +1,169 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <windows.h>
+#include <DirectXMath.h>
+
+using namespace DirectX;
+
+struct sVertex;
+struct sVertexQuantized;
+struct sMeshlet;
+struct sSubmeshGeometry;
+struct sMaterial;
+struct sTextureRef;
+struct sLightConstants;
+struct sModel;
+
+// --------------------------------------------------------------------------------------------------------------------------
+// Binary layout of a cooked scene file. Every chunk is a plain array in GPU-ready
+// layout, so the mapped file can be handed to the renderer without conversion.
+// Bump c_CookedSceneVersion whenever one of the chunk element types changes.
+// --------------------------------------------------------------------------------------------------------------------------
+
+constexpr uint32_t c_CookedSceneMagic	= 0x4353505A; // "ZPSC"
+constexpr uint32_t c_CookedSceneVersion	= 10;
+
+enum eCookedChunk : uint32_t
+{
+	COOKED_CHUNK_VERTICES = 0,
+	COOKED_CHUNK_QUANTIZED_VERTICES,
+	COOKED_CHUNK_INDICES,
+	COOKED_CHUNK_INDICES16,
+	COOKED_CHUNK_SUBMESHES,
+	COOKED_CHUNK_MATERIALS,
+	COOKED_CHUNK_WORLD_MATRICES,
+	COOKED_CHUNK_INSTANCE_SUBMESHES,
+	COOKED_CHUNK_LIGHTS,
+	COOKED_CHUNK_TEXTURES,
+	COOKED_CHUNK_TEXTURE_DATA,
+	COOKED_CHUNK_MESHLETS,
+	COOKED_CHUNK_MESHLET_VERTICES,
+	COOKED_CHUNK_MESHLET_TRIANGLES,
+	COOKED_CHUNK_TEXTURE_REFS,
+	COOKED_CHUNK_NODE_PARENTS,
+	COOKED_CHUNK_NODE_LOCALS,
+	COOKED_CHUNK_INSTANCE_NODES,
+
+	COOKED_CHUNK_COUNT
+};
+
+struct sCookedChunk
+{
+	uint64_t offset;
+	uint64_t count;
+	uint32_t elementSize;
+	uint32_t padding;
+};
+
+struct sCookedSceneHeader
+{
+	uint32_t		magic;
+	uint32_t		version;
+	uint64_t		sourceSize;
+	int64_t			sourceWriteTime;
+	sCookedChunk	chunks[COOKED_CHUNK_COUNT];
+};
+
+struct sCookedTexture
+{
+	int32_t		width;
+	int32_t		height;
+	uint32_t	format;
+	uint32_t	mipLevels;		// all levels are stored back to back in dataSize
+	uint32_t	arraySize;		// slices follow each other, each with all its levels
+	uint32_t	padding;
+	uint64_t	dataOffset;		// relative to COOKED_CHUNK_TEXTURE_DATA
+	uint64_t	dataSize;
+};
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+class cCookedScene
+{
+	public:
+
+		cCookedScene();
+		~cCookedScene();
+
+		cCookedScene(const cCookedScene&) = delete;
+		cCookedScene& operator=(const cCookedScene&) = delete;
+
+	public:
+
+		static bool Write(const std::string& _rCookedPath, const std::string& _rSourcePath, sModel& _rModel);
+
+		// maps the cooked file; fails when it is missing, from another version
+		// or older than the source it was cooked from
+		bool Open(const std::string& _rCookedPath, const std::string& _rSourcePath);
+		void Close();
+
+	public:
+
+		const sVertex*			GetVertices() const;
+		size_t					GetVertexCount() const;
+
+		const sVertexQuantized*	GetQuantizedVertices() const;
+		size_t					GetQuantizedVertexCount() const;
+
+		// sSubmeshGeometry::indexFormat selects the pool
+		const uint32_t*			GetIndices32() const;
+		size_t					GetIndex32Count() const;
+		const uint16_t*			GetIndices16() const;
+		size_t					GetIndex16Count() const;
+
+		const sSubmeshGeometry*	GetSubmeshes() const;
+		size_t					GetSubmeshCount() const;
+
+		// sSubmeshGeometry::meshletOffset / meshletCount index into these
+		const sMeshlet*			GetMeshlets() const;
+		size_t					GetMeshletCount() const;
+		const uint32_t*			GetMeshletVertices() const;
+		const uint8_t*			GetMeshletTriangles() const;
+
+		const sMaterial*		GetMaterials() const;
+		size_t					GetMaterialCount() const;
+
+		// one world matrix and one submesh index per instance
+		const XMFLOAT4X4*		GetWorldMatrices() const;
+		const uint32_t*			GetInstanceSubmeshes() const;
+		size_t					GetInstanceCount() const;
+
+		const sLightConstants*	GetLights() const;
+		size_t					GetLightCount() const;
+
+		const sCookedTexture*	GetTextures() const;
+		size_t					GetTextureCount() const;
+		const uint8_t*			GetTextureData(const sCookedTexture& _rTexture) const;
+
+		// sMaterial texture indices index these, see cTexturePacker
+		const sTextureRef*		GetTextureRefs() const;
+		size_t					GetTextureRefCount() const;
+
+		// scene graph in cSceneGraph order, one parent and one local matrix per node
+		const uint32_t*			GetNodeParents() const;
+		const XMFLOAT4X4*		GetNodeLocals() const;
+		size_t					GetNodeCount() const;
+
+		// one scene graph node per instance
+		const uint32_t*			GetInstanceNodes() const;
+
+	private:
+
+		static bool GetSourceStamp(const std::string& _rSourcePath, uint64_t& _rOutSize, int64_t& _rOutWriteTime);
+
+		// what is wrong with the first record that points outside its chunks, null when none does
+		const char* FindCorruptRecord() const;
+
+		const void* GetChunk(eCookedChunk _chunk) const;
+		size_t GetChunkCount(eCookedChunk _chunk) const;
+
+	private:
+
+		HANDLE						m_file;
+		HANDLE						m_mapping;
+		const uint8_t*				m_pView;
+		uint64_t					m_size;
+		const sCookedSceneHeader*	m_pHeader;
+};
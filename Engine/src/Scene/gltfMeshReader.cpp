@@ -0,0 +1,394 @@
+#include "gltfMeshReader.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "Core/parallel.h"
+
+#include "tiny_gltf.h"
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cGltfMeshReader::ReadMesh(const tinygltf::Model& _rModel, int _meshIndex, std::vector<sMeshData>& _rOutMeshes)
+{
+    const tinygltf::Mesh& mesh = _rModel.meshes[_meshIndex];
+
+    std::vector<sMeshData>& rMeshes =
+        _rOutMeshes;
+
+    for (const auto& primitive : mesh.primitives)
+    {
+        sMeshData meshData{};
+
+        // =========================================================
+        // ATTRIBUTE LOOKUPS
+        // =========================================================
+
+        const auto& rAttributes =
+            primitive.attributes;
+
+        auto posIt  = rAttributes.find("POSITION");
+        auto normIt = rAttributes.find("NORMAL");
+        auto uvIt   = rAttributes.find("TEXCOORD_0");
+        auto tanIt  = rAttributes.find("TANGENT");
+
+        // =========================================================
+        // POINTERS
+        // =========================================================
+
+        const float* pPositions = nullptr;
+        const float* pNormals   = nullptr;
+        const float* pTexcoords = nullptr;
+
+        size_t vertexCount = 0;
+
+        // =========================================================
+        // POSITION POINTER
+        // =========================================================
+
+        if (posIt != rAttributes.end())
+        {
+            const tinygltf::Accessor& accessor =
+                _rModel.accessors[posIt->second];
+
+            const tinygltf::BufferView& view =
+                _rModel.bufferViews[accessor.bufferView];
+
+            const tinygltf::Buffer& buffer =
+                _rModel.buffers[view.buffer];
+
+            pPositions =
+                reinterpret_cast<const float*>(
+                    buffer.data.data() +
+                    view.byteOffset +
+                    accessor.byteOffset);
+
+            vertexCount =
+                static_cast<size_t>(accessor.count);
+        }
+
+        // =========================================================
+        // NORMAL POINTER
+        // =========================================================
+
+        if (normIt != rAttributes.end())
+        {
+            const tinygltf::Accessor& accessor =
+                _rModel.accessors[normIt->second];
+
+            const tinygltf::BufferView& view =
+                _rModel.bufferViews[accessor.bufferView];
+
+            const tinygltf::Buffer& buffer =
+                _rModel.buffers[view.buffer];
+
+            pNormals =
+                reinterpret_cast<const float*>(
+                    buffer.data.data() +
+                    view.byteOffset +
+                    accessor.byteOffset);
+        }
+
+        // =========================================================
+        // TEXCOORD POINTER
+        // =========================================================
+
+        if (uvIt != rAttributes.end())
+        {
+            const tinygltf::Accessor& accessor =
+                _rModel.accessors[uvIt->second];
+
+            const tinygltf::BufferView& view =
+                _rModel.bufferViews[accessor.bufferView];
+
+            const tinygltf::Buffer& buffer =
+                _rModel.buffers[view.buffer];
+
+            pTexcoords =
+                reinterpret_cast<const float*>(
+                    buffer.data.data() +
+                    view.byteOffset +
+                    accessor.byteOffset);
+        }
+
+        // =========================================================
+        // SINGLE VERTEX LOOP
+        // =========================================================
+
+        meshData.vertices.resize(vertexCount);
+
+        for (size_t i = 0; i < vertexCount; ++i)
+        {
+            sVertex& rVertex =
+                meshData.vertices[i];
+
+            // -----------------------------
+            // POSITION
+            // -----------------------------
+
+            if (pPositions)
+            {
+                rVertex.position.x =
+                    -pPositions[i * 3 + 0];
+
+                rVertex.position.y =
+                     pPositions[i * 3 + 1];
+
+                rVertex.position.z =
+                     pPositions[i * 3 + 2];
+            }
+
+            // -----------------------------
+            // NORMAL
+            // -----------------------------
+
+            if (pNormals)
+            {
+                rVertex.normal.x =
+                    -pNormals[i * 3 + 0];
+
+                rVertex.normal.y =
+                     pNormals[i * 3 + 1];
+
+                rVertex.normal.z =
+                     pNormals[i * 3 + 2];
+            }
+
+            // -----------------------------
+            // TEXCOORD
+            // -----------------------------
+
+            if (pTexcoords)
+            {
+                rVertex.texC.x =
+                    pTexcoords[i * 2 + 0];
+
+                rVertex.texC.y =
+                    pTexcoords[i * 2 + 1];
+            }
+        }
+
+        // =========================================================
+        // TANGENT
+        // =========================================================
+
+        std::vector<float> tangents;
+
+        if (tanIt != rAttributes.end() &&
+            ReadAccessorFloats(_rModel, tanIt->second, 4, tangents) &&
+            tangents.size() == vertexCount * 4)
+        {
+            for (size_t i = 0; i < vertexCount; ++i)
+            {
+                // mirroring X flips the frame, so the bitangent sign flips too
+                meshData.vertices[i].tangentU = XMFLOAT4(
+                    -tangents[i * 4 + 0],
+                     tangents[i * 4 + 1],
+                     tangents[i * 4 + 2],
+                    -tangents[i * 4 + 3]);
+            }
+
+            meshData.hasTangents = true;
+        }
+
+        // =========================================================
+        // INDICES
+        // =========================================================
+
+        if (primitive.indices >= 0)
+        {
+            const tinygltf::Accessor& accessor =
+                _rModel.accessors[primitive.indices];
+
+            const tinygltf::BufferView& view =
+                _rModel.bufferViews[accessor.bufferView];
+
+            const tinygltf::Buffer& buffer =
+                _rModel.buffers[view.buffer];
+
+            const unsigned char* pData =
+                buffer.data.data() +
+                view.byteOffset +
+                accessor.byteOffset;
+
+            const size_t indexCount =
+                static_cast<size_t>(accessor.count);
+
+            meshData.indices32.resize(indexCount);
+
+            // -----------------------------------------------------
+            // UINT16
+            // -----------------------------------------------------
+            if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT)
+            {
+                const uint16_t* pIndices =
+                    reinterpret_cast<const uint16_t*>(pData);
+
+                for (size_t i = 0; i < indexCount; i += 3)
+                {
+                    meshData.indices32[i + 0] =
+                        static_cast<uint32_t>(pIndices[i + 0]);
+
+                    meshData.indices32[i + 1] =
+                        static_cast<uint32_t>(pIndices[i + 2]);
+
+                    meshData.indices32[i + 2] =
+                        static_cast<uint32_t>(pIndices[i + 1]);
+                }
+            }
+
+            // -----------------------------------------------------
+            // UINT32
+            // -----------------------------------------------------
+            else if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT)
+            {
+                const uint32_t* pIndices =
+                    reinterpret_cast<const uint32_t*>(pData);
+
+                for (size_t i = 0; i < indexCount; i += 3)
+                {
+                    meshData.indices32[i + 0] = pIndices[i + 0];
+                    meshData.indices32[i + 1] = pIndices[i + 2];
+                    meshData.indices32[i + 2] = pIndices[i + 1];
+                }
+            }
+            else
+            {
+                throw std::runtime_error("Unsupported glTF index component type.");
+            }
+
+            // =========================================================
+            // MATERIAL
+            // =========================================================
+
+            meshData.materialId =
+                primitive.material;
+
+            rMeshes.push_back(std::move(meshData));
+        }
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cGltfMeshReader::ReadMeshes(const tinygltf::Model& _rModel, const std::vector<int>& _rMeshIndices,
+    std::vector<std::vector<sMeshData>>& _rOutSlots, bool _multithreaded)
+{
+    _rOutSlots.clear();
+    _rOutSlots.resize(_rMeshIndices.size());
+
+    if (!_multithreaded)
+    {
+        for (size_t slot = 0; slot < _rMeshIndices.size(); ++slot)
+        {
+            ReadMesh(_rModel, _rMeshIndices[slot], _rOutSlots[slot]);
+        }
+
+        return;
+    }
+
+    cParallel::For(_rMeshIndices.size(), [&](size_t _slot)
+        {
+            ReadMesh(_rModel, _rMeshIndices[_slot], _rOutSlots[_slot]);
+        });
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+bool cGltfMeshReader::ReadAccessorFloats(const tinygltf::Model& _rModel, int _accessorIndex, int _componentCount, std::vector<float>& _rOutValues)
+{
+    if (_accessorIndex < 0 || _accessorIndex >= static_cast<int>(_rModel.accessors.size()))
+        return false;
+
+    const tinygltf::Accessor& accessor = _rModel.accessors[_accessorIndex];
+
+    if (tinygltf::GetNumComponentsInType(static_cast<uint32_t>(accessor.type)) != _componentCount)
+        return false;
+
+    if (accessor.bufferView < 0 || accessor.bufferView >= static_cast<int>(_rModel.bufferViews.size()))
+        return false;
+
+    const tinygltf::BufferView& view = _rModel.bufferViews[accessor.bufferView];
+
+    if (view.buffer < 0 || view.buffer >= static_cast<int>(_rModel.buffers.size()))
+        return false;
+
+    const tinygltf::Buffer& buffer = _rModel.buffers[view.buffer];
+
+    const int stride        = accessor.ByteStride(view);
+    const int componentSize = tinygltf::GetComponentSizeInBytes(static_cast<uint32_t>(accessor.componentType));
+
+    if (stride <= 0 || componentSize <= 0)
+        return false;
+
+    _rOutValues.clear();
+
+    if (accessor.count == 0)
+        return true;
+
+    // the last element has to end inside both the view and the buffer, the divisions keep a
+    // corrupt count from overflowing the product
+    const size_t elementSize    = static_cast<size_t>(componentSize) * _componentCount;
+    const size_t viewSize       = (std::min)(view.byteLength, buffer.data.size() - (std::min)(view.byteOffset, buffer.data.size()));
+
+    if (accessor.byteOffset > viewSize || viewSize - accessor.byteOffset < elementSize)
+        return false;
+
+    if (accessor.count - 1 > (viewSize - accessor.byteOffset - elementSize) / stride)
+        return false;
+
+    const unsigned char* pBase =
+        buffer.data.data() +
+        view.byteOffset +
+        accessor.byteOffset;
+
+    _rOutValues.resize(accessor.count * _componentCount);
+
+    for (size_t i = 0; i < accessor.count; ++i)
+    {
+        const unsigned char* pElement = pBase + i * stride;
+
+        for (int c = 0; c < _componentCount; ++c)
+        {
+            float value = 0.f;
+
+            // integer components are only mapped to [-1, 1] / [0, 1] when the accessor says so
+            switch (accessor.componentType)
+            {
+                case TINYGLTF_COMPONENT_TYPE_FLOAT:
+                    value = reinterpret_cast<const float*>(pElement)[c];
+                    break;
+
+                case TINYGLTF_COMPONENT_TYPE_BYTE:
+                    value = reinterpret_cast<const int8_t*>(pElement)[c];
+                    value = accessor.normalized ? (std::max)(value / 127.f, -1.f) : value;
+                    break;
+
+                case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+                    value = reinterpret_cast<const uint8_t*>(pElement)[c];
+                    value = accessor.normalized ? value / 255.f : value;
+                    break;
+
+                case TINYGLTF_COMPONENT_TYPE_SHORT:
+                    value = reinterpret_cast<const int16_t*>(pElement)[c];
+                    value = accessor.normalized ? (std::max)(value / 32767.f, -1.f) : value;
+                    break;
+
+                case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+                    value = reinterpret_cast<const uint16_t*>(pElement)[c];
+                    value = accessor.normalized ? value / 65535.f : value;
+                    break;
+
+                default:
+                    _rOutValues.clear();
+                    return false;
+            }
+
+            _rOutValues[i * _componentCount + c] = value;
+        }
+    }
+
+    return true;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
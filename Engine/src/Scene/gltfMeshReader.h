@@ -0,0 +1,30 @@
+#pragma once
+
+#include <vector>
+
+#include "Graphics/meshData.h"
+
+namespace tinygltf
+{
+	class Model;
+}
+
+// Converts glTF meshes into sMeshData in the engine's left handed space (X mirrored, winding
+// swapped). Only reads the parsed model, so it runs without a device and on any platform.
+class cGltfMeshReader
+{
+	public:
+
+		// appends every indexed primitive of the mesh
+		static void ReadMesh(const tinygltf::Model& _rModel, int _meshIndex, std::vector<sMeshData>& _rOutMeshes);
+
+		// one slot per entry of _rMeshIndices. Every mesh converts into its own slot, so the
+		// output is the same with and without _multithreaded and on any number of workers
+		static void ReadMeshes(const tinygltf::Model& _rModel, const std::vector<int>& _rMeshIndices,
+			std::vector<std::vector<sMeshData>>& _rOutSlots, bool _multithreaded);
+
+		// _componentCount floats per element. False unless the accessor type has that many components
+		// and every element lies inside its buffer view. Integer components are mapped to [-1, 1] /
+		// [0, 1] only for normalized accessors
+		static bool ReadAccessorFloats(const tinygltf::Model& _rModel, int _accessorIndex, int _componentCount, std::vector<float>& _rOutValues);
+};
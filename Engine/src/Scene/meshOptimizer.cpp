@@ -0,0 +1,444 @@
+#include "meshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+constexpr int   c_ForsythCacheSize          = 32;
+constexpr float c_ForsythCacheDecayPower    = 1.5f;
+constexpr float c_ForsythLastTriScore       = 0.75f;
+constexpr float c_ForsythValenceBoostScale  = 2.0f;
+constexpr float c_ForsythValenceBoostPower  = 0.5f;
+
+constexpr unsigned c_OverdrawCacheSize      = 16;
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+static float ForsythVertexScore(int _cachePosition, uint32_t _remainingValence)
+{
+    if (_remainingValence == 0)
+        return -1.0f;
+
+    float score = 0.0f;
+
+    if (_cachePosition >= 0)
+    {
+        if (_cachePosition < 3)
+        {
+            // the last triangle's vertices get a fixed score so strips are not favoured
+            score = c_ForsythLastTriScore;
+        }
+        else
+        {
+            const float scaler = 1.0f / (c_ForsythCacheSize - 3);
+            score = std::pow(1.0f - (_cachePosition - 3) * scaler, c_ForsythCacheDecayPower);
+        }
+    }
+
+    // boost vertices with few remaining triangles, so lone triangles do not get left behind
+    score += c_ForsythValenceBoostScale * std::pow(static_cast<float>(_remainingValence), -c_ForsythValenceBoostPower);
+
+    return score;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cMeshOptimizer::OptimizeVertexCache(uint32_t* _pIndices, size_t _indexCount, size_t _vertexCount)
+{
+    const size_t triangleCount = _indexCount / 3;
+
+    if (triangleCount == 0 || _vertexCount == 0)
+        return;
+
+    // ---------------------------------------------------------
+    // vertex -> triangle adjacency
+    // ---------------------------------------------------------
+    std::vector<uint32_t> remaining(_vertexCount, 0);
+
+    for (size_t i = 0; i < triangleCount * 3; ++i)
+    {
+        remaining[_pIndices[i]]++;
+    }
+
+    std::vector<uint32_t> offsets(_vertexCount + 1, 0);
+
+    for (size_t v = 0; v < _vertexCount; ++v)
+    {
+        offsets[v + 1] = offsets[v] + remaining[v];
+    }
+
+    std::vector<uint32_t> adjacency(offsets[_vertexCount]);
+    std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        for (size_t k = 0; k < 3; ++k)
+        {
+            adjacency[fill[_pIndices[t * 3 + k]]++] = static_cast<uint32_t>(t);
+        }
+    }
+
+    // ---------------------------------------------------------
+    // initial scores
+    // ---------------------------------------------------------
+    std::vector<int>     cachePosition(_vertexCount, -1);
+    std::vector<float>   vertexScore(_vertexCount);
+    std::vector<float>   triangleScore(triangleCount);
+    std::vector<uint8_t> emitted(triangleCount, 0);
+
+    for (size_t v = 0; v < _vertexCount; ++v)
+    {
+        vertexScore[v] = ForsythVertexScore(-1, remaining[v]);
+    }
+
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        triangleScore[t] =
+            vertexScore[_pIndices[t * 3 + 0]] +
+            vertexScore[_pIndices[t * 3 + 1]] +
+            vertexScore[_pIndices[t * 3 + 2]];
+    }
+
+    std::vector<uint32_t> output;
+    output.reserve(triangleCount * 3);
+
+    uint32_t cache[c_ForsythCacheSize + 3];
+    uint32_t nextCache[c_ForsythCacheSize + 3];
+    int      cacheCount = 0;
+
+    size_t   inputCursor  = 0;
+    int64_t  bestTriangle = 0;
+
+    for (size_t t = 1; t < triangleCount; ++t)
+    {
+        if (triangleScore[t] > triangleScore[bestTriangle])
+            bestTriangle = static_cast<int64_t>(t);
+    }
+
+    while (bestTriangle >= 0)
+    {
+        const uint32_t* pTriangle = &_pIndices[bestTriangle * 3];
+
+        output.insert(output.end(), pTriangle, pTriangle + 3);
+        emitted[bestTriangle] = 1;
+
+        // drop the triangle from the remaining adjacency of its vertices
+        for (int k = 0; k < 3; ++k)
+        {
+            const uint32_t vertex = pTriangle[k];
+
+            uint32_t* pBegin = &adjacency[offsets[vertex]];
+            uint32_t* pEnd   = pBegin + remaining[vertex];
+            uint32_t* pFound = std::find(pBegin, pEnd, static_cast<uint32_t>(bestTriangle));
+
+            if (pFound != pEnd)
+            {
+                *pFound = *(pEnd - 1);
+                remaining[vertex]--;
+            }
+        }
+
+        // new cache: the emitted triangle first, then the old entries
+        int nextCount = 0;
+
+        for (int k = 0; k < 3; ++k)
+        {
+            nextCache[nextCount++] = pTriangle[k];
+        }
+
+        for (int i = 0; i < cacheCount; ++i)
+        {
+            const uint32_t vertex = cache[i];
+
+            if (vertex != pTriangle[0] && vertex != pTriangle[1] && vertex != pTriangle[2])
+                nextCache[nextCount++] = vertex;
+        }
+
+        // rescore everything that moved or fell out of the cache
+        for (int i = 0; i < nextCount; ++i)
+        {
+            const uint32_t vertex = nextCache[i];
+
+            cachePosition[vertex] = i < c_ForsythCacheSize ? i : -1;
+            vertexScore[vertex]   = ForsythVertexScore(cachePosition[vertex], remaining[vertex]);
+        }
+
+        bestTriangle = -1;
+        float bestScore = -1.0f;
+
+        for (int i = 0; i < nextCount; ++i)
+        {
+            const uint32_t vertex = nextCache[i];
+
+            for (uint32_t a = 0; a < remaining[vertex]; ++a)
+            {
+                const uint32_t triangle = adjacency[offsets[vertex] + a];
+
+                const float score =
+                    vertexScore[_pIndices[triangle * 3 + 0]] +
+                    vertexScore[_pIndices[triangle * 3 + 1]] +
+                    vertexScore[_pIndices[triangle * 3 + 2]];
+
+                triangleScore[triangle] = score;
+
+                if (score > bestScore)
+                {
+                    bestScore    = score;
+                    bestTriangle = triangle;
+                }
+            }
+        }
+
+        cacheCount = std::min(nextCount, c_ForsythCacheSize);
+        std::memcpy(cache, nextCache, cacheCount * sizeof(uint32_t));
+
+        // nothing adjacent to the cache is left, continue with the next unused input triangle
+        if (bestTriangle < 0)
+        {
+            while (inputCursor < triangleCount && emitted[inputCursor])
+            {
+                ++inputCursor;
+            }
+
+            if (inputCursor < triangleCount)
+                bestTriangle = static_cast<int64_t>(inputCursor);
+        }
+    }
+
+    std::memcpy(_pIndices, output.data(), output.size() * sizeof(uint32_t));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cMeshOptimizer::OptimizeOverdraw(uint32_t* _pIndices, size_t _indexCount, const float* _pPositions,
+    size_t _vertexCount, size_t _positionStride)
+{
+    const size_t triangleCount = _indexCount / 3;
+
+    if (triangleCount < 2 || _vertexCount == 0)
+        return;
+
+    auto GetPosition = [&](uint32_t _vertex) -> const float*
+        {
+            return reinterpret_cast<const float*>(
+                reinterpret_cast<const uint8_t*>(_pPositions) + _vertex * _positionStride);
+        };
+
+    // ---------------------------------------------------------
+    // hard cache boundaries: a triangle whose three vertices all
+    // miss a FIFO cache can start a cluster without hurting ACMR
+    // ---------------------------------------------------------
+    std::vector<uint32_t> clusterStarts;
+    std::vector<uint32_t> cacheTimestamps(_vertexCount, 0);
+    uint32_t              timestamp = c_OverdrawCacheSize + 1;
+
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        int misses = 0;
+
+        for (int k = 0; k < 3; ++k)
+        {
+            const uint32_t vertex = _pIndices[t * 3 + k];
+
+            if (timestamp - cacheTimestamps[vertex] > c_OverdrawCacheSize)
+            {
+                cacheTimestamps[vertex] = timestamp++;
+                ++misses;
+            }
+        }
+
+        if (t == 0 || misses == 3)
+            clusterStarts.push_back(static_cast<uint32_t>(t));
+    }
+
+    const size_t clusterCount = clusterStarts.size();
+
+    if (clusterCount < 2)
+        return;
+
+    clusterStarts.push_back(static_cast<uint32_t>(triangleCount));
+
+    // ---------------------------------------------------------
+    // mesh centroid (area weighted)
+    // ---------------------------------------------------------
+    struct sCluster
+    {
+        float       centroid[3];
+        float       normal[3];
+        float       sortKey;
+        uint32_t    index;
+    };
+
+    std::vector<sCluster> clusters(clusterCount);
+
+    double meshCentroid[3]  = { 0.0, 0.0, 0.0 };
+    double meshArea         = 0.0;
+
+    for (size_t c = 0; c < clusterCount; ++c)
+    {
+        float centroid[3]   = { 0.f, 0.f, 0.f };
+        float normal[3]     = { 0.f, 0.f, 0.f };
+        float area          = 0.f;
+
+        for (uint32_t t = clusterStarts[c]; t < clusterStarts[c + 1]; ++t)
+        {
+            const float* p0 = GetPosition(_pIndices[t * 3 + 0]);
+            const float* p1 = GetPosition(_pIndices[t * 3 + 1]);
+            const float* p2 = GetPosition(_pIndices[t * 3 + 2]);
+
+            const float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+            const float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+
+            // clockwise front faces in a left handed frame: e1 x e2 points outwards
+            const float n[3] =
+            {
+                e1[1] * e2[2] - e1[2] * e2[1],
+                e1[2] * e2[0] - e1[0] * e2[2],
+                e1[0] * e2[1] - e1[1] * e2[0],
+            };
+
+            const float triangleArea = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+            for (int k = 0; k < 3; ++k)
+            {
+                centroid[k] += (p0[k] + p1[k] + p2[k]) * (triangleArea / 3.0f);
+                normal[k]   += n[k];
+            }
+
+            area += triangleArea;
+        }
+
+        const float invArea = area > 0.f ? 1.0f / area : 0.f;
+
+        for (int k = 0; k < 3; ++k)
+        {
+            meshCentroid[k] += centroid[k];
+            clusters[c].centroid[k] = centroid[k] * invArea;
+        }
+
+        const float normalLength = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        const float invNormal    = normalLength > 0.f ? 1.0f / normalLength : 0.f;
+
+        for (int k = 0; k < 3; ++k)
+        {
+            clusters[c].normal[k] = normal[k] * invNormal;
+        }
+
+        clusters[c].index = static_cast<uint32_t>(c);
+        meshArea += area;
+    }
+
+    if (meshArea <= 0.0)
+        return;
+
+    for (int k = 0; k < 3; ++k)
+    {
+        meshCentroid[k] /= meshArea;
+    }
+
+    // clusters that face away from the centroid occlude the others, draw them first
+    for (sCluster& rCluster : clusters)
+    {
+        rCluster.sortKey =
+            (rCluster.centroid[0] - static_cast<float>(meshCentroid[0])) * rCluster.normal[0] +
+            (rCluster.centroid[1] - static_cast<float>(meshCentroid[1])) * rCluster.normal[1] +
+            (rCluster.centroid[2] - static_cast<float>(meshCentroid[2])) * rCluster.normal[2];
+    }
+
+    std::stable_sort(clusters.begin(), clusters.end(), [](const sCluster& _rA, const sCluster& _rB)
+        {
+            return _rA.sortKey > _rB.sortKey;
+        });
+
+    std::vector<uint32_t> output;
+    output.reserve(triangleCount * 3);
+
+    for (const sCluster& rCluster : clusters)
+    {
+        output.insert(
+            output.end(),
+            _pIndices + clusterStarts[rCluster.index] * 3,
+            _pIndices + clusterStarts[rCluster.index + 1] * 3);
+    }
+
+    std::memcpy(_pIndices, output.data(), output.size() * sizeof(uint32_t));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+size_t cMeshOptimizer::OptimizeVertexFetch(uint32_t* _pIndices, size_t _indexCount, void* _pVertices,
+    size_t _vertexCount, size_t _vertexSize)
+{
+    constexpr uint32_t c_Unused = UINT32_MAX;
+
+    std::vector<uint32_t> remap(_vertexCount, c_Unused);
+    uint32_t              nextVertex = 0;
+
+    for (size_t i = 0; i < _indexCount; ++i)
+    {
+        uint32_t& rTarget = remap[_pIndices[i]];
+
+        if (rTarget == c_Unused)
+            rTarget = nextVertex++;
+
+        _pIndices[i] = rTarget;
+    }
+
+    std::vector<uint8_t> reordered(static_cast<size_t>(nextVertex) * _vertexSize);
+    const uint8_t*       pSource = static_cast<const uint8_t*>(_pVertices);
+
+    for (size_t v = 0; v < _vertexCount; ++v)
+    {
+        if (remap[v] != c_Unused)
+            std::memcpy(&reordered[remap[v] * _vertexSize], pSource + v * _vertexSize, _vertexSize);
+    }
+
+    std::memcpy(_pVertices, reordered.data(), reordered.size());
+
+    return nextVertex;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+sVertexCacheStats cMeshOptimizer::AnalyzeVertexCache(const uint32_t* _pIndices, size_t _indexCount,
+    size_t _vertexCount, unsigned _cacheSize)
+{
+    sVertexCacheStats stats = { 0.f, 0.f };
+
+    const size_t triangleCount = _indexCount / 3;
+
+    if (triangleCount == 0 || _vertexCount == 0)
+        return stats;
+
+    std::vector<uint32_t> cacheTimestamps(_vertexCount, 0);
+    std::vector<uint8_t>  referenced(_vertexCount, 0);
+
+    uint32_t timestamp      = _cacheSize + 1;
+    size_t   misses         = 0;
+    size_t   uniqueVertices = 0;
+
+    for (size_t i = 0; i < triangleCount * 3; ++i)
+    {
+        const uint32_t vertex = _pIndices[i];
+
+        if (timestamp - cacheTimestamps[vertex] > _cacheSize)
+        {
+            cacheTimestamps[vertex] = timestamp++;
+            ++misses;
+        }
+
+        if (!referenced[vertex])
+        {
+            referenced[vertex] = 1;
+            ++uniqueVertices;
+        }
+    }
+
+    stats.acmr = static_cast<float>(misses) / static_cast<float>(triangleCount);
+    stats.atvr = static_cast<float>(misses) / static_cast<float>(uniqueVertices);
+
+    return stats;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+struct sVertexCacheStats
+{
+	float acmr;		// average cache misses per triangle, 0.5 is ideal for regular grids
+	float atvr;		// average transformed vertices per referenced vertex, 1.0 is ideal
+};
+
+// Platform neutral index/vertex reordering. Works on raw arrays so it can run
+// on anything the loader produces, positions are read with an arbitrary stride.
+class cMeshOptimizer
+{
+	public:
+
+		// Forsyth's linear-speed vertex cache optimisation
+		static void OptimizeVertexCache(uint32_t* _pIndices, size_t _indexCount, size_t _vertexCount);
+
+		// Splits the cache-optimised triangle order into clusters at hard cache
+		// boundaries and sorts the clusters front to back (outward facing first).
+		// Run after OptimizeVertexCache, the per-cluster order is kept.
+		static void OptimizeOverdraw(uint32_t* _pIndices, size_t _indexCount, const float* _pPositions, 
+			size_t _vertexCount, size_t _positionStride);
+
+		// Reorders the vertex buffer into first-use order of the index buffer and
+		// rewrites the indices. Unreferenced vertices are dropped, returns the new count.
+		static size_t OptimizeVertexFetch(uint32_t* _pIndices, size_t _indexCount, void* _pVertices, 
+			size_t _vertexCount, size_t _vertexSize);
+
+		// FIFO post-transform cache simulation
+		static sVertexCacheStats AnalyzeVertexCache(const uint32_t* _pIndices, size_t _indexCount, 
+			size_t _vertexCount, unsigned _cacheSize);
+};
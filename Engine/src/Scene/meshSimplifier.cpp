@@ -0,0 +1,423 @@
+#include "meshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// symmetric 3x3 plane quadric, weighted by triangle area
+struct sQuadric
+{
+    double a00, a01, a02, a11, a12, a22;
+    double b0, b1, b2;
+    double c;
+    double weight;
+
+    void AddPlane(const double _n[3], double _d, double _weight)
+    {
+        a00 += _weight * _n[0] * _n[0];
+        a01 += _weight * _n[0] * _n[1];
+        a02 += _weight * _n[0] * _n[2];
+        a11 += _weight * _n[1] * _n[1];
+        a12 += _weight * _n[1] * _n[2];
+        a22 += _weight * _n[2] * _n[2];
+        b0  += _weight * _n[0] * _d;
+        b1  += _weight * _n[1] * _d;
+        b2  += _weight * _n[2] * _d;
+        c   += _weight * _d * _d;
+
+        weight += _weight;
+    }
+
+    void Add(const sQuadric& _rOther)
+    {
+        a00 += _rOther.a00; a01 += _rOther.a01; a02 += _rOther.a02;
+        a11 += _rOther.a11; a12 += _rOther.a12; a22 += _rOther.a22;
+        b0  += _rOther.b0;  b1  += _rOther.b1;  b2  += _rOther.b2;
+        c   += _rOther.c;
+
+        weight += _rOther.weight;
+    }
+
+    // mean squared distance of _p to the accumulated planes
+    double Evaluate(const float* _p) const
+    {
+        const double x = _p[0], y = _p[1], z = _p[2];
+
+        const double error =
+            a00 * x * x + 2.0 * a01 * x * y + 2.0 * a02 * x * z +
+            a11 * y * y + 2.0 * a12 * y * z + a22 * z * z +
+            2.0 * (b0 * x + b1 * y + b2 * z) + c;
+
+        return weight > 0.0 ? std::max(error, 0.0) / weight : 0.0;
+    }
+};
+
+struct sCollapse
+{
+    double      error;
+    uint32_t    source;
+    uint32_t    target;
+};
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+size_t cMeshSimplifier::Simplify(const uint32_t* _pIndices, size_t _indexCount, const float* _pPositions, size_t _vertexCount,
+    size_t _positionStride, size_t _targetIndexCount, float _targetError, uint32_t* _pOutIndices, float* _pOutError)
+{
+    auto GetPosition = [&](uint32_t _vertex)
+        {
+            return reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(_pPositions) + _vertex * _positionStride);
+        };
+
+    if (_pOutError)
+        *_pOutError = 0.0f;
+
+    // ---------------------------------------------------------
+    // working copy without degenerate / out of range triangles
+    // ---------------------------------------------------------
+    std::vector<uint32_t> indices;
+    indices.reserve(_indexCount);
+
+    for (size_t i = 0; i + 2 < _indexCount; i += 3)
+    {
+        const uint32_t a = _pIndices[i + 0];
+        const uint32_t b = _pIndices[i + 1];
+        const uint32_t c = _pIndices[i + 2];
+
+        if (a < _vertexCount && b < _vertexCount && c < _vertexCount && a != b && b != c && a != c)
+            indices.insert(indices.end(), { a, b, c });
+    }
+
+    // ---------------------------------------------------------
+    // locked vertices: shared positions (attribute seams),
+    // open or non-manifold edges
+    // ---------------------------------------------------------
+    std::vector<uint8_t> locked(_vertexCount, 0);
+
+    {
+        struct sPositionHash
+        {
+            size_t operator()(const uint32_t* _p) const
+            {
+                return (static_cast<size_t>(_p[0]) * 73856093u) ^ (static_cast<size_t>(_p[1]) * 19349663u) ^ (static_cast<size_t>(_p[2]) * 83492791u);
+            }
+        };
+
+        struct sPositionEqual
+        {
+            bool operator()(const uint32_t* _a, const uint32_t* _b) const
+            {
+                return _a[0] == _b[0] && _a[1] == _b[1] && _a[2] == _b[2];
+            }
+        };
+
+        std::unordered_map<const uint32_t*, uint32_t, sPositionHash, sPositionEqual> firstAtPosition;
+        firstAtPosition.reserve(_vertexCount);
+
+        for (uint32_t v = 0; v < _vertexCount; ++v)
+        {
+            auto [it, inserted] = firstAtPosition.emplace(reinterpret_cast<const uint32_t*>(GetPosition(v)), v);
+
+            if (!inserted)
+            {
+                locked[v]           = 1;
+                locked[it->second]  = 1;
+            }
+        }
+
+        std::vector<uint64_t> edges;
+        edges.reserve(indices.size());
+
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                const uint32_t a = indices[i + k];
+                const uint32_t b = indices[i + (k + 1) % 3];
+
+                edges.push_back((static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b));
+            }
+        }
+
+        std::sort(edges.begin(), edges.end());
+
+        for (size_t i = 0; i < edges.size(); )
+        {
+            size_t j = i + 1;
+
+            while (j < edges.size() && edges[j] == edges[i])
+                ++j;
+
+            // manifold interior edges are shared by exactly two triangles
+            if (j - i != 2)
+            {
+                locked[static_cast<uint32_t>(edges[i] >> 32)]           = 1;
+                locked[static_cast<uint32_t>(edges[i] & 0xFFFFFFFFu)]   = 1;
+            }
+
+            i = j;
+        }
+    }
+
+    // ---------------------------------------------------------
+    // vertex quadrics
+    // ---------------------------------------------------------
+    std::vector<sQuadric> quadrics(_vertexCount); // value initialised to zero
+
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        const float* p0 = GetPosition(indices[i + 0]);
+        const float* p1 = GetPosition(indices[i + 1]);
+        const float* p2 = GetPosition(indices[i + 2]);
+
+        const double e1[3] = { double(p1[0]) - p0[0], double(p1[1]) - p0[1], double(p1[2]) - p0[2] };
+        const double e2[3] = { double(p2[0]) - p0[0], double(p2[1]) - p0[1], double(p2[2]) - p0[2] };
+
+        double n[3] =
+        {
+            e1[1] * e2[2] - e1[2] * e2[1],
+            e1[2] * e2[0] - e1[0] * e2[2],
+            e1[0] * e2[1] - e1[1] * e2[0],
+        };
+
+        const double length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+        if (length <= 0.0)
+            continue;
+
+        n[0] /= length; n[1] /= length; n[2] /= length;
+
+        const double d      = -(n[0] * p0[0] + n[1] * p0[1] + n[2] * p0[2]);
+        const double area   = length * 0.5;
+
+        for (int k = 0; k < 3; ++k)
+        {
+            quadrics[indices[i + k]].AddPlane(n, d, area);
+        }
+    }
+
+    // ---------------------------------------------------------
+    // collapse passes: every pass collapses an independent set of
+    // the cheapest edges, then the index buffer is rewritten
+    // ---------------------------------------------------------
+    const double maxErrorSq     = static_cast<double>(_targetError) * _targetError;
+    double       resultErrorSq  = 0.0;
+
+    std::vector<uint32_t>   remap(_vertexCount);
+    std::vector<uint8_t>    touched(_vertexCount);
+    std::vector<uint32_t>   adjacencyOffsets(_vertexCount + 1);
+    std::vector<uint32_t>   adjacency;
+    std::vector<uint64_t>   edges;
+    std::vector<sCollapse>  collapses;
+
+    for (uint32_t v = 0; v < _vertexCount; ++v)
+    {
+        remap[v] = v;
+    }
+
+    auto TriangleNormal = [&](const float* _p0, const float* _p1, const float* _p2, double _outNormal[3])
+        {
+            const double e1[3] = { double(_p1[0]) - _p0[0], double(_p1[1]) - _p0[1], double(_p1[2]) - _p0[2] };
+            const double e2[3] = { double(_p2[0]) - _p0[0], double(_p2[1]) - _p0[1], double(_p2[2]) - _p0[2] };
+
+            _outNormal[0] = e1[1] * e2[2] - e1[2] * e2[1];
+            _outNormal[1] = e1[2] * e2[0] - e1[0] * e2[2];
+            _outNormal[2] = e1[0] * e2[1] - e1[1] * e2[0];
+        };
+
+    while (indices.size() > _targetIndexCount)
+    {
+        const size_t triangleCount = indices.size() / 3;
+
+        // ---- candidate edges ----
+        edges.clear();
+
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                const uint32_t a = indices[i + k];
+                const uint32_t b = indices[i + (k + 1) % 3];
+
+                if (!locked[a] || !locked[b])
+                    edges.push_back((static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b));
+            }
+        }
+
+        std::sort(edges.begin(), edges.end());
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+        collapses.clear();
+
+        for (uint64_t edge : edges)
+        {
+            const uint32_t a = static_cast<uint32_t>(edge >> 32);
+            const uint32_t b = static_cast<uint32_t>(edge & 0xFFFFFFFFu);
+
+            sQuadric combined = quadrics[a];
+            combined.Add(quadrics[b]);
+
+            sCollapse best = { -1.0, 0, 0 };
+
+            if (!locked[a])
+                best = { combined.Evaluate(GetPosition(b)), a, b };
+
+            if (!locked[b])
+            {
+                const double error = combined.Evaluate(GetPosition(a));
+
+                if (best.error < 0.0 || error < best.error)
+                    best = { error, b, a };
+            }
+
+            if (best.error >= 0.0 && best.error <= maxErrorSq)
+                collapses.push_back(best);
+        }
+
+        if (collapses.empty())
+            break;
+
+        std::sort(collapses.begin(), collapses.end(), [](const sCollapse& _a, const sCollapse& _b)
+            {
+                if (_a.error != _b.error)
+                    return _a.error < _b.error;
+
+                return _a.source != _b.source ? _a.source < _b.source : _a.target < _b.target;
+            });
+
+        // ---- vertex -> triangle adjacency ----
+        std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+
+        for (uint32_t index : indices)
+        {
+            ++adjacencyOffsets[index + 1];
+        }
+
+        for (size_t v = 0; v < _vertexCount; ++v)
+        {
+            adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+        }
+
+        adjacency.resize(indices.size());
+
+        {
+            std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+
+            for (size_t i = 0; i < indices.size(); ++i)
+            {
+                adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+            }
+        }
+
+        // ---- apply ----
+        std::fill(touched.begin(), touched.end(), 0);
+
+        const size_t targetTriangles    = _targetIndexCount / 3;
+        size_t       removedTriangles   = 0;
+        size_t       appliedCollapses   = 0;
+
+        for (const sCollapse& rCollapse : collapses)
+        {
+            if (triangleCount - removedTriangles <= targetTriangles)
+                break;
+
+            const uint32_t source = rCollapse.source;
+            const uint32_t target = rCollapse.target;
+
+            if (touched[source] || touched[target])
+                continue;
+
+            // reject collapses that flip or squash a remaining triangle
+            bool    flips   = false;
+            size_t  removed = 0;
+
+            for (uint32_t i = adjacencyOffsets[source]; i < adjacencyOffsets[source + 1] && !flips; ++i)
+            {
+                const uint32_t* pTriangle = &indices[adjacency[i] * 3];
+
+                if (pTriangle[0] == target || pTriangle[1] == target || pTriangle[2] == target)
+                {
+                    ++removed;
+                    continue;
+                }
+
+                const float* p[3];
+                const float* q[3];
+
+                for (int k = 0; k < 3; ++k)
+                {
+                    p[k] = GetPosition(pTriangle[k]);
+                    q[k] = pTriangle[k] == source ? GetPosition(target) : p[k];
+                }
+
+                double before[3];
+                double after[3];
+
+                TriangleNormal(p[0], p[1], p[2], before);
+                TriangleNormal(q[0], q[1], q[2], after);
+
+                const double dot            = before[0] * after[0] + before[1] * after[1] + before[2] * after[2];
+                const double lengthBefore   = std::sqrt(before[0] * before[0] + before[1] * before[1] + before[2] * before[2]);
+                const double lengthAfter    = std::sqrt(after[0] * after[0] + after[1] * after[1] + after[2] * after[2]);
+
+                if (dot <= 1e-2 * lengthBefore * lengthAfter)
+                    flips = true;
+            }
+
+            if (flips)
+                continue;
+
+            remap[source] = target;
+            quadrics[target].Add(quadrics[source]);
+
+            // every vertex around the source sees changed triangles, keep them out of this pass
+            for (uint32_t i = adjacencyOffsets[source]; i < adjacencyOffsets[source + 1]; ++i)
+            {
+                const uint32_t* pTriangle = &indices[adjacency[i] * 3];
+
+                touched[pTriangle[0]] = 1;
+                touched[pTriangle[1]] = 1;
+                touched[pTriangle[2]] = 1;
+            }
+
+            removedTriangles += removed;
+            resultErrorSq     = std::max(resultErrorSq, rCollapse.error);
+
+            ++appliedCollapses;
+        }
+
+        if (appliedCollapses == 0)
+            break;
+
+        // ---- rewrite, drop the collapsed triangles ----
+        size_t writeIndex = 0;
+
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            const uint32_t a = remap[indices[i + 0]];
+            const uint32_t b = remap[indices[i + 1]];
+            const uint32_t c = remap[indices[i + 2]];
+
+            if (a == b || b == c || a == c)
+                continue;
+
+            indices[writeIndex++] = a;
+            indices[writeIndex++] = b;
+            indices[writeIndex++] = c;
+        }
+
+        indices.resize(writeIndex);
+    }
+
+    std::copy(indices.begin(), indices.end(), _pOutIndices);
+
+    if (_pOutError)
+        *_pOutError = static_cast<float>(std::sqrt(resultErrorSq));
+
+    return indices.size();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Platform neutral quadric error edge collapse. Vertices only collapse onto
+// existing vertices, so every LOD reuses the original vertex buffer and only
+// needs its own index range. Open borders and attribute seams (vertices that
+// share a position) are locked, which keeps silhouettes and UV/normal seams intact.
+class cMeshSimplifier
+{
+	public:
+
+		// Simplifies until the index count reaches _targetIndexCount or the next
+		// collapse would move the surface by more than _targetError (mesh units).
+		// _pOutIndices needs room for _indexCount indices, returns the written count.
+		// _pOutError receives the largest error that was introduced, may be null.
+		static size_t Simplify(const uint32_t* _pIndices, size_t _indexCount, const float* _pPositions, size_t _vertexCount,
+			size_t _positionStride, size_t _targetIndexCount, float _targetError, uint32_t* _pOutIndices, float* _pOutError);
+};
@@ -0,0 +1,277 @@
+#include "meshletBuilder.h"
+
+#include <algorithm>
+#include <cmath>
+
+// a cone whose narrowest normal is this close to the side plane culls too rarely to be worth testing
+constexpr float c_MeshletMinConeDot = 0.1f;
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cMeshletBuilder::Build(const uint32_t* _pIndices, size_t _indexCount, const float* _pPositions, size_t _vertexCount,
+    size_t _positionStride, sMeshletData& _rOutData)
+{
+    _rOutData.meshlets.clear();
+    _rOutData.vertices.clear();
+    _rOutData.triangles.clear();
+
+    const size_t triangleCount = _indexCount / 3;
+
+    if (triangleCount == 0 || _vertexCount == 0)
+        return;
+
+    // rough upper bound, the scan rarely leaves a meshlet less than half full
+    _rOutData.meshlets.reserve(triangleCount / (c_MeshletMaxTriangles / 2) + 1);
+    _rOutData.triangles.reserve(triangleCount * 3);
+
+    // mesh vertex -> slot in the open meshlet, 0xFF when it is not in there
+    std::vector<uint8_t> localIndices(_vertexCount, 0xFF);
+
+    sMeshlet meshlet = {};
+
+    auto Flush = [&]()
+        {
+            if (meshlet.triangleCount == 0)
+                return;
+
+            for (uint32_t i = 0; i < meshlet.vertexCount; ++i)
+            {
+                localIndices[_rOutData.vertices[meshlet.vertexOffset + i]] = 0xFF;
+            }
+
+            ComputeBounds(_rOutData, meshlet, _pPositions, _positionStride);
+            _rOutData.meshlets.push_back(meshlet);
+
+            meshlet                 = {};
+            meshlet.vertexOffset    = static_cast<uint32_t>(_rOutData.vertices.size());
+            meshlet.triangleOffset  = static_cast<uint32_t>(_rOutData.triangles.size());
+        };
+
+    for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+    {
+        const uint32_t* pTriangle = _pIndices + triangle * 3;
+
+        const uint32_t a = pTriangle[0];
+        const uint32_t b = pTriangle[1];
+        const uint32_t c = pTriangle[2];
+
+        // degenerate triangles rasterise nothing, out of range ones would corrupt the lookup
+        if (a >= _vertexCount || b >= _vertexCount || c >= _vertexCount || a == b || b == c || a == c)
+            continue;
+
+        const uint32_t newVertices =
+            (localIndices[a] == 0xFF ? 1u : 0u) +
+            (localIndices[b] == 0xFF ? 1u : 0u) +
+            (localIndices[c] == 0xFF ? 1u : 0u);
+
+        if (meshlet.vertexCount + newVertices > c_MeshletMaxVertices || meshlet.triangleCount + 1u > c_MeshletMaxTriangles)
+            Flush();
+
+        for (uint32_t vertex : { a, b, c })
+        {
+            if (localIndices[vertex] == 0xFF)
+            {
+                localIndices[vertex] = meshlet.vertexCount++;
+                _rOutData.vertices.push_back(vertex);
+            }
+
+            _rOutData.triangles.push_back(localIndices[vertex]);
+        }
+
+        ++meshlet.triangleCount;
+    }
+
+    Flush();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+bool cMeshletBuilder::IsBackfacing(const sMeshlet& _rMeshlet, const float _eye[3])
+{
+    if (_rMeshlet.coneCutoff == 127)
+        return false;
+
+    const float toCenter[3] =
+    {
+        _rMeshlet.center[0] - _eye[0],
+        _rMeshlet.center[1] - _eye[1],
+        _rMeshlet.center[2] - _eye[2],
+    };
+
+    const float distance = std::sqrt(toCenter[0] * toCenter[0] + toCenter[1] * toCenter[1] + toCenter[2] * toCenter[2]);
+
+    const float axisDot =
+        toCenter[0] * (_rMeshlet.coneAxis[0] / 127.0f) +
+        toCenter[1] * (_rMeshlet.coneAxis[1] / 127.0f) +
+        toCenter[2] * (_rMeshlet.coneAxis[2] / 127.0f);
+
+    return axisDot >= (_rMeshlet.coneCutoff / 127.0f) * distance + _rMeshlet.radius;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cMeshletBuilder::ComputeBounds(const sMeshletData& _rData, sMeshlet& _rMeshlet, const float* _pPositions, size_t _positionStride)
+{
+    const uint32_t* pVertices = _rData.vertices.data() + _rMeshlet.vertexOffset;
+
+    auto GetPosition = [&](uint32_t _localIndex)
+        {
+            const uint8_t* pBytes = reinterpret_cast<const uint8_t*>(_pPositions) + pVertices[_localIndex] * _positionStride;
+            return reinterpret_cast<const float*>(pBytes);
+        };
+
+    auto DistanceSq = [](const float* _a, const float* _b)
+        {
+            const float d[3] = { _a[0] - _b[0], _a[1] - _b[1], _a[2] - _b[2] };
+            return d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+        };
+
+    // ---------------------------------------------------------
+    // bounding sphere (Ritter)
+    // ---------------------------------------------------------
+    uint32_t extremes[6] = { 0, 0, 0, 0, 0, 0 }; // min / max per axis
+
+    for (uint32_t i = 1; i < _rMeshlet.vertexCount; ++i)
+    {
+        const float* p = GetPosition(i);
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            if (p[axis] < GetPosition(extremes[axis * 2 + 0])[axis]) extremes[axis * 2 + 0] = i;
+            if (p[axis] > GetPosition(extremes[axis * 2 + 1])[axis]) extremes[axis * 2 + 1] = i;
+        }
+    }
+
+    int   widestAxis    = 0;
+    float widestSq      = -1.0f;
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const float spanSq = DistanceSq(GetPosition(extremes[axis * 2 + 0]), GetPosition(extremes[axis * 2 + 1]));
+
+        if (spanSq > widestSq)
+        {
+            widestSq    = spanSq;
+            widestAxis  = axis;
+        }
+    }
+
+    const float* pMin = GetPosition(extremes[widestAxis * 2 + 0]);
+    const float* pMax = GetPosition(extremes[widestAxis * 2 + 1]);
+
+    float center[3] = { (pMin[0] + pMax[0]) * 0.5f, (pMin[1] + pMax[1]) * 0.5f, (pMin[2] + pMax[2]) * 0.5f };
+    float radius    = std::sqrt(widestSq) * 0.5f;
+
+    for (uint32_t i = 0; i < _rMeshlet.vertexCount; ++i)
+    {
+        const float* p          = GetPosition(i);
+        const float  distance   = std::sqrt(DistanceSq(p, center));
+
+        if (distance > radius)
+        {
+            const float newRadius   = (radius + distance) * 0.5f;
+            const float shift       = (newRadius - radius) / distance;
+
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                center[axis] += (p[axis] - center[axis]) * shift;
+            }
+
+            radius = newRadius;
+        }
+    }
+
+    // float rounding in the growth steps can leave a vertex a hair outside
+    for (uint32_t i = 0; i < _rMeshlet.vertexCount; ++i)
+    {
+        radius = std::max(radius, std::sqrt(DistanceSq(GetPosition(i), center)));
+    }
+
+    std::copy(center, center + 3, _rMeshlet.center);
+    _rMeshlet.radius = radius;
+
+    // ---------------------------------------------------------
+    // normal cone
+    // ---------------------------------------------------------
+    const uint8_t* pTriangles = _rData.triangles.data() + _rMeshlet.triangleOffset;
+
+    float normals[c_MeshletMaxTriangles][3];
+    uint32_t normalCount = 0;
+
+    float axis[3] = { 0.f, 0.f, 0.f };
+
+    for (uint32_t t = 0; t < _rMeshlet.triangleCount; ++t)
+    {
+        const float* p0 = GetPosition(pTriangles[t * 3 + 0]);
+        const float* p1 = GetPosition(pTriangles[t * 3 + 1]);
+        const float* p2 = GetPosition(pTriangles[t * 3 + 2]);
+
+        const float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+        const float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+
+        // clockwise front faces in a left handed frame: e1 x e2 points outwards
+        float n[3] =
+        {
+            e1[1] * e2[2] - e1[2] * e2[1],
+            e1[2] * e2[0] - e1[0] * e2[2],
+            e1[0] * e2[1] - e1[1] * e2[0],
+        };
+
+        const float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+        if (length <= 0.0f)
+            continue;
+
+        for (int k = 0; k < 3; ++k)
+        {
+            n[k] /= length;
+            axis[k] += n[k];
+            normals[normalCount][k] = n[k];
+        }
+
+        ++normalCount;
+    }
+
+    const float axisLength = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+
+    float minDot = -1.0f;
+
+    if (axisLength > 0.0f)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            axis[k] /= axisLength;
+        }
+
+        minDot = 1.0f;
+
+        for (uint32_t t = 0; t < normalCount; ++t)
+        {
+            minDot = std::min(minDot, normals[t][0] * axis[0] + normals[t][1] * axis[1] + normals[t][2] * axis[2]);
+        }
+    }
+
+    if (minDot <= c_MeshletMinConeDot)
+    {
+        _rMeshlet.coneAxis[0]   = 0;
+        _rMeshlet.coneAxis[1]   = 0;
+        _rMeshlet.coneAxis[2]   = 0;
+        _rMeshlet.coneCutoff    = 127;
+        return;
+    }
+
+    // sin of the widest normal's angle to the axis, plus the error the snorm8 axis adds
+    float cutoff = std::sqrt(1.0f - minDot * minDot);
+
+    for (int k = 0; k < 3; ++k)
+    {
+        const int quantized = static_cast<int>(std::lround(axis[k] * 127.0f));
+
+        _rMeshlet.coneAxis[k] = static_cast<int8_t>(std::min(std::max(quantized, -127), 127));
+        cutoff += std::fabs(_rMeshlet.coneAxis[k] / 127.0f - axis[k]);
+    }
+
+    _rMeshlet.coneCutoff = static_cast<int8_t>(std::min(static_cast<int>(cutoff * 127.0f) + 1, 127));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+constexpr uint32_t c_MeshletMaxVertices		= 64;
+constexpr uint32_t c_MeshletMaxTriangles	= 124;
+
+// --------------------------------------------------------------------------------------------------------------------------
+// 32 byte cluster record. Vertices are indices into the mesh's own vertex range,
+// triangles are three local uint8 indices into the meshlet's vertex list.
+//
+// Backface test with the sphere, everything in mesh space:
+//   dot(center - eye, axis) >= cutoff * length(center - eye) + radius  ->  all triangles face away
+// A cutoff of 127 disables the cone test.
+// --------------------------------------------------------------------------------------------------------------------------
+
+struct sMeshlet
+{
+	uint32_t	vertexOffset;		// into the meshlet vertex pool
+	uint32_t	triangleOffset;		// into the meshlet triangle pool, in bytes
+	uint8_t		vertexCount;
+	uint8_t		triangleCount;
+	uint16_t	padding;
+
+	float		center[3];
+	float		radius;
+
+	int8_t		coneAxis[3];		// snorm8
+	int8_t		coneCutoff;			// snorm8, rounded up so the test stays conservative
+};
+
+static_assert(sizeof(sMeshlet) == 32, "sMeshlet is stored in the cooked scene");
+
+struct sMeshletData
+{
+	std::vector<sMeshlet>	meshlets;
+	std::vector<uint32_t>	vertices;
+	std::vector<uint8_t>	triangles;
+};
+
+// Platform neutral cluster builder. Triangles are taken in index buffer order,
+// so it works best after cMeshOptimizer::OptimizeVertexCache.
+class cMeshletBuilder
+{
+	public:
+
+		// Output only depends on the input, callers may run one mesh per worker.
+		static void Build(const uint32_t* _pIndices, size_t _indexCount, const float* _pPositions, size_t _vertexCount,
+			size_t _positionStride, sMeshletData& _rOutData);
+
+		static bool IsBackfacing(const sMeshlet& _rMeshlet, const float _eye[3]);
+
+	private:
+
+		static void ComputeBounds(const sMeshletData& _rData, sMeshlet& _rMeshlet, const float* _pPositions, size_t _positionStride);
+};
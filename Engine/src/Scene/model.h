@@ -1,17 +1,25 @@
 #pragma once
 
+#include <cstdint>
 #include <vector>
 
 #include "graphics/meshData.h"
 #include "graphics/material.h"
 #include "graphics/cpuTexture.h"
+#include "Graphics/textureRef.h"
 #include "graphics/Light.h"
 
+#include "sceneGraph.h"
+
 struct sModel
 {
-    std::vector<sMeshData>       meshes;
+    std::vector<sMeshData>       meshes;                // unique primitives, shared by all instances
     std::vector<sMaterial>       materials;
-    std::vector<XMMATRIX>        worldMatrices;
+    std::vector<XMMATRIX>        worldMatrices;         // one per instance
+    std::vector<uint32_t>        instanceMeshIndices;   // one per instance, index into meshes
+    std::vector<uint32_t>        instanceNodes;         // one per instance, the scene graph node it moves with
+    cSceneGraph                  sceneGraph;            // worldMatrices are its worlds as of the load
     std::vector<cCpuTexture>     cpuTextures;
+    std::vector<sTextureRef>     textureRefs;           // one per glTF texture, sMaterial indices point here
     std::vector<sLightConstants> lights;
 };
\ No newline at end of file
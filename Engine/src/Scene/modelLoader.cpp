@@ -1,16 +1,46 @@
 #include "modelLoader.h"
 
-#include <stack>
+#include <cstring>
 #include <chrono>
+#include <filesystem>
+#include <future>
 
 #include "model.h"
+#include "cookedScene.h"
+#include "sceneGraph.h"
+#include "gltfMeshReader.h"
+#include "meshOptimizer.h"
+#include "tangentGenerator.h"
+#include "meshletBuilder.h"
+#include "meshSimplifier.h"
+#include "Core/parallel.h"
+#include "Graphics/meshGeometry.h"
+#include "Graphics/textureProcessor.h"
+#include "Graphics/texturePayload.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #define TINYGLTF_IMPLEMENTATION
 #include "tiny_gltf.h"
 
-std::unordered_map<int, uint32_t> cModelLoader::s_gltfMaterialToEngineMaterial{};
+// post-load mesh optimisation, the cooked scene stores the optimised buffers
+constexpr bool		c_OptimizeMeshes			= true;
+constexpr bool		c_OptimizeOverdraw			= false;
+constexpr unsigned	c_AnalyzeVertexCacheSize	= 16;
+
+// LOD chain, every level targets half the triangles of the previous one and stops early
+// when the simplifier gets stuck or would deviate more than a fraction of the mesh radius
+constexpr bool		c_GenerateLods				= true;
+constexpr size_t	c_LodMinTriangles			= 512;
+constexpr float		c_LodReduction				= 0.5f;
+constexpr float		c_LodMinProgress			= 0.9f;
+constexpr float		c_LodMaxRelativeError		= 0.05f;
+
+// meshes at least this large generate their tangents on all workers, smaller ones run one per worker
+constexpr size_t	c_ParallelTangentIndexCount	= 1 << 18;
+
+// images that fail to decode become a single texel of this colour so texture indices stay valid
+constexpr uint8_t	c_MissingImageColor[4]		= { 255, 0, 255, 255 };
 
 // --------------------------------------------------------------------------------------------------------------------------
 
@@ -23,12 +53,21 @@ void cModelLoader::LoadGLTFModel(std::string& _rFilePath, sModel& _rOutModel)
 	_rOutModel.meshes.clear(); 
 	_rOutModel.materials.clear();
 	_rOutModel.worldMatrices.clear(); 
+	_rOutModel.instanceMeshIndices.clear();
+	_rOutModel.instanceNodes.clear();
+	_rOutModel.sceneGraph.Clear();
 	_rOutModel.cpuTextures.clear();
+	_rOutModel.textureRefs.clear();
+
+	cTextureArena::ResetStats();
 
 	tinygltf::Model		model;
 	tinygltf::TinyGLTF	loader;
 	std::string			err, warn;
 
+	// tinygltf only keeps the encoded bytes, DecodeImages runs alongside mesh extraction
+	loader.SetImageLoader(&cModelLoader::DeferImageDecode, nullptr);
+
 	auto parseStart = Clock::now();
 
 	bool ret = false;
@@ -128,6 +167,13 @@ void cModelLoader::LoadGLTFModel(std::string& _rFilePath, sModel& _rOutModel)
 		const auto& node = model.nodes[nodeIndex];
 	}
 
+	std::vector<cTexturePayload> imagePixels;
+
+	std::future<void> imageDecode = std::async(std::launch::async, [&model, &imagePixels]()
+		{
+			DecodeImages(model, imagePixels);
+		});
+
 	auto materialStart = Clock::now();
 
 	for (size_t i = 0; i < model.materials.size(); ++i)
@@ -147,20 +193,100 @@ void cModelLoader::LoadGLTFModel(std::string& _rFilePath, sModel& _rOutModel)
 	
 	auto meshStart =
 		Clock::now();
-	ProcessSceneIterative(model, scene, _rOutModel);
+
+	std::vector<sMeshJob>	meshJobs;
+	std::vector<sLightJob>	lightJobs;
+
+	BuildSceneGraph(model, scene, _rOutModel.sceneGraph, meshJobs, lightJobs);
+
+	_rOutModel.sceneGraph.UpdateWorlds();
+
+	auto walkEnd =
+		Clock::now();
+
+	ExtractMeshJobs(model, meshJobs, _rOutModel);
 
 	auto meshEnd =
 		Clock::now();
 
+	std::cout
+		<< "Node walk: "
+		<< std::chrono::duration<double>(
+			walkEnd - meshStart).count()
+		<< " seconds (" << _rOutModel.sceneGraph.GetNodeCount() << " nodes, "
+		<< _rOutModel.sceneGraph.GetLevelCount() << " levels, " << meshJobs.size() << " mesh jobs)\n";
+
 	std::cout
 		<< "Mesh extraction: "
 		<< std::chrono::duration<double>(
-			meshEnd - meshStart).count()
+			meshEnd - walkEnd).count()
+		<< " seconds (" << cParallel::GetWorkerCount() << " workers)\n";
+
+	auto tangentStart =
+		Clock::now();
+
+	GenerateTangents(_rOutModel.meshes);
+
+	std::cout
+		<< "Tangent generation: "
+		<< std::chrono::duration<double>(
+			Clock::now() - tangentStart).count()
+		<< " seconds\n";
+
+	if (c_OptimizeMeshes)
+	{
+		auto optimizeStart =
+			Clock::now();
+
+		OptimizeMeshes(_rOutModel.meshes);
+
+		std::cout
+			<< "Mesh optimization: "
+			<< std::chrono::duration<double>(
+				Clock::now() - optimizeStart).count()
+			<< " seconds\n";
+	}
+
+	if (c_GenerateLods)
+	{
+		auto lodStart =
+			Clock::now();
+
+		GenerateLods(_rOutModel.meshes);
+
+		std::cout
+			<< "LOD generation: "
+			<< std::chrono::duration<double>(
+				Clock::now() - lodStart).count()
+			<< " seconds\n";
+	}
+
+	// last geometry pass, meshlets reference the final index order
+	auto meshletStart =
+		Clock::now();
+
+	BuildMeshlets(_rOutModel.meshes);
+
+	std::cout
+		<< "Meshlet build: "
+		<< std::chrono::duration<double>(
+			Clock::now() - meshletStart).count()
+		<< " seconds\n";
+
+	auto decodeWaitStart =
+		Clock::now();
+
+	imageDecode.get();
+
+	std::cout
+		<< "Image decode wait: "
+		<< std::chrono::duration<double>(
+			Clock::now() - decodeWaitStart).count()
 		<< " seconds\n";
 
 	auto textureStart =
 		Clock::now();
-	CreateTexturesFromGltf(model, _rOutModel);
+	CreateTexturesFromGltf(model, imagePixels, _rOutModel);
 
 	auto textureEnd =
 		Clock::now();
@@ -171,346 +297,514 @@ void cModelLoader::LoadGLTFModel(std::string& _rFilePath, sModel& _rOutModel)
 			textureEnd - textureStart).count()
 		<< " seconds\n";
 
-	CreateLightsFromGltf(model, _rOutModel);
+	cTextureProcessor::Process(_rOutModel);
+
+	const sTextureArenaStats arenaStats = cTextureArena::GetStats();
+
+	std::cout
+		<< "Texture payloads: "
+		<< arenaStats.allocations << " allocations, "
+		<< arenaStats.reuses << " reused, "
+		<< arenaStats.adoptions << " adopted from the decoder, peak "
+		<< arenaStats.peakBytes / (1024 * 1024) << " MB\n";
+
+	CreateLightsFromGltf(model, lightJobs, _rOutModel);
 }
 
 // --------------------------------------------------------------------------------------------------------------------------
 
-void cModelLoader::ProcessSceneIterative(tinygltf::Model& _rModel, const tinygltf::Scene& _rScene, sModel& _rOutModel)
+bool cModelLoader::LoadCookedScene(std::string& _rFilePath, cCookedScene& _rOutScene)
 {
-	std::vector<sNodeJob> stack;
-	stack.reserve(_rModel.nodes.size());
+	using Clock = std::chrono::high_resolution_clock;
 
-	for (int root : _rScene.nodes)
+	const std::string cookedPath =
+		std::filesystem::path(_rFilePath).replace_extension(".zscene").string();
+
+	auto openStart = Clock::now();
+
+	if (_rOutScene.Open(cookedPath, _rFilePath))
 	{
-		stack.push_back({ root, XMMatrixIdentity() });
+		std::cout
+			<< "Cooked scene mapped: "
+			<< std::chrono::duration<double>(
+				Clock::now() - openStart).count()
+			<< " seconds\n";
+
+		return true;
 	}
 
-	while (!stack.empty())
+	bool cooked = false;
+
 	{
-		sNodeJob job = stack.back();
-		stack.pop_back();
+		sModel model;
+		LoadGLTFModel(_rFilePath, model);
 
-		const tinygltf::Node& node = _rModel.nodes[job.nodeIndex];
+		cooked = !model.meshes.empty() && cCookedScene::Write(cookedPath, _rFilePath, model);
+	}
 
-		XMMATRIX localRH = XMMatrixIdentity();
+	// the model's payloads are back in the pool now, nothing loads after cooking
+	cTextureArena::Trim();
 
-		if (node.matrix.size() == 16)
-		{
-			localRH = XMMatrixSet(
-				(float)node.matrix[0], (float)node.matrix[1],
-				(float)node.matrix[2], (float)node.matrix[3],
+	return cooked && _rOutScene.Open(cookedPath, _rFilePath);
+}
 
-				(float)node.matrix[4], (float)node.matrix[5],
-				(float)node.matrix[6], (float)node.matrix[7],
+// --------------------------------------------------------------------------------------------------------------------------
 
-				(float)node.matrix[8], (float)node.matrix[9],
-				(float)node.matrix[10], (float)node.matrix[11],
+void cModelLoader::BuildSceneGraph(const tinygltf::Model& _rModel, const tinygltf::Scene& _rScene, cSceneGraph& _rOutGraph,
+	std::vector<sMeshJob>& _rOutMeshJobs, std::vector<sLightJob>& _rOutLightJobs)
+{
+	_rOutGraph.Clear();
+	_rOutGraph.Reserve(_rModel.nodes.size());
 
-				(float)node.matrix[12], (float)node.matrix[13],
-				(float)node.matrix[14], (float)node.matrix[15]
-			);
+	// one level of the hierarchy per pass, the graph wants every node after the level of its parent
+	std::vector<sNodeJob>		level;
+	std::vector<sNodeJob>		nextLevel;
+	std::vector<sInstanceJob>	instances;
+	std::vector<sInstanceJob>	nextInstances;
+	std::vector<XMFLOAT4X4>		instanceLocals;
+
+	// glTF nodes have one parent, a broken file must not add a node twice
+	std::vector<uint8_t> visited(_rModel.nodes.size(), 0);
+
+	for (int root : _rScene.nodes)
+	{
+		level.push_back({ root, cSceneGraph::c_InvalidNode });
+	}
+
+	while (!level.empty() || !instances.empty())
+	{
+		nextLevel.clear();
+		nextInstances.clear();
+
+		// GPU instances are children of their node, a level below it
+		for (const sInstanceJob& rInstance : instances)
+		{
+			const uint32_t sceneNode = _rOutGraph.AddNode(rInstance.parent, rInstance.local);
+
+			_rOutMeshJobs.push_back({ rInstance.meshIndex, sceneNode });
 		}
-		else
+
+		for (const sNodeJob& rJob : level)
 		{
-			XMVECTOR t = XMVectorSet(
-				node.translation.size() > 0 ? (float)node.translation[0] : 0.f,
-				node.translation.size() > 1 ? (float)node.translation[1] : 0.f,
-				node.translation.size() > 2 ? (float)node.translation[2] : 0.f,
-				1.f);
+			if (rJob.nodeIndex < 0 || rJob.nodeIndex >= static_cast<int>(_rModel.nodes.size()) || visited[rJob.nodeIndex])
+				continue;
+
+			visited[rJob.nodeIndex] = 1;
+
+			const tinygltf::Node& node = _rModel.nodes[rJob.nodeIndex];
+
+			XMFLOAT4X4 local;
+			XMStoreFloat4x4(&local, GetNodeLocalMatrix(node));
 
-			XMVECTOR r = XMQuaternionIdentity();
+			const uint32_t sceneNode = _rOutGraph.AddNode(rJob.parent, local);
 
-			if (node.rotation.size() == 4)
+			if (node.mesh >= 0)
 			{
-				r = XMVectorSet(
-					(float)node.rotation[0],
-					(float)node.rotation[1],
-					(float)node.rotation[2],
-					(float)node.rotation[3]);
+				auto instancingIt = node.extensions.find("EXT_mesh_gpu_instancing");
+
+				if (instancingIt != node.extensions.end() && ReadGpuInstances(_rModel, instancingIt->second, instanceLocals))
+				{
+					for (const XMFLOAT4X4& rInstanceLocal : instanceLocals)
+					{
+						nextInstances.push_back({ node.mesh, sceneNode, rInstanceLocal });
+					}
+				}
+				else
+				{
+					_rOutMeshJobs.push_back({ node.mesh, sceneNode });
+				}
 			}
 
-			XMVECTOR s = XMVectorSet(
-				node.scale.size() > 0 ? (float)node.scale[0] : 1.f,
-				node.scale.size() > 1 ? (float)node.scale[1] : 1.f,
-				node.scale.size() > 2 ? (float)node.scale[2] : 1.f,
-				0.f);
-
-			localRH = XMMatrixAffineTransformation(
-				s,
-				XMVectorZero(),
-				r,
-				t);
-		}
+			if (node.light >= 0)
+			{
+				_rOutLightJobs.push_back({ node.light, sceneNode });
+			}
 
-		static const XMMATRIX flipX =
-			XMMatrixScaling(-1.f, 1.f, 1.f);
+			for (int child : node.children)
+			{
+				nextLevel.push_back({ child, sceneNode });
+			}
+		}
 
-		XMMATRIX localLH =
-			flipX * localRH * flipX;
+		std::swap(level, nextLevel);
+		std::swap(instances, nextInstances);
+	}
+}
 
-		XMMATRIX world =
-			localLH * job.parentMatrix;
+// --------------------------------------------------------------------------------------------------------------------------
 
-		if (node.mesh >= 0)
+void cModelLoader::ExtractMeshJobs(const tinygltf::Model& _rModel, const std::vector<sMeshJob>& _rJobs, sModel& _rOutModel)
+{
+	// ---------------------------------------------------------
+	// geometry cache: every glTF mesh is extracted once, in the
+	// order it is first referenced, no matter how many nodes use it
+	// ---------------------------------------------------------
+	std::vector<int>					uniqueMeshes;
+	std::unordered_map<int, size_t>		meshToSlot;
+
+	for (const sMeshJob& rJob : _rJobs)
+	{
+		if (meshToSlot.emplace(rJob.meshIndex, uniqueMeshes.size()).second)
 		{
-			size_t oldCount = _rOutModel.meshes.size();
+			uniqueMeshes.push_back(rJob.meshIndex);
+		}
+	}
 
-			ExtractPrimitives(_rModel, node.mesh, _rOutModel);
+	// every mesh converts into its own slot, so the output order only
+	// depends on the node walk and not on which worker finished first
+	std::vector<std::vector<sMeshData>> slotMeshes;
 
-			size_t newCount = _rOutModel.meshes.size();
+	cGltfMeshReader::ReadMeshes(_rModel, uniqueMeshes, slotMeshes, true);
 
-			_rOutModel.worldMatrices.reserve(newCount);
+	std::vector<uint32_t> slotFirstPrimitive(uniqueMeshes.size());
+	std::vector<uint32_t> slotPrimitiveCount(uniqueMeshes.size());
 
-			for (size_t i = oldCount; i < newCount; ++i)
-			{
-				_rOutModel.worldMatrices.push_back(world);
-			}
+	for (size_t slot = 0; slot < uniqueMeshes.size(); ++slot)
+	{
+		slotFirstPrimitive[slot] = static_cast<uint32_t>(_rOutModel.meshes.size());
+		slotPrimitiveCount[slot] = static_cast<uint32_t>(slotMeshes[slot].size());
+
+		for (sMeshData& rMeshData : slotMeshes[slot])
+		{
+			_rOutModel.meshes.push_back(std::move(rMeshData));
 		}
+	}
+
+	// ---------------------------------------------------------
+	// instances only add a transform per primitive
+	// ---------------------------------------------------------
+	for (const sMeshJob& rJob : _rJobs)
+	{
+		const size_t slot = meshToSlot[rJob.meshIndex];
 
-		for (int child : node.children)
+		for (uint32_t primitive = 0; primitive < slotPrimitiveCount[slot]; ++primitive)
 		{
-			stack.push_back({ child, world });
+			_rOutModel.instanceMeshIndices.push_back(slotFirstPrimitive[slot] + primitive);
+			_rOutModel.instanceNodes.push_back(rJob.sceneNode);
+			_rOutModel.worldMatrices.push_back(XMLoadFloat4x4(&_rOutModel.sceneGraph.GetWorld(rJob.sceneNode)));
 		}
 	}
+
+	std::cout
+		<< "Geometry cache: "
+		<< uniqueMeshes.size() << " unique meshes, "
+		<< _rOutModel.meshes.size() << " primitives, "
+		<< _rOutModel.worldMatrices.size() << " instances\n";
 }
 
-// ----------------------------------------------------------------------------------	----------------------------------------
+// --------------------------------------------------------------------------------------------------------------------------
 
-void cModelLoader::ExtractPrimitives(tinygltf::Model& model, int meshIndex, sModel& _rOutModel)
+void cModelLoader::OptimizeMeshes(std::vector<sMeshData>& _rMeshes)
 {
-    const tinygltf::Mesh& mesh = model.meshes[meshIndex];
-
-    std::vector<sMeshData>& rMeshes =
-        _rOutModel.meshes;
+	std::vector<sVertexCacheStats> statsBefore(_rMeshes.size());
+	std::vector<sVertexCacheStats> statsAfter(_rMeshes.size());
 
-    for (const auto& primitive : mesh.primitives)
-    {
-        sMeshData meshData{};
+	cParallel::For(_rMeshes.size(), [&](size_t _meshIndex)
+		{
+			sMeshData& rMesh = _rMeshes[_meshIndex];
 
-        // =========================================================
-        // ATTRIBUTE LOOKUPS
-        // =========================================================
+			std::vector<uint32>& rIndices  = rMesh.indices32;
+			std::vector<sVertex>& rVertices = rMesh.vertices;
 
-        const auto& rAttributes =
-            primitive.attributes;
+			statsBefore[_meshIndex] = cMeshOptimizer::AnalyzeVertexCache(
+				rIndices.data(), rIndices.size(), rVertices.size(), c_AnalyzeVertexCacheSize);
 
-        auto posIt  = rAttributes.find("POSITION");
-        auto normIt = rAttributes.find("NORMAL");
-        auto uvIt   = rAttributes.find("TEXCOORD_0");
+			cMeshOptimizer::OptimizeVertexCache(rIndices.data(), rIndices.size(), rVertices.size());
 
-        // =========================================================
-        // POINTERS
-        // =========================================================
+			if (c_OptimizeOverdraw && !rVertices.empty())
+			{
+				cMeshOptimizer::OptimizeOverdraw(
+					rIndices.data(), rIndices.size(),
+					&rVertices[0].position.x, rVertices.size(), sizeof(sVertex));
+			}
 
-        const float* pPositions = nullptr;
-        const float* pNormals   = nullptr;
-        const float* pTexcoords = nullptr;
+			const size_t vertexCount = cMeshOptimizer::OptimizeVertexFetch(
+				rIndices.data(), rIndices.size(), rVertices.data(), rVertices.size(), sizeof(sVertex));
 
-        size_t vertexCount = 0;
+			rVertices.resize(vertexCount);
+			rMesh.indices16.clear();
 
-        // =========================================================
-        // POSITION POINTER
-        // =========================================================
+			statsAfter[_meshIndex] = cMeshOptimizer::AnalyzeVertexCache(
+				rIndices.data(), rIndices.size(), rVertices.size(), c_AnalyzeVertexCacheSize);
+		});
 
-        if (posIt != rAttributes.end())
-        {
-            const tinygltf::Accessor& accessor =
-                model.accessors[posIt->second];
+	// triangle / vertex weighted totals over the whole scene
+	double trianglesTotal = 0.0;
+	double verticesTotal  = 0.0;
+	double missesBefore   = 0.0;
+	double missesAfter    = 0.0;
 
-            const tinygltf::BufferView& view =
-                model.bufferViews[accessor.bufferView];
+	for (size_t i = 0; i < _rMeshes.size(); ++i)
+	{
+		const double triangles = static_cast<double>(_rMeshes[i].indices32.size() / 3);
 
-            const tinygltf::Buffer& buffer =
-                model.buffers[view.buffer];
+		trianglesTotal	+= triangles;
+		missesBefore	+= statsBefore[i].acmr * triangles;
+		missesAfter		+= statsAfter[i].acmr * triangles;
+		verticesTotal	+= static_cast<double>(_rMeshes[i].vertices.size()); // only referenced vertices are left
+	}
 
-            pPositions =
-                reinterpret_cast<const float*>(
-                    buffer.data.data() +
-                    view.byteOffset +
-                    accessor.byteOffset);
+	if (trianglesTotal > 0.0 && verticesTotal > 0.0)
+	{
+		std::cout
+			<< "Vertex cache (" << c_AnalyzeVertexCacheSize << " entries): "
+			<< "ACMR " << missesBefore / trianglesTotal << " -> " << missesAfter / trianglesTotal
+			<< ", ATVR " << missesBefore / verticesTotal << " -> " << missesAfter / verticesTotal
+			<< "\n";
+	}
+}
 
-            vertexCount =
-                static_cast<size_t>(accessor.count);
-        }
+// --------------------------------------------------------------------------------------------------------------------------
 
-        // =========================================================
-        // NORMAL POINTER
-        // =========================================================
+void cModelLoader::GenerateTangents(std::vector<sMeshData>& _rMeshes)
+{
+	std::vector<size_t> largeMeshes;
+	std::vector<size_t> smallMeshes;
 
-        if (normIt != rAttributes.end())
-        {
-            const tinygltf::Accessor& accessor =
-                model.accessors[normIt->second];
+	size_t generatedVertices = 0;
 
-            const tinygltf::BufferView& view =
-                model.bufferViews[accessor.bufferView];
+	for (size_t i = 0; i < _rMeshes.size(); ++i)
+	{
+		const sMeshData& rMesh = _rMeshes[i];
 
-            const tinygltf::Buffer& buffer =
-                model.buffers[view.buffer];
+		if (rMesh.hasTangents || rMesh.vertices.empty())
+			continue;
 
-            pNormals =
-                reinterpret_cast<const float*>(
-                    buffer.data.data() +
-                    view.byteOffset +
-                    accessor.byteOffset);
-        }
+		generatedVertices += rMesh.vertices.size();
 
-        // =========================================================
-        // TEXCOORD POINTER
-        // =========================================================
+		if (rMesh.indices32.size() >= c_ParallelTangentIndexCount)
+			largeMeshes.push_back(i);
+		else
+			smallMeshes.push_back(i);
+	}
 
-        if (uvIt != rAttributes.end())
-        {
-            const tinygltf::Accessor& accessor =
-                model.accessors[uvIt->second];
+	auto Generate = [&](size_t _meshIndex, bool _multithreaded)
+		{
+			sMeshData& rMesh = _rMeshes[_meshIndex];
+			sVertex& rFirst = rMesh.vertices[0];
 
-            const tinygltf::BufferView& view =
-                model.bufferViews[accessor.bufferView];
+			const sTangentStreams streams =
+			{
+				&rFirst.position.x,
+				&rFirst.normal.x,
+				&rFirst.texC.x,
+				&rFirst.tangentU.x,
+				sizeof(sVertex)
+			};
 
-            const tinygltf::Buffer& buffer =
-                model.buffers[view.buffer];
+			cTangentGenerator::Generate(
+				rMesh.indices32.data(), rMesh.indices32.size(), rMesh.vertices.size(), streams, _multithreaded);
 
-            pTexcoords =
-                reinterpret_cast<const float*>(
-                    buffer.data.data() +
-                    view.byteOffset +
-                    accessor.byteOffset);
-        }
+			rMesh.hasTangents = true;
+		};
 
-        // =========================================================
-        // SINGLE VERTEX LOOP
-        // =========================================================
+	// one large mesh at a time across all workers, then the rest one mesh per worker
+	for (size_t meshIndex : largeMeshes)
+	{
+		Generate(meshIndex, true);
+	}
 
-        meshData.vertices.resize(vertexCount);
+	cParallel::For(smallMeshes.size(), [&](size_t _i)
+		{
+			Generate(smallMeshes[_i], false);
+		});
 
-        for (size_t i = 0; i < vertexCount; ++i)
-        {
-            sVertex& rVertex =
-                meshData.vertices[i];
-
-            // -----------------------------
-            // POSITION
-            // -----------------------------
-
-            if (pPositions)
-            {
-                rVertex.position.x =
-                    -pPositions[i * 3 + 0];
+	std::cout
+		<< "Tangents: generated for "
+		<< largeMeshes.size() + smallMeshes.size() << " of " << _rMeshes.size() << " primitives ("
+		<< generatedVertices << " vertices)\n";
+}
 
-                rVertex.position.y =
-                     pPositions[i * 3 + 1];
-
-                rVertex.position.z =
-                     pPositions[i * 3 + 2];
-            }
-
-            // -----------------------------
-            // NORMAL
-            // -----------------------------
-
-            if (pNormals)
-            {
-                rVertex.normal.x =
-                    -pNormals[i * 3 + 0];
-
-                rVertex.normal.y =
-                     pNormals[i * 3 + 1];
-
-                rVertex.normal.z =
-                     pNormals[i * 3 + 2];
-            }
-
-            // -----------------------------
-            // TEXCOORD
-            // -----------------------------
-
-            if (pTexcoords)
-            {
-                rVertex.texC.x =
-                    pTexcoords[i * 2 + 0];
+// --------------------------------------------------------------------------------------------------------------------------
 
-                rVertex.texC.y =
-                    pTexcoords[i * 2 + 1];
-            }
-        }
-
-        // =========================================================
-        // INDICES
-        // =========================================================
-
-		if (primitive.indices >= 0)
+void cModelLoader::GenerateLods(std::vector<sMeshData>& _rMeshes)
+{
+	cParallel::For(_rMeshes.size(), [&](size_t _meshIndex)
 		{
-			const tinygltf::Accessor& accessor =
-				model.accessors[primitive.indices];
+			sMeshData& rMesh = _rMeshes[_meshIndex];
 
-			const tinygltf::BufferView& view =
-				model.bufferViews[accessor.bufferView];
+			rMesh.lods.clear();
+			rMesh.lodIndices.clear();
+
+			if (rMesh.vertices.empty() || rMesh.indices32.size() / 3 < c_LodMinTriangles)
+				return;
 
-			const tinygltf::Buffer& buffer =
-				model.buffers[view.buffer];
+			const float* pPositions = &rMesh.vertices[0].position.x;
 
-			const unsigned char* pData =
-				buffer.data.data() +
-				view.byteOffset +
-				accessor.byteOffset;
+			BoundingSphere bounds;
+			BoundingSphere::CreateFromPoints(bounds, rMesh.vertices.size(), &rMesh.vertices[0].position, sizeof(sVertex));
 
-			const size_t indexCount =
-				static_cast<size_t>(accessor.count);
+			const float maxError = bounds.Radius * c_LodMaxRelativeError;
 
-			meshData.indices32.resize(indexCount);
+			// every level is simplified from the previous one, the errors add up
+			std::vector<uint32> source = rMesh.indices32;
+			std::vector<uint32> simplified(source.size());
 
-			// -----------------------------------------------------
-			// UINT16
-			// -----------------------------------------------------
-			if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT)
+			float error = 0.0f;
+
+			for (UINT level = 1; level < c_MaxSubmeshLods; ++level)
 			{
-				const uint16_t* pIndices =
-					reinterpret_cast<const uint16_t*>(pData);
+				const size_t targetIndexCount = static_cast<size_t>(source.size() / 3 * c_LodReduction) * 3;
 
-				for (size_t i = 0; i < indexCount; i += 3)
-				{
-					meshData.indices32[i + 0] =
-						static_cast<uint32_t>(pIndices[i + 0]);
+				float levelError = 0.0f;
 
-					meshData.indices32[i + 1] =
-						static_cast<uint32_t>(pIndices[i + 2]);
+				const size_t indexCount = cMeshSimplifier::Simplify(
+					source.data(), source.size(), pPositions, rMesh.vertices.size(), sizeof(sVertex),
+					targetIndexCount, maxError - error, simplified.data(), &levelError);
 
-					meshData.indices32[i + 2] =
-						static_cast<uint32_t>(pIndices[i + 1]);
-				}
-			}
+				if (indexCount == 0 || indexCount > source.size() * c_LodMinProgress)
+					break;
 
-			// -----------------------------------------------------
-			// UINT32
-			// -----------------------------------------------------
-			else if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT)
-			{
-				const uint32_t* pIndices =
-					reinterpret_cast<const uint32_t*>(pData);
+				error += levelError;
 
-				for (size_t i = 0; i < indexCount; i += 3)
-				{
-					meshData.indices32[i + 0] = pIndices[i + 0];
-					meshData.indices32[i + 1] = pIndices[i + 2];
-					meshData.indices32[i + 2] = pIndices[i + 1];
-				}
+				cMeshOptimizer::OptimizeVertexCache(simplified.data(), indexCount, rMesh.vertices.size());
+
+				rMesh.lods.push_back({
+					static_cast<uint32>(rMesh.lodIndices.size()),
+					static_cast<uint32>(indexCount),
+					error });
+
+				rMesh.lodIndices.insert(rMesh.lodIndices.end(), simplified.begin(), simplified.begin() + indexCount);
+
+				source.assign(simplified.begin(), simplified.begin() + indexCount);
 			}
-			else
+		});
+
+	size_t baseTriangles	= 0;
+	size_t lodTriangles		= 0;
+	size_t lodCount			= 0;
+
+	for (const sMeshData& rMesh : _rMeshes)
+	{
+		baseTriangles	+= rMesh.indices32.size() / 3;
+		lodTriangles	+= rMesh.lodIndices.size() / 3;
+		lodCount		+= rMesh.lods.size();
+	}
+
+	std::cout
+		<< "LODs: " << lodCount << " levels, "
+		<< lodTriangles << " extra triangles on top of " << baseTriangles << "\n";
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cModelLoader::BuildMeshlets(std::vector<sMeshData>& _rMeshes)
+{
+	cParallel::For(_rMeshes.size(), [&](size_t _meshIndex)
+		{
+			sMeshData& rMesh = _rMeshes[_meshIndex];
+
+			if (rMesh.vertices.empty())
 			{
-				throw std::runtime_error("Unsupported glTF index component type.");
+				rMesh.meshletData = {};
+				return;
 			}
 
-			// =========================================================
-			// MATERIAL
-			// =========================================================
+			cMeshletBuilder::Build(
+				rMesh.indices32.data(), rMesh.indices32.size(),
+				&rMesh.vertices[0].position.x, rMesh.vertices.size(), sizeof(sVertex),
+				rMesh.meshletData);
+		});
 
-			meshData.materialId =
-				primitive.material;
+	size_t meshletCount		= 0;
+	size_t triangleCount	= 0;
+	size_t vertexCount		= 0;
 
-			rMeshes.push_back(std::move(meshData));
-		}
-    }
+	for (const sMeshData& rMesh : _rMeshes)
+	{
+		meshletCount	+= rMesh.meshletData.meshlets.size();
+		triangleCount	+= rMesh.meshletData.triangles.size() / 3;
+		vertexCount		+= rMesh.meshletData.vertices.size();
+	}
+
+	if (meshletCount > 0)
+	{
+		std::cout
+			<< "Meshlets: " << meshletCount << " ("
+			<< static_cast<double>(triangleCount) / meshletCount << " triangles, "
+			<< static_cast<double>(vertexCount) / meshletCount << " vertices on average)\n";
+	}
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+bool cModelLoader::ReadGpuInstances(const tinygltf::Model& _rModel, const tinygltf::Value& _rInstancing, std::vector<XMFLOAT4X4>& _rOutLocals)
+{
+	_rOutLocals.clear();
+
+	if (!_rInstancing.Has("attributes"))
+		return false;
+
+	const tinygltf::Value& rAttributes = _rInstancing.Get("attributes");
+
+	auto GetAccessor = [&](const char* _pName) -> int
+		{
+			return rAttributes.Has(_pName) ? rAttributes.Get(_pName).GetNumberAsInt() : -1;
+		};
+
+	std::vector<float> translations;
+	std::vector<float> rotations;
+	std::vector<float> scales;
+
+	const int translationAccessor	= GetAccessor("TRANSLATION");
+	const int rotationAccessor		= GetAccessor("ROTATION");
+	const int scaleAccessor			= GetAccessor("SCALE");
+
+	const bool hasTranslation	= translationAccessor >= 0;
+	const bool hasRotation		= rotationAccessor >= 0;
+	const bool hasScale			= scaleAccessor >= 0;
+
+	// an attribute that is named but unreadable fails the extension rather than being ignored
+	if ((hasTranslation && !cGltfMeshReader::ReadAccessorFloats(_rModel, translationAccessor, 3, translations)) ||
+		(hasRotation && !cGltfMeshReader::ReadAccessorFloats(_rModel, rotationAccessor, 4, rotations)) ||
+		(hasScale && !cGltfMeshReader::ReadAccessorFloats(_rModel, scaleAccessor, 3, scales)))
+		return false;
+
+	size_t instanceCount = 0;
+
+	if (hasTranslation)	instanceCount = translations.size() / 3;
+	else if (hasRotation)	instanceCount = rotations.size() / 4;
+	else if (hasScale)		instanceCount = scales.size() / 3;
+	else				return false;
+
+	// every present attribute has to describe the same instances, indexing below relies on it
+	if ((hasTranslation && translations.size() != instanceCount * 3) ||
+		(hasRotation && rotations.size() != instanceCount * 4) ||
+		(hasScale && scales.size() != instanceCount * 3))
+	{
+		std::cerr << "EXT_mesh_gpu_instancing: attribute counts differ, instancing ignored\n";
+		return false;
+	}
+
+	const XMMATRIX flipX =
+		XMMatrixScaling(-1.f, 1.f, 1.f);
+
+	for (size_t i = 0; i < instanceCount; ++i)
+	{
+		XMVECTOR t = hasTranslation
+			? XMVectorSet(translations[i * 3 + 0], translations[i * 3 + 1], translations[i * 3 + 2], 1.f)
+			: XMVectorSet(0.f, 0.f, 0.f, 1.f);
+
+		XMVECTOR r = hasRotation
+			? XMVectorSet(rotations[i * 4 + 0], rotations[i * 4 + 1], rotations[i * 4 + 2], rotations[i * 4 + 3])
+			: XMQuaternionIdentity();
+
+		XMVECTOR s = hasScale
+			? XMVectorSet(scales[i * 3 + 0], scales[i * 3 + 1], scales[i * 3 + 2], 0.f)
+			: XMVectorSet(1.f, 1.f, 1.f, 0.f);
+
+		XMMATRIX instanceRH =
+			XMMatrixAffineTransformation(s, XMVectorZero(), r, t);
+
+		// instance transforms live in the node's local space
+		XMMATRIX instanceLH =
+			flipX * instanceRH * flipX;
+
+		_rOutLocals.emplace_back();
+		XMStoreFloat4x4(&_rOutLocals.back(), instanceLH);
+	}
+
+	return true;
 }
 
 // --------------------------------------------------------------------------------------------------------------------------
@@ -656,53 +950,118 @@ sMaterial cModelLoader::ExtractMaterialFromGLTF(const tinygltf::Model& model, in
 
 	return mat;
 }
+
 // --------------------------------------------------------------------------------------------------------------------------
 
-uint32_t cModelLoader::GetOrCreateMaterialId(const tinygltf::Model& _rModel, int _materialIndex, sModel& _rOutModel)
+bool cModelLoader::DeferImageDecode(tinygltf::Image* _pImage, const int _imageIndex, std::string* _pError, std::string* _pWarning,
+	int _requiredWidth, int _requiredHeight, const unsigned char* _pBytes, int _size, void* _pUserData)
 {
-	std::vector<sMaterial>& rMaterials = _rOutModel.materials;
+	_pImage->width	= -1;
+	_pImage->height	= -1;
+	_pImage->as_is	= true;
+	_pImage->image.assign(_pBytes, _pBytes + _size);
 
-	if (_materialIndex < 0)
-	{
-		auto iterator = s_gltfMaterialToEngineMaterial.find(-1);
-		if (iterator != s_gltfMaterialToEngineMaterial.end())
-			return iterator->second;
+	return true;
+}
 
-		sMaterial defaultMat{};
-		const uint32_t newId = static_cast<uint32_t>(rMaterials.size());
-		rMaterials.push_back(std::move(defaultMat));
-		s_gltfMaterialToEngineMaterial[-1] = newId;
-		return newId;
-	}
+// --------------------------------------------------------------------------------------------------------------------------
 
-	auto iterator = s_gltfMaterialToEngineMaterial.find(_materialIndex);
-	if (iterator != s_gltfMaterialToEngineMaterial.end())
-		return iterator->second;
+void cModelLoader::DecodeImages(tinygltf::Model& _rModel, std::vector<cTexturePayload>& _rOutPixels)
+{
+	using Clock = std::chrono::high_resolution_clock;
 
-	sMaterial newMaterial = cModelLoader::ExtractMaterialFromGLTF(_rModel, _materialIndex);
+	auto decodeStart = Clock::now();
 
-	const uint32_t newId = static_cast<uint32_t>(rMaterials.size());
-	rMaterials.push_back(std::move(newMaterial));
-	s_gltfMaterialToEngineMaterial[_materialIndex] = newId;
+	std::vector<double> decodeSeconds(_rModel.images.size(), 0.0);
 
-	return newId;
-}
+	_rOutPixels.clear();
+	_rOutPixels.resize(_rModel.images.size());
+
+	cParallel::For(_rModel.images.size(), [&](size_t _imageIndex)
+		{
+			auto imageStart = Clock::now();
+
+			tinygltf::Image& rImage = _rModel.images[_imageIndex];
+
+			int width		= 0;
+			int height		= 0;
+			int components	= 0;
+
+			// always RGBA8, 16 bit sources are narrowed by stb
+			stbi_uc* pPixels = nullptr;
+
+			if (rImage.as_is && !rImage.image.empty())
+			{
+				pPixels = stbi_load_from_memory(
+					rImage.image.data(), static_cast<int>(rImage.image.size()), &width, &height, &components, 4);
+			}
+
+			// the encoded bytes are done with, stb's output becomes the texture payload as it is
+			std::vector<unsigned char>().swap(rImage.image);
+
+			if (pPixels)
+			{
+				_rOutPixels[_imageIndex] = cTextureArena::Adopt(pPixels, static_cast<size_t>(width) * height * 4, &stbi_image_free);
+			}
+			else
+			{
+				width	= 1;
+				height	= 1;
+
+				_rOutPixels[_imageIndex] = cTextureArena::Allocate(sizeof(c_MissingImageColor));
+				std::memcpy(_rOutPixels[_imageIndex].GetData(), c_MissingImageColor, sizeof(c_MissingImageColor));
+			}
+
+			rImage.width		= width;
+			rImage.height		= height;
+			rImage.component	= 4;
+			rImage.bits			= 8;
+			rImage.pixel_type	= TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE;
+			rImage.as_is		= false;
+
+			decodeSeconds[_imageIndex] = std::chrono::duration<double>(Clock::now() - imageStart).count();
+
+			if (!pPixels)
+				std::cerr << "Image decode failed: image[" << _imageIndex << "] \"" << rImage.name << "\"\n";
+		});
 
+	double totalSeconds = 0.0;
+
+	for (size_t i = 0; i < decodeSeconds.size(); ++i)
+	{
+		const tinygltf::Image& rImage = _rModel.images[i];
+
+		std::cout
+			<< "Image decode [" << i << "] "
+			<< rImage.width << "x" << rImage.height << ": "
+			<< decodeSeconds[i] * 1000.0
+			<< " ms\n";
+
+		totalSeconds += decodeSeconds[i];
+	}
+
+	std::cout
+		<< "Image decode: "
+		<< std::chrono::duration<double>(
+			Clock::now() - decodeStart).count()
+		<< " seconds (" << totalSeconds << " seconds summed over "
+		<< decodeSeconds.size() << " images)\n";
+}
 
 // --------------------------------------------------------------------------------------------------------------------------
 
-void cModelLoader::CreateTexturesFromGltf(tinygltf::Model& _rModel, sModel& _rOutModel)
+void cModelLoader::CreateTexturesFromGltf(tinygltf::Model& _rModel, std::vector<cTexturePayload>& _rPixels, sModel& _rOutModel)
 {
 	std::vector<cCpuTexture>& rTextures = _rOutModel.cpuTextures;
 
-	for (auto& image : _rModel.images)
-	{
-		int width = image.width;
-		int height = image.height;
+	rTextures.reserve(_rModel.images.size());
 
+	for (size_t i = 0; i < _rModel.images.size(); ++i)
+	{
+		int width = _rModel.images[i].width;
+		int height = _rModel.images[i].height;
 
-		cCpuTexture texture(width, height, std::move(image.image));
-		rTextures.emplace_back(std::move(texture));
+		rTextures.emplace_back(width, height, std::move(_rPixels[i]));
 	}
 
 	std::cout << "number of cpu Textures: " << rTextures.size() << std::endl;
@@ -712,11 +1071,13 @@ void cModelLoader::CreateTexturesFromGltf(tinygltf::Model& _rModel, sModel& _rOu
 
 XMMATRIX cModelLoader::GetNodeLocalMatrix(const tinygltf::Node& node)
 {
+	XMMATRIX localRH = XMMatrixIdentity();
+
 	if (node.matrix.size() == 16)
 	{
 		// glTF speichert Matrizen column-major.
 		// Fr DirectX row-vector convention: v' = v * M
-		return XMMatrixSet(
+		localRH = XMMatrixSet(
 			static_cast<float>(node.matrix[0]),
 			static_cast<float>(node.matrix[1]),
 			static_cast<float>(node.matrix[2]),
@@ -738,45 +1099,40 @@ XMMATRIX cModelLoader::GetNodeLocalMatrix(const tinygltf::Node& node)
 			static_cast<float>(node.matrix[15])
 		);
 	}
-
-	XMVECTOR translation = XMVectorZero();
-	XMVECTOR rotation = XMQuaternionIdentity();
-	XMVECTOR scale = XMVectorSet(1.0f, 1.0f, 1.0f, 0.0f);
-
-	if (node.translation.size() == 3)
+	else
 	{
-		translation = XMVectorSet(
-			static_cast<float>(node.translation[0]),
-			static_cast<float>(node.translation[1]),
-			static_cast<float>(node.translation[2]),
-			0.0f
-		);
-	}
+		XMVECTOR t = XMVectorSet(
+			node.translation.size() > 0 ? (float)node.translation[0] : 0.f,
+			node.translation.size() > 1 ? (float)node.translation[1] : 0.f,
+			node.translation.size() > 2 ? (float)node.translation[2] : 0.f,
+			1.f);
 
-	if (node.rotation.size() == 4)
-	{
 		// glTF Quaternion: x, y, z, w
-		rotation = XMVectorSet(
-			static_cast<float>(node.rotation[0]),
-			static_cast<float>(node.rotation[1]),
-			static_cast<float>(node.rotation[2]),
-			static_cast<float>(node.rotation[3])
-		);
-	}
+		XMVECTOR r = XMQuaternionIdentity();
 
-	if (node.scale.size() == 3)
-	{
-		scale = XMVectorSet(
-			static_cast<float>(node.scale[0]),
-			static_cast<float>(node.scale[1]),
-			static_cast<float>(node.scale[2]),
-			0.0f
-		);
+		if (node.rotation.size() == 4)
+		{
+			r = XMVectorSet(
+				(float)node.rotation[0],
+				(float)node.rotation[1],
+				(float)node.rotation[2],
+				(float)node.rotation[3]);
+		}
+
+		XMVECTOR s = XMVectorSet(
+			node.scale.size() > 0 ? (float)node.scale[0] : 1.f,
+			node.scale.size() > 1 ? (float)node.scale[1] : 1.f,
+			node.scale.size() > 2 ? (float)node.scale[2] : 1.f,
+			0.f);
+
+		localRH = XMMatrixAffineTransformation(s, XMVectorZero(), r, t);
 	}
 
-	return XMMatrixScalingFromVector(scale)
-		* XMMatrixRotationQuaternion(rotation)
-		* XMMatrixTranslationFromVector(translation);
+	// glTF is right handed, meshes, instances and lights all go through the same mirror
+	static const XMMATRIX flipX =
+		XMMatrixScaling(-1.f, 1.f, 1.f);
+
+	return flipX * localRH * flipX;
 }
 
 // --------------------------------------------------------------------------------------------------------------------------
@@ -839,155 +1195,111 @@ void cModelLoader::GetGltfSpotConeCos(
 
 // --------------------------------------------------------------------------------------------------------------------------
 
-void cModelLoader::CreateLightsFromGltf(tinygltf::Model& _rModel, sModel& _rOutModel)
+void cModelLoader::CreateLightsFromGltf(tinygltf::Model& _rModel, const std::vector<sLightJob>& _rJobs, sModel& _rOutModel)
 {
 	_rOutModel.lights.clear();
 
-	if (_rModel.lights.empty())
-		return;
-
-	auto ProcessNodeRecursive =
-		[&](auto&& self, int nodeIndex, const XMMATRIX& parentWorld) -> void
-		{
-			if (nodeIndex < 0 || nodeIndex >= static_cast<int>(_rModel.nodes.size()))
-				return;
-
-			const tinygltf::Node& node = _rModel.nodes[nodeIndex];
-
-			XMMATRIX local = GetNodeLocalMatrix(node);
+	for (const sLightJob& rJob : _rJobs)
+	{
+		if (rJob.lightIndex >= static_cast<int>(_rModel.lights.size()))
+			continue;
 
-			// DirectX row-vector convention:
-			// childWorld = childLocal * parentWorld
-			XMMATRIX world = local * parentWorld;
+		// the same left handed world the meshes use
+		const XMMATRIX world = XMLoadFloat4x4(&_rOutModel.sceneGraph.GetWorld(rJob.sceneNode));
 
-			if (node.light >= 0 && node.light < static_cast<int>(_rModel.lights.size()))
-			{
-				const tinygltf::Light& gltfLight = _rModel.lights[node.light];
+		const tinygltf::Light& gltfLight = _rModel.lights[rJob.lightIndex];
 
-				sLightConstants outLight{};
+		sLightConstants outLight{};
 
-				outLight.strength = XMFLOAT3(1.0f, 1.0f, 1.0f);
-				outLight.falloffStart = 0.0f;
+		outLight.strength = XMFLOAT3(1.0f, 1.0f, 1.0f);
+		outLight.falloffStart = 0.0f;
 
-				outLight.direction = XMFLOAT3(0.0f, 0.0f, -1.0f);
-				outLight.falloffEnd = 10.0f;
+		outLight.direction = XMFLOAT3(0.0f, 0.0f, -1.0f);
+		outLight.falloffEnd = 10.0f;
 
-				outLight.position = XMFLOAT3(0.0f, 0.0f, 0.0f);
-				outLight.spotInnerConeCos = 1.0f;
+		outLight.position = XMFLOAT3(0.0f, 0.0f, 0.0f);
+		outLight.spotInnerConeCos = 1.0f;
 
-				outLight.type = 1;
-				outLight.spotOuterConeCos = std::cos(XM_PIDIV4);
-				outLight.padding = XMFLOAT2(0.0f, 0.0f);
+		outLight.type = 1;
+		outLight.spotOuterConeCos = std::cos(XM_PIDIV4);
+		outLight.padding = XMFLOAT2(0.0f, 0.0f);
 
-				// ------------------------------------------------------------
-				// Light Type
-				// glTF: "directional", "point", "spot"
-				// Shader: 0 = directional, 1 = point, 2 = spot
-				// ------------------------------------------------------------
-				if (gltfLight.type == "directional")
-				{
-					outLight.type = 0;
-				}
-				else if (gltfLight.type == "point")
-				{
-					outLight.type = 1;
-				}
-				else if (gltfLight.type == "spot")
-				{
-					outLight.type = 2;
-				}
-				else
-				{
-					return;
-				}
-
-				// ------------------------------------------------------------
-				// Color * Intensity
-				// ------------------------------------------------------------
-				const XMFLOAT3 color = GetGltfLightColor(gltfLight);
-				const float intensity = static_cast<float>(gltfLight.intensity);
-
-				outLight.strength = XMFLOAT3(
-					color.x * intensity,
-					color.y * intensity,
-					color.z * intensity
-				);
-
-				// ------------------------------------------------------------
-				// Position
-				// ------------------------------------------------------------
-				XMVECTOR positionW = XMVector3TransformCoord(
-					XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f),
-					world
-				);
-
-				XMStoreFloat3(&outLight.position, positionW);
-
-				// ------------------------------------------------------------
-				// Direction
-				//
-				// KHR_lights_punctual:
-				// Directional und Spot Lights zeigen lokal in -Z-Richtung.
-				// ------------------------------------------------------------
-				XMVECTOR directionW = XMVector3TransformNormal(
-					XMVectorSet(0.0f, 0.0f, -1.0f, 0.0f),
-					world
-				);
-
-				directionW = XMVector3Normalize(directionW);
-				XMStoreFloat3(&outLight.direction, directionW);
-
-				// ------------------------------------------------------------
-				// Range / Falloff
-				// ------------------------------------------------------------
-				outLight.falloffStart = 0.0f;
-				outLight.falloffEnd = GetGltfLightRange(gltfLight);
-
-				// ------------------------------------------------------------
-				// Spot Cone
-				// ------------------------------------------------------------
-				if (outLight.type == 2)
-				{
-					GetGltfSpotConeCos(
-						gltfLight,
-						outLight.spotInnerConeCos,
-						outLight.spotOuterConeCos
-					);
-				}
+		// ------------------------------------------------------------
+		// Light Type
+		// glTF: "directional", "point", "spot"
+		// Shader: 0 = directional, 1 = point, 2 = spot
+		// ------------------------------------------------------------
+		if (gltfLight.type == "directional")
+		{
+			outLight.type = 0;
+		}
+		else if (gltfLight.type == "point")
+		{
+			outLight.type = 1;
+		}
+		else if (gltfLight.type == "spot")
+		{
+			outLight.type = 2;
+		}
+		else
+		{
+			continue;
+		}
 
-				_rOutModel.lights.push_back(outLight);
-			}
+		// ------------------------------------------------------------
+		// Color * Intensity
+		// ------------------------------------------------------------
+		const XMFLOAT3 color = GetGltfLightColor(gltfLight);
+		const float intensity = static_cast<float>(gltfLight.intensity);
 
-			for (int childIndex : node.children)
-			{
-				self(self, childIndex, world);
-			}
-		};
+		outLight.strength = XMFLOAT3(
+			color.x * intensity,
+			color.y * intensity,
+			color.z * intensity
+		);
 
-	XMMATRIX identity = XMMatrixIdentity();
+		// ------------------------------------------------------------
+		// Position
+		// ------------------------------------------------------------
+		XMVECTOR positionW = XMVector3TransformCoord(
+			XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f),
+			world
+		);
 
-	int sceneIndex = _rModel.defaultScene;
+		XMStoreFloat3(&outLight.position, positionW);
+
+		// ------------------------------------------------------------
+		// Direction
+		//
+		// KHR_lights_punctual:
+		// Directional und Spot Lights zeigen lokal in -Z-Richtung.
+		// ------------------------------------------------------------
+		XMVECTOR directionW = XMVector3TransformNormal(
+			XMVectorSet(0.0f, 0.0f, -1.0f, 0.0f),
+			world
+		);
 
-	if (sceneIndex < 0 || sceneIndex >= static_cast<int>(_rModel.scenes.size()))
-	{
-		sceneIndex = _rModel.scenes.empty() ? -1 : 0;
-	}
+		directionW = XMVector3Normalize(directionW);
+		XMStoreFloat3(&outLight.direction, directionW);
 
-	if (sceneIndex >= 0)
-	{
-		const tinygltf::Scene& scene = _rModel.scenes[sceneIndex];
+		// ------------------------------------------------------------
+		// Range / Falloff
+		// ------------------------------------------------------------
+		outLight.falloffStart = 0.0f;
+		outLight.falloffEnd = GetGltfLightRange(gltfLight);
 
-		for (int rootNodeIndex : scene.nodes)
+		// ------------------------------------------------------------
+		// Spot Cone
+		// ------------------------------------------------------------
+		if (outLight.type == 2)
 		{
-			ProcessNodeRecursive(ProcessNodeRecursive, rootNodeIndex, identity);
-		}
-	}
-	else
-	{
-		// Fallback fr Dateien ohne Scene.
-		for (int nodeIndex = 0; nodeIndex < static_cast<int>(_rModel.nodes.size()); ++nodeIndex)
-		{
-			ProcessNodeRecursive(ProcessNodeRecursive, nodeIndex, identity);
+			GetGltfSpotConeCos(
+				gltfLight,
+				outLight.spotInnerConeCos,
+				outLight.spotOuterConeCos
+			);
 		}
+
+		_rOutModel.lights.push_back(outLight);
 	}
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include <DirectXMath.h>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include <cstdint>
 
 namespace tinygltf
@@ -12,11 +13,15 @@ namespace tinygltf
     struct Scene;
     class Node;
     struct Light;
+    class Value;
 }
 
 using namespace DirectX;
 
 class cCpuTexture;
+class cTexturePayload;
+class cCookedScene;
+class cSceneGraph;
 struct sMaterial;
 struct sMeshData;
 struct sModel;
@@ -25,31 +30,71 @@ class cModelLoader
 {
     public:
         static void LoadGLTFModel(std::string& _rFilePath, sModel& _rOutModel);
+
+        // maps the cooked scene next to _rFilePath and cooks it from the glTF
+        // first when it is missing or older than the glTF
+        static bool LoadCookedScene(std::string& _rFilePath, cCookedScene& _rOutScene);
     
     private:
     
         struct sNodeJob
         {
             int nodeIndex;
-            XMMATRIX parentMatrix;
+            uint32_t parent;        // scene graph node
+        };
+
+        // one GPU instance, added as a child of its node on the next level
+        struct sInstanceJob
+        {
+            int meshIndex;
+            uint32_t parent;
+            XMFLOAT4X4 local;
+        };
+
+        // one instance of a glTF mesh found during the node walk
+        struct sMeshJob
+        {
+            int meshIndex;
+            uint32_t sceneNode;
+        };
+
+        // one node with a KHR_lights_punctual light
+        struct sLightJob
+        {
+            int lightIndex;
+            uint32_t sceneNode;
         };
     
     private:
 
-        static void ExtractPrimitives(tinygltf::Model& model, int meshIndex, sModel& _rOutModel);
+        static void OptimizeMeshes(std::vector<sMeshData>& _rMeshes);
+        static void GenerateTangents(std::vector<sMeshData>& _rMeshes);
+        static void BuildMeshlets(std::vector<sMeshData>& _rMeshes);
+        static void GenerateLods(std::vector<sMeshData>& _rMeshes);
+        static void ExtractMeshJobs(const tinygltf::Model& _rModel, const std::vector<sMeshJob>& _rJobs, sModel& _rOutModel);
         static sMaterial ExtractMaterialFromGLTF(const tinygltf::Model& model, int materialIndex);
-        static uint32_t GetOrCreateMaterialId(const tinygltf::Model& _rModel, int _materialIndex, sModel& _rOutModel);
-        static void CreateTexturesFromGltf(tinygltf::Model& _rModel, sModel& _rOutModel);
-        static void ProcessSceneIterative(tinygltf::Model& _rModel, const tinygltf::Scene& _rScene, sModel& _rOutModel);
-        static XMMATRIX GetNodeLocalMatrix(const tinygltf::Node& node);
-        static XMFLOAT3 GetGltfLightColor(const tinygltf::Light& gltfLight);
-        static float GetGltfLightRange(const tinygltf::Light& gltfLight);
-        static void GetGltfSpotConeCos(const tinygltf::Light& gltfLight, float& outInnerConeCos, float& outOuterConeCos);
-        static void CreateLightsFromGltf(tinygltf::Model& _rModel, sModel& _rOutModel); 
+        static void CreateTexturesFromGltf(tinygltf::Model& _rModel, std::vector<cTexturePayload>& _rPixels, sModel& _rOutModel);
 
+        // image loader for tinygltf, keeps the encoded bytes so DecodeImages can run them in parallel
+        static bool DeferImageDecode(tinygltf::Image* _pImage, const int _imageIndex, std::string* _pError, std::string* _pWarning,
+            int _requiredWidth, int _requiredHeight, const unsigned char* _pBytes, int _size, void* _pUserData);
 
+        // decodes to RGBA8 in place of the encoded bytes, one payload per image
+        static void DecodeImages(tinygltf::Model& _rModel, std::vector<cTexturePayload>& _rOutPixels);
 
-    private:
+        // walks the scene breadth first once, adds every node to the graph (GPU instances as children
+        // of their node) and collects the nodes with meshes and lights. Worlds are not computed yet
+        static void BuildSceneGraph(const tinygltf::Model& _rModel, const tinygltf::Scene& _rScene, cSceneGraph& _rOutGraph,
+            std::vector<sMeshJob>& _rOutMeshJobs, std::vector<sLightJob>& _rOutLightJobs);
 
-        static std::unordered_map<int, uint32_t> s_gltfMaterialToEngineMaterial;
+        // EXT_mesh_gpu_instancing transforms in the node's local space. False without attributes, when one
+        // of them cannot be read or when their counts differ
+        static bool ReadGpuInstances(const tinygltf::Model& _rModel, const tinygltf::Value& _rInstancing, std::vector<XMFLOAT4X4>& _rOutLocals);
+
+        // left handed, the X mirror of the glTF matrix
+        static XMMATRIX GetNodeLocalMatrix(const tinygltf::Node& node);
+        static XMFLOAT3 GetGltfLightColor(const tinygltf::Light& gltfLight);
+        static float GetGltfLightRange(const tinygltf::Light& gltfLight);
+        static void GetGltfSpotConeCos(const tinygltf::Light& gltfLight, float& outInnerConeCos, float& outOuterConeCos);
+        static void CreateLightsFromGltf(tinygltf::Model& _rModel, const std::vector<sLightJob>& _rJobs, sModel& _rOutModel);
 };
\ No newline at end of file
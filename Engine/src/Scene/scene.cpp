@@ -1,5 +1,52 @@
 #include "scene.h"
 
+#include <algorithm>
+#include <cmath>
+
+#include "camera.h"
+#include "Graphics/material.h"
+#include "Graphics/textureStreamer.h"
+
+// screen space error a LOD may introduce before the next finer one is used
+constexpr float c_MaxLodPixelError      = 1.0f;
+
+// items whose bounding sphere covers less than this radius in pixels are not drawn
+constexpr float c_MinProjectedRadius    = 0.5f;
+
+// surfaces seen from inside their bounds want the finest level
+constexpr float c_NearProjectedPixels   = 1.0e6f;
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+struct sProjectedBounds
+{
+    float worldScale;   // largest axis of the instance transform
+    float radius;
+    float distance;     // from the eye to the center
+};
+
+static bool GetProjectedBounds(const sRenderItem& _rItem, const XMFLOAT4X4& _rWorld, const XMFLOAT3& _rEye, sProjectedBounds& _rOutBounds)
+{
+    if (_rItem.pGeometry == nullptr || _rItem.submeshIndex >= _rItem.pGeometry->drawArguments.size())
+        return false;
+
+    const sSubmeshGeometry& rSubmesh = _rItem.pGeometry->drawArguments[_rItem.submeshIndex];
+
+    const XMMATRIX world = XMLoadFloat4x4(&_rWorld);
+
+    _rOutBounds.worldScale = std::sqrt((std::max)((std::max)(
+        XMVectorGetX(XMVector3LengthSq(world.r[0])),
+        XMVectorGetX(XMVector3LengthSq(world.r[1]))),
+        XMVectorGetX(XMVector3LengthSq(world.r[2]))));
+
+    const XMVECTOR center = XMVector3TransformCoord(XMLoadFloat3(&rSubmesh.bounds.Center), world);
+
+    _rOutBounds.radius      = XMVectorGetX(XMVector3Length(XMLoadFloat3(&rSubmesh.bounds.Extents))) * _rOutBounds.worldScale;
+    _rOutBounds.distance    = XMVectorGetX(XMVector3Length(XMVectorSubtract(center, XMLoadFloat3(&_rEye))));
+
+    return true;
+}
+
 // --------------------------------------------------------------------------------------------------------------------------
 
 std::vector<sRenderItem>& cScene::GetRenderItems()
@@ -15,3 +62,163 @@ std::vector<sLightConstants>& cScene::GetLight()
 }
 
 // --------------------------------------------------------------------------------------------------------------------------
+
+cSceneGraph& cScene::GetSceneGraph()
+{
+    return m_sceneGraph;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+std::vector<uint32_t>& cScene::GetItemNodes()
+{
+    return m_itemNodes;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cScene::UpdateTransforms()
+{
+    m_sceneGraph.UpdateWorlds();
+
+    // nothing moved, the common case for a static city
+    if (m_sceneGraph.GetChangedCount() == 0)
+        return;
+
+    const size_t itemCount = (std::min)(m_renderItems.size(), m_itemNodes.size());
+
+    for (size_t i = 0; i < itemCount; ++i)
+    {
+        if (!m_sceneGraph.HasChanged(m_itemNodes[i]))
+            continue;
+
+        m_renderItems[i].numberOfFramesDirty = c_NumberOfFrameResources;
+        m_movedItems.push_back(static_cast<uint32_t>(i));
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cScene::MarkAllTransformsMoved()
+{
+    const size_t itemCount = (std::min)(m_renderItems.size(), m_itemNodes.size());
+
+    m_movedItems.resize(itemCount);
+
+    for (size_t i = 0; i < itemCount; ++i)
+    {
+        m_renderItems[i].numberOfFramesDirty = c_NumberOfFrameResources;
+        m_movedItems[i] = static_cast<uint32_t>(i);
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cScene::TakeMovedTransforms(std::vector<sTransformUpdate>& _rOutUpdates)
+{
+    _rOutUpdates.resize(m_movedItems.size());
+
+    for (size_t i = 0; i < m_movedItems.size(); ++i)
+    {
+        const uint32_t item = m_movedItems[i];
+
+        _rOutUpdates[i].index = m_renderItems[item].objCBIndex;
+        _rOutUpdates[i].world = m_sceneGraph.GetWorld(m_itemNodes[item]);
+    }
+
+    m_movedItems.clear();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cScene::SelectLods(const cCamera& _rCamera, float _viewportHeight)
+{
+    const XMFLOAT3 eye = _rCamera.GetPosition();
+
+    XMFLOAT4X4 proj;
+    XMStoreFloat4x4(&proj, _rCamera.GetProjectionMatrix());
+
+    // pixels covered by one world unit at distance 1
+    const float pixelsPerUnit = proj._22 * _viewportHeight * 0.5f;
+
+    const size_t itemCount = (std::min)(m_renderItems.size(), m_itemNodes.size());
+
+    for (size_t i = 0; i < itemCount; ++i)
+    {
+        sRenderItem&        rItem = m_renderItems[i];
+        sProjectedBounds    bounds;
+
+        if (!GetProjectedBounds(rItem, m_sceneGraph.GetWorld(m_itemNodes[i]), eye, bounds))
+            continue;
+
+        const sSubmeshGeometry& rSubmesh = rItem.pGeometry->drawArguments[rItem.submeshIndex];
+
+        // mesh errors scale with the largest axis of the instance transform
+        const float worldScale  = bounds.worldScale;
+        const float radius      = bounds.radius;
+        const float distance    = bounds.distance;
+
+        UINT lodIndex = 0;
+
+        if (distance > radius)
+        {
+            const float pixelsAtDistance = pixelsPerUnit / distance;
+
+            rItem.isCulled = radius * pixelsAtDistance < c_MinProjectedRadius;
+
+            while (lodIndex + 1 < rSubmesh.lodCount &&
+                rSubmesh.lods[lodIndex + 1].error * worldScale * pixelsAtDistance <= c_MaxLodPixelError)
+            {
+                ++lodIndex;
+            }
+        }
+        else
+        {
+            rItem.isCulled = false;
+        }
+
+        rItem.lodIndex              = lodIndex;
+        rItem.indexCount            = rSubmesh.lods[lodIndex].indexCount;
+        rItem.startIndexLocation    = rSubmesh.lods[lodIndex].startIndexLocation;
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cScene::RequestTextureMips(const cCamera& _rCamera, float _viewportHeight, std::vector<sTextureRequest>& _rOutRequests) const
+{
+    _rOutRequests.clear();
+
+    const XMFLOAT3 eye = _rCamera.GetPosition();
+
+    XMFLOAT4X4 proj;
+    XMStoreFloat4x4(&proj, _rCamera.GetProjectionMatrix());
+
+    const float pixelsPerUnit = proj._22 * _viewportHeight * 0.5f;
+
+    const size_t itemCount = (std::min)(m_renderItems.size(), m_itemNodes.size());
+
+    for (size_t i = 0; i < itemCount; ++i)
+    {
+        const sRenderItem&  rItem = m_renderItems[i];
+        sProjectedBounds    bounds;
+
+        if (rItem.isCulled || rItem.pMaterial == nullptr || !GetProjectedBounds(rItem, m_sceneGraph.GetWorld(m_itemNodes[i]), eye, bounds))
+            continue;
+
+        // the texture is assumed to span the bounds once, tiling UVs ask for a level too coarse
+        const float projectedPixels = bounds.distance > bounds.radius
+            ? 2.0f * bounds.radius * pixelsPerUnit / bounds.distance
+            : c_NearProjectedPixels;
+
+        const sMaterial& rMaterial = *rItem.pMaterial;
+
+        _rOutRequests.push_back({ rMaterial.baseColorIndex,            projectedPixels });
+        _rOutRequests.push_back({ rMaterial.metallicRoughnessIndex,    projectedPixels });
+        _rOutRequests.push_back({ rMaterial.normalIndex,               projectedPixels });
+        _rOutRequests.push_back({ rMaterial.occlusionIndex,            projectedPixels });
+        _rOutRequests.push_back({ rMaterial.emissiveIndex,             projectedPixels });
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
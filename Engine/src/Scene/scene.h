@@ -3,6 +3,13 @@
 
 #include "Graphics/renderItem.h"
 #include "Graphics/light.h"
+#include "Graphics/transformSystem.h"
+
+#include "sceneGraph.h"
+
+class cCamera;
+
+struct sTextureRequest;
 
 class cScene
 {
@@ -10,8 +17,36 @@ class cScene
 		std::vector<sRenderItem>&		GetRenderItems(); 
 		std::vector<sLightConstants>&	GetLight();
 
+		cSceneGraph&					GetSceneGraph();
+
+		// scene graph node of every render item, parallel to GetRenderItems
+		std::vector<uint32_t>&			GetItemNodes();
+
+		// updates the worlds of the moved nodes and marks the render items below them dirty,
+		// run before SelectLods so it sees where the items are this frame
+		void UpdateTransforms();
+
+		// every item counts as moved, once the render items and their nodes were created
+		void MarkAllTransformsMoved();
+
+		// the scene graph worlds of the items that moved since the last call, for the renderer's
+		// transform system, which keeps the worlds of every item
+		void TakeMovedTransforms(std::vector<sTransformUpdate>& _rOutUpdates);
+
+		// picks the coarsest LOD whose error stays below a pixel and culls
+		// items whose bounds project smaller than c_MinProjectedRadius
+		void SelectLods(const cCamera& _rCamera, float _viewportHeight);
+
+		// asks for the texture levels of every drawn item's material by the size
+		// its bounds project to, run after SelectLods so culled items ask for nothing.
+		// The requests go to the streamer with the frame on the render thread
+		void RequestTextureMips(const cCamera& _rCamera, float _viewportHeight, std::vector<sTextureRequest>& _rOutRequests) const;
+
 	private:
 
 		std::vector<sRenderItem>		m_renderItems;
 		std::vector<sLightConstants>	m_lightConstants; 
+		cSceneGraph						m_sceneGraph;
+		std::vector<uint32_t>			m_itemNodes;
+		std::vector<uint32_t>			m_movedItems;
 };
\ No newline at end of file
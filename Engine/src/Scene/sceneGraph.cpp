@@ -0,0 +1,283 @@
+#include "sceneGraph.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+
+#include "Core/parallel.h"
+
+// levels with more nodes are split into tasks of this size
+constexpr uint32_t c_NodesPerTask   = 1024;
+
+// m_firstDirtyLevel while nothing is dirty
+constexpr uint32_t c_NoDirtyLevel   = ~0u;
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+cSceneGraph::cSceneGraph()
+    : m_updateStamp(1)
+    , m_changedCount(0)
+    , m_firstDirtyLevel(c_NoDirtyLevel)
+    , m_lastDirtyLevel(0)
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cSceneGraph::Clear()
+{
+    m_parents.clear();
+    m_levels.clear();
+    m_levelStarts.clear();
+    m_locals.clear();
+    m_worlds.clear();
+    m_dirty.clear();
+    m_changedStamps.clear();
+
+    m_updateStamp       = 1;
+    m_changedCount      = 0;
+    m_firstDirtyLevel   = c_NoDirtyLevel;
+    m_lastDirtyLevel    = 0;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cSceneGraph::Reserve(size_t _nodeCount)
+{
+    m_parents.reserve(_nodeCount);
+    m_levels.reserve(_nodeCount);
+    m_locals.reserve(_nodeCount);
+    m_worlds.reserve(_nodeCount);
+    m_dirty.reserve(_nodeCount);
+    m_changedStamps.reserve(_nodeCount);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+uint32_t cSceneGraph::AddNode(uint32_t _parent, const XMFLOAT4X4& _rLocal)
+{
+    const uint32_t node         = GetNodeCount();
+    const uint32_t lastLevel    = m_levels.empty() ? 0 : m_levels.back();
+
+    uint32_t level = 0;
+
+    if (_parent != c_InvalidNode)
+    {
+        if (_parent >= node)
+            throw std::runtime_error("Scene graph parent added after its child");
+
+        level = m_levels[_parent] + 1;
+    }
+
+    // a parent of an earlier level would put the child before nodes of a shallower level
+    if (level < lastLevel)
+        throw std::runtime_error("Scene graph nodes not added breadth first");
+
+    if (m_levelStarts.empty())
+    {
+        m_levelStarts.push_back(0);
+        m_levelStarts.push_back(1);
+    }
+    else if (level > lastLevel)
+    {
+        m_levelStarts.push_back(node + 1);
+    }
+    else
+    {
+        m_levelStarts.back() = node + 1;
+    }
+
+    m_parents.push_back(_parent);
+    m_levels.push_back(level);
+    m_locals.push_back(_rLocal);
+    m_worlds.push_back(_rLocal);
+    m_dirty.push_back(1);
+    m_changedStamps.push_back(0);
+
+    m_firstDirtyLevel   = (std::min)(m_firstDirtyLevel, level);
+    m_lastDirtyLevel    = (std::max)(m_lastDirtyLevel, level);
+
+    return node;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cSceneGraph::SetLocal(uint32_t _node, const XMFLOAT4X4& _rLocal)
+{
+    assert(_node < GetNodeCount());
+
+    // animations set every frame, a node that did not move keeps its subtree clean
+    if (std::memcmp(&m_locals[_node], &_rLocal, sizeof(XMFLOAT4X4)) == 0)
+        return;
+
+    m_locals[_node] = _rLocal;
+    m_dirty[_node]  = 1;
+
+    m_firstDirtyLevel   = (std::min)(m_firstDirtyLevel, m_levels[_node]);
+    m_lastDirtyLevel    = (std::max)(m_lastDirtyLevel, m_levels[_node]);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+const XMFLOAT4X4& cSceneGraph::GetLocal(uint32_t _node) const
+{
+    return m_locals[_node];
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+const XMFLOAT4X4& cSceneGraph::GetWorld(uint32_t _node) const
+{
+    return m_worlds[_node];
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+uint32_t cSceneGraph::GetParent(uint32_t _node) const
+{
+    return m_parents[_node];
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+uint32_t cSceneGraph::GetNodeCount() const
+{
+    return static_cast<uint32_t>(m_parents.size());
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+uint32_t cSceneGraph::GetLevelCount() const
+{
+    return m_levelStarts.empty() ? 0 : static_cast<uint32_t>(m_levelStarts.size() - 1);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+const std::vector<uint32_t>& cSceneGraph::GetParents() const
+{
+    return m_parents;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+const std::vector<XMFLOAT4X4>& cSceneGraph::GetLocals() const
+{
+    return m_locals;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cSceneGraph::UpdateWorlds()
+{
+    // a new stamp marks this update, the nodes of the last one need no clearing
+    if (++m_updateStamp == 0)
+    {
+        std::fill(m_changedStamps.begin(), m_changedStamps.end(), 0u);
+        m_updateStamp = 1;
+    }
+
+    m_changedCount = 0;
+
+    if (m_firstDirtyLevel == c_NoDirtyLevel)
+        return;
+
+    const uint32_t levelCount = GetLevelCount();
+
+    for (uint32_t level = m_firstDirtyLevel; level < levelCount; ++level)
+    {
+        const uint32_t changed = UpdateLevel(level);
+
+        m_changedCount += changed;
+
+        // below the last dirty level only children of changed nodes change
+        if (changed == 0 && level >= m_lastDirtyLevel)
+            break;
+    }
+
+    m_firstDirtyLevel   = c_NoDirtyLevel;
+    m_lastDirtyLevel    = 0;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+bool cSceneGraph::HasChanged(uint32_t _node) const
+{
+    return m_changedStamps[_node] == m_updateStamp;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+uint32_t cSceneGraph::GetChangedCount() const
+{
+    return m_changedCount;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+uint32_t cSceneGraph::UpdateLevel(uint32_t _level)
+{
+    const uint32_t begin = m_levelStarts[_level];
+    const uint32_t end   = m_levelStarts[_level + 1];
+
+    if (end - begin <= c_NodesPerTask)
+        return UpdateRange(begin, end);
+
+    // the parents are one level up and final, every task only writes its own nodes
+    const uint32_t taskCount = (end - begin + c_NodesPerTask - 1) / c_NodesPerTask;
+
+    m_taskChanges.assign(taskCount, 0);
+
+    cParallel::For(taskCount, [&](size_t _task)
+        {
+            const uint32_t taskBegin = begin + static_cast<uint32_t>(_task) * c_NodesPerTask;
+            const uint32_t taskEnd   = (std::min)(taskBegin + c_NodesPerTask, end);
+
+            m_taskChanges[_task] = UpdateRange(taskBegin, taskEnd);
+        });
+
+    uint32_t changed = 0;
+
+    for (uint32_t taskChanged : m_taskChanges)
+    {
+        changed += taskChanged;
+    }
+
+    return changed;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+uint32_t cSceneGraph::UpdateRange(uint32_t _begin, uint32_t _end)
+{
+    uint32_t changed = 0;
+
+    for (uint32_t node = _begin; node < _end; ++node)
+    {
+        const uint32_t parent = m_parents[node];
+
+        const bool hasParentChanged = parent != c_InvalidNode && m_changedStamps[parent] == m_updateStamp;
+
+        if (!m_dirty[node] && !hasParentChanged)
+            continue;
+
+        if (parent == c_InvalidNode)
+        {
+            m_worlds[node] = m_locals[node];
+        }
+        else
+        {
+            XMStoreFloat4x4(&m_worlds[node], XMMatrixMultiply(XMLoadFloat4x4(&m_locals[node]), XMLoadFloat4x4(&m_worlds[parent])));
+        }
+
+        m_dirty[node]           = 0;
+        m_changedStamps[node]   = m_updateStamp;
+
+        ++changed;
+    }
+
+    return changed;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+
+using namespace DirectX;
+
+// Node transforms of a scene, world = local * parent world (row vectors). Nodes are stored
+// breadth first, a parent always comes before its children and the nodes of one level are
+// contiguous, so UpdateWorlds walks the levels in order and runs every level in parallel.
+// SetLocal only marks the node, UpdateWorlds recomputes the dirty nodes and the subtrees
+// below them and leaves everything else alone.
+class cSceneGraph
+{
+	public:
+
+		static constexpr uint32_t c_InvalidNode = ~0u;
+
+	public:
+
+		cSceneGraph();
+
+	public:
+
+		void Clear();
+		void Reserve(size_t _nodeCount);
+
+		// _parent is c_InvalidNode for roots, otherwise a node of this or the previous level.
+		// Throws when the order is not breadth first
+		uint32_t AddNode(uint32_t _parent, const XMFLOAT4X4& _rLocal);
+
+		void SetLocal(uint32_t _node, const XMFLOAT4X4& _rLocal);
+
+		const XMFLOAT4X4& GetLocal(uint32_t _node) const;
+		const XMFLOAT4X4& GetWorld(uint32_t _node) const;
+		uint32_t GetParent(uint32_t _node) const;
+
+		uint32_t GetNodeCount() const;
+		uint32_t GetLevelCount() const;
+
+		// one per node, in node order
+		const std::vector<uint32_t>& GetParents() const;
+		const std::vector<XMFLOAT4X4>& GetLocals() const;
+
+		// recomputes the world matrices of the dirty nodes and their descendants
+		void UpdateWorlds();
+
+		// whether the last UpdateWorlds recomputed the node, and how many it recomputed
+		bool HasChanged(uint32_t _node) const;
+		uint32_t GetChangedCount() const;
+
+	private:
+
+		// recomputes one level, returns how many nodes of it changed
+		uint32_t UpdateLevel(uint32_t _level);
+		uint32_t UpdateRange(uint32_t _begin, uint32_t _end);
+
+	private:
+
+		std::vector<uint32_t>		m_parents;
+		std::vector<uint32_t>		m_levels;			// depth of every node, roots are 0
+		std::vector<uint32_t>		m_levelStarts;		// first node of every level, plus the end
+		std::vector<XMFLOAT4X4>		m_locals;
+		std::vector<XMFLOAT4X4>		m_worlds;
+		std::vector<uint8_t>		m_dirty;
+		std::vector<uint32_t>		m_changedStamps;	// m_updateStamp when the node changed last
+		std::vector<uint32_t>		m_taskChanges;		// per task of a level UpdateLevel splits up
+
+		uint32_t					m_updateStamp;
+		uint32_t					m_changedCount;
+		uint32_t					m_firstDirtyLevel;
+		uint32_t					m_lastDirtyLevel;
+};
@@ -0,0 +1,230 @@
+#include "tangentGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <vector>
+
+#include "Core/parallel.h"
+
+// triangles / vertices handed to one worker at a time
+constexpr size_t c_TangentBlockSize = 16384;
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+struct sFloat3
+{
+    float x, y, z;
+};
+
+static inline sFloat3 Sub(const sFloat3& _a, const sFloat3& _b)     { return { _a.x - _b.x, _a.y - _b.y, _a.z - _b.z }; }
+static inline sFloat3 Scale(const sFloat3& _a, float _s)            { return { _a.x * _s, _a.y * _s, _a.z * _s }; }
+static inline float   Dot(const sFloat3& _a, const sFloat3& _b)     { return _a.x * _b.x + _a.y * _b.y + _a.z * _b.z; }
+static inline float   Length(const sFloat3& _a)                     { return std::sqrt(Dot(_a, _a)); }
+
+static inline sFloat3 Cross(const sFloat3& _a, const sFloat3& _b)
+{
+    return { _a.y * _b.z - _a.z * _b.y, _a.z * _b.x - _a.x * _b.z, _a.x * _b.y - _a.y * _b.x };
+}
+
+// removes the component along the unit vector _n and normalises, false when nothing is left
+static inline bool ProjectNormalize(const sFloat3& _v, const sFloat3& _n, sFloat3& _rOut)
+{
+    const sFloat3 projected = Sub(_v, Scale(_n, Dot(_v, _n)));
+    const float   length    = Length(projected);
+
+    if (length <= 1e-12f)
+        return false;
+
+    _rOut = Scale(projected, 1.0f / length);
+    return true;
+}
+
+static inline const float* Stream(const float* _pBase, size_t _stride, size_t _index)
+{
+    return reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(_pBase) + _index * _stride);
+}
+
+static void RunBlocks(size_t _count, bool _multithreaded, const std::function<void(size_t, size_t)>& _function)
+{
+    const size_t blockCount = (_count + c_TangentBlockSize - 1) / c_TangentBlockSize;
+
+    auto RunBlock = [&](size_t _block)
+        {
+            const size_t begin = _block * c_TangentBlockSize;
+            _function(begin, std::min(begin + c_TangentBlockSize, _count));
+        };
+
+    if (_multithreaded)
+    {
+        cParallel::For(blockCount, RunBlock);
+    }
+    else
+    {
+        for (size_t block = 0; block < blockCount; ++block)
+        {
+            RunBlock(block);
+        }
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTangentGenerator::Generate(const uint32_t* _pIndices, size_t _indexCount, size_t _vertexCount,
+    const sTangentStreams& _rStreams, bool _multithreaded)
+{
+    const size_t triangleCount  = _indexCount / 3;
+    const size_t stride         = _rStreams.stride;
+
+    auto Position = [&](size_t _vertex)
+        {
+            const float* p = Stream(_rStreams.pPositions, stride, _vertex);
+            return sFloat3{ p[0], p[1], p[2] };
+        };
+
+    // ---- face tangents -------------------------------------------------------------------------------------------------
+
+    // unnormalised dP/du and the bitangent per triangle, zero when the UVs are degenerate
+    std::vector<sFloat3>    faceTangents(triangleCount);
+    std::vector<sFloat3>    faceBitangents(triangleCount);
+    std::vector<uint8_t>    faceValid(triangleCount);
+
+    RunBlocks(triangleCount, _multithreaded, [&](size_t _begin, size_t _end)
+        {
+            for (size_t triangle = _begin; triangle < _end; ++triangle)
+            {
+                const uint32_t* pTriangle = _pIndices + triangle * 3;
+
+                faceValid[triangle] = 0;
+
+                if (pTriangle[0] >= _vertexCount || pTriangle[1] >= _vertexCount || pTriangle[2] >= _vertexCount)
+                    continue;
+
+                const sFloat3 p0 = Position(pTriangle[0]);
+                const sFloat3 e1 = Sub(Position(pTriangle[1]), p0);
+                const sFloat3 e2 = Sub(Position(pTriangle[2]), p0);
+
+                const float* uv0 = Stream(_rStreams.pTexCoords, stride, pTriangle[0]);
+                const float* uv1 = Stream(_rStreams.pTexCoords, stride, pTriangle[1]);
+                const float* uv2 = Stream(_rStreams.pTexCoords, stride, pTriangle[2]);
+
+                const float du1 = uv1[0] - uv0[0], dv1 = uv1[1] - uv0[1];
+                const float du2 = uv2[0] - uv0[0], dv2 = uv2[1] - uv0[1];
+
+                const float determinant = du1 * dv2 - du2 * dv1;
+
+                if (std::fabs(determinant) <= 1e-20f)
+                    continue;
+
+                const float r = 1.0f / determinant;
+
+                const sFloat3 dPdu = Scale(Sub(Scale(e1, dv2), Scale(e2, dv1)), r);
+                const sFloat3 dPdv = Scale(Sub(Scale(e2, du1), Scale(e1, du2)), r);
+
+                // glTF v runs down the image while the normal map's +Y points up
+                faceTangents[triangle]      = dPdu;
+                faceBitangents[triangle]    = Scale(dPdv, -1.0f);
+                faceValid[triangle]         = 1;
+            }
+        });
+
+    // ---- vertex -> corner adjacency ------------------------------------------------------------------------------------
+
+    // filled in corner order so every vertex sums its corners in the same order on any thread count
+    std::vector<uint32_t> cornerOffsets(_vertexCount + 1, 0);
+    std::vector<uint32_t> corners;
+
+    for (size_t corner = 0; corner < triangleCount * 3; ++corner)
+    {
+        if (faceValid[corner / 3])
+            ++cornerOffsets[_pIndices[corner] + 1];
+    }
+
+    for (size_t vertex = 0; vertex < _vertexCount; ++vertex)
+    {
+        cornerOffsets[vertex + 1] += cornerOffsets[vertex];
+    }
+
+    corners.resize(cornerOffsets[_vertexCount]);
+
+    {
+        std::vector<uint32_t> cursor(cornerOffsets.begin(), cornerOffsets.end() - 1);
+
+        for (size_t corner = 0; corner < triangleCount * 3; ++corner)
+        {
+            if (faceValid[corner / 3])
+                corners[cursor[_pIndices[corner]]++] = static_cast<uint32_t>(corner);
+        }
+    }
+
+    // ---- per vertex frames ---------------------------------------------------------------------------------------------
+
+    RunBlocks(_vertexCount, _multithreaded, [&](size_t _begin, size_t _end)
+        {
+            for (size_t vertex = _begin; vertex < _end; ++vertex)
+            {
+                const float* pNormal = Stream(_rStreams.pNormals, stride, vertex);
+
+                sFloat3 n = { pNormal[0], pNormal[1], pNormal[2] };
+
+                const float normalLength = Length(n);
+                n = normalLength > 0.0f ? Scale(n, 1.0f / normalLength) : sFloat3{ 0.0f, 0.0f, 1.0f };
+
+                sFloat3 sumTangent      = { 0.0f, 0.0f, 0.0f };
+                sFloat3 sumBitangent    = { 0.0f, 0.0f, 0.0f };
+
+                for (uint32_t i = cornerOffsets[vertex]; i < cornerOffsets[vertex + 1]; ++i)
+                {
+                    const size_t    triangle    = corners[i] / 3;
+                    const uint32_t  corner      = corners[i] % 3;
+                    const uint32_t* pTriangle   = _pIndices + triangle * 3;
+
+                    const sFloat3 p     = Position(pTriangle[corner]);
+                    const sFloat3 edge0 = Sub(Position(pTriangle[(corner + 1) % 3]), p);
+                    const sFloat3 edge1 = Sub(Position(pTriangle[(corner + 2) % 3]), p);
+
+                    const float edgeLengths = Length(edge0) * Length(edge1);
+
+                    if (edgeLengths <= 0.0f)
+                        continue;
+
+                    const float angle = std::acos(std::min(std::max(Dot(edge0, edge1) / edgeLengths, -1.0f), 1.0f));
+
+                    sFloat3 tangent;
+                    sFloat3 bitangent;
+
+                    if (ProjectNormalize(faceTangents[triangle], n, tangent))
+                    {
+                        sumTangent.x += tangent.x * angle;
+                        sumTangent.y += tangent.y * angle;
+                        sumTangent.z += tangent.z * angle;
+                    }
+
+                    if (ProjectNormalize(faceBitangents[triangle], n, bitangent))
+                    {
+                        sumBitangent.x += bitangent.x * angle;
+                        sumBitangent.y += bitangent.y * angle;
+                        sumBitangent.z += bitangent.z * angle;
+                    }
+                }
+
+                sFloat3 tangent = { 0.0f, 0.0f, 0.0f };
+
+                if (!ProjectNormalize(sumTangent, n, tangent))
+                {
+                    // no usable UVs around this vertex, any frame around the normal keeps the shader stable
+                    const sFloat3 axis = std::fabs(n.x) < 0.9f ? sFloat3{ 1.0f, 0.0f, 0.0f } : sFloat3{ 0.0f, 1.0f, 0.0f };
+                    ProjectNormalize(axis, n, tangent);
+                }
+
+                float* pTangent = reinterpret_cast<float*>(reinterpret_cast<uint8_t*>(_rStreams.pTangents) + vertex * stride);
+
+                pTangent[0] = tangent.x;
+                pTangent[1] = tangent.y;
+                pTangent[2] = tangent.z;
+                pTangent[3] = Dot(Cross(n, tangent), sumBitangent) < 0.0f ? -1.0f : 1.0f;
+            }
+        });
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
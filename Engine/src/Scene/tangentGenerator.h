@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Strided views into an interleaved vertex buffer, all streams share one stride.
+struct sTangentStreams
+{
+	const float*	pPositions;		// float3
+	const float*	pNormals;		// float3
+	const float*	pTexCoords;		// float2, the UV set of the normal map
+	float*			pTangents;		// float4 out, w = bitangent sign
+	size_t			stride;			// in bytes
+};
+
+// Per-vertex tangent frames following the MikkTSpace conventions: face tangents
+// are projected onto the vertex normal plane and accumulated weighted by the
+// corner angle, the bitangent sign comes from the accumulated face bitangents.
+// Vertices are not split, a vertex shared across a mirrored UV seam gets the
+// handedness of the larger side.
+class cTangentGenerator
+{
+	public:
+
+		// Large meshes are split into blocks that run on all workers, set
+		// _multithreaded to false when the caller already runs in parallel.
+		// Output is identical either way.
+		static void Generate(const uint32_t* _pIndices, size_t _indexCount, size_t _vertexCount,
+			const sTangentStreams& _rStreams, bool _multithreaded);
+};
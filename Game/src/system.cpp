@@ -10,6 +10,7 @@
 #include "core/window.h"
 #include "core/timer.h"
 #include "core/input.h"
+#include "Core/jobSystem.h"
 
 #include "graphics/directx12.h"
 #include "graphics/directx12Util.h"
@@ -17,9 +18,11 @@
 #include "graphics/vertex.h"
 #include "graphics/meshGeometry.h"
 #include "graphics/cpuTexture.h"
+#include "Graphics/gfxConfig.h"
 
 #include "Scene/modelLoader.h"
 #include "Scene/model.h"
+#include "Scene/cookedScene.h"
 
 using namespace DirectX;
 using namespace Microsoft::WRL;
@@ -30,6 +33,9 @@ void cSystem::Initialize()
 {
     std::cout << "Initialize\n";
 
+    // one worker per core besides the main thread, the loader already runs on them
+    cJobSystem::Initialize();
+
     m_pTimer = new cTimer();
     m_pTimer->Start();
 
@@ -47,6 +53,13 @@ void cSystem::Initialize()
     InitializeRenderItems();
     InitializeLights();
 
+    // loading recorded on this thread, from here on only the render thread draws
+    m_renderThread.Start([this](sFrameSnapshot& _rSnapshot)
+        {
+            m_pDirectX12->Update(_rSnapshot);
+            m_pDirectX12->Draw();
+        }, GFX_RENDER_THREAD != 0);
+
     std::cout << "Initialize finished. time: " << m_pTimer->GetTotalTime() << "seconds \n";
 }
 
@@ -68,7 +81,17 @@ void cSystem::Run()
         float deltaTime = static_cast<float>(m_pTimer->GetDeltaTime());
         Update(deltaTime);
 
-        m_pDirectX12->Draw();
+        sFrameSnapshot& rSnapshot = m_renderThread.BeginFrame();
+
+        FillSnapshot(rSnapshot);
+
+        m_renderThread.SubmitFrame();
+
+        // the resize reads the window, which the next message handling may change again
+        if (rSnapshot.hasResized)
+        {
+            m_renderThread.WaitIdle();
+        }
     }
 }
 
@@ -80,11 +103,24 @@ void cSystem::Finalize()
 
     m_pWindow->SetConsoleCloseEnabled(true);
 
+    m_renderThread.Stop();
+
+    const sFramePipelineStats renderStats = m_renderThread.GetStats();
+
+    if (renderStats.frames > 0)
+    {
+        std::cout << "Render thread: " << renderStats.frames << " frames, handoff "
+            << renderStats.totalHandoffSeconds * 1000.0 / static_cast<double>(renderStats.frames) << " ms average, "
+            << renderStats.maxHandoffSeconds * 1000.0 << " ms max\n";
+    }
+
     m_pDirectX12->Finalize();
 
     delete m_pWindow;
     delete m_pDirectX12;
     delete m_pTimer;
+
+    cJobSystem::Shutdown();
 }
 
 // --------------------------------------------------------------------------------------------------------------------------
@@ -94,45 +130,84 @@ void cSystem::InitializeRenderItems()
     m_materials.clear();
     m_textures.clear();
     m_pScene->GetRenderItems().clear();
+    m_pScene->GetItemNodes().clear();
+    m_pScene->GetSceneGraph().Clear();
 
     std::string path = "..\\Assets\\Objects\\scene.glb";
 
-    sModel model;
+    // streamed texture levels are read from the mapped file, so the scene stays open
+    cCookedScene& cookedScene = m_cookedScene;
 
-    cModelLoader::LoadGLTFModel(path, model);
+    if (!cModelLoader::LoadCookedScene(path, cookedScene))
+    {
+        std::cerr << "Failed to load scene: " << path << "\n";
+        return;
+    }
 
-    std::vector<sMeshData>&         meshes          = model.meshes;
-    std::vector<sMaterial>&         materials       = model.materials;
-    std::vector<XMMATRIX>&          worldMatrices   = model.worldMatrices;
-    std::vector<cCpuTexture>&       cpuTextures     = model.cpuTextures;
-    std::vector<sLightConstants>&   lights          = model.lights;
+    const size_t submeshCount  = cookedScene.GetSubmeshCount();
+    const size_t instanceCount = cookedScene.GetInstanceCount();
 
     std::cout << "----------------------------------------\n";
-    std::cout << "GLTF LOAD DEBUG\n";
-    std::cout << "meshes:        " << meshes.size() << "\n";
-    std::cout << "materials:     " << materials.size() << "\n";
-    std::cout << "worldMatrices: " << worldMatrices.size() << "\n";
-    std::cout << "cpuTextures:   " << cpuTextures.size() << "\n";
-    std::cout << "lights:        " << lights.size() << "\n";
+    std::cout << "SCENE LOAD DEBUG\n";
+    std::cout << "submeshes:     " << submeshCount << "\n";
+    std::cout << "materials:     " << cookedScene.GetMaterialCount() << "\n";
+    std::cout << "instances:     " << instanceCount << "\n";
+    std::cout << "textures:      " << cookedScene.GetTextureCount() << "\n";
+    std::cout << "lights:        " << cookedScene.GetLightCount() << "\n";
+    std::cout << "nodes:         " << cookedScene.GetNodeCount() << "\n";
+
+    // instances move with their node, the graph holds the hierarchy the cook flattened
+    cSceneGraph& rSceneGraph = m_pScene->GetSceneGraph();
 
-    assert(meshes.size() == worldMatrices.size());
+    rSceneGraph.Reserve(cookedScene.GetNodeCount());
 
-    for (auto& mat : materials)
+    for (size_t i = 0; i < cookedScene.GetNodeCount(); ++i)
+    {
+        rSceneGraph.AddNode(cookedScene.GetNodeParents()[i], cookedScene.GetNodeLocals()[i]);
+    }
+
+    rSceneGraph.UpdateWorlds();
+
+    m_materials.assign(
+        cookedScene.GetMaterials(),
+        cookedScene.GetMaterials() + cookedScene.GetMaterialCount());
+
+    for (auto& mat : m_materials)
     {
         if (mat.alpha == 0.f)      mat.alpha = 1.f;
         if (mat.roughness == 0.f)  mat.roughness = 0.5f;
         if (mat.ao == 0.f)         mat.ao = 1.f;
     }
 
-    m_materials = std::move(materials);
+    // the object constants follow the scene, the heap they share with the textures is created again
+    m_pDirectX12->ReserveRenderItems(static_cast<UINT>(instanceCount));
+
+    std::vector<cCpuTexture> cpuTextures;
+    cpuTextures.reserve(cookedScene.GetTextureCount());
 
-    for (size_t i = 0; i < meshes.size(); ++i)
+    for (size_t i = 0; i < cookedScene.GetTextureCount(); ++i)
     {
-        m_pDirectX12->InitializeMesh(meshes[i]);
+        const sCookedTexture& rTexture = cookedScene.GetTextures()[i];
+        const uint8_t* pData = cookedScene.GetTextureData(rTexture);
+
+        // the mapped file stays open while textures stream, so they read it in place
+        cpuTextures.emplace_back(
+            rTexture.width,
+            rTexture.height,
+            cTexturePayload::View(pData, rTexture.dataSize),
+            static_cast<DXGI_FORMAT>(rTexture.format),
+            rTexture.mipLevels,
+            rTexture.arraySize);
     }
 
-    sMeshGeometry* pMeshGeo = m_pDirectX12->InitializeGeometryBuffer();
-    m_pDirectX12->UploadCpuTexturesToGpu(cpuTextures);
+    sMeshGeometry* pMeshGeo = m_pDirectX12->InitializeGeometryBuffer(cookedScene);
+
+    // material texture indices point into this table, it knows the packed pages
+    std::vector<sTextureRef> textureRefs(
+        cookedScene.GetTextureRefs(),
+        cookedScene.GetTextureRefs() + cookedScene.GetTextureRefCount());
+
+    m_pDirectX12->UploadCpuTexturesToGpu(cpuTextures, textureRefs);
 
     static sMaterial defaultMaterial;
     defaultMaterial.albedo = XMFLOAT3(1.f, 1.f, 1.f);
@@ -144,33 +219,48 @@ void cSystem::InitializeRenderItems()
 
     UINT objCBIndex = 0;
 
-    for (size_t i = 0; i < meshes.size(); ++i)
+    // submeshes are shared, every instance only adds a render item with its own transform
+    for (size_t i = 0; i < instanceCount; ++i)
     {
+        const uint32_t submeshIndex = cookedScene.GetInstanceSubmeshes()[i];
+
+        if (submeshIndex >= submeshCount)
+            continue;
+
         sRenderItem ri{};
 
         ri.pGeometry = pMeshGeo;
         ri.objCBIndex = objCBIndex++;
 
-        const UINT matIndex = meshes[i].materialId;
+        const auto& submesh = pMeshGeo->drawArguments[submeshIndex];
+
+        const UINT matIndex = submesh.materialId;
         if (matIndex < m_materials.size())
             ri.pMaterial = &m_materials[matIndex];
         else
             ri.pMaterial = &defaultMaterial;
 
-        const auto& submesh = pMeshGeo->drawArguments[i];
         ri.indexCount = submesh.indexCount;
         ri.startIndexLocation = submesh.startIndexLocation;
         ri.baseVertexLocation = submesh.startVertexLocation;
+        ri.vertexFormat = submesh.vertexFormat;
+        ri.indexFormat = submesh.indexFormat;
+        ri.positionOffset = submesh.positionOffset;
+        ri.positionScale = submesh.positionScale;
+        ri.submeshIndex = submeshIndex;
 
-        XMStoreFloat4x4(&ri.worldMatrix, worldMatrices[i]);
         ri.numberOfFramesDirty = c_NumberOfFrameResources;
 
         m_pScene->GetRenderItems().emplace_back(std::move(ri));
+        m_pScene->GetItemNodes().push_back(cookedScene.GetInstanceNodes()[i]);
     }
 
-    for (sLightConstants light : lights)
+    // the renderer learns every world with the first frame, later only the moved ones
+    m_pScene->MarkAllTransformsMoved();
+
+    for (size_t i = 0; i < cookedScene.GetLightCount(); ++i)
     {
-        m_pScene->GetLight().emplace_back(std::move(light));
+        m_pScene->GetLight().push_back(cookedScene.GetLights()[i]);
     }
     
     std::cout << "city.gltf erfolgreich geladen.\n";
@@ -219,10 +309,45 @@ void cSystem::Update(float deltaTime)
 {
     HandleInput(deltaTime);
 
-    XMMATRIX view = m_pCamera->GetViewMatrix();
-    XMFLOAT3 camPos = m_pCamera->GetPosition();
+    m_pScene->UpdateTransforms();
+
+    m_pScene->SelectLods(*m_pCamera, static_cast<float>(m_pWindow->GetHeight()));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cSystem::FillSnapshot(sFrameSnapshot& _rSnapshot)
+{
+    XMStoreFloat4x4(&_rSnapshot.view, m_pCamera->GetViewMatrix());
+
+    _rSnapshot.eyePos       = m_pCamera->GetPosition();
+    _rSnapshot.totalTime    = m_pTimer->GetTotalTime();
+    _rSnapshot.deltaTime    = m_pTimer->GetDeltaTime();
+    _rSnapshot.hasResized   = m_pWindow->GetHasResized();
+
+    m_pWindow->SetHasResized(false);
+
+    // the copies carry the dirty count to the renderer, every snapshot is drawn exactly once.
+    // Culled items still go along while dirty, each frame resource in turn has to get their
+    // constants or the one skipped keeps the old ones. Draw leaves them out
+    _rSnapshot.renderItems.clear();
+
+    for (sRenderItem& rItem : m_pScene->GetRenderItems())
+    {
+        if (rItem.isCulled && rItem.numberOfFramesDirty <= 0)
+            continue;
+
+        _rSnapshot.renderItems.push_back(rItem);
+
+        if (rItem.numberOfFramesDirty > 0)
+            --rItem.numberOfFramesDirty;
+    }
+
+    m_pScene->TakeMovedTransforms(_rSnapshot.transforms);
+
+    _rSnapshot.lights = m_pScene->GetLight();
 
-    m_pDirectX12->Update(view, camPos, &m_pScene->GetRenderItems(), &m_pScene->GetLight());
+    m_pScene->RequestTextureMips(*m_pCamera, static_cast<float>(m_pWindow->GetHeight()), _rSnapshot.textureRequests);
 }
 
 // --------------------------------------------------------------------------------------------------------------------------
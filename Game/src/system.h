@@ -12,6 +12,8 @@
 #include "Graphics/texture.h"
 #include <Scene/scene.h>
 #include "Scene/camera.h"
+#include "Scene/cookedScene.h"
+#include "Graphics/frameSnapshot.h"
 
 using namespace DirectX;
 
@@ -39,6 +41,9 @@ class cSystem
     
         void Update(float deltaTime);
         void HandleInput(float deltaTime);
+
+        // copies what the renderer reads of this frame, the scene moves on while it draws
+        void FillSnapshot(sFrameSnapshot& _rSnapshot);
     
     private:
 
@@ -53,6 +58,10 @@ class cSystem
     
         std::vector<cTexture> m_textures;
 
+        cCookedScene m_cookedScene;
+
+        cRenderThread m_renderThread;
+
         XMFLOAT4X4 m_view{};
         XMFLOAT4X4 m_proj{};
 };
\ No newline at end of file
@@ -0,0 +1,263 @@
+#include "testFramework.h"
+
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "Core/framePipeline.h"
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+struct sTestFrame
+{
+    uint64_t            number;
+    std::vector<int>    payload;    // keeps its capacity like the snapshot vectors
+};
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+static void ProduceFrames(cFramePipeline<sTestFrame>& _rPipeline, uint64_t _first, uint64_t _count)
+{
+    for (uint64_t i = 0; i < _count; ++i)
+    {
+        sTestFrame& rFrame = _rPipeline.BeginFrame();
+
+        rFrame.number = _first + i;
+        rFrame.payload.assign(16, static_cast<int>(_first + i));
+
+        _rPipeline.SubmitFrame();
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(FramePipelineConsumesFramesInOrder)
+{
+    for (bool useThread : { false, true })
+    {
+        std::vector<uint64_t> consumed;
+        bool payloadMatches = true;
+
+        {
+            cFramePipeline<sTestFrame> pipeline;
+
+            pipeline.Start([&](sTestFrame& _rFrame)
+                {
+                    consumed.push_back(_rFrame.number);
+                    payloadMatches &= _rFrame.payload.size() == 16 && _rFrame.payload[15] == static_cast<int>(_rFrame.number);
+                }, useThread);
+
+            ProduceFrames(pipeline, 0, 1000);
+
+            // consumes what is still queued
+            pipeline.Stop();
+
+            CHECK(pipeline.GetStats().frames == 1000);
+        }
+
+        CHECK(consumed.size() == 1000);
+        CHECK(payloadMatches);
+
+        for (size_t i = 0; i < consumed.size(); ++i)
+        {
+            CHECK(consumed[i] == i);
+        }
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(FramePipelineRunsAtMostOneFrameAhead)
+{
+    cFramePipeline<sTestFrame> pipeline;
+
+    std::atomic<bool> release(false);
+    std::atomic<uint64_t> started(0);
+
+    pipeline.Start([&](sTestFrame&)
+        {
+            started.fetch_add(1);
+
+            while (!release.load())
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+
+    // one frame is being consumed, the other one waits in the queue
+    ProduceFrames(pipeline, 0, 2);
+
+    std::atomic<bool> released(false);
+
+    std::thread releaser([&]()
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+            released.store(true);
+            release.store(true);
+        });
+
+    // both snapshots are in flight, this has to wait for the consumer
+    pipeline.BeginFrame();
+
+    CHECK(released.load());
+    CHECK(started.load() >= 1);
+
+    pipeline.SubmitFrame();
+    pipeline.WaitIdle();
+
+    CHECK(pipeline.GetStats().frames == 3);
+
+    releaser.join();
+    pipeline.Stop();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(FramePipelineWaitIdleWaitsForEveryFrame)
+{
+    cFramePipeline<sTestFrame> pipeline;
+
+    std::atomic<uint64_t> consumed(0);
+
+    pipeline.Start([&](sTestFrame&)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            consumed.fetch_add(1);
+        });
+
+    for (uint64_t round = 1; round <= 20; ++round)
+    {
+        ProduceFrames(pipeline, 0, 3);
+
+        pipeline.WaitIdle();
+
+        CHECK(consumed.load() == round * 3);
+    }
+
+    // nothing submitted, returns right away
+    pipeline.WaitIdle();
+
+    pipeline.Stop();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(FramePipelineRethrowsOnTheProducer)
+{
+    cFramePipeline<sTestFrame> pipeline;
+
+    std::atomic<uint64_t> consumed(0);
+
+    pipeline.Start([&](sTestFrame& _rFrame)
+        {
+            if (_rFrame.number == 5)
+                throw std::runtime_error("consume failed");
+
+            consumed.fetch_add(1);
+        });
+
+    bool rethrown = false;
+
+    try
+    {
+        // BeginFrame or WaitIdle sees the failure, whichever runs after it
+        ProduceFrames(pipeline, 0, 100);
+        pipeline.WaitIdle();
+    }
+    catch (const std::runtime_error&)
+    {
+        rethrown = true;
+    }
+
+    CHECK(rethrown);
+
+    // frames after the failed one are not consumed, the pipeline still stops
+    CHECK(consumed.load() == 5);
+
+    pipeline.Stop();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// a consumer waiting for frames sleeps, the process burns next to no CPU time while nothing is submitted
+TEST_CASE(FramePipelineSleepsWhileIdle)
+{
+    cFramePipeline<sTestFrame> pipeline;
+
+    pipeline.Start([](sTestFrame&) {});
+
+    ProduceFrames(pipeline, 0, 4);
+    pipeline.WaitIdle();
+
+    const std::clock_t cpuStart = std::clock();
+    const auto wallStart = std::chrono::steady_clock::now();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    const double cpuSeconds     = static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+    const double wallSeconds    = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+    // a thread yielding in a loop takes all of it
+    CHECK(cpuSeconds < wallSeconds * 0.25);
+
+    pipeline.Stop();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+BENCHMARK(FramePipeline)
+{
+    const uint64_t c_Frames = 100000;
+
+    // frames back to back, the producer only waits when both snapshots are in flight
+    {
+        cFramePipeline<sTestFrame> pipeline;
+
+        pipeline.Start([](sTestFrame&) {});
+
+        const double seconds = cBenchmark::Measure(1, [&]()
+            {
+                ProduceFrames(pipeline, 0, c_Frames);
+                pipeline.WaitIdle();
+            });
+
+        const sFramePipelineStats stats = pipeline.GetStats();
+
+        cBenchmark::Report("throughput", static_cast<double>(c_Frames) / seconds, "frames/s");
+        cBenchmark::Report("handoff, average", stats.totalHandoffSeconds / static_cast<double>(stats.frames) * 1e6, "us");
+
+        pipeline.Stop();
+    }
+
+    // one frame at a time, every handoff finds the consumer asleep
+    {
+        cFramePipeline<sTestFrame> pipeline;
+
+        pipeline.Start([](sTestFrame&) {});
+
+        const uint64_t c_RoundTrips = 10000;
+
+        const double seconds = cBenchmark::Measure(1, [&]()
+            {
+                for (uint64_t i = 0; i < c_RoundTrips; ++i)
+                {
+                    ProduceFrames(pipeline, i, 1);
+                    pipeline.WaitIdle();
+                }
+            });
+
+        const sFramePipelineStats stats = pipeline.GetStats();
+
+        cBenchmark::Report("submit + WaitIdle round trip", seconds / static_cast<double>(c_RoundTrips) * 1e6, "us");
+        cBenchmark::Report("wake-up handoff, average", stats.totalHandoffSeconds / static_cast<double>(stats.frames) * 1e6, "us");
+        cBenchmark::Report("wake-up handoff, max", stats.maxHandoffSeconds * 1e6, "us");
+
+        pipeline.Stop();
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
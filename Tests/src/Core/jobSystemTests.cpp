@@ -0,0 +1,538 @@
+#include "testFramework.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Core/jobSystem.h"
+#include "Core/parallel.h"
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(JobsRunInlineWithoutWorkers)
+{
+    cJobSystem::Shutdown();
+
+    CHECK(cJobSystem::GetThreadCount() == 1);
+
+    const std::thread::id caller = std::this_thread::get_id();
+
+    cJobCounter counter;
+    bool        ranOnCaller = false;
+
+    cJobSystem::Run([&]() { ranOnCaller = std::this_thread::get_id() == caller; }, &counter);
+
+    // done before Run returned
+    CHECK(ranOnCaller);
+    CHECK(counter.IsDone());
+
+    cJobSystem::Wait(counter);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(JobCountersTrackEveryJob)
+{
+    cJobSystem::Initialize(3);
+
+    std::atomic<uint32_t> sum{ 0 };
+
+    cJobCounter counter;
+
+    // reused after every Wait
+    for (uint32_t round = 1; round <= 3; ++round)
+    {
+        for (uint32_t i = 0; i < 10000; ++i)
+        {
+            cJobSystem::Run([&sum]() { sum.fetch_add(1, std::memory_order_relaxed); }, &counter);
+        }
+
+        cJobSystem::Wait(counter);
+
+        CHECK(counter.IsDone());
+        CHECK(sum.load() == 10000 * round);
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(JobContinuationsRunAfterTheirDependency)
+{
+    cJobSystem::Initialize(3);
+
+    const uint32_t c_Jobs   = 200;
+    const uint32_t c_Chain  = 50;
+
+    std::vector<std::atomic<uint32_t>> done(c_Jobs);
+
+    cJobCounter producers;
+    cJobCounter consumers;
+
+    for (uint32_t i = 0; i < c_Jobs; ++i)
+    {
+        done[i].store(0);
+
+        cJobSystem::Run([&done, i]()
+            {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+                done[i].store(1, std::memory_order_release);
+            }, &producers);
+    }
+
+    // every continuation sees all jobs of its dependency finished
+    std::atomic<uint32_t> missed{ 0 };
+
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        cJobSystem::Run([&]()
+            {
+                for (std::atomic<uint32_t>& rDone : done)
+                {
+                    if (rDone.load(std::memory_order_acquire) == 0)
+                        missed.fetch_add(1);
+                }
+            }, &consumers, &producers);
+    }
+
+    cJobSystem::Wait(consumers);
+    cJobSystem::Wait(producers);
+
+    CHECK(missed.load() == 0);
+
+    // a chain, every link depends on the counter of the previous one
+    std::vector<std::unique_ptr<cJobCounter>> links;
+    std::vector<uint32_t> order;
+
+    for (uint32_t i = 0; i < c_Chain; ++i)
+    {
+        links.push_back(std::make_unique<cJobCounter>());
+
+        cJobCounter* pDependency = i > 0 ? links[i - 1].get() : nullptr;
+
+        cJobSystem::Run([&order, i]() { order.push_back(i); }, links[i].get(), pDependency);
+    }
+
+    cJobSystem::Wait(*links.back());
+
+    // the earlier links finished before the last one started, their locks are free once waited on
+    for (std::unique_ptr<cJobCounter>& rLink : links)
+    {
+        cJobSystem::Wait(*rLink);
+    }
+
+    CHECK(order.size() == c_Chain);
+
+    for (uint32_t i = 0; i < order.size(); ++i)
+    {
+        CHECK(order[i] == i);
+    }
+
+    // a dependency that is done already does not hold the job back
+    cJobCounter finished;
+    cJobCounter after;
+    std::atomic<bool> ran{ false };
+
+    cJobSystem::Run([&]() { ran.store(true); }, &after, &finished);
+    cJobSystem::Wait(after);
+
+    CHECK(ran.load());
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(JobWaitRunsJobsWhileWaiting)
+{
+    cJobSystem::Initialize(1);
+
+    // the only worker is held up until the main thread let it go
+    std::atomic<bool> started{ false };
+    std::atomic<bool> release{ false };
+
+    cJobCounter blocker;
+
+    cJobSystem::Run([&]()
+        {
+            started.store(true);
+
+            while (!release.load())
+            {
+                std::this_thread::yield();
+            }
+        }, &blocker);
+
+    while (!started.load())
+    {
+        std::this_thread::yield();
+    }
+
+    // nobody but the waiting thread can run these
+    cJobCounter counter;
+    std::atomic<uint32_t> onCaller{ 0 };
+
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+        cJobSystem::Run([&]()
+            {
+                if (cJobSystem::GetWorkerIndex() < 0)
+                    onCaller.fetch_add(1);
+            }, &counter);
+    }
+
+    cJobSystem::Wait(counter);
+
+    CHECK(onCaller.load() == 100);
+
+    release.store(true);
+    cJobSystem::Wait(blocker);
+
+    // jobs that start jobs and wait for them, one worker and the caller are enough
+    std::atomic<uint32_t> inner{ 0 };
+
+    cParallel::For(16, [&](size_t)
+        {
+            cParallel::For(64, [&](size_t) { inner.fetch_add(1, std::memory_order_relaxed); });
+        });
+
+    CHECK(inner.load() == 16 * 64);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// a thread waiting for a long job it cannot help with sleeps, the process burns next to no CPU time besides the job
+TEST_CASE(JobWaitSleepsWhileTheLastJobRuns)
+{
+    cJobSystem::Initialize(1);
+
+    cJobCounter counter;
+    std::atomic<bool> started{ false };
+
+    cJobSystem::Run([&]()
+        {
+            started.store(true);
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        }, &counter);
+
+    // on the worker, not run by Wait itself
+    while (!started.load())
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    const std::clock_t cpuStart = std::clock();
+    const auto wallStart = std::chrono::steady_clock::now();
+
+    cJobSystem::Wait(counter);
+
+    const double cpuSeconds     = static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+    const double wallSeconds    = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+    CHECK(counter.IsDone());
+    CHECK(wallSeconds > 0.1);
+
+    // a waiter yielding in a loop takes all of it
+    CHECK(cpuSeconds < wallSeconds * 0.25);
+
+    // a job pushed while the caller sleeps in Wait still gets its help
+    std::atomic<bool> release{ false };
+    std::atomic<uint32_t> onCaller{ 0 };
+
+    cJobCounter blocker;
+    cJobCounter children;
+
+    started.store(false);
+
+    cJobSystem::Run([&]()
+        {
+            started.store(true);
+
+            // the caller is asleep in Wait by now
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+            // the only worker is busy, the children can only run on the waiting thread
+            for (uint32_t i = 0; i < 8; ++i)
+            {
+                cJobSystem::Run([&]()
+                    {
+                        if (cJobSystem::GetWorkerIndex() < 0)
+                            onCaller.fetch_add(1);
+                    }, &children);
+            }
+
+            while (!release.load())
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }, &blocker);
+
+    while (!started.load())
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    std::thread releaser([&]()
+        {
+            while (onCaller.load() < 8)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+
+            release.store(true);
+        });
+
+    cJobSystem::Wait(blocker);
+    releaser.join();
+
+    cJobSystem::Wait(children);
+
+    CHECK(onCaller.load() == 8);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(JobWorkersStealQueuedJobs)
+{
+    cJobSystem::Initialize(3);
+
+    // a worker pushes every child onto its own deque, the others only get them by stealing
+    std::vector<int> workers(64, -2);
+
+    cJobCounter parent;
+
+    cJobSystem::Run([&]()
+        {
+            cJobCounter children;
+
+            for (size_t i = 0; i < workers.size(); ++i)
+            {
+                cJobSystem::Run([&workers, i]()
+                    {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                        workers[i] = cJobSystem::GetWorkerIndex();
+                    }, &children);
+            }
+
+            cJobSystem::Wait(children);
+        }, &parent);
+
+    cJobSystem::Wait(parent);
+
+    const std::set<int> distinct(workers.begin(), workers.end());
+
+    CHECK(distinct.count(-2) == 0);
+    CHECK(distinct.size() >= 2);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(JobParallelForCoversEveryIndexOnce)
+{
+    for (unsigned workers : { 0u, 1u, 3u, 7u })
+    {
+        // Initialize(0) means a worker per hardware thread, without workers everything runs inline
+        if (workers == 0)
+            cJobSystem::Shutdown();
+        else
+            cJobSystem::Initialize(workers);
+
+        for (size_t count : { size_t(0), size_t(1), size_t(2), size_t(7), size_t(1000), size_t(100003) })
+        {
+            std::vector<std::atomic<uint8_t>> hits(count);
+
+            for (std::atomic<uint8_t>& rHit : hits)
+            {
+                rHit.store(0);
+            }
+
+            cJobSystem::ParallelFor(count, [&](size_t _index) { hits[_index].fetch_add(1, std::memory_order_relaxed); });
+
+            bool once = true;
+
+            for (std::atomic<uint8_t>& rHit : hits)
+            {
+                once = once && rHit.load() == 1;
+            }
+
+            CHECK(once);
+        }
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(JobParallelForRethrowsOnTheCaller)
+{
+    for (unsigned workers : { 0u, 3u })
+    {
+        if (workers == 0)
+            cJobSystem::Shutdown();
+        else
+            cJobSystem::Initialize(workers);
+
+        bool caught = false;
+
+        try
+        {
+            cJobSystem::ParallelFor(10000, [](size_t _index)
+                {
+                    if (_index == 4321)
+                        throw std::runtime_error("item failed");
+                });
+        }
+        catch (const std::runtime_error& _rError)
+        {
+            caught = std::string(_rError.what()) == "item failed";
+        }
+
+        CHECK(caught);
+
+        // the system stays usable
+        std::atomic<size_t> sum{ 0 };
+        cJobSystem::ParallelFor(100, [&](size_t _index) { sum.fetch_add(_index); });
+
+        CHECK(sum.load() == 4950);
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(JobShutdownFinishesQueuedJobs)
+{
+    for (uint32_t round = 0; round < 3; ++round)
+    {
+        cJobSystem::Initialize(2);
+
+        CHECK(cJobSystem::GetThreadCount() == 3);
+
+        // jobs without a counter nobody waits for
+        std::atomic<uint32_t> ran{ 0 };
+
+        for (uint32_t i = 0; i < 1000; ++i)
+        {
+            cJobSystem::Run([&ran]() { ran.fetch_add(1, std::memory_order_relaxed); });
+        }
+
+        cJobSystem::Shutdown();
+
+        CHECK(ran.load() == 1000);
+        CHECK(cJobSystem::GetThreadCount() == 1);
+
+        // twice is fine
+        cJobSystem::Shutdown();
+    }
+
+    // initializing again replaces the running workers
+    cJobSystem::Initialize(2);
+    cJobSystem::Initialize(4);
+
+    CHECK(cJobSystem::GetThreadCount() == 5);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// every item some arithmetic, enough that the split matters and little enough that the scheduler shows
+static double Work(size_t _index, uint32_t _iterations)
+{
+    double value = static_cast<double>(_index);
+
+    for (uint32_t i = 0; i < _iterations; ++i)
+    {
+        value = std::sqrt(value * 1.0001 + 1.0);
+    }
+
+    return value;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// Scheduler overhead (empty jobs, continuations, ParallelFor items) and how fixed work scales
+// on every power of two thread count up to the hardware threads.
+BENCHMARK(JobSystem)
+{
+    const unsigned hardwareThreads = (std::max)(std::thread::hardware_concurrency(), 1u);
+
+    double serialWorkSeconds = 0.0;
+
+    for (unsigned threads = 1; threads <= (std::max)(hardwareThreads, 2u); threads *= 2)
+    {
+        cJobSystem::Initialize(threads - 1);
+
+        std::cout << "  " << threads << (threads == 1 ? " thread\n" : " threads\n");
+
+        // ------------------------------------------------------------------------------------------------------------------
+        // overhead
+        // ------------------------------------------------------------------------------------------------------------------
+
+        const size_t c_Jobs = 100000;
+
+        const double runSeconds = cBenchmark::Measure(3, [&]()
+            {
+                cJobCounter counter;
+
+                for (size_t i = 0; i < c_Jobs; ++i)
+                {
+                    cJobSystem::Run([]() {}, &counter);
+                }
+
+                cJobSystem::Wait(counter);
+            });
+
+        cBenchmark::Report("empty jobs, Run + Wait", runSeconds / c_Jobs * 1e9, "ns/job");
+
+        const double chainSeconds = cBenchmark::Measure(3, [&]()
+            {
+                std::vector<std::unique_ptr<cJobCounter>> links(1000);
+
+                for (size_t i = 0; i < links.size(); ++i)
+                {
+                    links[i] = std::make_unique<cJobCounter>();
+
+                    cJobSystem::Run([]() {}, links[i].get(), i > 0 ? links[i - 1].get() : nullptr);
+                }
+
+                for (std::unique_ptr<cJobCounter>& rLink : links)
+                {
+                    cJobSystem::Wait(*rLink);
+                }
+            });
+
+        cBenchmark::Report("continuation chain", chainSeconds / 1000 * 1e9, "ns/link");
+
+        const size_t c_Items = 1000000;
+        std::vector<double> results(c_Items);
+
+        const double forSeconds = cBenchmark::Measure(3, [&]()
+            {
+                cParallel::For(c_Items, [&](size_t _index) { results[_index] = static_cast<double>(_index); });
+            });
+
+        cBenchmark::Report("ParallelFor, trivial items", forSeconds / c_Items * 1e9, "ns/item");
+
+        // ------------------------------------------------------------------------------------------------------------------
+        // scalability
+        // ------------------------------------------------------------------------------------------------------------------
+
+        const size_t c_WorkItems = 4096;
+
+        const double workSeconds = cBenchmark::Measure(3, [&]()
+            {
+                cParallel::For(c_WorkItems, [&](size_t _index) { results[_index] = Work(_index, 20000); });
+            });
+
+        if (threads == 1)
+            serialWorkSeconds = workSeconds;
+
+        cBenchmark::Report("ParallelFor, 4096 x 20k sqrt", workSeconds * 1000.0, "ms");
+        cBenchmark::Report("  speedup over one thread", serialWorkSeconds / workSeconds, "x");
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
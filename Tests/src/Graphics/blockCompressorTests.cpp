@@ -0,0 +1,283 @@
+#include "testFramework.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "Core/jobSystem.h"
+#include "Graphics/blockCompressor.h"
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+struct sFormatFloor
+{
+    eBlockFormat    format;
+    const char*     pName;
+    double          gradientPsnr;   // dB over the channels the format stores
+    double          noisePsnr;
+};
+
+// a few dB under what the encoder reaches, a weaker endpoint fit or palette search drops below them
+static const sFormatFloor s_formatFloors[] =
+{
+    { BLOCK_FORMAT_BC1, "BC1", 38.0, 29.0 },
+    { BLOCK_FORMAT_BC3, "BC3", 39.0, 30.0 },
+    { BLOCK_FORMAT_BC4, "BC4", 48.0, 43.0 },
+    { BLOCK_FORMAT_BC5, "BC5", 48.0, 43.0 },
+    { BLOCK_FORMAT_BC7, "BC7", 42.0, 29.0 },
+};
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// smooth ramps in every channel, _noise adds up to +-_noise per channel on top
+static std::vector<uint8_t> BuildGradientImage(uint32_t _width, uint32_t _height, int _noise, uint32_t _seed)
+{
+    std::mt19937 random(_seed);
+
+    std::vector<uint8_t> pixels(static_cast<size_t>(_width) * _height * 4);
+
+    for (uint32_t y = 0; y < _height; ++y)
+    {
+        for (uint32_t x = 0; x < _width; ++x)
+        {
+            const float u = static_cast<float>(x) / static_cast<float>((std::max)(_width - 1, 1u));
+            const float v = static_cast<float>(y) / static_cast<float>((std::max)(_height - 1, 1u));
+
+            int values[4] =
+            {
+                static_cast<int>(255.0f * u),
+                static_cast<int>(255.0f * v),
+                static_cast<int>(255.0f * (1.0f - u) * v),
+                static_cast<int>(64.0f + 191.0f * u * u),
+            };
+
+            uint8_t* pPixel = &pixels[(static_cast<size_t>(y) * _width + x) * 4];
+
+            for (int channel = 0; channel < 4; ++channel)
+            {
+                if (_noise > 0)
+                    values[channel] += static_cast<int>(random() % (2 * _noise + 1)) - _noise;
+
+                pPixel[channel] = static_cast<uint8_t>((std::min)((std::max)(values[channel], 0), 255));
+            }
+        }
+    }
+
+    return pixels;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+static double RoundTripPsnr(const std::vector<uint8_t>& _rPixels, uint32_t _width, uint32_t _height, eBlockFormat _format)
+{
+    std::vector<uint8_t> blocks(cBlockCompressor::GetCompressedSize(_width, _height, _format));
+    std::vector<uint8_t> decoded(_rPixels.size());
+
+    cBlockCompressor::Compress(_rPixels.data(), _width, _height, _format, blocks.data(), false);
+    cBlockCompressor::Decompress(blocks.data(), _width, _height, _format, decoded.data());
+
+    return cBlockCompressor::ComputePsnr(_rPixels.data(), decoded.data(), static_cast<size_t>(_width) * _height,
+        cBlockCompressor::GetChannelCount(_format));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(BlockCompressorSizesFollowTheFormat)
+{
+    CHECK(cBlockCompressor::GetBlockByteSize(BLOCK_FORMAT_BC1) == 8);
+    CHECK(cBlockCompressor::GetBlockByteSize(BLOCK_FORMAT_BC3) == 16);
+    CHECK(cBlockCompressor::GetBlockByteSize(BLOCK_FORMAT_BC4) == 8);
+    CHECK(cBlockCompressor::GetBlockByteSize(BLOCK_FORMAT_BC5) == 16);
+    CHECK(cBlockCompressor::GetBlockByteSize(BLOCK_FORMAT_BC7) == 16);
+
+    // partial blocks at the edges count as whole ones
+    CHECK(cBlockCompressor::GetCompressedSize(13, 7, BLOCK_FORMAT_BC1) == 4 * 2 * 8);
+    CHECK(cBlockCompressor::GetCompressedSize(64, 64, BLOCK_FORMAT_BC7) == 16 * 16 * 16);
+
+    CHECK(cBlockCompressor::GetChannelCount(BLOCK_FORMAT_BC1) == 3);
+    CHECK(cBlockCompressor::GetChannelCount(BLOCK_FORMAT_BC3) == 4);
+    CHECK(cBlockCompressor::GetChannelCount(BLOCK_FORMAT_BC4) == 1);
+    CHECK(cBlockCompressor::GetChannelCount(BLOCK_FORMAT_BC5) == 2);
+    CHECK(cBlockCompressor::GetChannelCount(BLOCK_FORMAT_BC7) == 4);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(BlockCompressorPsnrOfKnownErrors)
+{
+    std::vector<uint8_t> reference(64 * 4, 100);
+    std::vector<uint8_t> test = reference;
+
+    CHECK(std::isinf(cBlockCompressor::ComputePsnr(reference.data(), test.data(), 64, 4)));
+
+    // off by one everywhere is an MSE of 1, 20 log10(255)
+    for (uint8_t& rValue : test)
+    {
+        ++rValue;
+    }
+
+    CHECK_NEAR(cBlockCompressor::ComputePsnr(reference.data(), test.data(), 64, 4), 48.1308, 1e-3);
+
+    // channels past the count are not compared
+    test = reference;
+
+    for (size_t i = 3; i < test.size(); i += 4)
+    {
+        test[i] = 0;
+    }
+
+    CHECK(std::isinf(cBlockCompressor::ComputePsnr(reference.data(), test.data(), 64, 3)));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(BlockCompressorKeepsGradients)
+{
+    const std::vector<uint8_t> pixels = BuildGradientImage(128, 96, 0, 3);
+
+    for (const sFormatFloor& rFloor : s_formatFloors)
+    {
+        const double psnr = RoundTripPsnr(pixels, 128, 96, rFloor.format);
+
+        if (psnr < rFloor.gradientPsnr)
+            std::cout << "  " << rFloor.pName << " gradient " << psnr << " dB\n";
+
+        CHECK(psnr >= rFloor.gradientPsnr);
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(BlockCompressorKeepsNoisyGradients)
+{
+    // odd size, the right and bottom blocks replicate their last column and row
+    const std::vector<uint8_t> pixels = BuildGradientImage(125, 93, 16, 7);
+
+    for (const sFormatFloor& rFloor : s_formatFloors)
+    {
+        const double psnr = RoundTripPsnr(pixels, 125, 93, rFloor.format);
+
+        if (psnr < rFloor.noisePsnr)
+            std::cout << "  " << rFloor.pName << " noise " << psnr << " dB\n";
+
+        CHECK(psnr >= rFloor.noisePsnr);
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(BlockCompressorKeepsFlatBlocks)
+{
+    uint8_t rgba[64];
+
+    for (int i = 0; i < 16; ++i)
+    {
+        rgba[i * 4 + 0] = 77;
+        rgba[i * 4 + 1] = 180;
+        rgba[i * 4 + 2] = 3;
+        rgba[i * 4 + 3] = 255;
+    }
+
+    // BC4 and BC5 endpoints hit any 8 bit value, BC1 and BC3 color is 565
+    for (eBlockFormat format : { BLOCK_FORMAT_BC4, BLOCK_FORMAT_BC5 })
+    {
+        uint8_t block[16];
+        uint8_t decoded[64];
+
+        cBlockCompressor::EncodeBlock(rgba, format, block);
+        cBlockCompressor::DecodeBlock(block, format, decoded);
+
+        CHECK(std::isinf(cBlockCompressor::ComputePsnr(rgba, decoded, 16, cBlockCompressor::GetChannelCount(format))));
+    }
+
+    // mode 6 endpoints are 7 bits and a p-bit shared by the channels, odd and even values
+    // side by side may land one off
+    uint8_t block[16];
+    uint8_t decoded[64];
+
+    cBlockCompressor::EncodeBlock(rgba, BLOCK_FORMAT_BC7, block);
+    cBlockCompressor::DecodeBlock(block, BLOCK_FORMAT_BC7, decoded);
+
+    for (int i = 0; i < 64; ++i)
+    {
+        CHECK(std::abs(static_cast<int>(decoded[i]) - static_cast<int>(rgba[i])) <= 1);
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(BlockCompressorParallelMatchesSerial)
+{
+    cJobSystem::Initialize(3);
+
+    const std::vector<uint8_t> pixels = BuildGradientImage(133, 77, 16, 11);
+
+    for (const sFormatFloor& rFloor : s_formatFloors)
+    {
+        const size_t size = cBlockCompressor::GetCompressedSize(133, 77, rFloor.format);
+
+        std::vector<uint8_t> serial(size);
+        std::vector<uint8_t> parallel(size);
+
+        cBlockCompressor::Compress(pixels.data(), 133, 77, rFloor.format, serial.data(), false);
+        cBlockCompressor::Compress(pixels.data(), 133, 77, rFloor.format, parallel.data(), true);
+
+        CHECK(serial == parallel);
+    }
+
+    cJobSystem::Shutdown();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// encode throughput in MB of RGBA8 input per second, one thread and all of them, with the PSNR it reaches
+BENCHMARK(BlockCompressor)
+{
+    const uint32_t c_Size = 1024;
+
+    const std::vector<uint8_t> pixels = BuildGradientImage(c_Size, c_Size, 16, 5);
+
+    const double megabytes = static_cast<double>(pixels.size()) / (1024.0 * 1024.0);
+
+    cJobSystem::Initialize();
+
+    std::cout << "  " << c_Size << " x " << c_Size << ", " << cJobSystem::GetThreadCount() << " threads\n";
+
+    for (const sFormatFloor& rFloor : s_formatFloors)
+    {
+        std::vector<uint8_t> blocks(cBlockCompressor::GetCompressedSize(c_Size, c_Size, rFloor.format));
+        std::vector<uint8_t> decoded(pixels.size());
+
+        const double serialSeconds = cBenchmark::Measure(3, [&]()
+            {
+                cBlockCompressor::Compress(pixels.data(), c_Size, c_Size, rFloor.format, blocks.data(), false);
+            });
+
+        const double parallelSeconds = cBenchmark::Measure(3, [&]()
+            {
+                cBlockCompressor::Compress(pixels.data(), c_Size, c_Size, rFloor.format, blocks.data(), true);
+            });
+
+        const double decodeSeconds = cBenchmark::Measure(3, [&]()
+            {
+                cBlockCompressor::Decompress(blocks.data(), c_Size, c_Size, rFloor.format, decoded.data());
+            });
+
+        const double psnr = cBlockCompressor::ComputePsnr(pixels.data(), decoded.data(), static_cast<size_t>(c_Size) * c_Size,
+            cBlockCompressor::GetChannelCount(rFloor.format));
+
+        std::cout << "  " << rFloor.pName << "\n";
+
+        cBenchmark::Report("encode, one thread", megabytes / serialSeconds, "MB/s");
+        cBenchmark::Report("encode, all threads", megabytes / parallelSeconds, "MB/s");
+        cBenchmark::Report("decode", megabytes / decodeSeconds, "MB/s");
+        cBenchmark::Report("PSNR", psnr, "dB");
+    }
+
+    cJobSystem::Shutdown();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
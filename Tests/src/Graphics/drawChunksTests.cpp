@@ -0,0 +1,77 @@
+#include "testFramework.h"
+
+#include <cstddef>
+
+#include "Graphics/drawChunks.h"
+#include "Graphics/gfxConfig.h"
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(DrawChunksKeepSmallScenesOnOneList)
+{
+    CHECK(cDrawChunks::GetCount(0, 8) == 1);
+    CHECK(cDrawChunks::GetCount(1, 8) == 1);
+    CHECK(cDrawChunks::GetCount(2 * GFX_MIN_DRAWS_PER_RECORDING_CHUNK - 1, 8) == 1);
+
+    // one thread records everything itself
+    CHECK(cDrawChunks::GetCount(100 * GFX_MIN_DRAWS_PER_RECORDING_CHUNK, 1) == 1);
+    CHECK(cDrawChunks::GetCount(100 * GFX_MIN_DRAWS_PER_RECORDING_CHUNK, 0) == 1);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(DrawChunksSplitLargeScenes)
+{
+    // the default object capacity already spans several lists
+    CHECK(cDrawChunks::GetCount(GFX_MAX_NUMBER_OF_RENDER_ITEMS, 8) > 1);
+
+    CHECK(cDrawChunks::GetCount(2 * GFX_MIN_DRAWS_PER_RECORDING_CHUNK, 8) == 2);
+    CHECK(cDrawChunks::GetCount(3 * GFX_MIN_DRAWS_PER_RECORDING_CHUNK + 7, 8) == 3);
+    CHECK(cDrawChunks::GetCount(100 * GFX_MIN_DRAWS_PER_RECORDING_CHUNK, 3) == 3);
+    CHECK(cDrawChunks::GetCount(100 * GFX_MIN_DRAWS_PER_RECORDING_CHUNK, 64) == GFX_MAX_RECORDING_THREADS);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// the lists are submitted in chunk order, together they must draw every item once in item order
+TEST_CASE(DrawChunksCoverEveryItemInOrder)
+{
+    const size_t itemCounts[] = { 0, 1, GFX_MIN_DRAWS_PER_RECORDING_CHUNK, 2 * GFX_MIN_DRAWS_PER_RECORDING_CHUNK + 1, 4099, 100000 };
+
+    for (size_t itemCount : itemCounts)
+    {
+        for (size_t threadCount = 1; threadCount <= 16; ++threadCount)
+        {
+            const size_t chunkCount = cDrawChunks::GetCount(itemCount, threadCount);
+
+            CHECK(chunkCount >= 1 && chunkCount <= GFX_MAX_RECORDING_THREADS);
+            CHECK(chunkCount <= threadCount);
+
+            size_t next = 0;
+
+            for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+            {
+                size_t begin    = 0;
+                size_t end      = 0;
+                cDrawChunks::GetRange(itemCount, chunk, chunkCount, begin, end);
+
+                CHECK(begin == next);
+                CHECK(end >= begin);
+
+                // only a single list may hold fewer draws than the threshold
+                if (chunkCount > 1)
+                {
+                    CHECK(end - begin >= GFX_MIN_DRAWS_PER_RECORDING_CHUNK);
+                }
+
+                CHECK(end - begin <= itemCount / chunkCount + 1);
+
+                next = end;
+            }
+
+            CHECK(next == itemCount);
+        }
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,316 @@
+#include "testFramework.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Core/hash.h"
+#include "Core/jobSystem.h"
+#include "Graphics/mipGenerator.h"
+#include "Graphics/textureFootprint.h"
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+static std::vector<uint8_t> BuildNoiseImage(uint32_t _width, uint32_t _height, uint32_t _seed)
+{
+    std::mt19937 random(_seed);
+
+    std::vector<uint8_t> pixels(static_cast<size_t>(_width) * _height * 4);
+
+    // smooth gradients with noise on top, so both the flat and the busy paths of the encoders run
+    for (uint32_t y = 0; y < _height; ++y)
+    {
+        for (uint32_t x = 0; x < _width; ++x)
+        {
+            uint8_t* pPixel = &pixels[(static_cast<size_t>(y) * _width + x) * 4];
+
+            pPixel[0] = static_cast<uint8_t>((x * 255) / (std::max)(_width - 1, 1u));
+            pPixel[1] = static_cast<uint8_t>((y * 255) / (std::max)(_height - 1, 1u));
+            pPixel[2] = static_cast<uint8_t>(random() & 0xFF);
+            pPixel[3] = static_cast<uint8_t>((x ^ y) & 1 ? 255 : random() & 0xFF);
+        }
+    }
+
+    return pixels;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+static std::vector<uint8_t> GenerateChain(const std::vector<uint8_t>& _rPixels, uint32_t _width, uint32_t _height,
+    eMipFilter _filter, bool _srgb, bool _multithreaded)
+{
+    std::vector<uint8_t> chain(cMipGenerator::GetChainByteSize(_width, _height));
+
+    cMipGenerator::GenerateChain(_rPixels.data(), _width, _height, chain.data(), _filter, _srgb, _multithreaded);
+
+    return chain;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+static double SrgbToLinear(double _value)
+{
+    return _value <= 0.04045 ? _value / 12.92 : std::pow((_value + 0.055) / 1.055, 2.4);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// The documented box filter written out in scalar float: decode, average rows of texel pairs,
+// average the two rows, encode to the nearest code (in sRGB for color). Edges repeat.
+static std::vector<uint8_t> GenerateBoxReference(const std::vector<uint8_t>& _rPixels, uint32_t _width, uint32_t _height, bool _srgb)
+{
+    std::vector<uint8_t> chain(_rPixels);
+
+    uint32_t width  = _width;
+    uint32_t height = _height;
+    size_t   offset = 0;
+
+    auto Decode = [&](uint8_t _code, int _channel)
+        {
+            return _srgb && _channel < 3 ? static_cast<float>(SrgbToLinear(_code / 255.0)) : static_cast<float>(_code / 255.0);
+        };
+
+    auto Encode = [&](float _value, int _channel)
+        {
+            const float value = (std::min)((std::max)(_value, 0.f), 1.f);
+
+            if (!_srgb || _channel == 3)
+                return static_cast<uint8_t>(value * 255.f + 0.5f);
+
+            // the code whose sRGB interval the linear value falls in
+            int code = 0;
+
+            while (code < 255 && value >= static_cast<float>(SrgbToLinear((code + 0.5) / 255.0)))
+            {
+                ++code;
+            }
+
+            return static_cast<uint8_t>(code);
+        };
+
+    while (width > 1 || height > 1)
+    {
+        const uint32_t nextWidth    = (std::max)(width >> 1, 1u);
+        const uint32_t nextHeight   = (std::max)(height >> 1, 1u);
+
+        const size_t nextOffset = offset + static_cast<size_t>(width) * height * 4;
+
+        chain.resize(nextOffset + static_cast<size_t>(nextWidth) * nextHeight * 4);
+
+        auto Texel = [&](uint32_t _x, uint32_t _y, int _channel)
+            {
+                _x = (std::min)(_x, width - 1);
+                _y = (std::min)(_y, height - 1);
+
+                return Decode(chain[offset + (static_cast<size_t>(_y) * width + _x) * 4 + _channel], _channel);
+            };
+
+        for (uint32_t y = 0; y < nextHeight; ++y)
+        {
+            for (uint32_t x = 0; x < nextWidth; ++x)
+            {
+                for (int channel = 0; channel < 4; ++channel)
+                {
+                    const float top     = 0.5f * Texel(x * 2, y * 2, channel) + 0.5f * Texel(x * 2 + 1, y * 2, channel);
+                    const float bottom  = 0.5f * Texel(x * 2, y * 2 + 1, channel) + 0.5f * Texel(x * 2 + 1, y * 2 + 1, channel);
+
+                    chain[nextOffset + (static_cast<size_t>(y) * nextWidth + x) * 4 + channel] = Encode(0.5f * top + 0.5f * bottom, channel);
+                }
+            }
+        }
+
+        offset  = nextOffset;
+        width   = nextWidth;
+        height  = nextHeight;
+    }
+
+    return chain;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(MipChainSizes)
+{
+    CHECK(cMipGenerator::GetMipCount(1, 1) == 1);
+    CHECK(cMipGenerator::GetMipCount(256, 256) == 9);
+    CHECK(cMipGenerator::GetMipCount(300, 17) == 9);
+    CHECK(cMipGenerator::GetMipCount(1, 1024) == 11);
+
+    // 4x2, 2x1, 1x1
+    CHECK(cMipGenerator::GetChainByteSize(4, 2) == (8 + 2 + 1) * 4);
+    CHECK(cMipGenerator::GetChainByteSize(1, 1) == 4);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(MipBoxMatchesScalarReference)
+{
+    const uint32_t sizes[][2] = { { 64, 48 }, { 33, 17 }, { 1, 40 }, { 7, 1 } };
+
+    for (const uint32_t* pSize : sizes)
+    {
+        const std::vector<uint8_t> pixels = BuildNoiseImage(pSize[0], pSize[1], pSize[0] * 31 + pSize[1]);
+
+        for (bool srgb : { false, true })
+        {
+            CHECK(GenerateChain(pixels, pSize[0], pSize[1], MIP_FILTER_BOX, srgb, false) == GenerateBoxReference(pixels, pSize[0], pSize[1], srgb));
+        }
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(MipConstantImageStaysConstant)
+{
+    const uint8_t color[4] = { 200, 17, 90, 128 };
+
+    std::vector<uint8_t> pixels(40 * 24 * 4);
+
+    for (size_t i = 0; i < pixels.size(); ++i)
+    {
+        pixels[i] = color[i % 4];
+    }
+
+    for (eMipFilter filter : { MIP_FILTER_BOX, MIP_FILTER_KAISER })
+    {
+        for (bool srgb : { false, true })
+        {
+            const std::vector<uint8_t> chain = GenerateChain(pixels, 40, 24, filter, srgb, false);
+
+            for (size_t i = 0; i < chain.size(); ++i)
+            {
+                CHECK(chain[i] == color[i % 4]);
+            }
+        }
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(MipParallelMatchesSerial)
+{
+    const std::vector<uint8_t> pixels = BuildNoiseImage(513, 257, 3);
+
+    for (eMipFilter filter : { MIP_FILTER_BOX, MIP_FILTER_KAISER })
+    {
+        for (bool srgb : { false, true })
+        {
+            CHECK(GenerateChain(pixels, 513, 257, filter, srgb, true) == GenerateChain(pixels, 513, 257, filter, srgb, false));
+        }
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(MipFootprintChainMatchesPacked)
+{
+    const uint32_t width    = 75;
+    const uint32_t height   = 40;
+    const uint32_t mipCount = cMipGenerator::GetMipCount(width, height);
+
+    const std::vector<uint8_t> pixels = BuildNoiseImage(width, height, 9);
+
+    std::vector<sSubresourceFootprint> packed(mipCount);
+    std::vector<sSubresourceFootprint> staging(mipCount);
+
+    cTextureFootprint::ComputePacked(width, height, mipCount, 1, 4, 1, packed.data());
+
+    std::vector<uint8_t> stagingBytes(cTextureFootprint::ComputeStaging(width, height, mipCount, 1, 4, 1, staging.data()), 0xCD);
+
+    cMipGenerator::GenerateChain(pixels.data(), width, height, stagingBytes.data(), staging.data(), MIP_FILTER_KAISER, true, false);
+
+    // the staging layout only adds row and placement padding, every row has to match
+    std::vector<uint8_t> repacked(cMipGenerator::GetChainByteSize(width, height));
+
+    for (uint32_t mip = 0; mip < mipCount; ++mip)
+    {
+        cTextureFootprint::CopyRows(stagingBytes.data(), staging[mip], repacked.data(), packed[mip]);
+    }
+
+    CHECK(repacked == GenerateChain(pixels, width, height, MIP_FILTER_KAISER, true, false));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// The chains of fixed inputs, recorded once. SSE2 and AVX builds, any thread count and any
+// compiler that keeps IEEE single precision without contraction must reproduce them.
+TEST_CASE(MipChainsAreBitExact)
+{
+    struct sGolden
+    {
+        eMipFilter  filter;
+        bool        srgb;
+        uint64_t    hash;
+    };
+
+    const sGolden goldens[] =
+    {
+        { MIP_FILTER_BOX,       false,  0x4bb066ae2a003ce3ull },
+        { MIP_FILTER_BOX,       true,   0xdce561787eec2492ull },
+        { MIP_FILTER_KAISER,    false,  0x4f233946061ea49cull },
+        { MIP_FILTER_KAISER,    true,   0xab57bb85fb79cfc5ull },
+    };
+
+    const std::vector<uint8_t> pixels = BuildNoiseImage(301, 190, 1);
+
+    for (const sGolden& rGolden : goldens)
+    {
+        const std::vector<uint8_t> chain = GenerateChain(pixels, 301, 190, rGolden.filter, rGolden.srgb, true);
+
+        const uint64_t hash = cHash::Hash64(chain.data(), chain.size());
+
+        if (hash != rGolden.hash)
+        {
+            std::cout << "  filter " << rGolden.filter << (rGolden.srgb ? " sRGB" : " linear") << ": 0x" << std::hex << hash << std::dec << "\n";
+        }
+
+        CHECK(hash == rGolden.hash);
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// Full chains of a 4k color texture, serially and with row bands on every power of two thread count.
+BENCHMARK(MipGenerator)
+{
+    const uint32_t size = 4096;
+
+    const std::vector<uint8_t> pixels = BuildNoiseImage(size, size, 2);
+
+    std::vector<uint8_t> chain(cMipGenerator::GetChainByteSize(size, size));
+
+    const double megapixels = static_cast<double>(size) * size / 1e6;
+
+    const unsigned hardwareThreads = (std::max)(std::thread::hardware_concurrency(), 1u);
+
+    for (eMipFilter filter : { MIP_FILTER_BOX, MIP_FILTER_KAISER })
+    {
+        const std::string name = filter == MIP_FILTER_BOX ? "box, sRGB" : "Kaiser, sRGB";
+
+        const double serialSeconds = cBenchmark::Measure(3, [&]()
+            {
+                cMipGenerator::GenerateChain(pixels.data(), size, size, chain.data(), filter, true, false);
+            });
+
+        cBenchmark::Report((name + ", serial").c_str(), serialSeconds * 1000.0, "ms");
+        cBenchmark::Report("  throughput", megapixels / serialSeconds, "Mpix/s");
+
+        for (unsigned threads = 2; threads <= hardwareThreads; threads *= 2)
+        {
+            cJobSystem::Initialize(threads - 1);
+
+            const double parallelSeconds = cBenchmark::Measure(3, [&]()
+                {
+                    cMipGenerator::GenerateChain(pixels.data(), size, size, chain.data(), filter, true, true);
+                });
+
+            cBenchmark::Report((name + ", " + std::to_string(threads) + " threads").c_str(), parallelSeconds * 1000.0, "ms");
+            cBenchmark::Report("  speedup over serial", serialSeconds / parallelSeconds, "x");
+        }
+    }
+}
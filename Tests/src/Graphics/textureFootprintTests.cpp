@@ -0,0 +1,239 @@
+#include "testFramework.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "Graphics/textureFootprint.h"
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+static std::vector<sSubresourceFootprint> ComputeFootprints(bool _staging, uint32_t _width, uint32_t _height, uint32_t _mipCount, uint32_t _arraySize,
+    uint32_t _blockBytes, uint32_t _blockSize, uint64_t& _rOutTotalBytes)
+{
+    std::vector<sSubresourceFootprint> footprints(_mipCount * _arraySize);
+
+    _rOutTotalBytes = _staging
+        ? cTextureFootprint::ComputeStaging(_width, _height, _mipCount, _arraySize, _blockBytes, _blockSize, footprints.data())
+        : cTextureFootprint::ComputePacked(_width, _height, _mipCount, _arraySize, _blockBytes, _blockSize, footprints.data());
+
+    return footprints;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// worked by hand from the GetCopyableFootprints rules
+TEST_CASE(FootprintStagingMatchesTheD3D12Layout)
+{
+    uint64_t totalBytes = 0;
+    const std::vector<sSubresourceFootprint> footprints = ComputeFootprints(true, 100, 60, 3, 1, 4, 1, totalBytes);
+
+    CHECK(footprints[0].offset == 0);
+    CHECK(footprints[0].width == 100 && footprints[0].height == 60);
+    CHECK(footprints[0].rowBytes == 400 && footprints[0].rowPitch == 512 && footprints[0].rowCount == 60);
+
+    CHECK(footprints[1].offset == 30720);
+    CHECK(footprints[1].width == 50 && footprints[1].height == 30);
+    CHECK(footprints[1].rowBytes == 200 && footprints[1].rowPitch == 256 && footprints[1].rowCount == 30);
+
+    CHECK(footprints[2].offset == 38400);
+    CHECK(footprints[2].width == 25 && footprints[2].height == 15);
+    CHECK(footprints[2].rowBytes == 100 && footprints[2].rowPitch == 256 && footprints[2].rowCount == 15);
+
+    // the last row is not padded
+    CHECK(totalBytes == 38400 + 256 * 14 + 100);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(FootprintStagingIsAligned)
+{
+    const uint32_t sizes[][2] = { { 1, 1 }, { 3, 7 }, { 64, 64 }, { 257, 129 }, { 1000, 3 }, { 4096, 2048 } };
+
+    for (const uint32_t* pSize : sizes)
+    {
+        for (uint32_t blockSize : { 1u, 4u })
+        {
+            const uint32_t blockBytes = blockSize == 4 ? 16 : 4;
+
+            uint64_t totalBytes = 0;
+            const std::vector<sSubresourceFootprint> footprints = ComputeFootprints(true, pSize[0], pSize[1], 5, 3, blockBytes, blockSize, totalBytes);
+
+            uint64_t previousEnd = 0;
+
+            for (const sSubresourceFootprint& rFootprint : footprints)
+            {
+                CHECK(rFootprint.offset % c_TexturePlacementAlignment == 0);
+                CHECK(rFootprint.rowPitch % c_TexturePitchAlignment == 0);
+                CHECK(rFootprint.rowPitch >= rFootprint.rowBytes);
+                CHECK(rFootprint.rowPitch - rFootprint.rowBytes < c_TexturePitchAlignment);
+                CHECK(rFootprint.offset >= previousEnd);
+
+                previousEnd = rFootprint.offset + static_cast<uint64_t>(rFootprint.rowPitch) * rFootprint.rowCount;
+            }
+
+            const sSubresourceFootprint& rLast = footprints.back();
+
+            CHECK(totalBytes == rLast.offset + static_cast<uint64_t>(rLast.rowPitch) * (rLast.rowCount - 1) + rLast.rowBytes);
+        }
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(FootprintBlockCompressedRows)
+{
+    // BC1, 8 bytes per 4x4 block, the chain runs down to a partial block
+    uint64_t totalBytes = 0;
+    const std::vector<sSubresourceFootprint> footprints = ComputeFootprints(false, 70, 30, 7, 1, 8, 4, totalBytes);
+
+    const uint32_t expected[7][4] =
+    {
+        // width, height, rowBytes, rowCount
+        { 70, 30, 18 * 8, 8 },
+        { 35, 15,  9 * 8, 4 },
+        { 17,  7,  5 * 8, 2 },
+        {  8,  3,  2 * 8, 1 },
+        {  4,  1,  1 * 8, 1 },
+        {  2,  1,  1 * 8, 1 },
+        {  1,  1,  1 * 8, 1 },
+    };
+
+    uint64_t packedBytes = 0;
+
+    for (uint32_t mip = 0; mip < 7; ++mip)
+    {
+        CHECK(footprints[mip].width == expected[mip][0]);
+        CHECK(footprints[mip].height == expected[mip][1]);
+        CHECK(footprints[mip].rowBytes == expected[mip][2]);
+        CHECK(footprints[mip].rowCount == expected[mip][3]);
+
+        // packed rows carry no padding and follow each other without gaps
+        CHECK(footprints[mip].rowPitch == footprints[mip].rowBytes);
+        CHECK(footprints[mip].offset == packedBytes);
+
+        packedBytes += static_cast<uint64_t>(footprints[mip].rowBytes) * footprints[mip].rowCount;
+    }
+
+    CHECK(totalBytes == packedBytes);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(FootprintArraySlicesFollowEachOther)
+{
+    const uint32_t mipCount     = 4;
+    const uint32_t arraySize    = 3;
+
+    for (bool staging : { false, true })
+    {
+        uint64_t totalBytes = 0;
+        const std::vector<sSubresourceFootprint> footprints = ComputeFootprints(staging, 40, 24, mipCount, arraySize, 4, 1, totalBytes);
+
+        for (uint32_t slice = 0; slice < arraySize; ++slice)
+        {
+            for (uint32_t mip = 0; mip < mipCount; ++mip)
+            {
+                const sSubresourceFootprint& rFootprint = footprints[mip + slice * mipCount];
+                const sSubresourceFootprint& rFirst     = footprints[mip];
+
+                // every slice repeats the chain of the first, only further along
+                CHECK(rFootprint.width == rFirst.width && rFootprint.height == rFirst.height);
+                CHECK(rFootprint.rowPitch == rFirst.rowPitch && rFootprint.rowCount == rFirst.rowCount);
+                CHECK(rFootprint.offset - footprints[slice * mipCount].offset == rFirst.offset);
+            }
+        }
+
+        // slices start where the previous one ended, aligned when staging
+        const sSubresourceFootprint& rLastMip = footprints[mipCount - 1];
+        const uint64_t sliceEnd = rLastMip.offset + static_cast<uint64_t>(rLastMip.rowPitch) * rLastMip.rowCount;
+        const uint64_t alignment = staging ? c_TexturePlacementAlignment : 1;
+
+        CHECK(footprints[mipCount].offset == (sliceEnd + alignment - 1) / alignment * alignment);
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// packed -> staging -> packed keeps every byte and leaves the staging padding alone
+TEST_CASE(FootprintCopyRowsRoundTrips)
+{
+    const uint32_t width        = 97;
+    const uint32_t height       = 33;
+    const uint32_t mipCount     = 7;
+    const uint32_t arraySize    = 2;
+
+    uint64_t packedBytes    = 0;
+    uint64_t stagingBytes   = 0;
+
+    const std::vector<sSubresourceFootprint> packed     = ComputeFootprints(false, width, height, mipCount, arraySize, 4, 1, packedBytes);
+    const std::vector<sSubresourceFootprint> staging    = ComputeFootprints(true, width, height, mipCount, arraySize, 4, 1, stagingBytes);
+
+    std::vector<uint8_t> source(packedBytes);
+
+    for (size_t i = 0; i < source.size(); ++i)
+    {
+        source[i] = static_cast<uint8_t>(i * 131 + (i >> 8));
+    }
+
+    const uint8_t c_Padding = 0xcd;
+
+    std::vector<uint8_t> upload(stagingBytes, c_Padding);
+    std::vector<uint8_t> readBack(packedBytes, 0);
+
+    for (size_t subresource = 0; subresource < packed.size(); ++subresource)
+    {
+        cTextureFootprint::CopyRows(source.data(), packed[subresource], upload.data(), staging[subresource]);
+    }
+
+    for (size_t subresource = 0; subresource < packed.size(); ++subresource)
+    {
+        const sSubresourceFootprint& rStaging = staging[subresource];
+
+        for (uint32_t row = 0; row < rStaging.rowCount; ++row)
+        {
+            const uint64_t rowStart = rStaging.offset + static_cast<uint64_t>(row) * rStaging.rowPitch;
+            const uint64_t rowEnd   = (std::min)(rowStart + rStaging.rowPitch, stagingBytes);
+
+            for (uint64_t i = rowStart + rStaging.rowBytes; i < rowEnd; ++i)
+            {
+                CHECK(upload[i] == c_Padding);
+            }
+        }
+
+        cTextureFootprint::CopyRows(upload.data(), rStaging, readBack.data(), packed[subresource]);
+    }
+
+    CHECK(readBack == source);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// equal pitches take the single block copy, which must not run past the last row
+TEST_CASE(FootprintCopyRowsMatchingPitches)
+{
+    sSubresourceFootprint footprint = {};
+    footprint.offset    = 16;
+    footprint.width     = 64;
+    footprint.height    = 4;
+    footprint.rowPitch  = 256;
+    footprint.rowCount  = 4;
+    footprint.rowBytes  = 256;
+
+    std::vector<uint8_t> source(16 + 256 * 4);
+
+    for (size_t i = 0; i < source.size(); ++i)
+    {
+        source[i] = static_cast<uint8_t>(i);
+    }
+
+    std::vector<uint8_t> destination(16 + 256 * 4 + 1, 0);
+
+    cTextureFootprint::CopyRows(source.data(), footprint, destination.data(), footprint);
+
+    CHECK(std::equal(source.begin() + 16, source.end(), destination.begin() + 16));
+    CHECK(destination[15] == 0);
+    CHECK(destination.back() == 0);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,481 @@
+#include "testFramework.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "Graphics/textureFootprint.h"
+#include "Graphics/texturePacker.h"
+
+// DXGI_FORMAT values, the packer only compares them
+constexpr uint32_t c_FormatRgba8    = 28;
+constexpr uint32_t c_FormatBc1      = 71;
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+static sTexturePackInput MakeInput(uint32_t _format, uint32_t _width, uint32_t _height, uint32_t _mipLevels)
+{
+    const bool isBc1 = _format == c_FormatBc1;
+
+    return { _width, _height, _mipLevels, _format, isBc1 ? 8u : 4u, isBc1 ? 4u : 1u };
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+static std::vector<sSubresourceFootprint> GetFootprints(const sTexturePackInput& _rInput, uint64_t& _rOutBytes)
+{
+    std::vector<sSubresourceFootprint> footprints(_rInput.mipLevels);
+
+    _rOutBytes = cTextureFootprint::ComputePacked(_rInput.width, _rInput.height, _rInput.mipLevels, 1, _rInput.blockBytes, _rInput.blockSize, footprints.data());
+
+    return footprints;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// random packed payloads, one per input
+static std::vector<std::vector<uint8_t>> MakeSources(const std::vector<sTexturePackInput>& _rInputs)
+{
+    std::mt19937 random(7);
+
+    std::vector<std::vector<uint8_t>> sources(_rInputs.size());
+
+    for (size_t i = 0; i < _rInputs.size(); ++i)
+    {
+        uint64_t byteSize = 0;
+        GetFootprints(_rInputs[i], byteSize);
+
+        sources[i].resize(byteSize);
+
+        for (uint8_t& rByte : sources[i])
+        {
+            rByte = static_cast<uint8_t>(random());
+        }
+    }
+
+    return sources;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+static std::vector<uint8_t> BuildPage(const sTexturePackPlan& _rPlan, uint32_t _pageIndex, const std::vector<sTexturePackInput>& _rInputs,
+    const std::vector<std::vector<uint8_t>>& _rSources)
+{
+    std::vector<const uint8_t*> sourcePointers;
+
+    for (const std::vector<uint8_t>& rSource : _rSources)
+    {
+        sourcePointers.push_back(rSource.data());
+    }
+
+    std::vector<uint8_t> page(cTexturePacker::GetPageByteSize(_rPlan.pages[_pageIndex]), 0xcd);
+
+    cTexturePacker::BuildPage(_rPlan, _pageIndex, _rInputs.data(), sourcePointers.data(), page.data());
+
+    return page;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// every placement sits on its page, pages list exactly the inputs placed on them
+static void CheckPlanIsConsistent(const sTexturePackPlan& _rPlan, const std::vector<sTexturePackInput>& _rInputs)
+{
+    CHECK(_rPlan.placements.size() == _rInputs.size());
+
+    std::vector<uint32_t> seen(_rInputs.size(), 0);
+
+    for (uint32_t pageIndex = 0; pageIndex < _rPlan.pages.size(); ++pageIndex)
+    {
+        const sTexturePage& rPage = _rPlan.pages[pageIndex];
+
+        for (size_t member = 0; member < rPage.members.size(); ++member)
+        {
+            const uint32_t textureIndex         = rPage.members[member];
+            const sTexturePlacement& rPlacement = _rPlan.placements[textureIndex];
+            const sTexturePackInput& rInput     = _rInputs[textureIndex];
+
+            ++seen[textureIndex];
+
+            CHECK(rPlacement.page == pageIndex);
+            CHECK(rPlacement.width == rInput.width && rPlacement.height == rInput.height);
+            CHECK(rInput.format == rPage.format);
+
+            if (rPage.kind == TEXTURE_PAGE_ARRAY)
+            {
+                CHECK(rPlacement.slice == member);
+                CHECK(rInput.width == rPage.width && rInput.height == rPage.height && rInput.mipLevels == rPage.mipLevels);
+            }
+            else if (rPage.kind == TEXTURE_PAGE_ATLAS)
+            {
+                // the entry and its gutter lie on the page and on the grid
+                CHECK(rPlacement.x % rPage.gutter == 0 && rPlacement.y % rPage.gutter == 0);
+                CHECK(rPlacement.x >= rPage.gutter && rPlacement.y >= rPage.gutter);
+                CHECK(rPlacement.x + (rInput.width + rPage.gutter - 1) / rPage.gutter * rPage.gutter + rPage.gutter <= rPage.width);
+                CHECK(rPlacement.y + (rInput.height + rPage.gutter - 1) / rPage.gutter * rPage.gutter + rPage.gutter <= rPage.height);
+                CHECK(rPage.mipLevels <= rInput.mipLevels);
+                CHECK((rPage.gutter >> (rPage.mipLevels - 1)) >= rPage.blockSize);
+            }
+            else
+            {
+                CHECK(rPage.members.size() == 1);
+                CHECK(rInput.width == rPage.width && rInput.mipLevels == rPage.mipLevels);
+            }
+        }
+
+        // no two atlas entries overlap, gutters included
+        if (rPage.kind == TEXTURE_PAGE_ATLAS)
+        {
+            for (size_t a = 0; a < rPage.members.size(); ++a)
+            {
+                for (size_t b = a + 1; b < rPage.members.size(); ++b)
+                {
+                    const sTexturePlacement& rA = _rPlan.placements[rPage.members[a]];
+                    const sTexturePlacement& rB = _rPlan.placements[rPage.members[b]];
+
+                    // entries reserve their size rounded up to the grid
+                    const uint32_t g        = rPage.gutter;
+                    const uint32_t widthA   = (rA.width + g - 1) / g * g;
+                    const uint32_t heightA  = (rA.height + g - 1) / g * g;
+                    const uint32_t widthB   = (rB.width + g - 1) / g * g;
+                    const uint32_t heightB  = (rB.height + g - 1) / g * g;
+
+                    const bool apart = rA.x + widthA + g <= rB.x - g || rB.x + widthB + g <= rA.x - g ||
+                                       rA.y + heightA + g <= rB.y - g || rB.y + heightB + g <= rA.y - g;
+
+                    CHECK(apart);
+                }
+            }
+        }
+    }
+
+    for (uint32_t count : seen)
+    {
+        CHECK(count == 1);
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// block by block against the sources, plus one gutter block on every side that has to repeat the opposite edge
+static void CheckAtlasPage(const sTexturePackPlan& _rPlan, uint32_t _pageIndex, const std::vector<sTexturePackInput>& _rInputs,
+    const std::vector<std::vector<uint8_t>>& _rSources, const std::vector<uint8_t>& _rPage)
+{
+    const sTexturePage& rPage = _rPlan.pages[_pageIndex];
+
+    std::vector<sSubresourceFootprint> pageFootprints(rPage.mipLevels);
+    cTextureFootprint::ComputePacked(rPage.width, rPage.height, rPage.mipLevels, 1, rPage.blockBytes, rPage.blockSize, pageFootprints.data());
+
+    const uint32_t blockBytes   = rPage.blockBytes;
+    const uint32_t blockSize    = rPage.blockSize;
+
+    for (uint32_t textureIndex : rPage.members)
+    {
+        const sTexturePlacement& rPlacement = _rPlan.placements[textureIndex];
+
+        uint64_t sourceBytes = 0;
+        const std::vector<sSubresourceFootprint> sourceFootprints = GetFootprints(_rInputs[textureIndex], sourceBytes);
+
+        for (uint32_t mip = 0; mip < rPage.mipLevels; ++mip)
+        {
+            const sSubresourceFootprint& rSource        = sourceFootprints[mip];
+            const sSubresourceFootprint& rDestination   = pageFootprints[mip];
+
+            const uint32_t columns  = rSource.rowBytes / blockBytes;
+            const uint32_t rows     = rSource.rowCount;
+            const uint32_t column0  = (rPlacement.x >> mip) / blockSize;
+            const uint32_t row0     = (rPlacement.y >> mip) / blockSize;
+
+            auto GetSource = [&](uint32_t _row, uint32_t _column)
+            {
+                return _rSources[textureIndex].data() + rSource.offset + static_cast<size_t>(_row) * rSource.rowPitch + static_cast<size_t>(_column) * blockBytes;
+            };
+
+            auto Matches = [&](uint32_t _pageRow, uint32_t _pageColumn, uint32_t _row, uint32_t _column)
+            {
+                const uint8_t* pPage = _rPage.data() + rDestination.offset + static_cast<size_t>(_pageRow) * rDestination.rowPitch +
+                    static_cast<size_t>(_pageColumn) * blockBytes;
+
+                return std::memcmp(pPage, GetSource(_row, _column), blockBytes) == 0;
+            };
+
+            bool interior = true;
+            bool gutter   = true;
+
+            for (uint32_t row = 0; row < rows; ++row)
+            {
+                for (uint32_t column = 0; column < columns; ++column)
+                {
+                    interior = interior && Matches(row0 + row, column0 + column, row, column);
+                }
+
+                gutter = gutter && Matches(row0 + row, column0 - 1, row, columns - 1);
+                gutter = gutter && Matches(row0 + row, column0 + columns, row, 0);
+            }
+
+            for (uint32_t column = 0; column < columns; ++column)
+            {
+                gutter = gutter && Matches(row0 - 1, column0 + column, rows - 1, column);
+                gutter = gutter && Matches(row0 + rows, column0 + column, 0, column);
+            }
+
+            gutter = gutter && Matches(row0 - 1, column0 - 1, rows - 1, columns - 1);
+            gutter = gutter && Matches(row0 + rows, column0 + columns, 0, 0);
+
+            CHECK(interior);
+            CHECK(gutter);
+        }
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(PackerGroupsTexturesIntoPages)
+{
+    const std::vector<sTexturePackInput> inputs =
+    {
+        MakeInput(c_FormatBc1, 512, 512, 10),   // 0 - 2 share an array
+        MakeInput(c_FormatBc1, 512, 512, 10),
+        MakeInput(c_FormatBc1, 512, 512, 10),
+        MakeInput(c_FormatBc1, 512, 512, 9),    // other mip count, too large for an atlas
+        MakeInput(c_FormatRgba8, 64, 64, 7),    // 4 - 7 share an atlas
+        MakeInput(c_FormatRgba8, 128, 32, 8),
+        MakeInput(c_FormatRgba8, 32, 32, 6),
+        MakeInput(c_FormatRgba8, 64, 16, 7),
+        MakeInput(c_FormatRgba8, 12, 12, 1),    // keeps no atlas mips in common with the others
+    };
+
+    sTexturePackPlan plan;
+    cTexturePacker::Plan(inputs.data(), inputs.size(), plan);
+
+    CheckPlanIsConsistent(plan, inputs);
+
+    // arrays first, then atlases, then the singles in input order
+    CHECK(plan.pages.size() == 4);
+
+    if (plan.pages.size() != 4)
+        return;
+
+    CHECK(plan.pages[0].kind == TEXTURE_PAGE_ARRAY);
+    CHECK(plan.pages[0].arraySize == 3);
+    CHECK((plan.pages[0].members == std::vector<uint32_t>{ 0, 1, 2 }));
+
+    CHECK(plan.pages[1].kind == TEXTURE_PAGE_ATLAS);
+    CHECK(plan.pages[1].members.size() == 4);
+    CHECK(plan.pages[1].mipLevels == 5);
+    CHECK(plan.pages[1].gutter == 16);
+
+    CHECK(plan.pages[2].kind == TEXTURE_PAGE_SINGLE);
+    CHECK(plan.pages[2].members[0] == 3);
+    CHECK(plan.pages[3].kind == TEXTURE_PAGE_SINGLE);
+    CHECK(plan.pages[3].members[0] == 8);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(PackerSplitsLargeArrays)
+{
+    const std::vector<sTexturePackInput> inputs(300, MakeInput(c_FormatBc1, 8, 8, 2));
+
+    sTexturePackPlan plan;
+    cTexturePacker::Plan(inputs.data(), inputs.size(), plan);
+
+    CheckPlanIsConsistent(plan, inputs);
+
+    CHECK(plan.pages.size() == 2);
+    CHECK(plan.pages[0].arraySize == 256);
+    CHECK(plan.pages[1].arraySize == 44);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(PackerAtlasesManySmallTextures)
+{
+    std::mt19937 random(3);
+
+    std::vector<sTexturePackInput> inputs;
+
+    for (uint32_t i = 0; i < 200; ++i)
+    {
+        const uint32_t width    = 16u << (random() % 5);
+        const uint32_t height   = 16u << (random() % 5);
+
+        inputs.push_back(MakeInput(c_FormatRgba8, width, height, 1 + random() % 5));
+    }
+
+    sTexturePackPlan plan;
+    cTexturePacker::Plan(inputs.data(), inputs.size(), plan);
+
+    CheckPlanIsConsistent(plan, inputs);
+
+    // far fewer descriptors than textures
+    // shapes that repeat become arrays, the rest fits one atlas per atlas mip count
+    uint32_t atlasCount = 0;
+
+    for (const sTexturePage& rPage : plan.pages)
+    {
+        CHECK(rPage.kind != TEXTURE_PAGE_SINGLE);
+
+        atlasCount += rPage.kind == TEXTURE_PAGE_ATLAS ? 1 : 0;
+    }
+
+    CHECK(atlasCount > 0 && atlasCount <= 5);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// the shader maps a texture UV into the page with uv * uvRect.zw + uvRect.xy
+TEST_CASE(PackerReferencesRemapUvs)
+{
+    const std::vector<sTexturePackInput> inputs =
+    {
+        MakeInput(c_FormatRgba8, 256, 256, 9),
+        MakeInput(c_FormatRgba8, 256, 256, 9),
+        MakeInput(c_FormatRgba8, 64, 64, 7),
+        MakeInput(c_FormatRgba8, 128, 32, 8),
+        MakeInput(c_FormatRgba8, 48, 80, 5),
+        MakeInput(c_FormatRgba8, 1024, 1024, 11),
+    };
+
+    sTexturePackPlan plan;
+    cTexturePacker::Plan(inputs.data(), inputs.size(), plan);
+
+    CheckPlanIsConsistent(plan, inputs);
+
+    for (uint32_t i = 0; i < inputs.size(); ++i)
+    {
+        const sTexturePlacement& rPlacement = plan.placements[i];
+        const sTexturePage& rPage           = plan.pages[rPlacement.page];
+        const sTextureRef reference         = cTexturePacker::GetReference(plan, i);
+
+        CHECK(reference.descriptorIndex == rPlacement.page);
+        CHECK(reference.slice == rPlacement.slice);
+
+        if (rPage.kind != TEXTURE_PAGE_ATLAS)
+        {
+            CHECK(reference.uvRect[0] == 0.0f && reference.uvRect[1] == 0.0f);
+            CHECK(reference.uvRect[2] == 1.0f && reference.uvRect[3] == 1.0f);
+            continue;
+        }
+
+        // the corners and the centre of the texture land on the matching page texels
+        for (float uv : { 0.0f, 0.5f, 1.0f })
+        {
+            const float pageX = (uv * reference.uvRect[2] + reference.uvRect[0]) * rPage.width;
+            const float pageY = (uv * reference.uvRect[3] + reference.uvRect[1]) * rPage.height;
+
+            CHECK_NEAR(pageX, rPlacement.x + uv * inputs[i].width, 1e-3);
+            CHECK_NEAR(pageY, rPlacement.y + uv * inputs[i].height, 1e-3);
+        }
+    }
+
+    CHECK(plan.pages[0].kind == TEXTURE_PAGE_ARRAY);
+    CHECK(plan.pages[1].kind == TEXTURE_PAGE_ATLAS);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(PackerBuildsArrayAndSinglePages)
+{
+    const std::vector<sTexturePackInput> inputs =
+    {
+        MakeInput(c_FormatBc1, 300, 300, 9),
+        MakeInput(c_FormatBc1, 300, 300, 9),
+        MakeInput(c_FormatBc1, 300, 300, 9),
+        MakeInput(c_FormatRgba8, 640, 480, 10),
+    };
+
+    const std::vector<std::vector<uint8_t>> sources = MakeSources(inputs);
+
+    sTexturePackPlan plan;
+    cTexturePacker::Plan(inputs.data(), inputs.size(), plan);
+
+    CHECK(plan.pages.size() == 2);
+
+    for (uint32_t pageIndex = 0; pageIndex < plan.pages.size(); ++pageIndex)
+    {
+        const sTexturePage& rPage       = plan.pages[pageIndex];
+        const std::vector<uint8_t> page = BuildPage(plan, pageIndex, inputs, sources);
+
+        // slices back to back, each the unchanged payload
+        size_t offset = 0;
+
+        for (uint32_t textureIndex : rPage.members)
+        {
+            const std::vector<uint8_t>& rSource = sources[textureIndex];
+
+            CHECK(std::equal(rSource.begin(), rSource.end(), page.begin() + offset));
+
+            offset += rSource.size();
+        }
+
+        CHECK(offset == page.size());
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(PackerBuildsAtlasPagesWithWrappedGutters)
+{
+    const std::vector<sTexturePackInput> inputs =
+    {
+        MakeInput(c_FormatRgba8, 64, 64, 7),
+        MakeInput(c_FormatRgba8, 128, 32, 8),
+        MakeInput(c_FormatRgba8, 48, 80, 5),
+        MakeInput(c_FormatRgba8, 32, 32, 6),
+        MakeInput(c_FormatBc1, 32, 32, 6),
+        MakeInput(c_FormatBc1, 64, 32, 7),
+        MakeInput(c_FormatBc1, 32, 64, 7),
+    };
+
+    const std::vector<std::vector<uint8_t>> sources = MakeSources(inputs);
+
+    sTexturePackPlan plan;
+    cTexturePacker::Plan(inputs.data(), inputs.size(), plan);
+
+    CheckPlanIsConsistent(plan, inputs);
+
+    uint32_t atlasCount = 0;
+
+    for (uint32_t pageIndex = 0; pageIndex < plan.pages.size(); ++pageIndex)
+    {
+        if (plan.pages[pageIndex].kind != TEXTURE_PAGE_ATLAS)
+            continue;
+
+        const std::vector<uint8_t> page = BuildPage(plan, pageIndex, inputs, sources);
+
+        CheckAtlasPage(plan, pageIndex, inputs, sources, page);
+
+        ++atlasCount;
+    }
+
+    // the 48x80 entry keeps fewer mips, so it sits in an atlas of its own kind or alone
+    CHECK(atlasCount >= 2);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(PackerShelvesStayInBounds)
+{
+    const uint32_t widths[]     = { 100, 80, 80, 60, 50, 50, 300 };
+    const uint32_t heights[]    = { 90, 70, 70, 40, 40, 30, 10 };
+
+    uint32_t x[7] = {};
+    uint32_t y[7] = {};
+    uint32_t usedWidth  = 0;
+    uint32_t usedHeight = 0;
+
+    const size_t placed = cTexturePacker::PackShelves(widths, heights, 7, 256, 160, x, y, usedWidth, usedHeight);
+
+    // 100 + 80 + 80 overflows the first shelf, the second (70 high) still fits, 300 is too wide
+    CHECK(placed == 6);
+    CHECK(x[0] == 0 && y[0] == 0);
+    CHECK(x[1] == 100 && y[1] == 0);
+    CHECK(x[2] == 0 && y[2] == 90);
+    CHECK(x[3] == 80 && y[3] == 90);
+    CHECK(usedWidth == 240);
+    CHECK(usedHeight == 160);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,190 @@
+#include "testFramework.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "Graphics/textureRegistry.h"
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(RegistryHandsOutSlotsInOrder)
+{
+    cTextureRegistry registry;
+    registry.Initialize(4);
+
+    CHECK(registry.GetCapacity() == 4);
+
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        CHECK(registry.Allocate() == i);
+    }
+
+    CHECK(registry.Allocate() == cTextureRegistry::c_InvalidSlot);
+    CHECK(registry.GetAllocatedCount() == 4);
+    CHECK(registry.GetUsedRange() == 4);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(RegistryReusesTheLowestFreeSlot)
+{
+    cTextureRegistry registry;
+    registry.Initialize(16);
+
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        registry.Allocate();
+    }
+
+    registry.Free(5, 0);
+    registry.Free(2, 0);
+    registry.Free(6, 0);
+
+    // lowest first keeps the used part of the range compact, the range itself does not grow
+    CHECK(registry.Allocate() == 2);
+    CHECK(registry.Allocate() == 5);
+    CHECK(registry.Allocate() == 6);
+    CHECK(registry.Allocate() == 8);
+    CHECK(registry.GetUsedRange() == 9);
+    CHECK(registry.GetAllocatedCount() == 9);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(RegistryKeepsSlotsUntilTheirFenceCompleted)
+{
+    cTextureRegistry registry;
+    registry.Initialize(3);
+
+    const uint32_t a = registry.Allocate();
+    const uint32_t b = registry.Allocate();
+    const uint32_t c = registry.Allocate();
+
+    // frames up to fence 10 and 11 may still read a and b
+    registry.Free(a, 10);
+    registry.Free(b, 11);
+
+    CHECK(registry.GetAllocatedCount() == 1);
+    CHECK(registry.Allocate() == cTextureRegistry::c_InvalidSlot);
+
+    registry.Retire(9);
+    CHECK(registry.Allocate() == cTextureRegistry::c_InvalidSlot);
+
+    registry.Retire(10);
+    CHECK(registry.Allocate() == a);
+    CHECK(registry.Allocate() == cTextureRegistry::c_InvalidSlot);
+
+    registry.Retire(20);
+    CHECK(registry.Allocate() == b);
+
+    registry.Free(c, 0);
+    CHECK(registry.Allocate() == c);
+    CHECK(registry.GetAllocatedCount() == 3);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(RegistryInitializeForgetsEverySlot)
+{
+    cTextureRegistry registry;
+    registry.Initialize(8);
+
+    for (uint32_t i = 0; i < 6; ++i)
+    {
+        registry.Allocate();
+    }
+
+    registry.Free(1, 5);
+    registry.Free(3, 0);
+
+    registry.Initialize(2);
+
+    CHECK(registry.GetAllocatedCount() == 0);
+    CHECK(registry.GetUsedRange() == 0);
+
+    // nothing retired before comes back
+    registry.Retire(100);
+
+    CHECK(registry.Allocate() == 0);
+    CHECK(registry.Allocate() == 1);
+    CHECK(registry.Allocate() == cTextureRegistry::c_InvalidSlot);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// the descriptor rebinding of the texture manager: every frame a few textures move to a fresh slot and
+// free the old one at the fence of the last recorded frame, frames complete a few fences behind
+TEST_CASE(RegistryNeverHandsOutASlotInFlight)
+{
+    const uint32_t c_TextureCount   = 200;
+    const uint32_t c_Capacity       = 256;
+    const uint64_t c_FramesInFlight = 3;
+
+    cTextureRegistry registry;
+    registry.Initialize(c_Capacity);
+
+    std::vector<uint32_t> slots(c_TextureCount);
+
+    for (uint32_t& rSlot : slots)
+    {
+        rSlot = registry.Allocate();
+    }
+
+    // slot -> last fence that may read it
+    std::vector<uint64_t> readUntil(c_Capacity, 0);
+
+    std::mt19937 random(11);
+
+    uint32_t deferred = 0;
+
+    for (uint64_t fence = 1; fence <= 2000; ++fence)
+    {
+        const uint64_t completed = fence > c_FramesInFlight ? fence - c_FramesInFlight : 0;
+
+        registry.Retire(completed);
+
+        const uint32_t moves = random() % 40;
+
+        for (uint32_t i = 0; i < moves; ++i)
+        {
+            const uint32_t texture  = random() % c_TextureCount;
+            const uint32_t slot     = registry.Allocate();
+
+            // the texture keeps its slot and tries again later
+            if (slot == cTextureRegistry::c_InvalidSlot)
+            {
+                ++deferred;
+                continue;
+            }
+
+            CHECK(readUntil[slot] <= completed);
+            CHECK(slot < c_Capacity);
+
+            // every frame up to the previous one read the old slot
+            readUntil[slots[texture]] = fence - 1;
+            registry.Free(slots[texture], fence - 1);
+
+            slots[texture] = slot;
+        }
+
+        // the frame reads the current slots
+        for (uint32_t slot : slots)
+        {
+            readUntil[slot] = fence;
+        }
+
+        CHECK(registry.GetAllocatedCount() == c_TextureCount);
+
+        const std::set<uint32_t> unique(slots.begin(), slots.end());
+        CHECK(unique.size() == c_TextureCount);
+    }
+
+    // the capacity leaves fewer spare slots than a busy frame asks for
+    CHECK(deferred > 0);
+    CHECK(registry.GetUsedRange() <= c_Capacity);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
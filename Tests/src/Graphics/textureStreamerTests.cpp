@@ -0,0 +1,518 @@
+#include "testFramework.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "Core/hash.h"
+#include "Graphics/textureFootprint.h"
+#include "Graphics/textureStreamer.h"
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+static uint32_t GetMipCount(uint32_t _width, uint32_t _height)
+{
+    uint32_t levels = 1;
+
+    while (((std::max)(_width, _height) >> levels) > 0)
+    {
+        ++levels;
+    }
+
+    return levels;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// BC1 and RGBA8 textures of 256 to 2048 texels, a few arrays, the tail is every level of at most 64 texels
+static std::vector<sStreamedTextureDesc> MakeTextures(uint32_t _count)
+{
+    std::vector<sStreamedTextureDesc> textures(_count);
+
+    for (uint32_t i = 0; i < _count; ++i)
+    {
+        sStreamedTextureDesc& rTexture = textures[i];
+
+        const bool isBc1 = i % 3 != 0;
+
+        rTexture.width      = isBc1 ? 256u << (i % 4) : 256u << (i % 3);
+        rTexture.height     = rTexture.width >> (i % 2);
+        rTexture.mipLevels  = GetMipCount(rTexture.width, rTexture.height);
+        rTexture.arraySize  = i % 8 == 5 ? 2 : 1;
+        rTexture.blockBytes = isBc1 ? 8 : 4;
+        rTexture.blockSize  = isBc1 ? 4 : 1;
+        rTexture.firstMip   = 0;
+        rTexture.tailMip    = cTextureStreamer::GetTailMip(rTexture.width, rTexture.height, rTexture.mipLevels, 64);
+    }
+
+    return textures;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(StreamerMipByteSizeMatchesTheFootprint)
+{
+    for (const sStreamedTextureDesc& rTexture : MakeTextures(24))
+    {
+        for (uint32_t arraySize : { 1u, 3u })
+        {
+            sStreamedTextureDesc texture = rTexture;
+            texture.arraySize = arraySize;
+
+            for (uint32_t mip = 0; mip < texture.mipLevels; ++mip)
+            {
+                std::vector<sSubresourceFootprint> footprints(arraySize);
+
+                const uint64_t expected = cTextureFootprint::ComputeStaging((std::max)(texture.width >> mip, 1u), (std::max)(texture.height >> mip, 1u),
+                    1, arraySize, texture.blockBytes, texture.blockSize, footprints.data());
+
+                CHECK(cTextureStreamer::GetMipByteSize(texture, mip) == expected);
+            }
+        }
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(StreamerMipSelection)
+{
+    // one texel per pixel at most, never past the coarsest level
+    CHECK(cTextureStreamer::ComputeMip(1024.0f, 1024.0f, 11) == 0);
+    CHECK(cTextureStreamer::ComputeMip(1024.0f, 1023.0f, 11) == 0);
+    CHECK(cTextureStreamer::ComputeMip(1024.0f, 512.0f, 11) == 1);
+    CHECK(cTextureStreamer::ComputeMip(1024.0f, 100.0f, 11) == 3);
+    CHECK(cTextureStreamer::ComputeMip(1024.0f, 0.5f, 11) == 10);
+    CHECK(cTextureStreamer::ComputeMip(1024.0f, 0.0f, 11) == 10);
+    CHECK(cTextureStreamer::ComputeMip(1024.0f, 4096.0f, 11) == 0);
+
+    CHECK(cTextureStreamer::GetTailMip(1024, 512, 11, 64) == 4);
+    CHECK(cTextureStreamer::GetTailMip(64, 64, 7, 64) == 0);
+    CHECK(cTextureStreamer::GetTailMip(1024, 512, 11, 0) == 0);
+    CHECK(cTextureStreamer::GetTailMip(1024, 512, 3, 64) == 2);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// requests the finest level of _rTextures, hands out everything at once and completes the copies right away
+static void RunFrame(cTextureStreamer& _rStreamer, const std::vector<uint32_t>& _rTextures, std::vector<sStreamingEviction>& _rOutEvictions)
+{
+    std::vector<sStreamingUpload> uploads;
+
+    for (uint32_t texture : _rTextures)
+    {
+        _rStreamer.RequestMip(texture, 0);
+    }
+
+    _rStreamer.Schedule(UINT64_MAX, UINT64_MAX, uploads, _rOutEvictions);
+
+    for (const sStreamingUpload& rUpload : uploads)
+    {
+        _rStreamer.MarkResident(rUpload);
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// four 1024 RGBA8 textures, the budget holds the tails and two full chains
+static std::vector<sStreamedTextureDesc> MakeBudgetTrace(uint64_t& _rOutStreamedBytes)
+{
+    std::vector<sStreamedTextureDesc> textures(4);
+
+    for (sStreamedTextureDesc& rTexture : textures)
+    {
+        rTexture = { 1024, 1024, 11, 1, 4, 1, 0, cTextureStreamer::GetTailMip(1024, 1024, 11, 64) };
+    }
+
+    _rOutStreamedBytes = 0;
+
+    for (uint32_t mip = 0; mip < textures[0].tailMip; ++mip)
+    {
+        _rOutStreamedBytes += cTextureStreamer::GetMipByteSize(textures[0], mip);
+    }
+
+    return textures;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(StreamerEvictsTheLeastRecentlyUsedFirst)
+{
+    uint64_t streamedBytes = 0;
+    const std::vector<sStreamedTextureDesc> textures = MakeBudgetTrace(streamedBytes);
+
+    cTextureStreamer streamer;
+    streamer.Initialize(textures.data(), textures.size(), nullptr, 0);
+
+    const uint64_t budget = streamer.GetCommittedBytes() + 2 * streamedBytes + cTextureStreamer::GetMipByteSize(textures[0], 3) / 2;
+
+    streamer.SetMemoryBudget(budget);
+
+    std::vector<sStreamingEviction> evictions;
+
+    // 0 and then 1 come in completely
+    RunFrame(streamer, { 0 }, evictions);
+    RunFrame(streamer, { 1 }, evictions);
+
+    CHECK(evictions.empty());
+    CHECK(streamer.GetResidentMip(0) == 0 && streamer.GetResidentMip(1) == 0);
+
+    // 2 takes the room of 0, which was sampled longest ago
+    RunFrame(streamer, { 2 }, evictions);
+
+    CHECK(streamer.GetResidentMip(1) == 0);
+    CHECK(streamer.GetResidentMip(2) == 0);
+    CHECK(streamer.GetResidentMip(0) > 0);
+    CHECK(streamer.GetCommittedBytes() <= budget);
+
+    for (const sStreamingEviction& rEviction : evictions)
+    {
+        CHECK(rEviction.texture == 0);
+    }
+
+    // levels sampled this frame stay, 3 only gets what the rest of 0 leaves
+    RunFrame(streamer, { 1, 2, 3 }, evictions);
+
+    CHECK(streamer.GetResidentMip(1) == 0);
+    CHECK(streamer.GetResidentMip(2) == 0);
+    CHECK(streamer.GetResidentMip(3) > 0);
+    CHECK(streamer.GetCommittedBytes() <= budget);
+    CHECK(streamer.GetStats().missingLevels > 0);
+
+    for (const sStreamingEviction& rEviction : evictions)
+    {
+        CHECK(rEviction.texture == 0);
+    }
+
+    // a lowered budget evicts on the next Schedule, the least recently used down to its tail first
+    streamer.SetMemoryBudget(budget - streamedBytes);
+
+    RunFrame(streamer, {}, evictions);
+
+    CHECK(streamer.GetCommittedBytes() <= budget - streamedBytes);
+    CHECK(streamer.GetResidentMip(0) == textures[0].tailMip);
+    CHECK(streamer.GetResidentMip(2) == 0);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(StreamerKeepsTheResolutionCap)
+{
+    uint64_t streamedBytes = 0;
+    std::vector<sStreamedTextureDesc> textures = MakeBudgetTrace(streamedBytes);
+
+    // 256 texels at most
+    for (sStreamedTextureDesc& rTexture : textures)
+    {
+        rTexture.firstMip = cTextureStreamer::GetTailMip(rTexture.width, rTexture.height, rTexture.mipLevels, 256);
+    }
+
+    const sTextureRef ref = { 1, 0, { 0.0f, 0.0f }, { 0.0f, 0.0f, 1.0f, 1.0f } };
+
+    cTextureStreamer streamer;
+    streamer.Initialize(textures.data(), textures.size(), &ref, 1);
+
+    std::vector<sStreamingUpload>   uploads;
+    std::vector<sStreamingEviction> evictions;
+
+    for (uint32_t frame = 0; frame < 8; ++frame)
+    {
+        streamer.RequestMip(0, 0);
+        streamer.Request(0, 1e6f);
+
+        streamer.Schedule(UINT64_MAX, UINT64_MAX, uploads, evictions);
+
+        for (const sStreamingUpload& rUpload : uploads)
+        {
+            CHECK(rUpload.mip >= textures[rUpload.texture].firstMip);
+
+            streamer.MarkResident(rUpload);
+        }
+    }
+
+    CHECK(textures[0].firstMip == 2);
+    CHECK(streamer.GetResidentMip(0) == 2);
+    CHECK(streamer.GetResidentMip(1) == 2);
+    CHECK(streamer.GetStats().missingLevels == 0);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+struct sStreamingSimulation
+{
+    uint64_t    trace;          // of every upload, cancel, completion and eviction
+    uint64_t    uploadedBytes;
+    uint64_t    evictedBytes;
+    uint32_t    oversizedFrames;
+    uint32_t    cancelledUploads;
+};
+
+// A camera moves along a row of textures and stops at the end. Copies take two frames, now
+// and then the recording fails and the rest of a frame's uploads is cancelled, the memory
+// budget is lowered halfway and lifted for the end. The streamer is checked against a model
+// of every texture after each frame.
+static sStreamingSimulation RunStreamingSimulation(bool _batchedRequests)
+{
+    const uint32_t c_TextureCount   = 64;
+    const uint32_t c_FrameCount     = 420;
+    const uint32_t c_StopFrame      = 320;
+    const uint32_t c_CopyLatency    = 2;
+    const uint64_t c_FrameBudget    = 256ull << 10;
+    const uint64_t c_MaxUploadBytes = 16ull << 20;
+
+    const std::vector<sStreamedTextureDesc> textures = MakeTextures(c_TextureCount);
+
+    // identity refs, and a second ref per texture as if a material used it at half the scale
+    std::vector<sTextureRef> refs(2 * c_TextureCount);
+
+    for (uint32_t i = 0; i < 2 * c_TextureCount; ++i)
+    {
+        refs[i] = {};
+        refs[i].descriptorIndex = i % c_TextureCount;
+        refs[i].uvRect[2]       = i < c_TextureCount ? 1.0f : 0.5f;
+        refs[i].uvRect[3]       = refs[i].uvRect[2];
+    }
+
+    cTextureStreamer streamer;
+    streamer.Initialize(textures.data(), textures.size(), refs.data(), refs.size());
+
+    const uint64_t tailBytes = streamer.GetCommittedBytes();
+
+    std::vector<uint32_t> modelResident(c_TextureCount);
+    std::vector<uint32_t> modelScheduled(c_TextureCount);
+
+    for (uint32_t i = 0; i < c_TextureCount; ++i)
+    {
+        modelResident[i]    = textures[i].tailMip;
+        modelScheduled[i]   = textures[i].tailMip;
+    }
+
+    struct sCopy
+    {
+        sStreamingUpload    upload;
+        uint32_t            completeFrame;
+    };
+
+    std::deque<sCopy>                   copies;
+    std::vector<sStreamingUpload>       uploads;
+    std::vector<sStreamingEviction>     evictions;
+    std::vector<sTextureRequest>        requests;
+    std::vector<uint32_t>               wantedMips(c_TextureCount);
+
+    sStreamingSimulation result = {};
+
+    auto Trace = [&](uint32_t _kind, uint32_t _texture, uint32_t _mip, uint64_t _byteSize)
+    {
+        result.trace = cHash::Combine(result.trace, _kind);
+        result.trace = cHash::Combine(result.trace, _texture);
+        result.trace = cHash::Combine(result.trace, _mip);
+        result.trace = cHash::Combine(result.trace, _byteSize);
+    };
+
+    for (uint32_t frame = 0; frame <= c_FrameCount; ++frame)
+    {
+        if (frame == 0)
+            streamer.SetMemoryBudget(tailBytes + (24ull << 20));
+        else if (frame == 180)
+            streamer.SetMemoryBudget(tailBytes + (6ull << 20));
+        else if (frame == c_StopFrame)
+            streamer.SetMemoryBudget(UINT64_MAX);
+
+        // ------------------------------------------------------------------------------------------------------------------
+        // completed copies, coarse to fine per texture as they were handed out
+        // ------------------------------------------------------------------------------------------------------------------
+
+        // the last frame drains everything so the end state can be checked
+        while (!copies.empty() && (copies.front().completeFrame <= frame || frame == c_FrameCount))
+        {
+            const sStreamingUpload& rUpload = copies.front().upload;
+
+            CHECK(rUpload.mip < modelResident[rUpload.texture]);
+
+            modelResident[rUpload.texture] = (std::min)(modelResident[rUpload.texture], rUpload.mip);
+
+            streamer.MarkResident(rUpload);
+            Trace(2, rUpload.texture, rUpload.mip, rUpload.byteSize);
+
+            copies.pop_front();
+        }
+
+        // ------------------------------------------------------------------------------------------------------------------
+        // requests of the textures near the camera, closer ones want finer levels
+        // ------------------------------------------------------------------------------------------------------------------
+
+        const float camera = static_cast<float>((std::min)(frame, c_StopFrame));
+
+        requests.clear();
+
+        for (uint32_t i = 0; i < c_TextureCount; ++i)
+        {
+            const float distance = std::fabs(static_cast<float>(i) * 5.0f - camera);
+
+            wantedMips[i] = textures[i].tailMip;
+
+            if (distance >= 30.0f)
+                continue;
+
+            const float projectedPixels = 2048.0f / (1.0f + distance);
+
+            requests.push_back({ static_cast<int>(i), projectedPixels });
+            requests.push_back({ static_cast<int>(i + c_TextureCount), projectedPixels * 0.25f });
+
+            // the finest of both requests, the half scale one texel per pixel at a quarter the size
+            const float texels      = static_cast<float>((std::max)(textures[i].width, textures[i].height));
+            const uint32_t fullMip  = cTextureStreamer::ComputeMip(texels, projectedPixels, textures[i].mipLevels);
+            const uint32_t halfMip  = cTextureStreamer::ComputeMip(texels * 0.5f, projectedPixels * 0.25f, textures[i].mipLevels);
+
+            wantedMips[i] = (std::min)(textures[i].tailMip, (std::min)(fullMip, halfMip));
+        }
+
+        if (_batchedRequests)
+        {
+            streamer.Request(requests);
+        }
+        else
+        {
+            for (const sTextureRequest& rRequest : requests)
+            {
+                streamer.Request(rRequest.refIndex, rRequest.projectedPixels);
+            }
+        }
+
+        streamer.Schedule(c_FrameBudget, c_MaxUploadBytes, uploads, evictions);
+
+        const sStreamingStats stats = streamer.GetStats();
+
+        // ------------------------------------------------------------------------------------------------------------------
+        // evictions drop the finest idle levels nobody asked for this frame
+        // ------------------------------------------------------------------------------------------------------------------
+
+        for (const sStreamingEviction& rEviction : evictions)
+        {
+            const uint32_t texture = rEviction.texture;
+
+            CHECK(modelResident[texture] == modelScheduled[texture]);
+            CHECK(rEviction.mip > modelResident[texture]);
+            CHECK(rEviction.mip <= wantedMips[texture]);
+
+            uint64_t byteSize = 0;
+
+            for (uint32_t mip = modelResident[texture]; mip < rEviction.mip; ++mip)
+            {
+                byteSize += cTextureStreamer::GetMipByteSize(textures[texture], mip);
+            }
+
+            CHECK(rEviction.byteSize == byteSize);
+
+            modelResident[texture]  = rEviction.mip;
+            modelScheduled[texture] = rEviction.mip;
+
+            result.evictedBytes += rEviction.byteSize;
+            Trace(3, texture, rEviction.mip, rEviction.byteSize);
+        }
+
+        // ------------------------------------------------------------------------------------------------------------------
+        // uploads go out one level at a time, coarse to fine, within the frame budget
+        // ------------------------------------------------------------------------------------------------------------------
+
+        uint64_t frameBytes = 0;
+
+        for (const sStreamingUpload& rUpload : uploads)
+        {
+            const uint32_t texture = rUpload.texture;
+
+            CHECK(rUpload.mip + 1 == modelScheduled[texture]);
+            CHECK(rUpload.mip >= wantedMips[texture]);
+            CHECK(rUpload.byteSize == cTextureStreamer::GetMipByteSize(textures[texture], rUpload.mip));
+
+            modelScheduled[texture] = rUpload.mip;
+            frameBytes             += rUpload.byteSize;
+        }
+
+        if (frameBytes > c_FrameBudget)
+        {
+            CHECK(uploads.size() == 1 && frameBytes <= c_MaxUploadBytes);
+
+            ++result.oversizedFrames;
+        }
+
+        // nothing goes out while the committed levels exceed the memory budget
+        if (!uploads.empty())
+        {
+            CHECK(streamer.GetCommittedBytes() <= stats.budgetBytes);
+        }
+
+        CHECK(stats.residentBytes + stats.scheduledBytes == streamer.GetCommittedBytes());
+
+        // every 7th frame the recording fails half way, the rest of the frame's uploads is handed back
+        const size_t recorded = frame % 7 == 3 ? uploads.size() / 2 : uploads.size();
+
+        for (size_t i = 0; i < uploads.size(); ++i)
+        {
+            const sStreamingUpload& rUpload = uploads[i];
+
+            if (i < recorded)
+            {
+                copies.push_back({ rUpload, frame + c_CopyLatency });
+
+                result.uploadedBytes += rUpload.byteSize;
+                Trace(1, rUpload.texture, rUpload.mip, rUpload.byteSize);
+            }
+            else
+            {
+                streamer.Cancel(rUpload);
+
+                modelScheduled[rUpload.texture] = (std::max)(modelScheduled[rUpload.texture], rUpload.mip + 1);
+
+                ++result.cancelledUploads;
+                Trace(4, rUpload.texture, rUpload.mip, rUpload.byteSize);
+            }
+        }
+
+        for (uint32_t i = 0; i < c_TextureCount; ++i)
+        {
+            CHECK(streamer.GetResidentMip(i) == modelResident[i]);
+            CHECK(modelScheduled[i] <= modelResident[i]);
+        }
+    }
+
+    // ----------------------------------------------------------------------------------------------------------------------
+    // the camera stood still long enough, every level it asks for is resident
+    // ----------------------------------------------------------------------------------------------------------------------
+
+    CHECK(copies.empty());
+
+    for (uint32_t i = 0; i < c_TextureCount; ++i)
+    {
+        CHECK(streamer.GetResidentMip(i) <= wantedMips[i]);
+    }
+
+    const sStreamingStats stats = streamer.GetStats();
+
+    CHECK(stats.scheduledBytes == 0);
+    CHECK(stats.streamedBytes == result.uploadedBytes);
+    CHECK(stats.evictedBytes == result.evictedBytes);
+
+    return result;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(StreamingSimulationIsDeterministic)
+{
+    const sStreamingSimulation first    = RunStreamingSimulation(false);
+    const sStreamingSimulation second   = RunStreamingSimulation(false);
+    const sStreamingSimulation batched  = RunStreamingSimulation(true);
+
+    CHECK(first.trace == second.trace);
+    CHECK(first.trace == batched.trace);
+
+    // the scenario reaches every path it is meant to
+    CHECK(first.uploadedBytes > 0);
+    CHECK(first.evictedBytes > 0);
+    CHECK(first.oversizedFrames > 0);
+    CHECK(first.cancelledUploads > 0);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,370 @@
+#include "testFramework.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "Graphics/transformSystem.h"
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// the two matrices of sObjectConstants at the start of a 256 byte constant buffer slot
+struct alignas(256) sTestObjectConstants
+{
+    XMFLOAT4X4  world;
+    XMFLOAT4X4  worldInvTranspose;
+};
+
+enum eTestTransform
+{
+    TEST_TRANSFORM_RIGID,
+    TEST_TRANSFORM_UNIFORM,
+    TEST_TRANSFORM_NONUNIFORM,
+    TEST_TRANSFORM_SHEARED,
+    TEST_TRANSFORM_COUNT,
+};
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// rotation from a random unit quaternion, rows scaled, then an optional shear and a translation
+static XMFLOAT4X4 RandomWorld(std::mt19937& _rRandom, eTestTransform _type)
+{
+    std::normal_distribution<float>         normal;
+    std::uniform_real_distribution<float>   scale(0.25f, 4.0f);
+    std::uniform_real_distribution<float>   position(-500.0f, 500.0f);
+
+    float q[4];
+    float length = 0.0f;
+
+    while (length < 1e-3f)
+    {
+        for (float& rComponent : q)
+        {
+            rComponent = normal(_rRandom);
+        }
+
+        length = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    }
+
+    const float x = q[0] / length, y = q[1] / length, z = q[2] / length, w = q[3] / length;
+
+    float m[3][3] =
+    {
+        { 1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + z * w),        2.0f * (x * z - y * w) },
+        { 2.0f * (x * y - z * w),        1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + x * w) },
+        { 2.0f * (x * z + y * w),        2.0f * (y * z - x * w),        1.0f - 2.0f * (x * x + y * y) },
+    };
+
+    float rowScales[3] = { 1.0f, 1.0f, 1.0f };
+
+    if (_type == TEST_TRANSFORM_UNIFORM)
+    {
+        rowScales[0] = rowScales[1] = rowScales[2] = scale(_rRandom);
+    }
+    else if (_type == TEST_TRANSFORM_NONUNIFORM || _type == TEST_TRANSFORM_SHEARED)
+    {
+        rowScales[0] = scale(_rRandom);
+        rowScales[1] = rowScales[0] * 1.5f;
+        rowScales[2] = scale(_rRandom);
+    }
+
+    for (int row = 0; row < 3; ++row)
+    {
+        for (int column = 0; column < 3; ++column)
+        {
+            m[row][column] *= rowScales[row];
+        }
+    }
+
+    if (_type == TEST_TRANSFORM_SHEARED)
+    {
+        for (int column = 0; column < 3; ++column)
+        {
+            m[1][column] += 0.5f * m[0][column];
+        }
+    }
+
+    return XMFLOAT4X4(
+        m[0][0], m[0][1], m[0][2], 0.0f,
+        m[1][0], m[1][1], m[1][2], 0.0f,
+        m[2][0], m[2][1], m[2][2], 0.0f,
+        position(_rRandom), position(_rRandom), position(_rRandom), 1.0f);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// the per item path the renderer took before, a full inverse of every matrix
+static void WriteConstantsPerItem(const XMFLOAT4X4& _rWorld, sTestObjectConstants& _rOutConstants)
+{
+    const XMMATRIX world = XMLoadFloat4x4(&_rWorld);
+
+    XMMATRIX worldNoTranslation = world;
+    worldNoTranslation.r[3] = XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f);
+
+    sTestObjectConstants constants;
+
+    XMStoreFloat4x4(&constants.world, XMMatrixTranspose(world));
+    XMStoreFloat4x4(&constants.worldInvTranspose, XMMatrixTranspose(XMMatrixInverse(nullptr, worldNoTranslation)));
+
+    std::memcpy(&_rOutConstants, &constants, sizeof(constants));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+static float MaxDifference(const XMFLOAT4X4& _rA, const XMFLOAT4X4& _rB)
+{
+    float difference = 0.0f;
+
+    for (int row = 0; row < 4; ++row)
+    {
+        for (int column = 0; column < 4; ++column)
+        {
+            difference = (std::max)(difference, std::fabs(_rA.m[row][column] - _rB.m[row][column]));
+        }
+    }
+
+    return difference;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(TransformSystemStartsWithIdentities)
+{
+    cTransformSystem transforms;
+    transforms.Initialize(13);
+
+    CHECK(transforms.GetCapacity() == 13);
+
+    const XMFLOAT4X4 identity(1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1);
+
+    for (uint32_t i = 0; i < 13; ++i)
+    {
+        XMFLOAT4X4 world;
+        XMFLOAT4X4 normal;
+
+        transforms.GetWorldTransposed(i, world);
+        transforms.GetInverseTranspose(i, normal);
+
+        CHECK(MaxDifference(world, identity) == 0.0f);
+        CHECK(MaxDifference(normal, identity) == 0.0f);
+    }
+
+    // nothing to recompute
+    transforms.Update();
+
+    CHECK(transforms.GetInvertedCount() == 0);
+    CHECK(transforms.GetScaledCount() == 0);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(TransformSystemMatchesTheFullInverse)
+{
+    const uint32_t c_Count = 1001;
+
+    std::mt19937 random(5);
+
+    std::vector<XMFLOAT4X4> worlds(c_Count);
+
+    cTransformSystem transforms;
+    transforms.Initialize(c_Count);
+
+    uint32_t generalCount = 0;
+
+    for (uint32_t i = 0; i < c_Count; ++i)
+    {
+        const eTestTransform type = static_cast<eTestTransform>(i % TEST_TRANSFORM_COUNT);
+
+        generalCount += type == TEST_TRANSFORM_NONUNIFORM || type == TEST_TRANSFORM_SHEARED ? 1 : 0;
+
+        worlds[i] = RandomWorld(random, type);
+        transforms.SetWorld(i, worlds[i]);
+    }
+
+    transforms.Update();
+
+    // rigid and uniformly scaled matrices skip the inverse
+    CHECK(transforms.GetInvertedCount() == generalCount);
+    CHECK(transforms.GetScaledCount() == c_Count - generalCount);
+
+    for (uint32_t i = 0; i < c_Count; ++i)
+    {
+        sTestObjectConstants expected;
+        sTestObjectConstants written;
+
+        WriteConstantsPerItem(worlds[i], expected);
+
+        transforms.GetWorldTransposed(i, written.world);
+        transforms.GetInverseTranspose(i, written.worldInvTranspose);
+
+        CHECK(MaxDifference(written.world, expected.world) == 0.0f);
+        CHECK_NEAR(MaxDifference(written.worldInvTranspose, expected.worldInvTranspose), 0.0f, 1e-4f);
+
+        // the one call the renderer makes writes the same
+        sTestObjectConstants streamed;
+        transforms.WriteConstants(i, streamed.world, streamed.worldInvTranspose);
+
+        CHECK(MaxDifference(streamed.world, written.world) == 0.0f);
+        CHECK(MaxDifference(streamed.worldInvTranspose, written.worldInvTranspose) == 0.0f);
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(TransformSystemOnlyRecomputesMovedEntries)
+{
+    std::mt19937 random(9);
+
+    cTransformSystem transforms;
+    transforms.Initialize(64);
+
+    std::vector<XMFLOAT4X4> worlds(64);
+
+    for (uint32_t i = 0; i < 64; ++i)
+    {
+        worlds[i] = RandomWorld(random, TEST_TRANSFORM_NONUNIFORM);
+        transforms.SetWorld(i, worlds[i]);
+    }
+
+    transforms.Update();
+
+    CHECK(transforms.GetInvertedCount() == 64);
+
+    std::vector<XMFLOAT4X4> normals(64);
+
+    for (uint32_t i = 0; i < 64; ++i)
+    {
+        transforms.GetInverseTranspose(i, normals[i]);
+    }
+
+    // the same matrix again is no change
+    for (uint32_t i = 0; i < 64; ++i)
+    {
+        transforms.SetWorld(i, worlds[i]);
+    }
+
+    transforms.Update();
+
+    CHECK(transforms.GetInvertedCount() == 0);
+    CHECK(transforms.GetScaledCount() == 0);
+
+    // one lane of a block moves, its neighbours keep their normals
+    worlds[11] = RandomWorld(random, TEST_TRANSFORM_SHEARED);
+    worlds[12] = RandomWorld(random, TEST_TRANSFORM_RIGID);
+
+    transforms.SetWorld(11, worlds[11]);
+    transforms.SetWorld(12, worlds[12]);
+    transforms.Update();
+
+    CHECK(transforms.GetInvertedCount() == 1);
+    CHECK(transforms.GetScaledCount() == 1);
+
+    for (uint32_t i = 0; i < 64; ++i)
+    {
+        XMFLOAT4X4 normal;
+        transforms.GetInverseTranspose(i, normal);
+
+        if (i == 11 || i == 12)
+        {
+            sTestObjectConstants expected;
+            WriteConstantsPerItem(worlds[i], expected);
+
+            CHECK_NEAR(MaxDifference(normal, expected.worldInvTranspose), 0.0f, 1e-4f);
+        }
+        else
+        {
+            CHECK(MaxDifference(normal, normals[i]) == 0.0f);
+        }
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// _count moved objects into 256 byte constant slots: the per item full inverse the renderer did
+// before against SetWorld, the batched Update and the constants written from the SoA
+static void BenchmarkTransforms(uint32_t _count)
+{
+    std::mt19937 random(17);
+
+    std::vector<XMFLOAT4X4> worlds(_count);
+
+    for (uint32_t i = 0; i < _count; ++i)
+    {
+        // a city, mostly rigid and uniformly scaled, some stretched props
+        const eTestTransform type = i % 8 == 7 ? TEST_TRANSFORM_NONUNIFORM : (i % 2 == 0 ? TEST_TRANSFORM_RIGID : TEST_TRANSFORM_UNIFORM);
+
+        worlds[i] = RandomWorld(random, type);
+    }
+
+    std::vector<sTestObjectConstants> constants(_count);
+
+    const double perItemSeconds = cBenchmark::Measure(9, [&]()
+        {
+            for (uint32_t i = 0; i < _count; ++i)
+            {
+                WriteConstantsPerItem(worlds[i], constants[i]);
+            }
+        });
+
+    cTransformSystem transforms;
+    transforms.Initialize(_count);
+
+    uint32_t generation = 0;
+
+    // every repetition moves every object, SetWorld ignores unchanged matrices
+    auto MoveAll = [&]()
+        {
+            ++generation;
+
+            for (uint32_t i = 0; i < _count; ++i)
+            {
+                worlds[i]._41 += generation & 1 ? 1.0f : -1.0f;
+
+                transforms.SetWorld(i, worlds[i]);
+            }
+
+            transforms.Update();
+        };
+
+    const double updateSeconds = cBenchmark::Measure(9, MoveAll);
+
+    const double writeSeconds = cBenchmark::Measure(9, [&]()
+        {
+            for (uint32_t i = 0; i < _count; ++i)
+            {
+                transforms.WriteConstants(i, constants[i].world, constants[i].worldInvTranspose);
+            }
+        });
+
+    const double soaSeconds = cBenchmark::Measure(9, [&]()
+        {
+            MoveAll();
+
+            for (uint32_t i = 0; i < _count; ++i)
+            {
+                transforms.WriteConstants(i, constants[i].world, constants[i].worldInvTranspose);
+            }
+        });
+
+    std::cout << "  " << _count << " objects, " << transforms.GetInvertedCount() << " inverted, " << transforms.GetScaledCount() << " scaled\n";
+
+    cBenchmark::Report("per item XMMatrixInverse", perItemSeconds / _count * 1e9, "ns/object");
+    cBenchmark::Report("SoA SetWorld + Update + write", soaSeconds / _count * 1e9, "ns/object");
+    cBenchmark::Report("  of it SetWorld + Update", updateSeconds / _count * 1e9, "ns/object");
+    cBenchmark::Report("  of it write", writeSeconds / _count * 1e9, "ns/object");
+    cBenchmark::Report("speedup", perItemSeconds / soaSeconds, "x");
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// 100k objects write 25.6 MB of constants and run at memory speed, 4k stay in the caches
+BENCHMARK(TransformSystem)
+{
+    BenchmarkTransforms(100000);
+    BenchmarkTransforms(4096);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,277 @@
+#include "testFramework.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+#include "Graphics/vertexQuantization.h"
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+static void RandomUnitVector(std::mt19937& _rRandom, float _outVector[3])
+{
+    std::normal_distribution<float> distribution;
+
+    float length = 0.f;
+
+    while (length < 1e-3f)
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            _outVector[i] = distribution(_rRandom);
+        }
+
+        length = std::sqrt(_outVector[0] * _outVector[0] + _outVector[1] * _outVector[1] + _outVector[2] * _outVector[2]);
+    }
+
+    for (int i = 0; i < 3; ++i)
+    {
+        _outVector[i] /= length;
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// in degrees, both vectors unit length
+static float GetAngle(const float _a[3], const float _b[3])
+{
+    const float cross[3] =
+    {
+        _a[1] * _b[2] - _a[2] * _b[1],
+        _a[2] * _b[0] - _a[0] * _b[2],
+        _a[0] * _b[1] - _a[1] * _b[0],
+    };
+
+    const float sine    = std::sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+    const float cosine  = _a[0] * _b[0] + _a[1] * _b[1] + _a[2] * _b[2];
+
+    return std::atan2(sine, cosine) * (180.f / 3.14159265f);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(HalfRoundTripsEveryValue)
+{
+    for (uint32_t half = 0; half <= 0xFFFFu; ++half)
+    {
+        const uint16_t value = static_cast<uint16_t>(half);
+
+        // NaNs only have to stay NaNs
+        if ((value & 0x7C00u) == 0x7C00u && (value & 0x3FFu) != 0)
+        {
+            CHECK(std::isnan(cVertexQuantization::HalfToFloat(value)));
+            continue;
+        }
+
+        CHECK(cVertexQuantization::FloatToHalf(cVertexQuantization::HalfToFloat(value)) == value);
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(HalfRoundsToNearest)
+{
+    std::mt19937 random(5);
+    std::uniform_real_distribution<float> exponent(-24.f, 15.9f);
+
+    for (int i = 0; i < 200000; ++i)
+    {
+        const float value   = std::exp2(exponent(random)) * (i & 1 ? -1.f : 1.f);
+        const float decoded = cVertexQuantization::HalfToFloat(cVertexQuantization::FloatToHalf(value));
+
+        // half an ulp of the half result, ulps stop shrinking in the subnormal range
+        const float ulp = std::exp2(std::max(std::floor(std::log2(std::fabs(value))), -14.f) - 10.f);
+
+        CHECK(std::fabs(decoded - value) <= 0.5f * ulp);
+    }
+
+    CHECK(cVertexQuantization::FloatToHalf(65520.f) == 0x7C00u);
+    CHECK(cVertexQuantization::FloatToHalf(65519.f) == 0x7BFFu);
+    CHECK(cVertexQuantization::FloatToHalf(1e-9f) == 0);
+    CHECK(cVertexQuantization::FloatToHalf(-0.f) == 0x8000u);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(NormalizedIntegersStayInHalfAStep)
+{
+    for (int i = 0; i <= 100000; ++i)
+    {
+        const float unorm = i / 100000.f;
+        const float snorm = unorm * 2.f - 1.f;
+
+        CHECK(std::fabs(cVertexQuantization::DequantizeUnorm16(cVertexQuantization::QuantizeUnorm16(unorm)) - unorm) <= 0.5f / 65535.f + 1e-7f);
+        CHECK(std::fabs(cVertexQuantization::DequantizeSnorm16(cVertexQuantization::QuantizeSnorm16(snorm)) - snorm) <= 0.5f / 32767.f + 1e-7f);
+    }
+
+    // out of range input clamps, both snorm minimums decode to -1
+    CHECK(cVertexQuantization::QuantizeUnorm16(2.f) == 65535);
+    CHECK(cVertexQuantization::QuantizeUnorm16(-1.f) == 0);
+    CHECK(cVertexQuantization::QuantizeSnorm16(-2.f) == -32767);
+    CHECK(cVertexQuantization::DequantizeSnorm16(-32768) == -1.f);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(OctahedralNormalErrorBound)
+{
+    std::mt19937 random(17);
+
+    float worst = 0.f;
+
+    for (int i = 0; i < 200000; ++i)
+    {
+        float normal[3];
+        RandomUnitVector(random, normal);
+
+        int16_t encoded[2];
+        float   decoded[3];
+
+        cVertexQuantization::EncodeOctahedral(normal, encoded);
+        cVertexQuantization::DecodeOctahedral(encoded, decoded);
+
+        worst = (std::max)(worst, GetAngle(normal, decoded));
+    }
+
+    // two snorm16 components resolve the sphere to about 0.004 degrees
+    std::cout << "  worst octahedral error " << worst << " degrees\n";
+    CHECK(worst < 0.005f);
+
+    // the axes and the folded octants' corners are exact
+    const float axes[6][3] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+
+    for (const float* pAxis : axes)
+    {
+        int16_t encoded[2];
+        float   decoded[3];
+
+        cVertexQuantization::EncodeOctahedral(pAxis, encoded);
+        cVertexQuantization::DecodeOctahedral(encoded, decoded);
+
+        CHECK(GetAngle(pAxis, decoded) < 1e-3f);
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(QTangentFrameErrorBound)
+{
+    std::mt19937 random(23);
+
+    float worstNormal   = 0.f;
+    float worstTangent  = 0.f;
+
+    for (int i = 0; i < 200000; ++i)
+    {
+        float normal[3];
+        float direction[3];
+        RandomUnitVector(random, normal);
+        RandomUnitVector(random, direction);
+
+        // unnormalized and not orthogonal on purpose, the encoder has to fix both
+        const float tangent[4] = { direction[0] * 3.f, direction[1] * 3.f, direction[2] * 3.f, i & 1 ? -1.f : 1.f };
+
+        const float nDotT = normal[0] * direction[0] + normal[1] * direction[1] + normal[2] * direction[2];
+
+        if (std::fabs(nDotT) > 0.99f)
+            continue;
+
+        float expected[3] =
+        {
+            direction[0] - normal[0] * nDotT,
+            direction[1] - normal[1] * nDotT,
+            direction[2] - normal[2] * nDotT,
+        };
+
+        const float length = std::sqrt(expected[0] * expected[0] + expected[1] * expected[1] + expected[2] * expected[2]);
+
+        for (float& rComponent : expected)
+        {
+            rComponent /= length;
+        }
+
+        int16_t encoded[4];
+        float   decodedNormal[3];
+        float   decodedTangent[4];
+
+        cVertexQuantization::EncodeQTangent(normal, tangent, encoded);
+        cVertexQuantization::DecodeQTangent(encoded, decodedNormal, decodedTangent);
+
+        worstNormal     = (std::max)(worstNormal, GetAngle(normal, decodedNormal));
+        worstTangent    = (std::max)(worstTangent, GetAngle(expected, decodedTangent));
+
+        CHECK(decodedTangent[3] == tangent[3]);
+    }
+
+    std::cout << "  worst qtangent error " << worstNormal << " (normal), " << worstTangent << " (tangent) degrees\n";
+    CHECK(worstNormal < 0.005f);
+    CHECK(worstTangent < 0.005f);
+
+    // a zero tangent still gives a frame around the normal
+    const float up[3]       = { 0.f, 1.f, 0.f };
+    const float none[4]     = { 0.f, 0.f, 0.f, -1.f };
+
+    int16_t encoded[4];
+    float   decodedNormal[3];
+    float   decodedTangent[4];
+
+    cVertexQuantization::EncodeQTangent(up, none, encoded);
+    cVertexQuantization::DecodeQTangent(encoded, decodedNormal, decodedTangent);
+
+    CHECK(GetAngle(up, decodedNormal) < 0.02f);
+    CHECK(std::fabs(decodedTangent[0] * up[0] + decodedTangent[1] * up[1] + decodedTangent[2] * up[2]) < 1e-3f);
+    CHECK(decodedTangent[3] == -1.f);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(PackedPositionErrorBound)
+{
+    std::mt19937 random(29);
+
+    const float boundsMin[3]    = { -1250.f, 3.5f, 0.f };
+    const float boundsExtent[3] = { 2500.f, 0.25f, 0.f };   // a flat submesh has a zero axis
+
+    const float zero[4] = {};
+
+    for (int i = 0; i < 100000; ++i)
+    {
+        float position[3];
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            position[axis] = boundsMin[axis] + std::uniform_real_distribution<float>(0.f, 1.f)(random) * boundsExtent[axis];
+        }
+
+        const sVertexQuantized vertex = cVertexQuantization::Pack(position, zero, zero, zero, zero, boundsMin, boundsExtent);
+
+        float decoded[3];
+        cVertexQuantization::UnpackPosition(vertex, boundsMin, boundsExtent, decoded);
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            CHECK(std::fabs(decoded[axis] - position[axis]) <= cVertexQuantization::GetPositionErrorBound(boundsExtent[axis]));
+        }
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(HalfTexCoordLimitKeepsPrecision)
+{
+    for (float precision : { 1.f / 256.f, 1.f / 1024.f, 1.f / 4096.f, 1.f / 16384.f })
+    {
+        const float limit = cVertexQuantization::GetMaxHalfTexCoord(precision);
+
+        CHECK(limit > 0.f);
+
+        for (int i = 0; i <= 20000; ++i)
+        {
+            const float value   = limit * i / 20000.f;
+            const float decoded = cVertexQuantization::HalfToFloat(cVertexQuantization::FloatToHalf(value));
+
+            CHECK(std::fabs(decoded - value) <= precision);
+        }
+    }
+}
@@ -0,0 +1,349 @@
+#include "testFramework.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "Core/jobSystem.h"
+#include "Scene/gltfMeshReader.h"
+
+#include "tiny_gltf.h"
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+static int AddAccessor(tinygltf::Model& _rModel, const std::vector<T>& _rValues, int _componentType, int _type, size_t _count)
+{
+    tinygltf::Buffer& rBuffer = _rModel.buffers[0];
+
+    tinygltf::BufferView view;
+    view.buffer     = 0;
+    view.byteOffset = rBuffer.data.size();
+    view.byteLength = _rValues.size() * sizeof(T);
+
+    rBuffer.data.resize(rBuffer.data.size() + view.byteLength);
+    std::memcpy(rBuffer.data.data() + view.byteOffset, _rValues.data(), view.byteLength);
+
+    tinygltf::Accessor accessor;
+    accessor.bufferView     = static_cast<int>(_rModel.bufferViews.size());
+    accessor.componentType  = _componentType;
+    accessor.type           = _type;
+    accessor.count          = _count;
+
+    _rModel.bufferViews.push_back(view);
+    _rModel.accessors.push_back(accessor);
+
+    return static_cast<int>(_rModel.accessors.size() - 1);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// _meshCount meshes, each a _gridSize x _gridSize vertex grid with positions, normals and uvs
+static void BuildGridModel(size_t _meshCount, uint32_t _gridSize, tinygltf::Model& _rOutModel)
+{
+    _rOutModel = tinygltf::Model();
+    _rOutModel.buffers.resize(1);
+
+    for (size_t mesh = 0; mesh < _meshCount; ++mesh)
+    {
+        std::vector<float>      positions;
+        std::vector<float>      normals;
+        std::vector<float>      texCoords;
+        std::vector<uint32_t>   indices;
+
+        for (uint32_t y = 0; y < _gridSize; ++y)
+        {
+            for (uint32_t x = 0; x < _gridSize; ++x)
+            {
+                positions.insert(positions.end(), { static_cast<float>(x), static_cast<float>(mesh), static_cast<float>(y) });
+                normals.insert(normals.end(), { 0.6f, 0.8f, 0.0f });
+                texCoords.insert(texCoords.end(), { x / float(_gridSize), y / float(_gridSize) });
+            }
+        }
+
+        for (uint32_t y = 0; y + 1 < _gridSize; ++y)
+        {
+            for (uint32_t x = 0; x + 1 < _gridSize; ++x)
+            {
+                const uint32_t i = y * _gridSize + x;
+
+                indices.insert(indices.end(), { i, i + 1, i + _gridSize, i + 1, i + _gridSize + 1, i + _gridSize });
+            }
+        }
+
+        const size_t vertexCount = size_t(_gridSize) * _gridSize;
+
+        tinygltf::Primitive primitive;
+        primitive.attributes["POSITION"]    = AddAccessor(_rOutModel, positions, TINYGLTF_COMPONENT_TYPE_FLOAT, TINYGLTF_TYPE_VEC3, vertexCount);
+        primitive.attributes["NORMAL"]      = AddAccessor(_rOutModel, normals, TINYGLTF_COMPONENT_TYPE_FLOAT, TINYGLTF_TYPE_VEC3, vertexCount);
+        primitive.attributes["TEXCOORD_0"]  = AddAccessor(_rOutModel, texCoords, TINYGLTF_COMPONENT_TYPE_FLOAT, TINYGLTF_TYPE_VEC2, vertexCount);
+        primitive.indices                   = AddAccessor(_rOutModel, indices, TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT, TINYGLTF_TYPE_SCALAR, indices.size());
+        primitive.material                  = static_cast<int>(mesh % 3);
+
+        tinygltf::Mesh gltfMesh;
+        gltfMesh.primitives.push_back(primitive);
+
+        _rOutModel.meshes.push_back(gltfMesh);
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+static bool IsSameMesh(const sMeshData& _rA, const sMeshData& _rB)
+{
+    return _rA.vertices.size() == _rB.vertices.size()
+        && _rA.indices32 == _rB.indices32
+        && _rA.materialId == _rB.materialId
+        && std::memcmp(_rA.vertices.data(), _rB.vertices.data(), _rA.vertices.size() * sizeof(sVertex)) == 0;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(GltfMeshReaderMirrorsIntoLeftHanded)
+{
+    tinygltf::Model model;
+    BuildGridModel(1, 2, model);
+
+    std::vector<sMeshData> meshes;
+    cGltfMeshReader::ReadMesh(model, 0, meshes);
+
+    CHECK(meshes.size() == 1);
+
+    if (meshes.size() != 1)
+        return;
+
+    const sMeshData& rMesh = meshes[0];
+
+    CHECK(rMesh.vertices.size() == 4);
+    CHECK(rMesh.materialId == 0);
+
+    // X is mirrored, so the winding of every triangle is swapped
+    CHECK(rMesh.indices32 == std::vector<uint32_t>({ 0, 2, 1, 1, 2, 3 }));
+
+    CHECK(rMesh.vertices[1].position.x == -1.0f);
+    CHECK(rMesh.vertices[1].normal.x == -0.6f);
+    CHECK(rMesh.vertices[1].normal.y == 0.8f);
+    CHECK(rMesh.vertices[1].texC.x == 0.5f);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(GltfMeshReaderParallelMatchesSerial)
+{
+    tinygltf::Model model;
+    BuildGridModel(48, 17, model);
+
+    // repeated and out of order mesh indices, like a node walk produces them
+    std::vector<int> meshIndices;
+
+    for (int i = 47; i >= 0; i -= 2)
+    {
+        meshIndices.push_back(i);
+        meshIndices.push_back(47 - i);
+    }
+
+    std::vector<std::vector<sMeshData>> serial;
+    std::vector<std::vector<sMeshData>> parallel;
+
+    cGltfMeshReader::ReadMeshes(model, meshIndices, serial, false);
+    cGltfMeshReader::ReadMeshes(model, meshIndices, parallel, true);
+
+    CHECK(serial.size() == meshIndices.size());
+    CHECK(parallel.size() == meshIndices.size());
+
+    for (size_t slot = 0; slot < serial.size() && slot < parallel.size(); ++slot)
+    {
+        CHECK(serial[slot].size() == 1);
+        CHECK(parallel[slot].size() == serial[slot].size());
+
+        if (serial[slot].size() == 1 && parallel[slot].size() == 1)
+        {
+            CHECK(IsSameMesh(serial[slot][0], parallel[slot][0]));
+        }
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(GltfAccessorRejectsMismatchedType)
+{
+    tinygltf::Model model;
+    model.buffers.resize(1);
+
+    const int vec3 = AddAccessor(model, std::vector<float>(12, 1.f), TINYGLTF_COMPONENT_TYPE_FLOAT, TINYGLTF_TYPE_VEC3, 4);
+
+    std::vector<float> values;
+
+    CHECK(cGltfMeshReader::ReadAccessorFloats(model, vec3, 3, values));
+    CHECK(values.size() == 12);
+
+    // a VEC3 read as VEC4 would walk past every element
+    CHECK(!cGltfMeshReader::ReadAccessorFloats(model, vec3, 4, values));
+    CHECK(!cGltfMeshReader::ReadAccessorFloats(model, -1, 3, values));
+    CHECK(!cGltfMeshReader::ReadAccessorFloats(model, vec3 + 1, 3, values));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(GltfAccessorRejectsOutOfBounds)
+{
+    tinygltf::Model model;
+    model.buffers.resize(1);
+
+    const int accessor = AddAccessor(model, std::vector<float>(12, 1.f), TINYGLTF_COMPONENT_TYPE_FLOAT, TINYGLTF_TYPE_VEC3, 4);
+
+    std::vector<float> values;
+
+    model.accessors[accessor].count = 5;
+    CHECK(!cGltfMeshReader::ReadAccessorFloats(model, accessor, 3, values));
+
+    // a count whose byte size wraps around size_t
+    model.accessors[accessor].count = ~size_t(0) / 4;
+    CHECK(!cGltfMeshReader::ReadAccessorFloats(model, accessor, 3, values));
+
+    model.accessors[accessor].count         = 4;
+    model.accessors[accessor].byteOffset    = 4;
+    CHECK(!cGltfMeshReader::ReadAccessorFloats(model, accessor, 3, values));
+
+    // the view may claim more than the buffer holds
+    model.accessors[accessor].byteOffset    = 0;
+    model.bufferViews[0].byteLength         = 64;
+    CHECK(cGltfMeshReader::ReadAccessorFloats(model, accessor, 3, values));
+    model.accessors[accessor].count         = 5;
+    CHECK(!cGltfMeshReader::ReadAccessorFloats(model, accessor, 3, values));
+
+    // the last element may end exactly at the end of the view
+    model.bufferViews[0].byteLength         = 48;
+    model.bufferViews[0].byteStride         = 16;
+    model.accessors[accessor].count         = 3;
+    CHECK(cGltfMeshReader::ReadAccessorFloats(model, accessor, 3, values));
+    model.accessors[accessor].count         = 4;
+    CHECK(!cGltfMeshReader::ReadAccessorFloats(model, accessor, 3, values));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(GltfAccessorNormalizesOnlyWhenFlagged)
+{
+    tinygltf::Model model;
+    model.buffers.resize(1);
+
+    const int bytes     = AddAccessor(model, std::vector<int8_t>({ 127, -127, -128, 0 }), TINYGLTF_COMPONENT_TYPE_BYTE, TINYGLTF_TYPE_VEC4, 1);
+    const int shorts    = AddAccessor(model, std::vector<int16_t>({ 32767, -16384, 0, -32768 }), TINYGLTF_COMPONENT_TYPE_SHORT, TINYGLTF_TYPE_VEC4, 1);
+    const int ubytes    = AddAccessor(model, std::vector<uint8_t>({ 255, 0, 51, 0 }), TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE, TINYGLTF_TYPE_VEC3, 1);
+
+    std::vector<float> values;
+
+    CHECK(cGltfMeshReader::ReadAccessorFloats(model, bytes, 4, values));
+    CHECK(values == std::vector<float>({ 127.f, -127.f, -128.f, 0.f }));
+
+    model.accessors[bytes].normalized = true;
+    CHECK(cGltfMeshReader::ReadAccessorFloats(model, bytes, 4, values));
+    CHECK(values == std::vector<float>({ 1.f, -1.f, -1.f, 0.f }));
+
+    CHECK(cGltfMeshReader::ReadAccessorFloats(model, shorts, 4, values));
+    CHECK(values == std::vector<float>({ 32767.f, -16384.f, 0.f, -32768.f }));
+
+    model.accessors[shorts].normalized = true;
+    CHECK(cGltfMeshReader::ReadAccessorFloats(model, shorts, 4, values));
+    CHECK_NEAR(values[1], -0.5f, 1e-4f);
+    CHECK(values[3] == -1.f);
+
+    model.accessors[ubytes].normalized = true;
+    CHECK(cGltfMeshReader::ReadAccessorFloats(model, ubytes, 3, values));
+    CHECK(values[0] == 1.f);
+    CHECK_NEAR(values[2], 0.2f, 1e-6f);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// keeps the encoded images, the benchmark is about geometry
+static bool SkipImage(tinygltf::Image*, const int, std::string*, std::string*, int, int, const unsigned char*, int, void*)
+{
+    return true;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// Mesh extraction of the scene given with --scene (.gltf or .glb), or of a synthetic city sized
+// model, on one thread and then on every worker count up to the hardware threads.
+BENCHMARK(SceneLoad)
+{
+    tinygltf::Model model;
+
+    const std::string scenePath = cTestRegistry::GetOption("--scene", "");
+
+    if (!scenePath.empty())
+    {
+        tinygltf::TinyGLTF  loader;
+        std::string         error;
+        std::string         warning;
+
+        loader.SetImageLoader(SkipImage, nullptr);
+
+        const bool isBinary = scenePath.size() > 4 && scenePath.compare(scenePath.size() - 4, 4, ".glb") == 0;
+
+        bool loaded = false;
+
+        const double parseSeconds = cBenchmark::Measure(1, [&]()
+            {
+                loaded = isBinary
+                    ? loader.LoadBinaryFromFile(&model, &error, &warning, scenePath)
+                    : loader.LoadASCIIFromFile(&model, &error, &warning, scenePath);
+            });
+
+        CHECK(loaded);
+
+        if (!loaded)
+        {
+            std::cout << "  " << error << "\n";
+            return;
+        }
+
+        std::cout << "  scene: " << scenePath << "\n";
+        cBenchmark::Report("glTF parse", parseSeconds * 1000.0, "ms");
+    }
+    else
+    {
+        std::cout << "  scene: synthetic, 512 meshes of 48x48 vertices (pass --scene for a file)\n";
+        BuildGridModel(512, 48, model);
+    }
+
+    std::vector<int> meshIndices(model.meshes.size());
+
+    for (size_t i = 0; i < meshIndices.size(); ++i)
+    {
+        meshIndices[i] = static_cast<int>(i);
+    }
+
+    std::vector<std::vector<sMeshData>> slots;
+
+    const double serialSeconds = cBenchmark::Measure(3, [&]()
+        {
+            cGltfMeshReader::ReadMeshes(model, meshIndices, slots, false);
+        });
+
+    cBenchmark::Report("mesh extraction, serial", serialSeconds * 1000.0, "ms");
+
+    const unsigned hardwareThreads = (std::max)(std::thread::hardware_concurrency(), 1u);
+
+    for (unsigned threads = 1; ; threads = (std::min)(threads * 2, hardwareThreads))
+    {
+        cJobSystem::Initialize(threads - 1);
+
+        const double parallelSeconds = cBenchmark::Measure(3, [&]()
+            {
+                cGltfMeshReader::ReadMeshes(model, meshIndices, slots, true);
+            });
+
+        const std::string name = "mesh extraction, " + std::to_string(threads) + " threads";
+
+        cBenchmark::Report(name.c_str(), parallelSeconds * 1000.0, "ms");
+        cBenchmark::Report("  speedup over serial", serialSeconds / parallelSeconds, "x");
+
+        if (threads == hardwareThreads)
+            break;
+    }
+}
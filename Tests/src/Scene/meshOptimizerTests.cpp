@@ -0,0 +1,231 @@
+#include "testFramework.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "Scene/meshOptimizer.h"
+#include "Scene/testMeshes.h"
+
+constexpr unsigned c_CacheSize = 16;	// the loader's analysis size
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// vertex positions of every triangle in its smallest rotation, so the winding is kept, sorted
+static std::vector<std::array<float, 9>> GetTriangles(const sMeshData& _rMesh)
+{
+    std::vector<std::array<float, 9>> triangles;
+
+    for (size_t i = 0; i + 2 < _rMesh.indices32.size(); i += 3)
+    {
+        std::array<float, 9> best;
+
+        for (size_t first = 0; first < 3; ++first)
+        {
+            std::array<float, 9> triangle;
+
+            for (size_t corner = 0; corner < 3; ++corner)
+            {
+                const XMFLOAT3& rPosition = _rMesh.vertices[_rMesh.indices32[i + (first + corner) % 3]].position;
+
+                triangle[corner * 3 + 0] = rPosition.x;
+                triangle[corner * 3 + 1] = rPosition.y;
+                triangle[corner * 3 + 2] = rPosition.z;
+            }
+
+            if (first == 0 || triangle < best)
+                best = triangle;
+        }
+
+        triangles.push_back(best);
+    }
+
+    std::sort(triangles.begin(), triangles.end());
+
+    return triangles;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// the loader's pass: cache order, optionally overdraw, then fetch order
+static void Optimize(sMeshData& _rMesh, bool _overdraw)
+{
+    std::vector<uint32_t>& rIndices = _rMesh.indices32;
+
+    cMeshOptimizer::OptimizeVertexCache(rIndices.data(), rIndices.size(), _rMesh.vertices.size());
+
+    if (_overdraw)
+    {
+        cMeshOptimizer::OptimizeOverdraw(rIndices.data(), rIndices.size(),
+            &_rMesh.vertices[0].position.x, _rMesh.vertices.size(), sizeof(sVertex));
+    }
+
+    const size_t vertexCount = cMeshOptimizer::OptimizeVertexFetch(
+        rIndices.data(), rIndices.size(), _rMesh.vertices.data(), _rMesh.vertices.size(), sizeof(sVertex));
+
+    _rMesh.vertices.resize(vertexCount);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(MeshOptimizerKeepsTriangles)
+{
+    for (bool overdraw : { false, true })
+    {
+        sMeshData mesh;
+        cTestMeshes::BuildSphere(24, 48, mesh);
+        cTestMeshes::ShuffleTriangles(mesh.indices32, 7);
+
+        const std::vector<std::array<float, 9>> before = GetTriangles(mesh);
+
+        Optimize(mesh, overdraw);
+
+        CHECK(GetTriangles(mesh) == before);
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(MeshOptimizerFetchOrderDropsUnused)
+{
+    sMeshData mesh;
+    cTestMeshes::BuildGrid(16, mesh);
+
+    // the last row is no longer referenced
+    mesh.indices32.resize(mesh.indices32.size() - 15 * 6);
+
+    const std::vector<std::array<float, 9>> before = GetTriangles(mesh);
+
+    const size_t vertexCount = cMeshOptimizer::OptimizeVertexFetch(
+        mesh.indices32.data(), mesh.indices32.size(), mesh.vertices.data(), mesh.vertices.size(), sizeof(sVertex));
+
+    CHECK(vertexCount == 15 * 16);
+
+    mesh.vertices.resize(vertexCount);
+
+    CHECK(GetTriangles(mesh) == before);
+
+    // first use order: every index is at most one past the largest seen so far
+    uint32_t next = 0;
+
+    for (uint32_t index : mesh.indices32)
+    {
+        CHECK(index <= next);
+        next = (std::max)(next, index + 1);
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(MeshOptimizerImprovesCacheHitRate)
+{
+    sMeshData mesh;
+    cTestMeshes::BuildGrid(64, mesh);
+    cTestMeshes::ShuffleTriangles(mesh.indices32, 11);
+
+    const sVertexCacheStats before = cMeshOptimizer::AnalyzeVertexCache(
+        mesh.indices32.data(), mesh.indices32.size(), mesh.vertices.size(), c_CacheSize);
+
+    Optimize(mesh, false);
+
+    const sVertexCacheStats after = cMeshOptimizer::AnalyzeVertexCache(
+        mesh.indices32.data(), mesh.indices32.size(), mesh.vertices.size(), c_CacheSize);
+
+    // a shuffled grid misses almost every vertex, an optimized one approaches 0.5 per triangle
+    CHECK(before.acmr > 2.f);
+    CHECK(after.acmr < 0.8f);
+    CHECK(after.atvr < 1.6f);
+
+    // running it again on optimized input must not make things worse
+    Optimize(mesh, false);
+
+    const sVertexCacheStats again = cMeshOptimizer::AnalyzeVertexCache(
+        mesh.indices32.data(), mesh.indices32.size(), mesh.vertices.size(), c_CacheSize);
+
+    CHECK(again.acmr <= after.acmr + 0.01f);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+static void ReportMesh(const char* _pName, std::vector<sMeshData>& _rMeshes)
+{
+    double triangles        = 0.0;
+    double vertices         = 0.0;
+    double verticesAfter    = 0.0;
+    double missesBefore     = 0.0;
+    double missesAfter      = 0.0;
+
+    for (const sMeshData& rMesh : _rMeshes)
+    {
+        const sVertexCacheStats stats = cMeshOptimizer::AnalyzeVertexCache(
+            rMesh.indices32.data(), rMesh.indices32.size(), rMesh.vertices.size(), c_CacheSize);
+
+        triangles       += rMesh.indices32.size() / 3;
+        vertices        += rMesh.vertices.size();
+        missesBefore    += stats.acmr * (rMesh.indices32.size() / 3);
+    }
+
+    // optimizes copies, every repetition starts from the exporter order
+    std::vector<sMeshData> optimized;
+
+    const double seconds = cBenchmark::Measure(3, [&]()
+        {
+            optimized = _rMeshes;
+
+            for (sMeshData& rMesh : optimized)
+            {
+                Optimize(rMesh, false);
+            }
+        });
+
+    for (const sMeshData& rMesh : optimized)
+    {
+        const sVertexCacheStats stats = cMeshOptimizer::AnalyzeVertexCache(
+            rMesh.indices32.data(), rMesh.indices32.size(), rMesh.vertices.size(), c_CacheSize);
+
+        missesAfter     += stats.acmr * (rMesh.indices32.size() / 3);
+        verticesAfter   += rMesh.vertices.size();
+    }
+
+    std::cout << "  " << _pName << ", " << static_cast<size_t>(triangles) << " triangles\n";
+
+    cBenchmark::Report("ACMR before", missesBefore / triangles, "");
+    cBenchmark::Report("ACMR after", missesAfter / triangles, "");
+    cBenchmark::Report("ATVR before", missesBefore / vertices, "");
+    cBenchmark::Report("ATVR after", missesAfter / verticesAfter, "");
+    cBenchmark::Report("optimization (cache + fetch)", seconds * 1000.0, "ms");
+    cBenchmark::Report("  throughput", triangles / seconds / 1e6, "Mtri/s");
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// ACMR / ATVR of a 16 entry FIFO cache before and after the loader's optimization, on
+// synthetic meshes in exporter and in shuffled order, and on the scene given with --scene.
+BENCHMARK(MeshOptimizer)
+{
+    std::vector<sMeshData> meshes(1);
+
+    cTestMeshes::BuildGrid(512, meshes[0]);
+    ReportMesh("grid 512x512, row order", meshes);
+
+    cTestMeshes::ShuffleTriangles(meshes[0].indices32, 1);
+    ReportMesh("grid 512x512, shuffled", meshes);
+
+    cTestMeshes::BuildSphere(256, 512, meshes[0]);
+    ReportMesh("sphere 256x512, row order", meshes);
+
+    cTestMeshes::ShuffleTriangles(meshes[0].indices32, 2);
+    ReportMesh("sphere 256x512, shuffled", meshes);
+
+    const std::string scenePath = cTestRegistry::GetOption("--scene", "");
+
+    if (!scenePath.empty())
+    {
+        CHECK(cTestMeshes::LoadScene(scenePath.c_str(), meshes));
+
+        const std::string name = "scene " + scenePath + ", " + std::to_string(meshes.size()) + " primitives";
+        ReportMesh(name.c_str(), meshes);
+    }
+}
@@ -0,0 +1,259 @@
+#include "testFramework.h"
+
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Scene/meshOptimizer.h"
+#include "Scene/meshSimplifier.h"
+#include "Scene/testMeshes.h"
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+struct sSimplifyResult
+{
+    std::vector<uint32_t>   indices;
+    float                   error       = 0.f;  // as reported
+    double                  seconds     = 0.0;
+};
+
+static sSimplifyResult Simplify(const sMeshData& _rMesh, float _ratio, float _targetError)
+{
+    sSimplifyResult result;
+    result.indices.resize(_rMesh.indices32.size());
+
+    const size_t targetIndexCount = static_cast<size_t>(_rMesh.indices32.size() / 3 * _ratio) * 3;
+
+    size_t indexCount = 0;
+
+    result.seconds = cBenchmark::Measure(1, [&]()
+        {
+            indexCount = cMeshSimplifier::Simplify(
+                _rMesh.indices32.data(), _rMesh.indices32.size(), &_rMesh.vertices[0].position.x, _rMesh.vertices.size(),
+                sizeof(sVertex), targetIndexCount, _targetError, result.indices.data(), &result.error);
+        });
+
+    result.indices.resize(indexCount);
+
+    return result;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+static XMFLOAT3 GetNormal(const sMeshData& _rMesh, const uint32_t* _pTriangle, float* _pOutArea)
+{
+    const XMFLOAT3& p0 = _rMesh.vertices[_pTriangle[0]].position;
+    const XMFLOAT3& p1 = _rMesh.vertices[_pTriangle[1]].position;
+    const XMFLOAT3& p2 = _rMesh.vertices[_pTriangle[2]].position;
+
+    const float e1[3] = { p1.x - p0.x, p1.y - p0.y, p1.z - p0.z };
+    const float e2[3] = { p2.x - p0.x, p2.y - p0.y, p2.z - p0.z };
+
+    const XMFLOAT3 n(e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]);
+
+    const float length = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+
+    *_pOutArea = length * 0.5f;
+
+    return length > 0.f ? XMFLOAT3(n.x / length, n.y / length, n.z / length) : XMFLOAT3(0.f, 0.f, 0.f);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// largest distance of a triangle centroid from the unit sphere, how far the faces sag inwards
+static float GetSphereDeviation(const sMeshData& _rMesh, const std::vector<uint32_t>& _rIndices)
+{
+    float deviation = 0.f;
+
+    for (size_t i = 0; i + 2 < _rIndices.size(); i += 3)
+    {
+        XMFLOAT3 centroid(0.f, 0.f, 0.f);
+
+        for (size_t corner = 0; corner < 3; ++corner)
+        {
+            const XMFLOAT3& rPosition = _rMesh.vertices[_rIndices[i + corner]].position;
+
+            centroid.x += rPosition.x / 3.f;
+            centroid.y += rPosition.y / 3.f;
+            centroid.z += rPosition.z / 3.f;
+        }
+
+        deviation = (std::max)(deviation, 1.f - std::sqrt(centroid.x * centroid.x + centroid.y * centroid.y + centroid.z * centroid.z));
+    }
+
+    return deviation;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(SimplifierCollapsesFlatInteriorExactly)
+{
+    sMeshData mesh;
+    cTestMeshes::BuildGrid(33, mesh);
+
+    const sSimplifyResult result = Simplify(mesh, 0.f, 1e-4f);
+
+    // a plane costs nothing to collapse, only the locked border is left to triangulate
+    CHECK(result.indices.size() / 3 < mesh.indices32.size() / 3 / 10);
+    CHECK(result.error <= 1e-4f);
+
+    float area = 0.f;
+
+    std::vector<uint8_t> referenced(mesh.vertices.size(), 0);
+
+    for (size_t i = 0; i < result.indices.size(); i += 3)
+    {
+        float triangleArea = 0.f;
+        const XMFLOAT3 normal = GetNormal(mesh, &result.indices[i], &triangleArea);
+
+        // same facing as the source, nothing folded over
+        CHECK(normal.y > 0.999f);
+
+        area += triangleArea;
+
+        for (size_t corner = 0; corner < 3; ++corner)
+        {
+            referenced[result.indices[i + corner]] = 1;
+        }
+    }
+
+    CHECK_NEAR(area, 32.f * 32.f, 1e-2f);
+
+    for (size_t i = 0; i < mesh.vertices.size(); ++i)
+    {
+        const XMFLOAT3& rPosition = mesh.vertices[i].position;
+
+        const bool isBorder = rPosition.x == 0.f || rPosition.z == 0.f || rPosition.x == 32.f || rPosition.z == 32.f;
+
+        if (isBorder)
+            CHECK(referenced[i]);
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(SimplifierKeepsSphereWithinError)
+{
+    sMeshData mesh;
+    cTestMeshes::BuildSphere(64, 128, mesh);
+
+    const float sourceDeviation = GetSphereDeviation(mesh, mesh.indices32);
+
+    const float targetError = 0.02f;
+
+    const sSimplifyResult result = Simplify(mesh, 0.25f, targetError);
+
+    const size_t triangles = result.indices.size() / 3;
+
+    std::cout << "  " << mesh.indices32.size() / 3 << " -> " << triangles << " triangles, error " << result.error
+        << ", sag " << sourceDeviation << " -> " << GetSphereDeviation(mesh, result.indices) << "\n";
+
+    CHECK(triangles > 0);
+    CHECK(triangles <= mesh.indices32.size() / 3 / 4 + 1);
+    CHECK(result.error <= targetError);
+
+    // faces only sag as far as the accepted error allows
+    CHECK(GetSphereDeviation(mesh, result.indices) <= sourceDeviation + 2.f * targetError);
+
+    // the uv seam and the poles share positions across vertices, they are locked
+    const uint32_t rowSize = 129;
+
+    std::vector<uint8_t> referenced(mesh.vertices.size(), 0);
+
+    for (size_t i = 0; i < result.indices.size(); i += 3)
+    {
+        const uint32_t* pTriangle = &result.indices[i];
+
+        CHECK(pTriangle[0] != pTriangle[1] && pTriangle[1] != pTriangle[2] && pTriangle[0] != pTriangle[2]);
+
+        for (size_t corner = 0; corner < 3; ++corner)
+        {
+            referenced[pTriangle[corner]] = 1;
+        }
+    }
+
+    for (uint32_t ring = 1; ring < 64; ++ring)
+    {
+        CHECK(referenced[ring * rowSize]);
+        CHECK(referenced[ring * rowSize + 128]);
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(SimplifierStopsAtTheErrorLimit)
+{
+    sMeshData mesh;
+    cTestMeshes::BuildSphere(32, 64, mesh);
+
+    const sSimplifyResult tight = Simplify(mesh, 0.f, 1e-3f);
+    const sSimplifyResult loose = Simplify(mesh, 0.f, 1e-1f);
+
+    CHECK(tight.error <= 1e-3f);
+    CHECK(loose.error <= 1e-1f);
+    CHECK(tight.indices.size() > loose.indices.size());
+
+    // same input, same output
+    const sSimplifyResult again = Simplify(mesh, 0.f, 1e-1f);
+
+    CHECK(again.indices == loose.indices);
+    CHECK(again.error == loose.error);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// Speed and quality of single reductions of a large sphere, then the loader's LOD chain on the
+// --scene file when given.
+BENCHMARK(MeshSimplifier)
+{
+    sMeshData mesh;
+    cTestMeshes::BuildSphere(512, 1024, mesh);
+    cMeshOptimizer::OptimizeVertexCache(mesh.indices32.data(), mesh.indices32.size(), mesh.vertices.size());
+
+    const size_t sourceTriangles = mesh.indices32.size() / 3;
+
+    std::cout << "  sphere 512x1024, " << sourceTriangles << " triangles, sag " << GetSphereDeviation(mesh, mesh.indices32) << "\n";
+
+    for (float ratio : { 0.5f, 0.25f, 0.1f, 0.01f })
+    {
+        const sSimplifyResult result = Simplify(mesh, ratio, 1.f);
+
+        const std::string name = std::to_string(static_cast<int>(ratio * 100.f)) + "% target";
+
+        std::cout << "  " << name << ", " << result.indices.size() / 3 << " triangles\n";
+
+        cBenchmark::Report("time", result.seconds * 1000.0, "ms");
+        cBenchmark::Report("  throughput", sourceTriangles / result.seconds / 1e6, "Mtri/s");
+        cBenchmark::Report("  reported error", result.error * 1000.0, "x 1e-3");
+        cBenchmark::Report("  sphere sag", GetSphereDeviation(mesh, result.indices) * 1000.0, "x 1e-3");
+    }
+
+    const std::string scenePath = cTestRegistry::GetOption("--scene", "");
+
+    if (scenePath.empty())
+        return;
+
+    std::vector<sMeshData> meshes;
+    CHECK(cTestMeshes::LoadScene(scenePath.c_str(), meshes));
+
+    size_t triangles        = 0;
+    size_t halfTriangles    = 0;
+
+    const double seconds = cBenchmark::Measure(1, [&]()
+        {
+            for (const sMeshData& rMesh : meshes)
+            {
+                if (rMesh.indices32.empty())
+                    continue;
+
+                triangles       += rMesh.indices32.size() / 3;
+                halfTriangles   += Simplify(rMesh, 0.5f, 1e-2f).indices.size() / 3;
+            }
+        });
+
+    std::cout << "  scene " << scenePath << ", " << meshes.size() << " primitives, " << triangles << " triangles\n";
+
+    cBenchmark::Report("halving every primitive", seconds * 1000.0, "ms");
+    cBenchmark::Report("  triangles kept", 100.0 * halfTriangles / (std::max)(triangles, size_t(1)), "%");
+}
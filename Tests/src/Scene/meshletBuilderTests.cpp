@@ -0,0 +1,284 @@
+#include "testFramework.h"
+
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "Core/jobSystem.h"
+#include "Core/parallel.h"
+#include "Scene/meshOptimizer.h"
+#include "Scene/meshletBuilder.h"
+#include "Scene/testMeshes.h"
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// the loader's call, on the cache optimized order
+static void BuildMeshlets(sMeshData& _rMesh)
+{
+    cMeshletBuilder::Build(
+        _rMesh.indices32.data(), _rMesh.indices32.size(),
+        &_rMesh.vertices[0].position.x, _rMesh.vertices.size(), sizeof(sVertex),
+        _rMesh.meshletData);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+static bool IsSameMeshletData(const sMeshletData& _rA, const sMeshletData& _rB)
+{
+    return _rA.meshlets.size() == _rB.meshlets.size()
+        && _rA.vertices == _rB.vertices
+        && _rA.triangles == _rB.triangles
+        && std::memcmp(_rA.meshlets.data(), _rB.meshlets.data(), _rA.meshlets.size() * sizeof(sMeshlet)) == 0;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+static const float* GetPosition(const sMeshData& _rMesh, const sMeshlet& _rMeshlet, uint8_t _localIndex)
+{
+    return &_rMesh.vertices[_rMesh.meshletData.vertices[_rMeshlet.vertexOffset + _localIndex]].position.x;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(MeshletsCoverEveryTriangleInOrder)
+{
+    sMeshData mesh;
+    cTestMeshes::BuildSphere(48, 96, mesh);
+    cTestMeshes::ShuffleTriangles(mesh.indices32, 13);
+
+    // a degenerate triangle is dropped, everything else keeps the index buffer order
+    mesh.indices32.insert(mesh.indices32.begin() + 300, { 5, 5, 6 });
+
+    BuildMeshlets(mesh);
+
+    const sMeshletData& rData = mesh.meshletData;
+
+    std::vector<uint32_t> rebuilt;
+
+    uint32_t vertexOffset   = 0;
+    uint32_t triangleOffset = 0;
+
+    for (const sMeshlet& rMeshlet : rData.meshlets)
+    {
+        CHECK(rMeshlet.vertexCount > 0 && rMeshlet.vertexCount <= c_MeshletMaxVertices);
+        CHECK(rMeshlet.triangleCount > 0 && rMeshlet.triangleCount <= c_MeshletMaxTriangles);
+
+        // packed back to back, the cooked scene stores the pools as they are
+        CHECK(rMeshlet.vertexOffset == vertexOffset);
+        CHECK(rMeshlet.triangleOffset == triangleOffset);
+
+        vertexOffset    += rMeshlet.vertexCount;
+        triangleOffset  += rMeshlet.triangleCount * 3;
+
+        for (uint32_t i = 0; i < rMeshlet.triangleCount * 3u; ++i)
+        {
+            const uint8_t localIndex = rData.triangles[rMeshlet.triangleOffset + i];
+
+            CHECK(localIndex < rMeshlet.vertexCount);
+            rebuilt.push_back(rData.vertices[rMeshlet.vertexOffset + localIndex]);
+        }
+    }
+
+    CHECK(vertexOffset == rData.vertices.size());
+    CHECK(triangleOffset == rData.triangles.size());
+
+    mesh.indices32.erase(mesh.indices32.begin() + 300, mesh.indices32.begin() + 303);
+
+    CHECK(rebuilt == mesh.indices32);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(MeshletBoundsAreConservative)
+{
+    sMeshData mesh;
+    cTestMeshes::BuildSphere(64, 128, mesh);
+
+    cMeshOptimizer::OptimizeVertexCache(mesh.indices32.data(), mesh.indices32.size(), mesh.vertices.size());
+
+    BuildMeshlets(mesh);
+
+    std::mt19937 random(31);
+    std::uniform_real_distribution<float> coordinate(-4.f, 4.f);
+
+    size_t culled = 0;
+    size_t tested = 0;
+
+    for (const sMeshlet& rMeshlet : mesh.meshletData.meshlets)
+    {
+        for (uint8_t i = 0; i < rMeshlet.vertexCount; ++i)
+        {
+            const float* p = GetPosition(mesh, rMeshlet, i);
+
+            const float d[3] = { p[0] - rMeshlet.center[0], p[1] - rMeshlet.center[1], p[2] - rMeshlet.center[2] };
+
+            CHECK(std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]) <= rMeshlet.radius * (1.f + 1e-5f));
+        }
+
+        // a backfacing verdict must hold for every triangle, seen from anywhere
+        for (int sample = 0; sample < 64; ++sample)
+        {
+            const float eye[3] = { coordinate(random), coordinate(random), coordinate(random) };
+
+            ++tested;
+
+            if (!cMeshletBuilder::IsBackfacing(rMeshlet, eye))
+                continue;
+
+            ++culled;
+
+            const uint8_t* pTriangles = &mesh.meshletData.triangles[rMeshlet.triangleOffset];
+
+            for (uint32_t t = 0; t < rMeshlet.triangleCount; ++t)
+            {
+                const float* p0 = GetPosition(mesh, rMeshlet, pTriangles[t * 3 + 0]);
+                const float* p1 = GetPosition(mesh, rMeshlet, pTriangles[t * 3 + 1]);
+                const float* p2 = GetPosition(mesh, rMeshlet, pTriangles[t * 3 + 2]);
+
+                const float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+                const float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+
+                const float n[3] =
+                {
+                    e1[1] * e2[2] - e1[2] * e2[1],
+                    e1[2] * e2[0] - e1[0] * e2[2],
+                    e1[0] * e2[1] - e1[1] * e2[0],
+                };
+
+                const float toTriangle[3] = { p0[0] - eye[0], p0[1] - eye[1], p0[2] - eye[2] };
+
+                CHECK(n[0] * toTriangle[0] + n[1] * toTriangle[1] + n[2] * toTriangle[2] >= -1e-6f);
+            }
+        }
+    }
+
+    // small patches of a sphere seen from around it, a good part has to go
+    std::cout << "  " << culled << " of " << tested << " meshlet views culled by the cone\n";
+    CHECK(culled * 5 > tested);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(MeshletsAreDeterministicAcrossWorkers)
+{
+    std::vector<sMeshData> serial(24);
+
+    for (size_t i = 0; i < serial.size(); ++i)
+    {
+        cTestMeshes::BuildSphere(16 + static_cast<uint32_t>(i), 32, serial[i]);
+        cTestMeshes::ShuffleTriangles(serial[i].indices32, static_cast<uint32_t>(i));
+    }
+
+    std::vector<sMeshData> parallel = serial;
+
+    for (sMeshData& rMesh : serial)
+    {
+        BuildMeshlets(rMesh);
+    }
+
+    // one mesh per job, as the loader runs it
+    cParallel::For(parallel.size(), [&](size_t _meshIndex)
+        {
+            BuildMeshlets(parallel[_meshIndex]);
+        });
+
+    for (size_t i = 0; i < serial.size(); ++i)
+    {
+        CHECK(IsSameMeshletData(serial[i].meshletData, parallel[i].meshletData));
+    }
+
+    // and again on the same data
+    sMeshData again = serial[3];
+    BuildMeshlets(again);
+
+    CHECK(IsSameMeshletData(again.meshletData, serial[3].meshletData));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+static void ReportMeshes(const char* _pName, std::vector<sMeshData>& _rMeshes)
+{
+    size_t triangles = 0;
+
+    for (sMeshData& rMesh : _rMeshes)
+    {
+        cMeshOptimizer::OptimizeVertexCache(rMesh.indices32.data(), rMesh.indices32.size(), rMesh.vertices.size());
+        triangles += rMesh.indices32.size() / 3;
+    }
+
+    auto Run = [&](size_t _meshIndex)
+        {
+            if (!_rMeshes[_meshIndex].vertices.empty())
+                BuildMeshlets(_rMeshes[_meshIndex]);
+        };
+
+    const double serialSeconds = cBenchmark::Measure(3, [&]()
+        {
+            for (size_t i = 0; i < _rMeshes.size(); ++i)
+            {
+                Run(i);
+            }
+        });
+
+    size_t meshlets = 0;
+
+    for (const sMeshData& rMesh : _rMeshes)
+    {
+        meshlets += rMesh.meshletData.meshlets.size();
+    }
+
+    std::cout << "  " << _pName << ", " << triangles << " triangles, " << meshlets << " meshlets\n";
+
+    cBenchmark::Report("triangles per meshlet", static_cast<double>(triangles) / meshlets, "");
+    cBenchmark::Report("serial", serialSeconds * 1000.0, "ms");
+    cBenchmark::Report("  throughput", triangles / serialSeconds / 1e6, "Mtri/s");
+
+    const unsigned hardwareThreads = (std::max)(std::thread::hardware_concurrency(), 1u);
+
+    for (unsigned threads = 2; threads <= hardwareThreads; threads *= 2)
+    {
+        cJobSystem::Initialize(threads - 1);
+
+        const double parallelSeconds = cBenchmark::Measure(3, [&]()
+            {
+                cParallel::For(_rMeshes.size(), Run);
+            });
+
+        const std::string name = std::to_string(threads) + " threads, one mesh per job";
+
+        cBenchmark::Report(name.c_str(), parallelSeconds * 1000.0, "ms");
+        cBenchmark::Report("  speedup over serial", serialSeconds / parallelSeconds, "x");
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// Meshlet building on cache optimized meshes, serially and one mesh per job like the loader,
+// on a set of synthetic meshes and on the scene given with --scene.
+BENCHMARK(MeshletBuilder)
+{
+    std::vector<sMeshData> meshes(64);
+
+    for (size_t i = 0; i < meshes.size(); ++i)
+    {
+        if (i % 2 == 0)
+            cTestMeshes::BuildSphere(128, 256, meshes[i]);
+        else
+            cTestMeshes::BuildGrid(192, meshes[i]);
+    }
+
+    ReportMeshes("64 spheres and grids", meshes);
+
+    const std::string scenePath = cTestRegistry::GetOption("--scene", "");
+
+    if (!scenePath.empty())
+    {
+        CHECK(cTestMeshes::LoadScene(scenePath.c_str(), meshes));
+
+        const std::string name = "scene " + scenePath + ", " + std::to_string(meshes.size()) + " primitives";
+        ReportMeshes(name.c_str(), meshes);
+    }
+}
@@ -0,0 +1,203 @@
+#include "testFramework.h"
+
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "Core/jobSystem.h"
+#include "Scene/tangentGenerator.h"
+#include "Scene/testMeshes.h"
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// the loader's call
+static void GenerateTangents(sMeshData& _rMesh, bool _multithreaded)
+{
+    sVertex& rFirst = _rMesh.vertices[0];
+
+    const sTangentStreams streams =
+    {
+        &rFirst.position.x,
+        &rFirst.normal.x,
+        &rFirst.texC.x,
+        &rFirst.tangentU.x,
+        sizeof(sVertex)
+    };
+
+    cTangentGenerator::Generate(
+        _rMesh.indices32.data(), _rMesh.indices32.size(), _rMesh.vertices.size(), streams, _multithreaded);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(TangentsFollowTheUvDirection)
+{
+    sMeshData mesh;
+    cTestMeshes::BuildGrid(8, mesh);
+
+    sMeshData mirrored = mesh;
+
+    for (sVertex& rVertex : mirrored.vertices)
+    {
+        rVertex.texC.x = 1.f - rVertex.texC.x;
+    }
+
+    GenerateTangents(mesh, false);
+    GenerateTangents(mirrored, false);
+
+    for (size_t i = 0; i < mesh.vertices.size(); ++i)
+    {
+        const XMFLOAT4& rTangent    = mesh.vertices[i].tangentU;
+        const XMFLOAT4& rMirrored   = mirrored.vertices[i].tangentU;
+
+        // u runs along +x, v along +z while the normal map's +Y points the other way
+        CHECK_NEAR(rTangent.x, 1.f, 1e-5f);
+        CHECK_NEAR(rTangent.y, 0.f, 1e-5f);
+        CHECK_NEAR(rTangent.z, 0.f, 1e-5f);
+        CHECK(rTangent.w == 1.f);
+
+        CHECK_NEAR(rMirrored.x, -1.f, 1e-5f);
+        CHECK(rMirrored.w == -1.f);
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(TangentsAreOrthonormalToTheNormal)
+{
+    sMeshData mesh;
+    cTestMeshes::BuildSphere(32, 64, mesh);
+
+    GenerateTangents(mesh, false);
+
+    // the poles have no usable uv gradient, every other ring has to be a clean frame
+    for (const sVertex& rVertex : mesh.vertices)
+    {
+        if (std::fabs(rVertex.normal.y) > 0.999f)
+            continue;
+
+        const XMFLOAT4& rTangent = rVertex.tangentU;
+
+        const float length  = std::sqrt(rTangent.x * rTangent.x + rTangent.y * rTangent.y + rTangent.z * rTangent.z);
+        const float nDotT   = rTangent.x * rVertex.normal.x + rTangent.y * rVertex.normal.y + rTangent.z * rVertex.normal.z;
+
+        CHECK_NEAR(length, 1.f, 1e-4f);
+        CHECK_NEAR(nDotT, 0.f, 1e-4f);
+        CHECK(std::fabs(rTangent.w) == 1.f);
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(TangentsWithoutUvsFallBackToAFrameAroundTheNormal)
+{
+    sMeshData mesh;
+    cTestMeshes::BuildSphere(16, 32, mesh);
+
+    // every corner on the same uv, no face has a tangent
+    for (sVertex& rVertex : mesh.vertices)
+    {
+        rVertex.texC        = XMFLOAT2(0.5f, 0.5f);
+        rVertex.tangentU    = XMFLOAT4(NAN, NAN, NAN, NAN);
+    }
+
+    GenerateTangents(mesh, false);
+
+    for (const sVertex& rVertex : mesh.vertices)
+    {
+        const XMFLOAT4& rTangent = rVertex.tangentU;
+
+        const float length  = std::sqrt(rTangent.x * rTangent.x + rTangent.y * rTangent.y + rTangent.z * rTangent.z);
+        const float nDotT   = rTangent.x * rVertex.normal.x + rTangent.y * rVertex.normal.y + rTangent.z * rVertex.normal.z;
+
+        CHECK_NEAR(length, 1.f, 1e-4f);
+        CHECK_NEAR(nDotT, 0.f, 1e-4f);
+        CHECK(std::fabs(rTangent.w) == 1.f);
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+TEST_CASE(TangentsParallelMatchSerial)
+{
+    sMeshData serial;
+    cTestMeshes::BuildSphere(256, 256, serial);
+    cTestMeshes::ShuffleTriangles(serial.indices32, 3);
+
+    sMeshData parallel = serial;
+
+    GenerateTangents(serial, false);
+    GenerateTangents(parallel, true);
+
+    CHECK(std::memcmp(serial.vertices.data(), parallel.vertices.data(), serial.vertices.size() * sizeof(sVertex)) == 0);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+static void ReportMesh(const char* _pName, std::vector<sMeshData>& _rMeshes)
+{
+    size_t vertices = 0;
+
+    for (const sMeshData& rMesh : _rMeshes)
+    {
+        vertices += rMesh.vertices.size();
+    }
+
+    std::cout << "  " << _pName << ", " << vertices << " vertices\n";
+
+    auto Run = [&](bool _multithreaded)
+        {
+            for (sMeshData& rMesh : _rMeshes)
+            {
+                if (!rMesh.vertices.empty())
+                    GenerateTangents(rMesh, _multithreaded);
+            }
+        };
+
+    const double serialSeconds = cBenchmark::Measure(3, [&]() { Run(false); });
+
+    cBenchmark::Report("serial", serialSeconds * 1000.0, "ms");
+    cBenchmark::Report("  throughput", vertices / serialSeconds / 1e6, "Mvert/s");
+
+    const unsigned hardwareThreads = (std::max)(std::thread::hardware_concurrency(), 1u);
+
+    for (unsigned threads = 2; threads <= hardwareThreads; threads *= 2)
+    {
+        cJobSystem::Initialize(threads - 1);
+
+        const double parallelSeconds = cBenchmark::Measure(3, [&]() { Run(true); });
+
+        const std::string name = std::to_string(threads) + " threads";
+
+        cBenchmark::Report(name.c_str(), parallelSeconds * 1000.0, "ms");
+        cBenchmark::Report("  speedup over serial", serialSeconds / parallelSeconds, "x");
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// Tangent frames for large meshes on one thread and on every power of two worker count up to
+// the hardware threads, and for the scene given with --scene.
+BENCHMARK(TangentGenerator)
+{
+    std::vector<sMeshData> meshes(1);
+
+    cTestMeshes::BuildGrid(1024, meshes[0]);
+    ReportMesh("grid 1024x1024", meshes);
+
+    cTestMeshes::BuildSphere(1024, 2048, meshes[0]);
+    cTestMeshes::ShuffleTriangles(meshes[0].indices32, 4);
+    ReportMesh("sphere 1024x2048, shuffled", meshes);
+
+    const std::string scenePath = cTestRegistry::GetOption("--scene", "");
+
+    if (!scenePath.empty())
+    {
+        CHECK(cTestMeshes::LoadScene(scenePath.c_str(), meshes));
+
+        const std::string name = "scene " + scenePath + ", " + std::to_string(meshes.size()) + " primitives";
+        ReportMesh(name.c_str(), meshes);
+    }
+}
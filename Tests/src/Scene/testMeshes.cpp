@@ -0,0 +1,149 @@
+#include "Scene/testMeshes.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "Scene/gltfMeshReader.h"
+
+#include "tiny_gltf.h"
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTestMeshes::BuildGrid(uint32_t _gridSize, sMeshData& _rOutMesh)
+{
+    _rOutMesh = sMeshData();
+    _rOutMesh.materialId = 0;
+
+    for (uint32_t z = 0; z < _gridSize; ++z)
+    {
+        for (uint32_t x = 0; x < _gridSize; ++x)
+        {
+            sVertex vertex = {};
+            vertex.position = XMFLOAT3(static_cast<float>(x), 0.f, static_cast<float>(z));
+            vertex.normal   = XMFLOAT3(0.f, 1.f, 0.f);
+            vertex.texC     = XMFLOAT2(x / float(_gridSize - 1), z / float(_gridSize - 1));
+
+            _rOutMesh.vertices.push_back(vertex);
+        }
+    }
+
+    for (uint32_t z = 0; z + 1 < _gridSize; ++z)
+    {
+        for (uint32_t x = 0; x + 1 < _gridSize; ++x)
+        {
+            const uint32_t i = z * _gridSize + x;
+
+            // clockwise seen from above, the engine's front face
+            _rOutMesh.indices32.insert(_rOutMesh.indices32.end(), { i, i + _gridSize, i + 1, i + 1, i + _gridSize, i + _gridSize + 1 });
+        }
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTestMeshes::BuildSphere(uint32_t _rings, uint32_t _segments, sMeshData& _rOutMesh)
+{
+    _rOutMesh = sMeshData();
+    _rOutMesh.materialId = 0;
+
+    const float pi = 3.14159265358979f;
+
+    // the seam column is duplicated for its own uvs, like an exporter writes it
+    for (uint32_t ring = 0; ring <= _rings; ++ring)
+    {
+        const float theta = pi * ring / _rings;
+
+        for (uint32_t segment = 0; segment <= _segments; ++segment)
+        {
+            const float phi = 2.f * pi * segment / _segments;
+
+            const XMFLOAT3 direction(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+
+            sVertex vertex = {};
+            vertex.position = direction;
+            vertex.normal   = direction;
+            vertex.texC     = XMFLOAT2(segment / float(_segments), ring / float(_rings));
+
+            _rOutMesh.vertices.push_back(vertex);
+        }
+    }
+
+    const uint32_t rowSize = _segments + 1;
+
+    for (uint32_t ring = 0; ring < _rings; ++ring)
+    {
+        for (uint32_t segment = 0; segment < _segments; ++segment)
+        {
+            const uint32_t i = ring * rowSize + segment;
+
+            if (ring != 0)
+                _rOutMesh.indices32.insert(_rOutMesh.indices32.end(), { i, i + 1, i + rowSize });
+
+            if (ring + 1 != _rings)
+                _rOutMesh.indices32.insert(_rOutMesh.indices32.end(), { i + 1, i + rowSize + 1, i + rowSize });
+        }
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTestMeshes::ShuffleTriangles(std::vector<uint32_t>& _rIndices, uint32_t _seed)
+{
+    std::mt19937 random(_seed);
+
+    const size_t triangleCount = _rIndices.size() / 3;
+
+    for (size_t i = triangleCount; i > 1; --i)
+    {
+        const size_t j = std::uniform_int_distribution<size_t>(0, i - 1)(random);
+
+        std::swap_ranges(&_rIndices[(i - 1) * 3], &_rIndices[(i - 1) * 3] + 3, &_rIndices[j * 3]);
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+// keeps the encoded images, the mesh tests never look at them
+static bool SkipImage(tinygltf::Image*, const int, std::string*, std::string*, int, int, const unsigned char*, int, void*)
+{
+    return true;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+bool cTestMeshes::LoadScene(const char* _pPath, std::vector<sMeshData>& _rOutMeshes)
+{
+    tinygltf::Model     model;
+    tinygltf::TinyGLTF  loader;
+    std::string         error;
+    std::string         warning;
+
+    loader.SetImageLoader(SkipImage, nullptr);
+
+    const std::string path = _pPath;
+    const bool isBinary = path.size() > 4 && path.compare(path.size() - 4, 4, ".glb") == 0;
+
+    const bool loaded = isBinary
+        ? loader.LoadBinaryFromFile(&model, &error, &warning, path)
+        : loader.LoadASCIIFromFile(&model, &error, &warning, path);
+
+    if (!loaded)
+    {
+        std::cout << "  " << path << ": " << error << "\n";
+        return false;
+    }
+
+    _rOutMeshes.clear();
+
+    for (size_t mesh = 0; mesh < model.meshes.size(); ++mesh)
+    {
+        cGltfMeshReader::ReadMesh(model, static_cast<int>(mesh), _rOutMeshes);
+    }
+
+    return true;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
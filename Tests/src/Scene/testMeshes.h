@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Graphics/meshData.h"
+
+// Synthetic meshes shared by the mesh processing tests and benchmarks, and the meshes of a
+// glTF scene given with --scene. Everything is deterministic so results compare across runs.
+class cTestMeshes
+{
+	public:
+
+		// _gridSize x _gridSize vertices on the XZ plane, unit spacing, normals up
+		static void BuildGrid(uint32_t _gridSize, sMeshData& _rOutMesh);
+
+		// unit sphere with shared vertices, _rings latitude bands of _segments quads
+		static void BuildSphere(uint32_t _rings, uint32_t _segments, sMeshData& _rOutMesh);
+
+		// random triangle order, the worst case for an exporter that wrote faces unsorted
+		static void ShuffleTriangles(std::vector<uint32_t>& _rIndices, uint32_t _seed);
+
+		// every indexed primitive of the scene, false when the file cannot be parsed
+		static bool LoadScene(const char* _pPath, std::vector<sMeshData>& _rOutMeshes);
+};
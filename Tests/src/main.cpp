@@ -0,0 +1,8 @@
+#include "testFramework.h"
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+int main(int _argumentCount, char** _ppArguments)
+{
+    return cTestRegistry::Run(_argumentCount, _ppArguments);
+}
@@ -0,0 +1,174 @@
+#include "testFramework.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <limits>
+#include <string>
+
+#include "Core/jobSystem.h"
+
+struct sTestRun
+{
+    int         argumentCount   = 0;
+    char**      ppArguments     = nullptr;
+    unsigned    failedChecks    = 0;    // of the running case
+};
+
+static sTestRun s_run;
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+int cTestRegistry::Register(const char* _pName, void (*_pFunction)(), bool _isBenchmark)
+{
+    GetCases().push_back({ _pName, _pFunction, _isBenchmark });
+
+    return static_cast<int>(GetCases().size());
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+int cTestRegistry::Run(int _argumentCount, char** _ppArguments)
+{
+    s_run.argumentCount = _argumentCount;
+    s_run.ppArguments   = _ppArguments;
+
+    bool        runBenchmarks   = false;
+    const char* pFilter         = nullptr;
+
+    for (int i = 1; i < _argumentCount; ++i)
+    {
+        if (std::strcmp(_ppArguments[i], "--bench") == 0)
+        {
+            runBenchmarks = true;
+        }
+        else if (std::strncmp(_ppArguments[i], "--", 2) == 0)
+        {
+            ++i; // options take a value
+        }
+        else
+        {
+            pFilter = _ppArguments[i];
+        }
+    }
+
+    const unsigned workerCount = static_cast<unsigned>(std::atoi(GetOption("--workers", "0")));
+
+    unsigned ran    = 0;
+    unsigned failed = 0;
+
+    for (const sTestCase& rCase : GetCases())
+    {
+        if (rCase.isBenchmark != runBenchmarks)
+            continue;
+
+        if (pFilter && std::strstr(rCase.pName, pFilter) == nullptr)
+            continue;
+
+        std::cout << "[ RUN  ] " << rCase.pName << std::endl;
+
+        s_run.failedChecks = 0;
+
+        cJobSystem::Initialize(workerCount);
+
+        try
+        {
+            rCase.pFunction();
+        }
+        catch (const std::exception& _rException)
+        {
+            std::cout << "  exception: " << _rException.what() << "\n";
+            ++s_run.failedChecks;
+        }
+
+        cJobSystem::Shutdown();
+
+        ++ran;
+
+        if (s_run.failedChecks > 0)
+        {
+            ++failed;
+            std::cout << "[ FAIL ] " << rCase.pName << " (" << s_run.failedChecks << " checks)\n";
+        }
+        else
+        {
+            std::cout << "[  OK  ] " << rCase.pName << "\n";
+        }
+    }
+
+    std::cout << ran - failed << " of " << ran << (runBenchmarks ? " benchmarks" : " tests") << " passed\n";
+
+    return failed == 0 ? 0 : 1;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cTestRegistry::Fail(const char* _pFile, int _line, const char* _pExpression)
+{
+    // only the first few per case, a broken loop should not flood the log
+    if (s_run.failedChecks < 10)
+    {
+        std::cout << "  " << _pFile << ":" << _line << ": CHECK(" << _pExpression << ") failed\n";
+    }
+
+    ++s_run.failedChecks;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+const char* cTestRegistry::GetOption(const char* _pName, const char* _pDefault)
+{
+    for (int i = 1; i + 1 < s_run.argumentCount; ++i)
+    {
+        if (std::strcmp(s_run.ppArguments[i], _pName) == 0)
+            return s_run.ppArguments[i + 1];
+    }
+
+    return _pDefault;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+std::vector<sTestCase>& cTestRegistry::GetCases()
+{
+    // function local, the registrations run during static initialization of other files
+    static std::vector<sTestCase> s_cases;
+
+    return s_cases;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+double cBenchmark::Measure(unsigned _repetitions, const std::function<void()>& _function)
+{
+    using Clock = std::chrono::steady_clock;
+
+    double best = (std::numeric_limits<double>::max)();
+
+    for (unsigned i = 0; i < _repetitions; ++i)
+    {
+        const auto start = Clock::now();
+
+        _function();
+
+        best = (std::min)(best, std::chrono::duration<double>(Clock::now() - start).count());
+    }
+
+    return best;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+void cBenchmark::Report(const char* _pName, double _value, const char* _pUnit)
+{
+    char line[160];
+    std::snprintf(line, sizeof(line), "  %-48s %12.3f %s\n", _pName, _value, _pUnit);
+
+    std::cout << line;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cmath>
+#include <functional>
+#include <vector>
+
+// Self registering checks for the headless Tests project. TEST_CASE bodies run on every
+// invocation, BENCHMARK bodies only with --bench. A failed CHECK is reported and the case
+// goes on, an exception ends the case as failed. Every case starts with a fresh cJobSystem.
+struct sTestCase
+{
+	const char*	pName;
+	void		(*pFunction)();
+	bool		isBenchmark;
+};
+
+class cTestRegistry
+{
+	public:
+
+		static int Register(const char* _pName, void (*_pFunction)(), bool _isBenchmark);
+
+		// Tests [--bench] [--workers N] [--scene path] [name filter]
+		static int Run(int _argumentCount, char** _ppArguments);
+
+		static void Fail(const char* _pFile, int _line, const char* _pExpression);
+
+		// the argument following _pName, _pDefault when it was not given
+		static const char* GetOption(const char* _pName, const char* _pDefault);
+
+	private:
+
+		static std::vector<sTestCase>& GetCases();
+};
+
+class cBenchmark
+{
+	public:
+
+		// fastest of _repetitions runs, in seconds
+		static double Measure(unsigned _repetitions, const std::function<void()>& _function);
+
+		// one aligned result line
+		static void Report(const char* _pName, double _value, const char* _pUnit);
+};
+
+#define TEST_CASE(_name) \
+	static void _name(); \
+	static const int s_register##_name = cTestRegistry::Register(#_name, &_name, false); \
+	static void _name()
+
+#define BENCHMARK(_name) \
+	static void _name(); \
+	static const int s_register##_name = cTestRegistry::Register(#_name, &_name, true); \
+	static void _name()
+
+#define CHECK(_expression) \
+	do { if (!(_expression)) cTestRegistry::Fail(__FILE__, __LINE__, #_expression); } while (false)
+
+#define CHECK_NEAR(_a, _b, _tolerance) \
+	CHECK(std::fabs(static_cast<double>(_a) - static_cast<double>(_b)) <= static_cast<double>(_tolerance))
@@ -0,0 +1,5 @@
+// the engine compiles tinygltf inside modelLoader.cpp, the tests only need the parser
+#define STB_IMAGE_IMPLEMENTATION
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#define TINYGLTF_IMPLEMENTATION
+#include "tiny_gltf.h"
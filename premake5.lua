@@ -13,6 +13,10 @@ IncludeDir["D3DX"]        = "External/d3dx"
 IncludeDir["tinygltf"]    = "External/tinygltf"
 IncludeDir["DDSTextureLoader"] = "External/DDSLoader" 
 
+-- Linux only, Windows builds take DirectXMath and sal.h from the Windows SDK
+IncludeDir["DirectXMath"] = "External/DirectXMath/Inc"
+IncludeDir["SalStubs"]    = "External/DirectX-Headers/include/wsl/stubs"
+
 -- ================================
 -- Engine Project
 -- ================================
@@ -98,6 +102,69 @@ project "Game"
         "dxguid"
     }
 
+    filter "configurations:Debug"
+        symbols "On"
+
+    filter "configurations:Release"
+        optimize "On"
+
+-- ================================
+-- Tests Project (headless, Windows and Linux)
+-- ================================
+project "Tests"
+    location "Tests"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++17"
+    staticruntime "on"
+
+    targetdir ("bin/" .. outputdir .. "/%{prj.name}")
+    objdir    ("bin-int/" .. outputdir .. "/%{prj.name}")
+
+    -- only the platform neutral engine sources, the Engine library needs D3D12
+    files {
+        "Tests/src/**.h",
+        "Tests/src/**.cpp",
+        "Engine/src/Core/hash.cpp",
+        "Engine/src/Core/jobSystem.cpp",
+        "Engine/src/Core/parallel.cpp",
+        "Engine/src/Graphics/blockCompressor.cpp",
+        "Engine/src/Graphics/drawChunks.cpp",
+        "Engine/src/Graphics/mipGenerator.cpp",
+        "Engine/src/Graphics/textureFootprint.cpp",
+        "Engine/src/Graphics/texturePacker.cpp",
+        "Engine/src/Graphics/textureRegistry.cpp",
+        "Engine/src/Graphics/textureStreamer.cpp",
+        "Engine/src/Graphics/transformSystem.cpp",
+        "Engine/src/Graphics/vertexQuantization.cpp",
+        "Engine/src/Scene/gltfMeshReader.cpp",
+        "Engine/src/Scene/meshOptimizer.cpp",
+        "Engine/src/Scene/meshSimplifier.cpp",
+        "Engine/src/Scene/meshletBuilder.cpp",
+        "Engine/src/Scene/tangentGenerator.cpp",
+    }
+
+    includedirs {
+        "Tests/src",
+        "Engine/src",
+        IncludeDir["tinygltf"],
+    }
+
+    vpaths {
+        ["Tests/*"]     = "Tests/src/**",
+        ["Engine/*"]    = "Engine/src/**",
+    }
+
+    filter "system:linux"
+        includedirs {
+            IncludeDir["DirectXMath"],
+            IncludeDir["SalStubs"],
+        }
+        links { "pthread" }
+
+        -- no fused multiply-add contraction, the bit exact tests expect the engine's separate mul / add
+        buildoptions { "-ffp-contract=off" }
+
     filter "configurations:Debug"
         symbols "On"
 